@@ -55,6 +55,9 @@
 #include "hal_key.h"
 #include "hal_lcd.h"
 #include "hal_led.h"
+#if (defined HAL_OTA_XNV_ERASE) && (HAL_OTA_XNV_ERASE == TRUE)
+#include "hal_ota.h"
+#endif
 #include "hal_sleep.h"
 #include "hal_timer.h"
 #include "hal_types.h"
@@ -289,6 +292,11 @@ void Hal_ProcessPoll ()
 #if (defined HAL_HID) && (HAL_HID == TRUE)
   usbHidProcessEvents();
 #endif
+
+  /* OTA Xtra-NV erase-ahead */
+#if (defined HAL_OTA_XNV_ERASE) && (HAL_OTA_XNV_ERASE == TRUE)
+  HalOTAPoll();
+#endif
  
 }
 
@@ -112,6 +112,86 @@ void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt);
  */
 void HalFlashErase(uint8 pg);
 
+#if (defined HAL_FLASH_ASYNC) && (HAL_FLASH_ASYNC == TRUE)
+/**************************************************************************************************
+ * @fn          HalFlashWriteAsync
+ *
+ * @brief       This function queues a write of 'cnt' 4-byte blocks to the internal flash and
+ *              returns while it is programmed. HalFlashRead(), HalFlashWrite() and
+ *              HalFlashErase() first wait for the queued writes to be done.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4, untouched until done.
+ * @param       cnt - Number of 4-byte blocks to write.
+ * @param       taskId - OSAL task to signal when the write is done, or TASK_NO_TASK.
+ * @param       event - OSAL event to set for the task.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the write was queued; FALSE if HAL_FLASH_ASYNC_CNT writes already are.
+ **************************************************************************************************
+ */
+uint8 HalFlashWriteAsync(uint16 addr, uint8 *buf, uint16 cnt, uint8 taskId, uint16 event);
+
+/**************************************************************************************************
+ * @fn          HalFlashBusy
+ *
+ * @brief       This function counts the writes queued by HalFlashWriteAsync() not yet done.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The number of queued writes, zero when the flash is idle.
+ **************************************************************************************************
+ */
+uint8 HalFlashBusy(void);
+
+/**************************************************************************************************
+ * @fn          HalFlashWait
+ *
+ * @brief       This function waits until the writes queued by HalFlashWriteAsync() are done.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashWait(void);
+
+/**************************************************************************************************
+ * @fn          HalFlashDmaIsr
+ *
+ * @brief       This function is called by the DMA ISR for the NV DMA channel.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashDmaIsr(void);
+#endif
+
 #ifdef __cplusplus
 };
 #endif
@@ -115,6 +115,9 @@ extern "C"
 
 typedef void (*halUARTCBack_t) (uint8 port, uint8 event);
 
+/* Releases a buffer handed to HalUARTWriteQueue() once it has been sent. */
+typedef void (*halUARTTxFree_t) (uint8 *pBuffer);
+
 typedef struct
 {
   // The head or tail is updated by the Tx or Rx ISR respectively, when not polled.
@@ -138,6 +141,22 @@ typedef struct
   halUARTCBack_t      callBackFunc;
 }halUARTCfg_t;
 
+/* Received bytes lent in place by HalUARTPeek(): byte i is at pData[i * stride]. */
+typedef struct
+{
+  uint8  *pData;
+  uint16 len;
+  uint8  stride;
+}halUARTSpan_t;
+
+typedef struct
+{
+  uint16 sent;      // Buffers sent and released.
+  uint16 drop;      // Buffers refused because the Tx queue was full.
+  uint8  depth;     // Buffers queued or in flight now.
+  uint8  depthMax;  // High-water mark of depth.
+}halUARTTxQStat_t;
+
 typedef union
 {
   bool paramCTS;
@@ -180,11 +199,31 @@ extern void HalUARTClose ( uint8 port );
  */
 extern uint16 HalUARTRead ( uint8 port, uint8 *pBuffer, uint16 length );
 
+/*
+ * Lend the contiguous bytes at the head of the Rx buffer without copying them (HAL_UART_SPAN)
+ */
+extern uint16 HalUARTPeek ( uint8 port, halUARTSpan_t *pSpan );
+
+/*
+ * Release bytes lent by HalUARTPeek() from the head of the Rx buffer (HAL_UART_SPAN)
+ */
+extern void HalUARTConsume ( uint8 port, uint16 length );
+
 /*
  * Write a buff to the uart *
  */
 extern uint16 HalUARTWrite ( uint8 port, uint8 *pBuffer, uint16 length );
 
+/*
+ * Queue a buffer to be sent in place and released by pfnFree, or refuse it when full (HAL_UART_TXQ)
+ */
+extern uint8 HalUARTWriteQueue ( uint8 port, uint8 *pBuffer, uint16 length, halUARTTxFree_t pfnFree );
+
+/*
+ * Read, and optionally clear, the Tx queue counters (HAL_UART_TXQ)
+ */
+extern void HalUARTTxQStat ( uint8 port, halUARTTxQStat_t *pStat, uint8 clear );
+
 /*
  * Write a buffer to the UART
  */
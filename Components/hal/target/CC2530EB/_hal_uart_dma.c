@@ -64,10 +64,12 @@
 #define HAL_UART_DMA_NEW_RX_BYTE(IDX)  (DMA_PAD == LO_UINT16(dmaCfg.rxBuf[(IDX)]))
 #define HAL_UART_DMA_GET_RX_BYTE(IDX)  (HI_UINT16(dmaCfg.rxBuf[(IDX)]))
 #define HAL_UART_DMA_CLR_RX_BYTE(IDX)  (dmaCfg.rxBuf[(IDX)] = BUILD_UINT16((DMA_PAD ^ 0xFF), 0))
+#define HAL_UART_DMA_RX_BYTE_PTR(IDX)  ((uint8 *)(dmaCfg.rxBuf + (IDX)) + 1)
 #else
 #define HAL_UART_DMA_NEW_RX_BYTE(IDX)  (DMA_PAD == HI_UINT16(dmaCfg.rxBuf[(IDX)]))
 #define HAL_UART_DMA_GET_RX_BYTE(IDX)  (LO_UINT16(dmaCfg.rxBuf[(IDX)]))
 #define HAL_UART_DMA_CLR_RX_BYTE(IDX)  (dmaCfg.rxBuf[(IDX)] = BUILD_UINT16(0, (DMA_PAD ^ 0xFF)))
+#define HAL_UART_DMA_RX_BYTE_PTR(IDX)  ((uint8 *)(dmaCfg.rxBuf + (IDX)))
 #endif
 
 /*********************************************************************
@@ -184,6 +186,17 @@
 #define HAL_UART_DMA_FULL         (HAL_UART_DMA_RX_MAX - 16)
 #endif
 
+#if HAL_UART_TXQ
+#if !defined HAL_UART_DMA_TXQ_CNT
+#define HAL_UART_DMA_TXQ_CNT       8
+#endif
+
+// State of the buffer at the head of the Tx queue.
+#define HAL_UART_TXQ_IDLE          0
+#define HAL_UART_TXQ_BUSY          1   // Owned by the Tx DMA.
+#define HAL_UART_TXQ_DONE          2   // Sent by the Tx DMA, to be released by the poll.
+#endif
+
 #if defined HAL_BOARD_CC2430EB || defined HAL_BOARD_CC2430DB || defined HAL_BOARD_CC2430BB
 #define HAL_DMA_U0DBUF             0xDFC1
 #define HAL_DMA_U1DBUF             0xDFF9
@@ -220,6 +233,15 @@ typedef uint8 txIdx_t;
 typedef uint16 txIdx_t;
 #endif
 
+#if HAL_UART_TXQ
+typedef struct
+{
+  uint8 *pBuf;
+  uint16 len;
+  halUARTTxFree_t pfnFree;
+} txDesc_t;
+#endif
+
 typedef struct
 {
   uint16 rxBuf[HAL_UART_DMA_RX_MAX];
@@ -241,6 +263,16 @@ typedef struct
   volatile uint8 txShdwValid; // TX shadow value is valid
   uint8 txDMAPending;     // UART TX DMA is pending
 
+#if HAL_UART_TXQ
+  // Buffers queued by HalUARTWriteQueue() are sent in place, each by its own DMA transfer,
+  // whenever the double buffer above is neither in flight nor pending.
+  txDesc_t txQ[HAL_UART_DMA_TXQ_CNT];
+  uint8 txQHead;
+  uint8 txQCnt;
+  volatile uint8 txQState;
+  halUARTTxQStat_t txQStat;
+#endif
+
   halUARTCBack_t uartCB;
 } uartDMACfg_t;
 
@@ -270,7 +302,15 @@ static rxIdx_t findTail(void);
 static void HalUARTInitDMA(void);
 static void HalUARTOpenDMA(halUARTCfg_t *config);
 static uint16 HalUARTReadDMA(uint8 *buf, uint16 len);
+#if HAL_UART_SPAN
+static uint16 HalUARTPeekDMA(halUARTSpan_t *pSpan);
+static void HalUARTConsumeDMA(uint16 len);
+#endif
 static uint16 HalUARTWriteDMA(uint8 *buf, uint16 len);
+#if HAL_UART_TXQ
+static uint8 HalUARTWriteQueueDMA(uint8 *buf, uint16 len, halUARTTxFree_t pfnFree);
+static void HalUARTTxQStatDMA(halUARTTxQStat_t *pStat, uint8 clear);
+#endif
 static void HalUARTPollDMA(void);
 static uint16 HalUARTRxAvailDMA(void);
 static void HalUARTSuspendDMA(void);
@@ -524,6 +564,60 @@ static uint16 HalUARTReadDMA(uint8 *buf, uint16 len)
   return cnt;
 }
 
+#if HAL_UART_SPAN
+/*****************************************************************************
+ * @fn      HalUARTPeekDMA
+ *
+ * @brief   Lend the bytes received from the head of rxBuf up to the first
+ *          entry not yet written by the DMA or the end of rxBuf, in place.
+ *
+ * @param   pSpan - span to fill; each byte is interleaved with its marker.
+ *
+ * @return  number of bytes in the span
+ *****************************************************************************/
+static uint16 HalUARTPeekDMA(halUARTSpan_t *pSpan)
+{
+  uint16 idx = dmaCfg.rxHead;
+
+  pSpan->pData = HAL_UART_DMA_RX_BYTE_PTR(idx);
+  pSpan->stride = sizeof(dmaCfg.rxBuf[0]);
+
+  while ((idx < HAL_UART_DMA_RX_MAX) && HAL_UART_DMA_NEW_RX_BYTE(idx))
+  {
+    idx++;
+  }
+  pSpan->len = idx - dmaCfg.rxHead;
+
+  return pSpan->len;
+}
+
+/*****************************************************************************
+ * @fn      HalUARTConsumeDMA
+ *
+ * @brief   Hand entries lent by HalUARTPeekDMA() back to the DMA.
+ *
+ * @param   len - number of bytes to release, at most the span length
+ *
+ * @return  none
+ *****************************************************************************/
+static void HalUARTConsumeDMA(uint16 len)
+{
+  while (len--)
+  {
+    HAL_UART_DMA_CLR_RX_BYTE(dmaCfg.rxHead);
+#if HAL_UART_DMA_RX_MAX == 256
+    (dmaCfg.rxHead)++;
+#else
+    if (++(dmaCfg.rxHead) >= HAL_UART_DMA_RX_MAX)
+    {
+      dmaCfg.rxHead = 0;
+    }
+#endif
+  }
+  PxOUT &= ~HAL_UART_Px_RTS;  // Re-enable the flow on any read.
+}
+#endif
+
 /******************************************************************************
  * @fn      HalUARTWriteDMA
  *
@@ -582,6 +676,72 @@ static uint16 HalUARTWriteDMA(uint8 *buf, uint16 len)
   return cnt;
 }
 
+#if HAL_UART_TXQ
+/******************************************************************************
+ * @fn      HalUARTWriteQueueDMA
+ *
+ * @brief   Queue a buffer to be sent in place by the Tx DMA.
+ *
+ * @param   buf     - pointer to the buffer, owned by the driver until released
+ *          len     - length of the buffer
+ *          pfnFree - function to release the buffer once it has been sent
+ *
+ * @return  TRUE if queued; FALSE if the queue is full and the caller keeps the buffer
+ *****************************************************************************/
+static uint8 HalUARTWriteQueueDMA(uint8 *buf, uint16 len, halUARTTxFree_t pfnFree)
+{
+  txDesc_t *pDesc;
+
+  if (dmaCfg.txQCnt >= HAL_UART_DMA_TXQ_CNT)
+  {
+    dmaCfg.txQStat.drop++;
+    return FALSE;
+  }
+
+  if (len == 0)
+  {
+    pfnFree(buf);
+    return TRUE;
+  }
+
+  // Only the poll, never the DMA ISR, moves the queue head and count.
+  pDesc = dmaCfg.txQ + ((dmaCfg.txQHead + dmaCfg.txQCnt) % HAL_UART_DMA_TXQ_CNT);
+  pDesc->pBuf = buf;
+  pDesc->len = len;
+  pDesc->pfnFree = pfnFree;
+
+  if (++dmaCfg.txQCnt > dmaCfg.txQStat.depthMax)
+  {
+    dmaCfg.txQStat.depthMax = dmaCfg.txQCnt;
+  }
+
+  return TRUE;
+}
+
+/******************************************************************************
+ * @fn      HalUARTTxQStatDMA
+ *
+ * @brief   Read the Tx queue counters.
+ *
+ * @param   pStat - pointer to the counters to fill
+ *          clear - TRUE to restart the sent and drop counts and the high-water mark
+ *
+ * @return  none
+ *****************************************************************************/
+static void HalUARTTxQStatDMA(halUARTTxQStat_t *pStat, uint8 clear)
+{
+  dmaCfg.txQStat.depth = dmaCfg.txQCnt;
+  *pStat = dmaCfg.txQStat;
+
+  if (clear)
+  {
+    dmaCfg.txQStat.sent = 0;
+    dmaCfg.txQStat.drop = 0;
+    dmaCfg.txQStat.depthMax = dmaCfg.txQCnt;
+  }
+}
+#endif
+
 /******************************************************************************
  * @fn      HalUARTPollDMA
  *
@@ -654,6 +814,22 @@ static void HalUARTPollDMA(void)
     evt |= HAL_UART_TX_EMPTY;
   }
 
+#if HAL_UART_TXQ
+  if (dmaCfg.txQState == HAL_UART_TXQ_DONE)
+  {
+    txDesc_t *pDesc = dmaCfg.txQ + dmaCfg.txQHead;
+
+    if (++dmaCfg.txQHead >= HAL_UART_DMA_TXQ_CNT)
+    {
+      dmaCfg.txQHead = 0;
+    }
+    dmaCfg.txQCnt--;
+    dmaCfg.txQStat.sent++;
+    dmaCfg.txQState = HAL_UART_TXQ_IDLE;
+    pDesc->pfnFree(pDesc->pBuf);
+  }
+#endif
+
   if (dmaCfg.txShdwValid)
   {
     uint8 decr = ST0;
@@ -667,7 +843,11 @@ static void HalUARTPollDMA(void)
     }
   }
   
+#if HAL_UART_TXQ
+  if (dmaCfg.txDMAPending && !dmaCfg.txShdwValid && (dmaCfg.txQState != HAL_UART_TXQ_BUSY))
+#else
   if (dmaCfg.txDMAPending && !dmaCfg.txShdwValid)
+#endif
   {
     // UART TX DMA is expected to be fired and enough time has lapsed since last DMA ISR
     // to know that DBUF can be overwritten
@@ -690,13 +870,47 @@ static void HalUARTPollDMA(void)
     HAL_DMA_MAN_TRIGGER(HAL_DMA_CH_TX);
     HAL_EXIT_CRITICAL_SECTION(intState);
   }
+#if HAL_UART_TXQ
+  else if (dmaCfg.txQCnt && (dmaCfg.txQState == HAL_UART_TXQ_IDLE) && !dmaCfg.txDMAPending
+                         && !dmaCfg.txShdwValid && (dmaCfg.txIdx[dmaCfg.txSel ^ 1] == 0))
+  {
+    // Neither buffer of the double buffer is in flight, so send the queue head in place.
+    halDMADesc_t *ch = HAL_DMA_GET_DESC1234(HAL_DMA_CH_TX);
+    txDesc_t *pDesc = dmaCfg.txQ + dmaCfg.txQHead;
+    halIntState_t intState;
+
+    dmaCfg.txQState = HAL_UART_TXQ_BUSY;
+
+    HAL_DMA_SET_SOURCE(ch, pDesc->pBuf);
+    HAL_DMA_SET_LEN(ch, pDesc->len);
+    HAL_ENTER_CRITICAL_SECTION(intState);
+    HAL_DMA_ARM_CH(HAL_DMA_CH_TX);
+    do
+    {
+      asm("NOP");
+    } while (!HAL_DMA_CH_ARMED(HAL_DMA_CH_TX));
+    HAL_DMA_CLEAR_IRQ(HAL_DMA_CH_TX);
+    HAL_DMA_MAN_TRIGGER(HAL_DMA_CH_TX);
+    HAL_EXIT_CRITICAL_SECTION(intState);
+  }
+#endif
   else
   {
     halIntState_t his;
 
+    // A pending restart means the DMA ISR has already run and is waiting out the shadow;
+    // running it again here would restart the wait and stall back-to-back data.
     HAL_ENTER_CRITICAL_SECTION(his);
-    if ((dmaCfg.txIdx[dmaCfg.txSel] != 0) && !HAL_DMA_CH_ARMED(HAL_DMA_CH_TX)
+#if HAL_UART_TXQ
+    if (((dmaCfg.txIdx[dmaCfg.txSel] != 0) || (dmaCfg.txQState == HAL_UART_TXQ_BUSY))
+                                          && !dmaCfg.txDMAPending
+                                          && !HAL_DMA_CH_ARMED(HAL_DMA_CH_TX)
                                           && !HAL_DMA_CHECK_IRQ(HAL_DMA_CH_TX))
+#else
+    if ((dmaCfg.txIdx[dmaCfg.txSel] != 0) && !dmaCfg.txDMAPending
+                                          && !HAL_DMA_CH_ARMED(HAL_DMA_CH_TX)
+                                          && !HAL_DMA_CHECK_IRQ(HAL_DMA_CH_TX))
+#endif
     {
       HAL_EXIT_CRITICAL_SECTION(his);
       HalUARTIsrDMA();
@@ -792,6 +1006,14 @@ void HalUARTIsrDMA(void)
   // Indicate that the other buffer is free now.
   dmaCfg.txIdx[(dmaCfg.txSel ^ 1)] = 0;
   dmaCfg.txMT = TRUE;
+
+#if HAL_UART_TXQ
+  // The transfer just completed may have been the queue head rather than the double buffer.
+  if (dmaCfg.txQState == HAL_UART_TXQ_BUSY)
+  {
+    dmaCfg.txQState = HAL_UART_TXQ_DONE;
+  }
+#endif
   
   // Set TX shadow
   dmaCfg.txShdw = ST0;
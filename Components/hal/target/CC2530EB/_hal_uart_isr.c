@@ -218,6 +218,10 @@ static uartISRCfg_t isrCfg;
 static void HalUARTInitISR(void);
 static void HalUARTOpenISR(halUARTCfg_t *config);
 uint16 HalUARTReadISR(uint8 *buf, uint16 len);
+#if HAL_UART_SPAN
+static uint16 HalUARTPeekISR(halUARTSpan_t *pSpan);
+static void HalUARTConsumeISR(uint16 len);
+#endif
 uint16 HalUARTWriteISR(uint8 *buf, uint16 len);
 static void HalUARTPollISR(void);
 static uint16 HalUARTRxAvailISR(void);
@@ -358,6 +362,48 @@ uint16 HalUARTReadISR(uint8 *buf, uint16 len)
   return cnt;
 }
 
+#if HAL_UART_SPAN
+/*****************************************************************************
+ * @fn      HalUARTPeekISR
+ *
+ * @brief   Lend the bytes received from the head of rxBuf up to the tail or
+ *          the end of rxBuf, in place.
+ *
+ * @param   pSpan - span to fill
+ *
+ * @return  number of bytes in the span
+ *****************************************************************************/
+static uint16 HalUARTPeekISR(halUARTSpan_t *pSpan)
+{
+  uint16 tail = isrCfg.rxTail;
+
+  pSpan->pData = isrCfg.rxBuf + isrCfg.rxHead;
+  pSpan->stride = 1;
+  pSpan->len = (tail >= isrCfg.rxHead) ? (tail - isrCfg.rxHead) : (HAL_UART_ISR_RX_MAX - isrCfg.rxHead);
+
+  return pSpan->len;
+}
+
+/*****************************************************************************
+ * @fn      HalUARTConsumeISR
+ *
+ * @brief   Release bytes lent by HalUARTPeekISR() to the Rx ISR.
+ *
+ * @param   len - number of bytes to release, at most the span length
+ *
+ * @return  none
+ *****************************************************************************/
+static void HalUARTConsumeISR(uint16 len)
+{
+  len += isrCfg.rxHead;
+  if (len >= HAL_UART_ISR_RX_MAX)
+  {
+    len -= HAL_UART_ISR_RX_MAX;
+  }
+  isrCfg.rxHead = len;
+}
+#endif
+
 /******************************************************************************
  * @fn      HalUARTWriteISR
  *
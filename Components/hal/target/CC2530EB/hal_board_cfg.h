@@ -507,6 +507,20 @@ st( \
 #define HAL_FLASH TRUE
 #endif
 
+/* Set to TRUE to enable HalFlashWriteAsync(), FALSE disable it */
+#ifndef HAL_FLASH_ASYNC
+#define HAL_FLASH_ASYNC FALSE
+#endif
+
+/* Writes that HalFlashWriteAsync() can queue */
+#ifndef HAL_FLASH_ASYNC_CNT
+#define HAL_FLASH_ASYNC_CNT 4
+#endif
+
+#if (HAL_FLASH_ASYNC == TRUE) && (HAL_DMA != TRUE)
+#error HAL_FLASH_ASYNC programs the flash with the NV DMA channel.
+#endif
+
 /* Set to TRUE enable AES usage, FALSE disable it */
 #ifndef HAL_AES
 #define HAL_AES TRUE
@@ -584,6 +598,18 @@ st( \
 
 /* USB is not used for CC2530 configuration */
 #define HAL_UART_USB  0
+
+/* The DMA and ISR drivers can lend their Rx buffers in place by HalUARTPeek() & HalUARTConsume(),
+ * for MT_UART to parse frames without copying them byte by byte.
+ */
+#ifndef HAL_UART_SPAN
+#define HAL_UART_SPAN  FALSE
+#endif
+
+/* The DMA driver can send buffers queued by HalUARTWriteQueue() in place, one DMA transfer each. */
+#ifndef HAL_UART_TXQ
+#define HAL_UART_TXQ  FALSE
+#endif
 #endif
 /*******************************************************************************************************
 */
@@ -44,6 +44,7 @@
 #include "hal_types.h"
 #include "hal_defs.h"
 #include "hal_dma.h"
+#include "hal_flash.h"
 #include "hal_mcu.h"
 #include "hal_uart.h"
 
@@ -104,14 +105,16 @@ void HalDmaInit( void )
   HAL_DMA_SET_ADDR_DESC1234( dmaCh1234 );
 #if (HAL_UART_DMA || \
    ((defined HAL_SPI) && (HAL_SPI == TRUE))  || \
-   ((defined HAL_IRGEN) && (HAL_IRGEN == TRUE)))
+   ((defined HAL_IRGEN) && (HAL_IRGEN == TRUE)) || \
+   (HAL_FLASH_ASYNC == TRUE))
   DMAIE = 1;
 #endif
 }
 
 #if (HAL_UART_DMA || \
    ((defined HAL_SPI) && (HAL_SPI == TRUE))  || \
-   ((defined HAL_IRGEN) && (HAL_IRGEN == TRUE)))
+   ((defined HAL_IRGEN) && (HAL_IRGEN == TRUE)) || \
+   (HAL_FLASH_ASYNC == TRUE))
 /******************************************************************************
  * @fn      HalDMAInit
  *
@@ -158,6 +161,14 @@ HAL_ISR_FUNCTION( halDmaIsr, DMA_VECTOR )
   }
 #endif // (defined HAL_IRGEN) && (HAL_IRGEN == TRUE)
 
+#if (HAL_FLASH_ASYNC == TRUE)
+  if ( HAL_DMA_CHECK_IRQ( HAL_NV_DMA_CH ) )
+  {
+    HAL_DMA_CLEAR_IRQ( HAL_NV_DMA_CH );
+    HalFlashDmaIsr();
+  }
+#endif // (HAL_FLASH_ASYNC == TRUE)
+
   CLEAR_SLEEP_MODE();
   HAL_EXIT_ISR();
 }
@@ -47,6 +47,51 @@
 #include "hal_flash.h"
 #include "hal_mcu.h"
 #include "hal_types.h"
+#if HAL_FLASH_ASYNC
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Typedefs
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#if HAL_FLASH_ASYNC
+typedef struct
+{
+  uint8 *buf;
+  uint16 addr;
+  uint16 cnt;
+  uint16 event;
+  uint8 taskId;
+} halFlashReq_t;
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#if HAL_FLASH_ASYNC
+// Queue of the writes from HalFlashWriteAsync(); the one at the head is being programmed.
+static halFlashReq_t halFlashQ[HAL_FLASH_ASYNC_CNT];
+static volatile uint8 halFlashQHead;
+static volatile uint8 halFlashQCnt;
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#if (defined HAL_DMA) && (HAL_DMA == TRUE)
+static void halFlashDmaArm(uint8 *buf, uint16 cnt, uint8 irq);
+#endif
+#if HAL_FLASH_ASYNC
+static void halFlashStart(void);
+static void halFlashPoll(void);
+#endif
 
 /**************************************************************************************************
  * @fn          HalFlashRead
@@ -78,6 +123,10 @@ void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
   halIntState_t is;
 #endif
 
+#if HAL_FLASH_ASYNC
+  HalFlashWait();  // The data may still be queued.
+#endif
+
   pg /= HAL_FLASH_PAGE_PER_BANK;  // Calculate the flash bank from the flash page.
 
 #if (!defined HAL_OAD_BOOT_CODE) && (!defined HAL_OTA_BOOT_CODE)
@@ -120,6 +169,239 @@ void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
 void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt)
 {
 #if (defined HAL_DMA) && (HAL_DMA == TRUE)
+#if HAL_FLASH_ASYNC
+  HalFlashWait();  // The NV DMA channel is in use until the queued writes are done.
+#endif
+
+  // The DMA is to be polled and shall not issue an IRQ upon completion.
+  halFlashDmaArm(buf, cnt, HAL_DMA_IRQMASK_DISABLE);
+
+  FADDRL = (uint8)addr;
+  FADDRH = (uint8)(addr >> 8);
+  FCTL |= 0x02;         // Trigger the DMA writes.
+  while (FCTL & 0x80);  // Wait until writing is done.
+#endif
+}
+
+#if HAL_FLASH_ASYNC
+/**************************************************************************************************
+ * @fn          HalFlashWriteAsync
+ *
+ * @brief       This function queues a write of 'cnt' 4-byte blocks to the internal flash, which
+ *              the DMA programs while the CPU runs on. The buffer must be left untouched until
+ *              the write is done.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4.
+ * @param       cnt - Number of 4-byte blocks to write.
+ * @param       taskId - OSAL task to signal when the write is done, or TASK_NO_TASK.
+ * @param       event - OSAL event to set for the task.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the write was queued; FALSE if the queue is full.
+ **************************************************************************************************
+ */
+uint8 HalFlashWriteAsync(uint16 addr, uint8 *buf, uint16 cnt, uint8 taskId, uint16 event)
+{
+  halIntState_t is;
+  uint8 rtrn = FALSE;
+
+  HAL_ENTER_CRITICAL_SECTION(is);
+
+  if (halFlashQCnt < HAL_FLASH_ASYNC_CNT)
+  {
+    halFlashReq_t *pReq = halFlashQ + ((halFlashQHead + halFlashQCnt) % HAL_FLASH_ASYNC_CNT);
+
+    pReq->buf = buf;
+    pReq->addr = addr;
+    pReq->cnt = cnt;
+    pReq->event = event;
+    pReq->taskId = taskId;
+
+    if (halFlashQCnt++ == 0)
+    {
+      halFlashStart();
+    }
+    rtrn = TRUE;
+  }
+
+  HAL_EXIT_CRITICAL_SECTION(is);
+
+  return rtrn;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashBusy
+ *
+ * @brief       This function counts the writes queued by HalFlashWriteAsync() not yet done.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The number of queued writes, zero when the flash is idle.
+ **************************************************************************************************
+ */
+uint8 HalFlashBusy(void)
+{
+  return halFlashQCnt;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashWait
+ *
+ * @brief       This function waits until the writes queued by HalFlashWriteAsync() are done.
+ *              It polls the flash controller, so it may be called with interrupts disabled.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashWait(void)
+{
+  halIntState_t is;
+
+  while (halFlashQCnt != 0)
+  {
+    HAL_ENTER_CRITICAL_SECTION(is);
+    halFlashPoll();
+    HAL_EXIT_CRITICAL_SECTION(is);
+  }
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashDmaIsr
+ *
+ * @brief       This function is called by the DMA ISR when the NV DMA channel is done feeding
+ *              a queued write to the flash controller.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashDmaIsr(void)
+{
+  if ((halFlashQCnt != 0) && !HAL_DMA_CH_ARMED(HAL_NV_DMA_CH))
+  {
+    while (FCTL & 0x80);  // The last word is still being programmed, for at most 20 usecs.
+    halFlashPoll();
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halFlashStart
+ *
+ * @brief       This function starts programming the write at the head of the queue.
+ *              Interrupts must be disabled.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void halFlashStart(void)
+{
+  halFlashReq_t *pReq = halFlashQ + halFlashQHead;
+
+  halFlashDmaArm(pReq->buf, pReq->cnt, HAL_DMA_IRQMASK_ENABLE);
+
+  FADDRL = (uint8)pReq->addr;
+  FADDRH = (uint8)(pReq->addr >> 8);
+  FCTL |= 0x02;         // Trigger the DMA writes.
+}
+
+/**************************************************************************************************
+ * @fn          halFlashPoll
+ *
+ * @brief       This function retires the write at the head of the queue once it is done,
+ *              signals its task and starts the next one. Interrupts must be disabled.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void halFlashPoll(void)
+{
+  if ((halFlashQCnt != 0) && !HAL_DMA_CH_ARMED(HAL_NV_DMA_CH) && !(FCTL & 0x80))
+  {
+    halFlashReq_t *pReq = halFlashQ + halFlashQHead;
+
+    if (pReq->taskId != TASK_NO_TASK)
+    {
+      (void)osal_set_event(pReq->taskId, pReq->event);
+    }
+
+    if (++halFlashQHead == HAL_FLASH_ASYNC_CNT)
+    {
+      halFlashQHead = 0;
+    }
+
+    if (--halFlashQCnt != 0)
+    {
+      halFlashStart();
+    }
+  }
+}
+#endif
+
+#if (defined HAL_DMA) && (HAL_DMA == TRUE)
+/**************************************************************************************************
+ * @fn          halFlashDmaArm
+ *
+ * @brief       This function arms the NV DMA channel to feed 'cnt' 4-byte blocks to the flash
+ *              controller.
+ *
+ * input parameters
+ *
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4.
+ * @param       cnt - Number of 4-byte blocks to write.
+ * @param       irq - HAL_DMA_IRQMASK_ENABLE to interrupt when done, else HAL_DMA_IRQMASK_DISABLE.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void halFlashDmaArm(uint8 *buf, uint16 cnt, uint8 irq)
+{
   halDMADesc_t *ch = HAL_NV_DMA_GET_DESC();
 
   HAL_DMA_SET_SOURCE(ch, buf);
@@ -131,19 +413,13 @@ void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt)
   HAL_DMA_SET_TRIG_SRC(ch, HAL_DMA_TRIG_FLASH);
   HAL_DMA_SET_SRC_INC(ch, HAL_DMA_SRCINC_1);
   HAL_DMA_SET_DST_INC(ch, HAL_DMA_DSTINC_0);
-  // The DMA is to be polled and shall not issue an IRQ upon completion.
-  HAL_DMA_SET_IRQ(ch, HAL_DMA_IRQMASK_DISABLE);
+  HAL_DMA_SET_IRQ(ch, irq);
   HAL_DMA_SET_M8( ch, HAL_DMA_M8_USE_8_BITS);
   HAL_DMA_SET_PRIORITY(ch, HAL_DMA_PRI_HIGH);
   HAL_DMA_CLEAR_IRQ(HAL_NV_DMA_CH);
   HAL_DMA_ARM_CH(HAL_NV_DMA_CH);
-
-  FADDRL = (uint8)addr;
-  FADDRH = (uint8)(addr >> 8);
-  FCTL |= 0x02;         // Trigger the DMA writes.
-  while (FCTL & 0x80);  // Wait until writing is done.
-#endif
 }
+#endif
 
 /**************************************************************************************************
  * @fn          HalFlashErase
@@ -163,6 +439,10 @@ void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt)
  */
 void HalFlashErase(uint8 pg)
 {
+#if HAL_FLASH_ASYNC
+  HalFlashWait();
+#endif
+
   FADDRH = pg * (HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE / 256);
   FCTL |= 0x01;
 }
@@ -53,14 +53,29 @@
 
 #include "ota_common.h"
 
+#if (HAL_FLASH_ASYNC || HAL_OTA_XNV_ERASE) && !HAL_OTA_BOOT_CODE
+#include "OSAL.h"
+#endif
+#if HAL_FLASH_ASYNC && !HAL_OTA_BOOT_CODE
+#include "OSAL_Tasks.h"
+#define HAL_OTA_ASYNC  TRUE
+#else
+#define HAL_OTA_ASYNC  FALSE
+#endif
+
 /******************************************************************************
  * CONSTANTS
  */
+#if !defined HAL_OTA_ASYNC_BUF_LEN
+#define HAL_OTA_ASYNC_BUF_LEN  128
+#endif
+
 #if HAL_OTA_XNV_IS_SPI
 #define XNV_STAT_CMD  0x05
 #define XNV_WREN_CMD  0x06
 #define XNV_WRPG_CMD  0x0A
 #define XNV_READ_CMD  0x0B
+#define XNV_PGPR_CMD  0x02
 
 #define XNV_STAT_WIP  0x01
 #endif
@@ -83,6 +98,20 @@ OTA_CrcControl_t OTA_crcControl;
 halDMADesc_t dmaCh0;
 #endif
 
+#if HAL_OTA_ASYNC
+// Blocks are copied here so the caller may reuse its buffer while the DMA programs the copy.
+static uint8 otaAsyncBuf[2][HAL_OTA_ASYNC_BUF_LEN];
+static uint8 otaAsyncIdx;
+#endif
+
+#if HAL_OTA_XNV_ERASE
+static halOTAStat_t otaXnvStat;
+static uint32 otaXnvCursor;  // XNV address just past the furthest DL write.
+static uint32 otaXnvErased;  // XNV from HAL_OTA_DL_OSET up to here is erased for the download.
+static uint8 otaXnvActive;   // A download is in progress: keep erasing ahead of the cursor.
+static uint8 otaXnvErasing;  // An erase at otaXnvErased is in progress.
+#endif
+
 /******************************************************************************
  * LOCAL FUNCTIONS
  */
@@ -94,6 +123,13 @@ static void HalSPIWrite(uint32 addr, uint8 *pBuf, uint16 len);
 static void xnvSPIWrite(uint8 ch);
 #endif
 
+#if HAL_OTA_XNV_ERASE
+static uint8 xnvStatus(void);
+static void xnvErase(void);
+static void xnvEraseStep(uint8 ahead);
+static void xnvEraseTo(uint32 end, uint16 *pStall);
+#endif
+
 #if HAL_OTA_BOOT_CODE
 static void dl2rc(void);
 static uint16 crcCalc(void);
@@ -257,6 +293,10 @@ uint8 HalOTAChkDL(uint8 dlImagePreambleOffset)
   XNV_SPI_INIT();
 #endif
 
+#if HAL_OTA_XNV_ERASE
+  otaXnvActive = FALSE;  // The download is complete.
+#endif
+
   // Read the OTA File Header
   HalOTARead(0, (uint8 *)&header, sizeof(OTA_ImageHeader_t), HAL_OTA_DL);
 
@@ -344,6 +384,8 @@ void HalOTARead(uint32 oset, uint8 *pBuf, uint16 len, image_t type)
  *  NOTE:   Destructive write on page boundary! When writing to the first flash word
  *          of a page boundary, the page is erased without saving/restoring the bytes not written.
  *          Writes anywhere else on a page assume that the location written to has been erased.
+ *          With HAL_FLASH_ASYNC, a block of up to HAL_OTA_ASYNC_BUF_LEN bytes is programmed by
+ *          the DMA after this returns, so the next block can be received in the meantime.
  *
  * @param   oset - Offset into the monolithic image, aligned to HAL_FLASH_WORD_SIZE.
  * @param   pBuf - Pointer to the buffer in from which to write.
@@ -361,6 +403,21 @@ void HalOTAWrite(uint32 oset, uint8 *pBuf, uint16 len, image_t type)
     oset += HAL_OTA_RC_START + HAL_OTA_DL_OSET;
 #elif HAL_OTA_XNV_IS_SPI
     oset += HAL_OTA_DL_OSET;
+#if HAL_OTA_XNV_ERASE
+    if (oset == HAL_OTA_DL_OSET)
+    {
+      // A new download starts: let any erase finish, then erase the image ahead of it.
+      xnvEraseTo(0, &otaXnvStat.writeStall);
+      otaXnvErased = HAL_OTA_DL_OSET;
+      otaXnvCursor = HAL_OTA_DL_OSET;
+      otaXnvActive = TRUE;
+    }
+
+    if (otaXnvActive && (otaXnvCursor < (oset + len)))
+    {
+      otaXnvCursor = oset + len;
+    }
+#endif
     HalSPIWrite(oset, pBuf, len);
     return;
 #endif
@@ -375,6 +432,22 @@ void HalOTAWrite(uint32 oset, uint8 *pBuf, uint16 len, image_t type)
     HalFlashErase(oset / HAL_FLASH_PAGE_SIZE);
   }
 
+#if HAL_OTA_ASYNC
+  if (len <= HAL_OTA_ASYNC_BUF_LEN)
+  {
+    // Writes complete in order, so with at most one queued the other buffer is free.
+    while (HalFlashBusy() > 1);
+
+    osal_memcpy(otaAsyncBuf[otaAsyncIdx], pBuf, len);
+    if (HalFlashWriteAsync(oset / HAL_FLASH_WORD_SIZE, otaAsyncBuf[otaAsyncIdx],
+                           len / HAL_FLASH_WORD_SIZE, TASK_NO_TASK, 0))
+    {
+      otaAsyncIdx ^= 1;
+      return;
+    }
+  }
+#endif
+
   HalFlashWrite(oset / HAL_FLASH_WORD_SIZE, pBuf, len / HAL_FLASH_WORD_SIZE);
 }
 
@@ -392,6 +465,59 @@ uint32 HalOTAAvail(void)
   return HAL_OTA_DL_MAX - HAL_OTA_DL_OSET;
 }
 
+#if HAL_OTA_XNV_ERASE
+/******************************************************************************
+ * @fn      HalOTAPoll
+ *
+ * @brief   Erase the SPI Xtra-NV ahead of the download cursor, one erase at a
+ *          time, so that the DL image writes find their pages erased.
+ *          Called from Hal_ProcessPoll(); it never waits on the Xtra-NV.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void HalOTAPoll(void)
+{
+  uint8 shdw;
+  halIntState_t his;
+
+  if (!otaXnvActive && !otaXnvErasing)
+  {
+    return;
+  }
+
+  shdw = P1DIR;
+  HAL_ENTER_CRITICAL_SECTION(his);
+  P1DIR |= BV(3);
+
+  xnvEraseStep(TRUE);
+
+  P1DIR = shdw;
+  HAL_EXIT_CRITICAL_SECTION(his);
+}
+
+/******************************************************************************
+ * @fn      HalOTAGetStat
+ *
+ * @brief   Copy the Xtra-NV throughput counters.
+ *
+ * @param   pStat - Pointer to the structure to fill.
+ * @param   clear - TRUE to zero the counters afterwards.
+ *
+ * @return  None.
+ */
+void HalOTAGetStat(halOTAStat_t *pStat, uint8 clear)
+{
+  *pStat = otaXnvStat;
+
+  if (clear)
+  {
+    (void)osal_memset(&otaXnvStat, 0, sizeof(otaXnvStat));
+  }
+}
+#endif
+
 #if HAL_OTA_XNV_IS_SPI
 /******************************************************************************
  * @fn      xnvSPIWrite
@@ -422,8 +548,12 @@ static void xnvSPIWrite(uint8 ch)
 static void HalSPIRead(uint32 addr, uint8 *pBuf, uint16 len)
 {
 #if !HAL_OTA_BOOT_CODE
-  uint8 shdw = P1DIR;
+  uint8 shdw;
   halIntState_t his;
+#if HAL_OTA_XNV_ERASE
+  xnvEraseTo(0, &otaXnvStat.readStall);  // Wait for an erase with interrupts enabled.
+#endif
+  shdw = P1DIR;
   HAL_ENTER_CRITICAL_SECTION(his);
   P1DIR |= BV(3);
 #endif
@@ -470,9 +600,20 @@ static void HalSPIRead(uint32 addr, uint8 *pBuf, uint16 len)
 static void HalSPIWrite(uint32 addr, uint8 *pBuf, uint16 len)
 {
   uint8 cnt;
+  uint8 cmd = XNV_WRPG_CMD;
 #if !HAL_OTA_BOOT_CODE
-  uint8 shdw = P1DIR;
+  uint8 shdw;
   halIntState_t his;
+#if HAL_OTA_XNV_ERASE
+  if (otaXnvActive)
+  {
+    // Only programming is needed once the pages written are erased.
+    xnvEraseTo(addr + len, &otaXnvStat.writeStall);
+    cmd = XNV_PGPR_CMD;
+    otaXnvStat.progBytes += len;
+  }
+#endif
+  shdw = P1DIR;
   HAL_ENTER_CRITICAL_SECTION(his);
   P1DIR |= BV(3);
 #endif
@@ -493,7 +634,7 @@ static void HalSPIWrite(uint32 addr, uint8 *pBuf, uint16 len)
     asm("NOP"); asm("NOP");
 
     XNV_SPI_BEGIN();
-    xnvSPIWrite(XNV_WRPG_CMD);
+    xnvSPIWrite(cmd);
     xnvSPIWrite(addr >> 16);
     xnvSPIWrite(addr >> 8);
     xnvSPIWrite(addr);
@@ -516,6 +657,9 @@ static void HalSPIWrite(uint32 addr, uint8 *pBuf, uint16 len)
       len--;
     } while (len && cnt);
     XNV_SPI_END();
+#if HAL_OTA_XNV_ERASE
+    otaXnvStat.progCnt++;
+#endif
   }
 
 #if !HAL_OTA_BOOT_CODE
@@ -524,6 +668,144 @@ static void HalSPIWrite(uint32 addr, uint8 *pBuf, uint16 len)
 #endif
 }
 
+#if HAL_OTA_XNV_ERASE
+/******************************************************************************
+ * @fn      xnvStatus
+ *
+ * @brief   Read the status register of the external NV once.
+ *          Interrupts must be disabled and the XNV chip select an output.
+ *
+ * @param   None.
+ *
+ * @return  The status register.
+ *****************************************************************************/
+static uint8 xnvStatus(void)
+{
+  uint8 stat;
+
+  XNV_SPI_BEGIN();
+  xnvSPIWrite(XNV_STAT_CMD);
+  xnvSPIWrite(0);
+  stat = XNV_SPI_RX();
+  XNV_SPI_END();
+  asm("NOP"); asm("NOP");
+
+  return stat;
+}
+
+/******************************************************************************
+ * @fn      xnvErase
+ *
+ * @brief   Start erasing the sector at otaXnvErased, unless the external NV is
+ *          still busy. Interrupts must be disabled and the XNV chip select an output.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ *****************************************************************************/
+static void xnvErase(void)
+{
+  if (xnvStatus() & XNV_STAT_WIP)
+  {
+    return;
+  }
+
+  XNV_SPI_BEGIN();
+  xnvSPIWrite(XNV_WREN_CMD);
+  XNV_SPI_END();
+  asm("NOP"); asm("NOP");
+
+  XNV_SPI_BEGIN();
+  xnvSPIWrite(HAL_OTA_XNV_ERASE_CMD);
+  xnvSPIWrite(otaXnvErased >> 16);
+  xnvSPIWrite(otaXnvErased >> 8);
+  xnvSPIWrite(otaXnvErased);
+  XNV_SPI_END();
+
+  otaXnvErasing = TRUE;
+  otaXnvStat.eraseCnt++;
+}
+
+/******************************************************************************
+ * @fn      xnvEraseStep
+ *
+ * @brief   Account for a finished erase and, if asked to, start the next one
+ *          when the erased area does not reach HAL_OTA_XNV_ERASE_AHEAD beyond
+ *          the download cursor. Interrupts must be disabled and the XNV chip
+ *          select an output.
+ *
+ * @param   ahead - TRUE to start erasing ahead of the cursor.
+ *
+ * @return  None.
+ *****************************************************************************/
+static void xnvEraseStep(uint8 ahead)
+{
+  if (otaXnvErasing)
+  {
+    if (xnvStatus() & XNV_STAT_WIP)
+    {
+      return;
+    }
+
+    otaXnvErasing = FALSE;
+    otaXnvErased += HAL_OTA_XNV_ERASE_SIZE;
+  }
+
+  if (ahead && otaXnvActive && (otaXnvErased < HAL_OTA_DL_MAX) &&
+               (otaXnvErased < (otaXnvCursor + HAL_OTA_XNV_ERASE_AHEAD)))
+  {
+    xnvErase();
+  }
+}
+
+/******************************************************************************
+ * @fn      xnvEraseTo
+ *
+ * @brief   Wait until no erase is in progress and the erased area reaches 'end',
+ *          erasing as needed. Interrupts are enabled between the status polls,
+ *          since an erase can take a second.
+ *
+ * @param   end - XNV address to be erased up to; 0 only to wait for an erase.
+ * @param   pStall - Counter bumped if anything had to be waited for.
+ *
+ * @return  None.
+ *****************************************************************************/
+static void xnvEraseTo(uint32 end, uint16 *pStall)
+{
+  uint8 stall = FALSE;
+  uint8 shdw;
+  halIntState_t his;
+
+  while (1)
+  {
+    shdw = P1DIR;
+    HAL_ENTER_CRITICAL_SECTION(his);
+    P1DIR |= BV(3);
+
+    xnvEraseStep(FALSE);
+    if (!otaXnvErasing && (otaXnvErased < end))
+    {
+      xnvErase();
+    }
+
+    P1DIR = shdw;
+    HAL_EXIT_CRITICAL_SECTION(his);
+
+    if (!otaXnvErasing && (otaXnvErased >= end))
+    {
+      break;
+    }
+
+    if (!stall)
+    {
+      stall = TRUE;
+      (*pStall)++;
+    }
+    otaXnvStat.stallPolls++;
+  }
+}
+#endif
+
 #elif !HAL_OTA_XNV_IS_INT
 #error Invalid Xtra-NV for OTA.
 #endif
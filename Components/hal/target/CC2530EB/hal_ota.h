@@ -70,7 +70,9 @@
 /* Note that corresponding changes must be made to ota.xcl when changing the source of Xtra-NV.
  * When using internal flash for XNV, (HAL_OTA_BOOT_PG_CNT + HAL_NV_PAGE_CNT) must be even.
  */
+#if !defined HAL_OTA_XNV_IS_INT
 #define HAL_OTA_XNV_IS_INT         TRUE
+#endif
 #define HAL_OTA_XNV_IS_SPI        !HAL_OTA_XNV_IS_INT
 
 /* The ota/ota-boot.xcl files only need 1 page of boot code (located on the first flash page),
@@ -95,6 +97,33 @@
 
 #define PREAMBLE_OFFSET            0x8C
 
+/* With HAL_OTA_XNV_ERASE, the SPI Xtra-NV is erased ahead of the download cursor from
+ * HalOTAPoll() and the DL image is written with Page Program instead of Page Write, which
+ * erases the page again for every block written to it. The granule and command default to the
+ * M25PE Page Erase: an erase keeps the Xtra-NV busy, so it should fit between two OTA blocks.
+ */
+#if !defined HAL_OTA_XNV_ERASE
+#define HAL_OTA_XNV_ERASE          FALSE
+#endif
+#if !defined HAL_OTA_XNV_ERASE_SIZE
+#define HAL_OTA_XNV_ERASE_SIZE     0x100UL
+#endif
+#if !defined HAL_OTA_XNV_ERASE_CMD
+#define HAL_OTA_XNV_ERASE_CMD      0xDB
+#endif
+#if !defined HAL_OTA_XNV_ERASE_AHEAD
+#define HAL_OTA_XNV_ERASE_AHEAD   (HAL_OTA_XNV_ERASE_SIZE * 4)
+#endif
+
+#if HAL_OTA_XNV_ERASE
+#if !HAL_OTA_XNV_IS_SPI || HAL_OTA_BOOT_CODE
+#error HAL_OTA_XNV_ERASE schedules the erases of the SPI Xtra-NV for the Application.
+#endif
+#if (HAL_OTA_DL_OSET % HAL_OTA_XNV_ERASE_SIZE) != 0
+#error HAL_OTA_DL_OSET must be aligned to HAL_OTA_XNV_ERASE_SIZE.
+#endif
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -109,6 +138,15 @@ typedef struct {
   uint16 crc_shadow;
 } otaCrc_t;
 
+typedef struct {
+  uint32 progBytes;   // Bytes of the DL image programmed.
+  uint32 stallPolls;  // Status reads made while a read or write waited for an erase.
+  uint16 progCnt;     // Page Program or Page Write commands.
+  uint16 eraseCnt;    // Erase commands.
+  uint16 writeStall;  // Writes that waited for an erase.
+  uint16 readStall;   // Reads that waited for an erase.
+} halOTAStat_t;
+
 typedef struct {
   uint32 programLength;
   uint16 manufacturerId;
@@ -125,4 +163,8 @@ void HalOTAInvRC(void);
 uint32 HalOTAAvail(void);
 void HalOTARead(uint32 oset, uint8 *pBuf, uint16 len, image_t type);
 void HalOTAWrite(uint32 oset, uint8 *pBuf, uint16 len, image_t type);
+#if HAL_OTA_XNV_ERASE
+void HalOTAPoll(void);
+void HalOTAGetStat(halOTAStat_t *pStat, uint8 clear);
+#endif
 #endif
@@ -44,6 +44,7 @@
 #include "hal_types.h"
 #include "hal_mcu.h"
 #include "hal_board.h"
+#include "hal_flash.h"
 #include "hal_sleep.h"
 #include "hal_led.h"
 #include "hal_key.h"
@@ -326,6 +327,11 @@ void halSleep( uint32 osal_timeout )
   {
     halIntState_t ien0, ien1, ien2;
 
+#if (HAL_FLASH_ASYNC == TRUE)
+    /* The DMA stops with the 32 MHz clock, so the queued flash writes are finished first. */
+    HalFlashWait();
+#endif
+
     HAL_ASSERT(HAL_INTERRUPTS_ARE_ENABLED());
     HAL_DISABLE_INTERRUPTS();
 
@@ -177,6 +177,70 @@ uint16 HalUARTRead(uint8 port, uint8 *buf, uint16 len)
 #endif
 }
 
+#if HAL_UART_SPAN
+/*****************************************************************************
+ * @fn      HalUARTPeek
+ *
+ * @brief   Lend the contiguous bytes at the head of the Rx buffer, in place.
+ *          They stay in the buffer until released by HalUARTConsume().
+ *
+ * @param   port  - USART module designation
+ *          pSpan - span to fill
+ *
+ * @return  number of bytes in the span, 0 if none or not supported by the port
+ *****************************************************************************/
+uint16 HalUARTPeek(uint8 port, halUARTSpan_t *pSpan)
+{
+  (void)port;
+
+  pSpan->len = 0;
+
+#if (HAL_UART_DMA == 1)
+  if (port == HAL_UART_PORT_0)  return HalUARTPeekDMA(pSpan);
+#endif
+#if (HAL_UART_DMA == 2)
+  if (port == HAL_UART_PORT_1)  return HalUARTPeekDMA(pSpan);
+#endif
+#if (HAL_UART_ISR == 1)
+  if (port == HAL_UART_PORT_0)  return HalUARTPeekISR(pSpan);
+#endif
+#if (HAL_UART_ISR == 2)
+  if (port == HAL_UART_PORT_1)  return HalUARTPeekISR(pSpan);
+#endif
+
+  return 0;
+}
+
+/*****************************************************************************
+ * @fn      HalUARTConsume
+ *
+ * @brief   Release bytes lent by HalUARTPeek() from the head of the Rx buffer.
+ *
+ * @param   port - USART module designation
+ *          len  - number of bytes to release, at most the span length
+ *
+ * @return  none
+ *****************************************************************************/
+void HalUARTConsume(uint8 port, uint16 len)
+{
+  (void)port;
+  (void)len;
+
+#if (HAL_UART_DMA == 1)
+  if (port == HAL_UART_PORT_0)  HalUARTConsumeDMA(len);
+#endif
+#if (HAL_UART_DMA == 2)
+  if (port == HAL_UART_PORT_1)  HalUARTConsumeDMA(len);
+#endif
+#if (HAL_UART_ISR == 1)
+  if (port == HAL_UART_PORT_0)  HalUARTConsumeISR(len);
+#endif
+#if (HAL_UART_ISR == 2)
+  if (port == HAL_UART_PORT_1)  HalUARTConsumeISR(len);
+#endif
+}
+#endif
+
 /******************************************************************************
  * @fn      HalUARTWrite
  *
@@ -215,6 +279,76 @@ uint16 HalUARTWrite(uint8 port, uint8 *buf, uint16 len)
 #endif
 }
 
+#if HAL_UART_TXQ
+/******************************************************************************
+ * @fn      HalUARTWriteQueue
+ *
+ * @brief   Queue a buffer to be sent in place and released once sent. Ports
+ *          without a Tx queue copy it by HalUARTWrite() and release it at once.
+ *
+ * @param   port    - UART port
+ *          buf     - pointer to the buffer, owned by the driver if queued
+ *          len     - length of the buffer
+ *          pfnFree - function to release the buffer once it has been sent
+ *
+ * @return  TRUE if queued; FALSE if refused and the caller keeps the buffer
+ *****************************************************************************/
+uint8 HalUARTWriteQueue(uint8 port, uint8 *buf, uint16 len, halUARTTxFree_t pfnFree)
+{
+#if (HAL_UART_DMA == 1)
+  if (port == HAL_UART_PORT_0)  return HalUARTWriteQueueDMA(buf, len, pfnFree);
+#endif
+#if (HAL_UART_DMA == 2)
+  if (port == HAL_UART_PORT_1)  return HalUARTWriteQueueDMA(buf, len, pfnFree);
+#endif
+
+  if (HalUARTWrite(port, buf, len) != len)
+  {
+    return FALSE;
+  }
+
+  pfnFree(buf);
+  return TRUE;
+}
+
+/******************************************************************************
+ * @fn      HalUARTTxQStat
+ *
+ * @brief   Read the Tx queue counters of a port.
+ *
+ * @param   port  - UART port
+ *          pStat - pointer to the counters to fill, all 0 for a port without a Tx queue
+ *          clear - TRUE to restart the sent and drop counts and the high-water mark
+ *
+ * @return  none
+ *****************************************************************************/
+void HalUARTTxQStat(uint8 port, halUARTTxQStat_t *pStat, uint8 clear)
+{
+  (void)port;
+  (void)clear;
+
+#if (HAL_UART_DMA == 1)
+  if (port == HAL_UART_PORT_0)
+  {
+    HalUARTTxQStatDMA(pStat, clear);
+    return;
+  }
+#endif
+#if (HAL_UART_DMA == 2)
+  if (port == HAL_UART_PORT_1)
+  {
+    HalUARTTxQStatDMA(pStat, clear);
+    return;
+  }
+#endif
+
+  pStat->sent = 0;
+  pStat->drop = 0;
+  pStat->depth = 0;
+  pStat->depthMax = 0;
+}
+#endif
+
 /******************************************************************************
  * @fn      HalUARTSuspend
  *
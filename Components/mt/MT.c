@@ -237,6 +237,38 @@ mtProcessMsg_t mtProcessIncoming[] =
 byte debugThreshold;
 byte debugCompId;
 
+/**************************************************************************************************
+ * LOCAL VARIABLES
+ **************************************************************************************************/
+
+#if !defined(NPI)
+/* While an MT_SYS_BATCH runs, the SRSP of each sub-command is folded into the batch SRSP */
+#define MT_BATCH_IDLE  0
+#define MT_BATCH_RUN   1
+#define MT_BATCH_SRSP  2   /* The current sub-command has sent its SRSP */
+
+static uint8 mtBatchState = MT_BATCH_IDLE;
+static uint8 mtBatchSrsp;  /* First data byte, i.e. status, of the captured SRSP */
+#endif
+
+#if MT_PIPE_SUPPORT
+/* The transports count each MT_SYS_PIPE_REQ as it is received and stop receiving while a window
+ * of them waits to be processed. The SRSP of a pipelined SREQ goes back in an MT_SYS_PIPE_RSP,
+ * tagged with the sequence ID of the request and the credits left to the host.
+ */
+#define MT_PIPE_IDLE  0
+#define MT_PIPE_RUN   1
+#define MT_PIPE_SENT  2   /* The pipelined SREQ has sent its SRSP */
+
+/* | seq | credits | cmd0 | cmd1 | ahead of the SRSP data */
+#define MT_PIPE_RSP_HDR_SZ  4
+
+static uint8 mtPipeState = MT_PIPE_IDLE;
+static uint8 mtPipeWindow = MT_PIPE_WINDOW;
+static uint8 mtPipeCnt;    /* Requests received and not yet processed */
+static uint8 mtPipeSeq;    /* Sequence ID of the request being processed */
+#endif
+
 /**************************************************************************************************
  * LOCAL FUNCTIONS
  **************************************************************************************************/
@@ -246,6 +278,17 @@ void MT_ResetMsgQueue( void );
 byte MT_QueueMsg( byte *msg , byte len );
 void MT_ProcessQueue( void );
 
+static uint8 MT_ProcessCommand(uint8 *pBuf);
+#if !defined(NPI)
+static uint8 MT_ProcessBatch(uint8 *pBuf);
+#endif
+#if MT_PIPE_SUPPORT
+static uint8 MT_ProcessPipe(uint8 *pBuf);
+static uint8 MT_ProcessPipeCfg(uint8 *pBuf);
+static uint8 MT_PipeCredits(void);
+static void MT_PipeSend(uint8 cmdType, uint8 cmdId, uint8 dataLen, uint8 *pData);
+#endif
+
 #if defined ( MT_USER_TEST_FUNC )
 void MT_ProcessAppUserCmd( byte *pData );
 #endif
@@ -302,6 +345,26 @@ void MT_BuildAndSendZToolResponse(uint8 cmdType, uint8 cmdId, uint8 dataLen, uin
 {
   uint8 *msg_ptr;
 
+  if ((mtBatchState != MT_BATCH_IDLE) && ((cmdType & MT_RPC_CMD_TYPE_MASK) == MT_RPC_CMD_SRSP))
+  {
+    /* Only the status of a batched sub-command goes back, in the batch SRSP */
+    mtBatchSrsp = (dataLen != 0) ? pData[0] : MT_RPC_SUCCESS;
+    mtBatchState = MT_BATCH_SRSP;
+    return;
+  }
+
+#if MT_PIPE_SUPPORT
+  if ((mtPipeState != MT_PIPE_IDLE) && ((cmdType & MT_RPC_CMD_TYPE_MASK) == MT_RPC_CMD_SRSP))
+  {
+    /* A pipelined SREQ is answered once, by the MT_SYS_PIPE_RSP */
+    if (mtPipeState == MT_PIPE_RUN)
+    {
+      MT_PipeSend(cmdType, cmdId, dataLen, pData);
+    }
+    return;
+  }
+#endif
+
 #ifdef FEATURE_DUAL_MAC
   msg_ptr = DMMGR_BuildRspMsg( cmdType, cmdId, dataLen, pData );
 
@@ -332,6 +395,20 @@ void MT_BuildAndSendZToolResponse(uint8 cmdType, uint8 cmdId, uint8 dataLen, uin
  * @return  void
  ***************************************************************************************************/
 void MT_ProcessIncoming(uint8 *pBuf)
+{
+  (void)MT_ProcessCommand(pBuf);
+}
+
+/***************************************************************************************************
+ * @fn      MT_ProcessCommand
+ *
+ * @brief   Dispatch one command to its subsystem and send the error SRSP if it fails.
+ *
+ * @param   byte *pBuf - pointer to the command, starting at its length byte
+ *
+ * @return  MT_RPC status of the dispatch
+ ***************************************************************************************************/
+static uint8 MT_ProcessCommand(uint8 *pBuf)
 {
   mtProcessMsg_t func;
   uint8 rsp[MT_RPC_FRAME_HDR_SZ];
@@ -345,6 +422,23 @@ void MT_ProcessIncoming(uint8 *pBuf)
   {
     rsp[0] = MT_RPC_ERR_LENGTH;
   }
+#if !defined(NPI)
+  /* a batch is dispatched here so that it works regardless of MT_SYS_FUNC */
+  else if ((rsp[1] == ((uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS)) && (rsp[2] == MT_SYS_BATCH))
+  {
+    rsp[0] = MT_ProcessBatch(pBuf);
+  }
+#endif
+#if MT_PIPE_SUPPORT
+  else if ((rsp[1] == ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS)) && (rsp[2] == MT_SYS_PIPE_REQ))
+  {
+    rsp[0] = MT_ProcessPipe(pBuf);
+  }
+  else if ((rsp[1] == ((uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS)) && (rsp[2] == MT_SYS_PIPE_CFG))
+  {
+    rsp[0] = MT_ProcessPipeCfg(pBuf);
+  }
+#endif
   /* check subsystem range */
   else if ((rsp[1] & MT_RPC_SUBSYSTEM_MASK) < MT_RPC_SYS_MAX)
   {
@@ -371,8 +465,293 @@ void MT_ProcessIncoming(uint8 *pBuf)
     MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_RES0), 0,
                                                                   MT_RPC_FRAME_HDR_SZ, rsp);
   }
+
+  return rsp[0];
+}
+
+#if !defined(NPI)
+/***************************************************************************************************
+ * @fn      MT_ProcessBatch
+ *
+ * @brief   Process an MT_SYS_BATCH: | count | count x (| len | cmd0 | cmd1 | data |) |
+ *          The sub-commands are dispatched in order and answered by one SRSP:
+ *          | count | count x status |
+ *          The status of a sub-command is the first byte of its SRSP (so commands whose SRSP
+ *          returns more than a status should not be batched), else its MT_RPC dispatch status.
+ *          A sub-command running past the end of the frame, and all after it, get
+ *          MT_RPC_ERR_LENGTH. Batches do not nest.
+ *
+ * @param   byte *pBuf - pointer to the batch command
+ *
+ * @return  MT_RPC status
+ ***************************************************************************************************/
+static uint8 MT_ProcessBatch(uint8 *pBuf)
+{
+  uint8 *pCmd = pBuf + MT_RPC_POS_DAT0 + 1;
+  uint8 left = pBuf[MT_RPC_POS_LEN];
+  uint8 cnt, idx;
+
+  if (mtBatchState != MT_BATCH_IDLE)
+  {
+    return MT_RPC_ERR_COMMAND_ID;
+  }
+
+  if ((left == 0) || ((uint16)pBuf[MT_RPC_POS_DAT0] * MT_RPC_FRAME_HDR_SZ > (uint16)(left - 1)))
+  {
+    return MT_RPC_ERR_LENGTH;
+  }
+  cnt = pBuf[MT_RPC_POS_DAT0];
+  left--;
+
+  for (idx = 0; idx < cnt; idx++)
+  {
+    uint8 status = MT_RPC_ERR_LENGTH;
+
+    if ((left >= MT_RPC_FRAME_HDR_SZ) && (pCmd[MT_RPC_POS_LEN] <= left - MT_RPC_FRAME_HDR_SZ))
+    {
+      uint8 size = MT_RPC_FRAME_HDR_SZ + pCmd[MT_RPC_POS_LEN];
+
+      mtBatchState = MT_BATCH_RUN;
+      status = MT_ProcessCommand(pCmd);
+      if ((status == MT_RPC_SUCCESS) && (mtBatchState == MT_BATCH_SRSP))
+      {
+        status = mtBatchSrsp;
+      }
+
+      pCmd += size;
+      left -= size;
+    }
+    else
+    {
+      left = 0;
+    }
+
+    /* The statuses overwrite sub-commands already processed: status idx lies before command idx+1 */
+    pBuf[MT_RPC_POS_DAT0 + 1 + idx] = status;
+  }
+
+  mtBatchState = MT_BATCH_IDLE;
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS), MT_SYS_BATCH,
+                               cnt + 1, pBuf + MT_RPC_POS_DAT0);
+
+  return MT_RPC_SUCCESS;
+}
+#endif
+
+#if MT_PIPE_SUPPORT
+/***************************************************************************************************
+ * @fn      MT_PipeFull
+ *
+ * @brief   Check whether the host has used up its credits. The transports stop taking frames
+ *          from the host while this is TRUE, so the requests stay in order behind the window.
+ *
+ * @param   None
+ *
+ * @return  TRUE if the window of pipelined requests is full
+ ***************************************************************************************************/
+bool MT_PipeFull(void)
+{
+  return (mtPipeCnt >= mtPipeWindow);
+}
+
+/***************************************************************************************************
+ * @fn      MT_PipeQueued
+ *
+ * @brief   Take a credit for a received frame if it is an MT_SYS_PIPE_REQ. The credit is given
+ *          back when the request is processed.
+ *
+ * @param   byte *pBuf - pointer to the received frame, starting at its length byte
+ *
+ * @return  void
+ ***************************************************************************************************/
+void MT_PipeQueued(uint8 *pBuf)
+{
+  if ((pBuf[MT_RPC_POS_CMD0] == ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS)) &&
+      (pBuf[MT_RPC_POS_CMD1] == MT_SYS_PIPE_REQ))
+  {
+    mtPipeCnt++;
+  }
+}
+
+/***************************************************************************************************
+ * @fn      MT_ProcessPipe
+ *
+ * @brief   Process an MT_SYS_PIPE_REQ: | seq | len | cmd0 | cmd1 | data |
+ *          The enclosed SREQ is dispatched as usual and its SRSP comes back as the AREQ
+ *          MT_SYS_PIPE_RSP: | seq | credits | cmd0 | cmd1 | data |
+ *          The SRSP is the MT_RPC error SRSP if the request is malformed or not an SREQ, and is
+ *          missing if the SREQ sent none. Requests are processed in the order received, so the
+ *          host may have up to 'credits' more of them outstanding.
+ *
+ * @param   byte *pBuf - pointer to the pipelined request
+ *
+ * @return  MT_RPC status
+ ***************************************************************************************************/
+static uint8 MT_ProcessPipe(uint8 *pBuf)
+{
+  uint8 *pCmd = pBuf + MT_RPC_POS_DAT0 + 1;
+  uint8 len = pBuf[MT_RPC_POS_LEN];
+  uint8 rsp[MT_RPC_FRAME_HDR_SZ];
+
+  if ((mtBatchState != MT_BATCH_IDLE) || (mtPipeState != MT_PIPE_IDLE))
+  {
+    return MT_RPC_ERR_COMMAND_ID;  // Not received on its own, so it holds no credit
+  }
+
+  if (mtPipeCnt != 0)
+  {
+    mtPipeCnt--;
+  }
+
+  if (len == 0)
+  {
+    return MT_RPC_ERR_LENGTH;
+  }
+  mtPipeSeq = pBuf[MT_RPC_POS_DAT0];
+  mtPipeState = MT_PIPE_RUN;
+
+  rsp[0] = MT_RPC_SUCCESS;
+  rsp[1] = 0;
+  rsp[2] = 0;
+
+  if ((len < (1 + MT_RPC_FRAME_HDR_SZ)) || (pCmd[MT_RPC_POS_LEN] > (len - 1 - MT_RPC_FRAME_HDR_SZ)))
+  {
+    rsp[0] = MT_RPC_ERR_LENGTH;
+  }
+  else if ((pCmd[MT_RPC_POS_CMD0] & MT_RPC_CMD_TYPE_MASK) != MT_RPC_CMD_SREQ)
+  {
+    rsp[0] = MT_RPC_ERR_COMMAND_ID;
+  }
+  else
+  {
+    (void)MT_ProcessCommand(pCmd);
+  }
+
+  if (rsp[0] != MT_RPC_SUCCESS)
+  {
+    if (len >= (1 + MT_RPC_FRAME_HDR_SZ))
+    {
+      rsp[1] = pCmd[MT_RPC_POS_CMD0];
+      rsp[2] = pCmd[MT_RPC_POS_CMD1];
+    }
+    MT_PipeSend(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_RES0), 0, MT_RPC_FRAME_HDR_SZ, rsp);
+  }
+  else if (mtPipeState == MT_PIPE_RUN)
+  {
+    MT_PipeSend(0, 0, 0, NULL);
+  }
+
+  mtPipeState = MT_PIPE_IDLE;
+
+  return MT_RPC_SUCCESS;
 }
 
+/***************************************************************************************************
+ * @fn      MT_ProcessPipeCfg
+ *
+ * @brief   Process an MT_SYS_PIPE_CFG: | window |
+ *          Set the number of pipelined requests the host may have outstanding, 0 to only read it.
+ *          A smaller window takes effect as the requests already received are processed.
+ *          SRSP: | status | window | credits |
+ *
+ * @param   byte *pBuf - pointer to the command
+ *
+ * @return  MT_RPC status
+ ***************************************************************************************************/
+static uint8 MT_ProcessPipeCfg(uint8 *pBuf)
+{
+  uint8 window = pBuf[MT_RPC_POS_DAT0];
+  uint8 retArray[3];
+
+  if (pBuf[MT_RPC_POS_LEN] < 1)
+  {
+    return MT_RPC_ERR_LENGTH;
+  }
+
+  retArray[0] = ZSuccess;
+  if (window > MT_PIPE_WINDOW_MAX)
+  {
+    retArray[0] = ZInvalidParameter;
+  }
+  else if (window != 0)
+  {
+    mtPipeWindow = window;
+  }
+  retArray[1] = mtPipeWindow;
+  retArray[2] = MT_PipeCredits();
+
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS), MT_SYS_PIPE_CFG,
+                               3, retArray);
+
+  return MT_RPC_SUCCESS;
+}
+
+/***************************************************************************************************
+ * @fn      MT_PipeCredits
+ *
+ * @brief   Number of pipelined requests the host may send beyond those already received.
+ *
+ * @param   None
+ *
+ * @return  Credits left
+ ***************************************************************************************************/
+static uint8 MT_PipeCredits(void)
+{
+  return (mtPipeCnt < mtPipeWindow) ? (mtPipeWindow - mtPipeCnt) : 0;
+}
+
+/***************************************************************************************************
+ * @fn      MT_PipeSend
+ *
+ * @brief   Send the MT_SYS_PIPE_RSP of the request being processed. An SRSP too long to be
+ *          tagged is replaced by an MT_RPC_ERR_LENGTH error SRSP.
+ *
+ * @param   uint8 cmdType - SRSP type and subsystem, 0 if the SREQ sent no SRSP
+ *          uint8 cmdId - SRSP command ID
+ *          byte dataLen
+ *          byte *pData
+ *
+ * @return  void
+ ***************************************************************************************************/
+static void MT_PipeSend(uint8 cmdType, uint8 cmdId, uint8 dataLen, uint8 *pData)
+{
+  uint8 hdrLen = (cmdType != 0) ? MT_PIPE_RSP_HDR_SZ : 2;
+  uint8 err[MT_RPC_FRAME_HDR_SZ];
+  uint8 *msg_ptr;
+
+  mtPipeState = MT_PIPE_SENT;
+
+  if (dataLen > (MT_RPC_DATA_MAX - MT_PIPE_RSP_HDR_SZ))
+  {
+    err[0] = MT_RPC_ERR_LENGTH;
+    err[1] = (cmdType & MT_RPC_SUBSYSTEM_MASK) | (uint8)MT_RPC_CMD_SREQ;
+    err[2] = cmdId;
+    cmdType = (uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_RES0;
+    cmdId = 0;
+    dataLen = MT_RPC_FRAME_HDR_SZ;
+    pData = err;
+  }
+
+  if ((msg_ptr = MT_TransportAlloc((uint8)MT_RPC_CMD_AREQ, hdrLen + dataLen)) != NULL)
+  {
+    msg_ptr[MT_RPC_POS_LEN] = hdrLen + dataLen;
+    msg_ptr[MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS;
+    msg_ptr[MT_RPC_POS_CMD1] = MT_SYS_PIPE_RSP;
+    msg_ptr[MT_RPC_POS_DAT0] = mtPipeSeq;
+    msg_ptr[MT_RPC_POS_DAT0 + 1] = MT_PipeCredits();
+
+    if (cmdType != 0)
+    {
+      msg_ptr[MT_RPC_POS_DAT0 + 2] = cmdType;
+      msg_ptr[MT_RPC_POS_DAT0 + 3] = cmdId;
+      (void)osal_memcpy(msg_ptr + MT_RPC_POS_DAT0 + MT_PIPE_RSP_HDR_SZ, pData, dataLen);
+    }
+
+    MT_TransportSend(msg_ptr);
+  }
+}
+#endif
+
 /***************************************************************************************************
  * @fn      MTProcessAppRspMsg
  *
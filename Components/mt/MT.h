@@ -103,6 +103,15 @@ extern "C"
 #define MT_SYS_ZDIAGS_SAVE_STATS_TO_NV       0x1B
 #define MT_SYS_OSAL_NV_READ_EXT              0x1C
 #define MT_SYS_OSAL_NV_WRITE_EXT             0x1D
+#define MT_SYS_MSG_POOL_STATS                0x1E
+#define MT_SYS_TASK_PROFILE                  0x1F
+#define MT_SYS_HEAP_MAP                      0x20
+#define MT_SYS_OSAL_NV_READ_STREAM           0x21
+#define MT_SYS_NV_SNAPSHOT_EXPORT            0x22
+#define MT_SYS_NV_SNAPSHOT_IMPORT            0x23
+#define MT_SYS_BATCH                         0x24
+#define MT_SYS_PIPE_CFG                      0x25
+#define MT_SYS_PIPE_REQ                      0x26  /* AREQ from host */
 
 /* Extended Non-Vloatile Memory */
 #define MT_SYS_NV_CREATE                     0x30
@@ -117,6 +126,10 @@ extern "C"
 #define MT_SYS_RESET_IND                     0x80
 #define MT_SYS_OSAL_TIMER_EXPIRED            0x81
 #define MT_SYS_JAMMER_IND                    0x82
+#define MT_SYS_OSAL_NV_STREAM_IND            0x83
+#define MT_SYS_NV_SNAPSHOT_IND               0x84
+#define MT_SYS_NV_SNAPSHOT_ACK               0x85
+#define MT_SYS_PIPE_RSP                      0x86
 
 #define MT_SYS_RESET_HARD     0
 #define MT_SYS_RESET_SOFT     1
@@ -434,6 +447,9 @@ extern "C"
 #define MT_UTIL_SRNG_GENERATE                0x4C
 #endif
 #define MT_UTIL_BIND_ADD_ENTRY               0x4D
+#define MT_UTIL_CB_FILTER_SET                0x50
+#define MT_UTIL_CB_FILTER_RESET              0x51
+#define MT_UTIL_CB_FILTER_STATS              0x52
 
 #define MT_UTIL_ZCL_KEY_EST_INIT_EST         0x80
 #define MT_UTIL_ZCL_KEY_EST_SIGN             0x81
@@ -545,6 +561,11 @@ extern "C"
 #define MT_SRNG_EVENT                   0x1000
 #endif
 
+/* Next MT_SYS_OSAL_NV_STREAM_IND or MT_SYS_NV_SNAPSHOT_IND due. The ZNP task
+ * takes MT's events too, and uses 0x1000-0x4000: this bit, which nothing else
+ * sets (MT_ZTOOL_SERIAL_RCV_CHAR is not used), is free in both. */
+#define MT_SYS_NV_STREAM_EVT            0x0001
+
 /* Message Command IDs */
 #define CMD_SERIAL_MSG                  0x01
 #define CMD_DEBUG_MSG                   0x02
@@ -791,6 +812,21 @@ extern "C"
   #define MT_CAP_ZOAD 0x0000
 #endif
 
+/* Pipelined SREQs (MT_SYS_PIPE_REQ) are answered in a frame from MT_TransportAlloc() */
+#if !defined ( NPI ) && !defined ( FEATURE_DUAL_MAC )
+  #define MT_PIPE_SUPPORT  TRUE
+#else
+  #define MT_PIPE_SUPPORT  FALSE
+#endif
+
+/* Number of MT_SYS_PIPE_REQ the host may have outstanding: default, and maximum MT_SYS_PIPE_CFG */
+#if !defined ( MT_PIPE_WINDOW )
+  #define MT_PIPE_WINDOW      4
+#endif
+#if !defined ( MT_PIPE_WINDOW_MAX )
+  #define MT_PIPE_WINDOW_MAX  16
+#endif
+
 /* ZNP NV items, 1-4 2-bytes each, 5-6 16-bytes each */
 #define ZNP_NV_APP_ITEM_1       0x0F01
 #define ZNP_NV_APP_ITEM_2       0x0F02
@@ -878,6 +914,18 @@ extern uint8 *MT_TransportAlloc(uint8 cmd0, uint8 len);
  */
 extern void MT_TransportSend(uint8 *pBuf);
 
+#if MT_PIPE_SUPPORT
+/*
+ * Credit check for the transports: TRUE while the window of pipelined requests is full
+ */
+extern bool MT_PipeFull(void);
+
+/*
+ * Count a received frame against the window if it is a pipelined request
+ */
+extern void MT_PipeQueued(uint8 *pBuf);
+#endif
+
 /*
  * Utility function to build endpoint descriptor from incoming buffer
  */
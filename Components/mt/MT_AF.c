@@ -58,6 +58,10 @@
 #include "MT_GP.h"
 #endif
 
+#if defined MT_UTIL_CB_FILTER
+#include "MT_UTIL.h"
+#endif
+
 /* ------------------------------------------------------------------------------------------------
  *                                          Constants
  * ------------------------------------------------------------------------------------------------
@@ -71,6 +75,14 @@
 #define MT_AF_EXEC_DLY  1000
 #endif
 
+// Incoming indications are built directly in the MT transport frame, unless NPI or the dual MAC
+// build the frame themselves.
+#if defined NPI || defined FEATURE_DUAL_MAC
+#define MT_AF_INC_IN_PLACE  FALSE
+#else
+#define MT_AF_INC_IN_PLACE  TRUE
+#endif
+
 /* ------------------------------------------------------------------------------------------------
  *                                           Typedefs
  * ------------------------------------------------------------------------------------------------
@@ -136,6 +148,9 @@ static void MT_AfDataStore(uint8 *pBuf);
 static void MT_AfAPSF_ConfigSet(uint8 *pBuf);
 static void MT_AfAPSF_ConfigGet(uint8 *pBuf);
 
+#if defined MT_UTIL_CB_FILTER
+static uint8 MT_AfCbFilter(uint8 cmd, uint8 endPoint, uint16 clusterId, afAddrType_t *pSrcAddr);
+#endif
 
 /**************************************************************************************************
  * @fn          MT_AfExec
@@ -627,6 +642,13 @@ void MT_AfDataConfirm(afDataConfirm_t *pMsg)
 {
   uint8 retArray[3];
 
+#if defined MT_UTIL_CB_FILTER
+  if (!MT_AfCbFilter(MT_AF_DATA_CONFIRM, pMsg->endpoint, 0, NULL))
+  {
+    return;
+  }
+#endif
+
   retArray[0] = pMsg->hdr.status;
   retArray[1] = pMsg->endpoint;
   retArray[2] = pMsg->transID;
@@ -677,6 +699,9 @@ void MT_AfIncomingMsg(afIncomingMSGPacket_t *pMsg)
   uint16 respLen = MT_AF_INC_MSG_LEN + dataLen;
   uint8 cmd = MT_AF_INCOMING_MSG;
   uint8 *pRsp, *pTmp;
+#if MT_AF_INC_IN_PLACE
+  uint8 *pFrame;
+#endif
   mtAfInMsgList_t *pItem = NULL;
 
 #if defined INTER_PAN
@@ -697,6 +722,13 @@ void MT_AfIncomingMsg(afIncomingMSGPacket_t *pMsg)
     respLen += MT_AF_INC_MSG_EXT;
   }
 
+#if defined MT_UTIL_CB_FILTER
+  if (!MT_AfCbFilter(cmd, pMsg->endPoint, pMsg->clusterId, &pMsg->srcAddr))
+  {
+    return;
+  }
+#endif
+
   if (respLen > (uint16)MT_RPC_DATA_MAX)
   {
     if ((pItem = (mtAfInMsgList_t *)osal_mem_alloc(sizeof(mtAfInMsgList_t) + dataLen)) == NULL)
@@ -709,7 +741,15 @@ void MT_AfIncomingMsg(afIncomingMSGPacket_t *pMsg)
   }
 
   // Attempt to allocate memory for the response packet.
+#if MT_AF_INC_IN_PLACE
+  if ((pFrame = MT_TransportAlloc((uint8)MT_RPC_CMD_AREQ, (uint8)respLen)) != NULL)
+  {
+    pRsp = pFrame + MT_RPC_POS_DAT0;
+  }
+  else
+#else
   if ((pRsp = osal_mem_alloc(respLen)) == NULL)
+#endif
   {
     if (pItem != NULL)
     {
@@ -825,10 +865,63 @@ void MT_AfIncomingMsg(afIncomingMSGPacket_t *pMsg)
   *pTmp = pMsg->radius;
 
   /* Build and send back the response */
+#if MT_AF_INC_IN_PLACE
+  pFrame[MT_RPC_POS_LEN] = (uint8)respLen;
+  pFrame[MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_AF;
+  pFrame[MT_RPC_POS_CMD1] = cmd;
+  MT_TransportSend(pFrame);
+#else
   MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_AREQ|(uint8)MT_RPC_SYS_AF), cmd, respLen, pRsp);
 
   (void)osal_mem_free(pRsp);
+#endif
+}
+
+#if defined MT_UTIL_CB_FILTER
+/***************************************************************************************************
+ * @fn          MT_AfCbFilter
+ *
+ * @brief       Describe an AF callback to the MT_UTIL callback filter. The profile is taken from
+ *              the local endpoint the callback is for.
+ *
+ * @param       cmd - MT_AF callback command ID.
+ * @param       endPoint - Local endpoint.
+ * @param       clusterId - Cluster of the message, not used without a source address.
+ * @param       pSrcAddr - Source of an incoming message, NULL for a confirm.
+ *
+ * @return      TRUE if the callback is to be sent.
+ ***************************************************************************************************/
+static uint8 MT_AfCbFilter(uint8 cmd, uint8 endPoint, uint16 clusterId, afAddrType_t *pSrcAddr)
+{
+  mtUtilCbKey_t key;
+  endPointDesc_t *epDesc = afFindEndPointDesc(endPoint);
+
+  key.cmd0 = (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_AF;
+  key.cmd1 = cmd;
+  key.known = MT_UTIL_CB_KEY_EP;
+  key.endpoint = endPoint;
+
+  if ((epDesc != NULL) && (epDesc->simpleDesc != NULL))
+  {
+    key.known |= MT_UTIL_CB_KEY_PROFILE;
+    key.profileId = epDesc->simpleDesc->AppProfId;
+  }
+
+  if (pSrcAddr != NULL)
+  {
+    key.known |= MT_UTIL_CB_KEY_CLUSTER;
+    key.clusterId = clusterId;
+
+    if (pSrcAddr->addrMode != afAddr64Bit)
+    {
+      key.known |= MT_UTIL_CB_KEY_SRC;
+      key.srcAddr = pSrcAddr->addr.shortAddr;
+    }
+  }
+
+  return MT_UtilCbFilter(&key);
 }
+#endif
 
 /**************************************************************************************************
  * @fn          MT_AfDataRetrieve
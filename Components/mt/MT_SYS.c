@@ -145,6 +145,33 @@
 #define MT_SYS_OSAL_NV_READ_CERTIFICATE_DATA  FALSE
 #endif
 
+#if defined( OSAL_NV_EXTENDED )
+/* Item data bytes per MT_SYS_OSAL_NV_STREAM_IND, after its 8 header bytes */
+#if !defined( MT_SYS_NV_STREAM_LEN )
+#define MT_SYS_NV_STREAM_LEN  ( MT_MAX_RSP_DATA_LEN - 8 )
+#endif
+#endif
+
+#if MT_SYS_NV_STREAM
+/* Delay, in msecs, between indications: about the time to send one at 38400 baud */
+#if !defined( MT_SYS_NV_STREAM_DLY )
+#define MT_SYS_NV_STREAM_DLY  40
+#endif
+#endif
+
+#if OSAL_NV_SNAPSHOT
+/* Snapshot bytes per MT_SYS_NV_SNAPSHOT_IND, after its 3 header bytes */
+#if !defined( MT_SYS_NV_SNAPSHOT_LEN )
+#define MT_SYS_NV_SNAPSHOT_LEN  ( MT_MAX_RSP_DATA_LEN - 3 )
+#endif
+/* MT_SYS_NV_SNAPSHOT_IMPORT AREQs acknowledged together by one MT_SYS_NV_SNAPSHOT_ACK */
+#if !defined( MT_SYS_NV_SNAPSHOT_WINDOW )
+#define MT_SYS_NV_SNAPSHOT_WINDOW  4
+#endif
+/* Size of the item Id and length that start each record of a snapshot */
+#define MT_SYS_NV_SNAPSHOT_HDR  4
+#endif
+
 #if defined( MT_SYS_FUNC )
 static const uint16 MT_SysOsalEventId[] =
 {
@@ -201,6 +228,46 @@ static uint32 jammerDetectPeriodTime = JAMMER_DETECT_PERIOD_TIME;
 static uint8 sniffer = FALSE;
 #endif
 
+#if MT_SYS_NV_STREAM && defined( OSAL_NV_EXTENDED )
+/* NV item being streamed by MT_SYS_OSAL_NV_STREAM_IND; nothing is left when 'len' is 0 */
+static struct
+{
+  uint16 id;
+  uint16 subId;
+  uint16 ofs;
+  uint16 len;
+} mtSysNvStream;
+#endif
+
+#if MT_SYS_NV_STREAM && OSAL_NV_SNAPSHOT
+/* NV snapshot being sent by MT_SYS_NV_SNAPSHOT_IND */
+static struct
+{
+  uint16 id;        // Item of the record being sent, zero past the last one
+  uint16 len;       // Length of that item
+  uint16 pos;       // Bytes of the record sent, its header included
+  uint16 seq;       // Sequence number of the next indication
+  uint16 crc;       // CRC of the snapshot bytes sent
+  uint16 changes;   // osal_nv_changes() when the snapshot was started
+  uint8 keys;       // The security key items are exported too
+  uint8 active;
+} mtSysNvExport;
+
+/* NV snapshot being received by MT_SYS_NV_SNAPSHOT_IMPORT */
+static struct
+{
+  uint8 *pData;     // RAM copy of the record data; NULL to write it to NV as it comes in
+  uint16 id;        // Item of the record being received
+  uint16 len;       // Length of that item
+  uint16 pos;       // Bytes of the record received, its header included
+  uint16 seq;       // Sequence number of the next request
+  uint16 crc;       // CRC of the snapshot bytes received
+  uint8 hdr[MT_SYS_NV_SNAPSHOT_HDR];
+  uint8 skip;       // The item of the record is not to be written
+  uint8 active;
+} mtSysNvImport;
+#endif
+
 /******************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
@@ -228,6 +295,23 @@ static void MT_SysOsalNVLength(uint8 *pBuf);
 static void MT_SysOsalNVRead(uint8 *pBuf);
 static void MT_SysOsalNVWrite(uint8 *pBuf);
 static uint8 MT_CheckNvId(uint16 nvId);
+#if !MT_SYS_KEY_MANAGEMENT
+static uint8 MT_CheckNvKeyId(uint16 nvId);
+#endif
+#if MT_SYS_NV_STREAM && defined( OSAL_NV_EXTENDED )
+static void MT_SysOsalNVReadStream(uint8 *pBuf);
+static uint8 MT_SysNvStreamItem(void);
+#endif /* OSAL_NV_EXTENDED */
+#if MT_SYS_NV_STREAM && OSAL_NV_SNAPSHOT
+static void MT_SysNvSnapshotExport(uint8 *pBuf);
+static void MT_SysNvSnapshotImport(uint8 *pBuf);
+static uint8 MT_SysNvSnapshotSend(void);
+static uint8 MT_SysNvSnapshotItem(uint16 id, uint16 len, uint8 *pData);
+static void MT_SysNvSnapshotAck(uint8 cmd0, uint8 status);
+static uint8 MT_SysNvSnapshotAllowed(uint16 id, uint8 keys);
+static uint16 MT_SysNvSnapshotNext(uint16 id);
+static uint16 MT_SysNvSnapshotCrc(uint16 crc, uint8 *pBuf, uint16 len);
+#endif /* OSAL_NV_SNAPSHOT */
 #if defined( FEATURE_NVEXID )
 static void MT_SysNvCompact(uint8 *pBuf);
 static void MT_SysNvCreate(uint8 *pBuf);
@@ -252,6 +336,15 @@ static void MT_SysZDiagsGetStatsAttr(uint8 *pBuf);
 static void MT_SysZDiagsRestoreStatsFromNV(void);
 static void MT_SysZDiagsSaveStatsToNV(void);
 #endif /* FEATURE_SYSTEM_STATS */
+#if ( OSAL_MSG_POOLS )
+static void MT_SysMsgPoolStats(void);
+#endif /* OSAL_MSG_POOLS */
+#if ( OSAL_PROFILE )
+static void MT_SysTaskProfile(uint8 *pBuf);
+#endif /* OSAL_PROFILE */
+#if ( OSALMEM_SITE_TAGS )
+static void MT_SysHeapMap(void);
+#endif /* OSALMEM_SITE_TAGS */
 #if defined( ENABLE_MT_SYS_RESET_SHUTDOWN )
 static void powerOffSoc(void);
 #endif /* ENABLE_MT_SYS_RESET_SHUTDOWN */
@@ -358,6 +451,22 @@ uint8 MT_SysCommandProcessing(uint8 *pBuf)
       MT_SysOsalNVWrite(pBuf);
       break;
 
+#if MT_SYS_NV_STREAM && defined( OSAL_NV_EXTENDED )
+    case MT_SYS_OSAL_NV_READ_STREAM:
+      MT_SysOsalNVReadStream(pBuf);
+      break;
+#endif  /* OSAL_NV_EXTENDED */
+
+#if MT_SYS_NV_STREAM && OSAL_NV_SNAPSHOT
+    case MT_SYS_NV_SNAPSHOT_EXPORT:
+      MT_SysNvSnapshotExport(pBuf);
+      break;
+
+    case MT_SYS_NV_SNAPSHOT_IMPORT:
+      MT_SysNvSnapshotImport(pBuf);
+      break;
+#endif  /* OSAL_NV_SNAPSHOT */
+
 #if defined( FEATURE_NVEXID )
     case MT_SYS_NV_COMPACT:
       MT_SysNvCompact(pBuf);
@@ -422,6 +531,24 @@ uint8 MT_SysCommandProcessing(uint8 *pBuf)
       break;
 #endif /* FEATURE_SYSTEM_STATS */
 
+#if ( OSAL_MSG_POOLS )
+    case MT_SYS_MSG_POOL_STATS:
+      MT_SysMsgPoolStats();
+      break;
+#endif /* OSAL_MSG_POOLS */
+
+#if ( OSAL_PROFILE )
+    case MT_SYS_TASK_PROFILE:
+      MT_SysTaskProfile(pBuf);
+      break;
+#endif /* OSAL_PROFILE */
+
+#if ( OSALMEM_SITE_TAGS )
+    case MT_SYS_HEAP_MAP:
+      MT_SysHeapMap();
+      break;
+#endif /* OSALMEM_SITE_TAGS */
+
     default:
       status = MT_RPC_ERR_COMMAND_ID;
       break;
@@ -440,6 +567,11 @@ uint8 MT_SysCommandProcessing(uint8 *pBuf)
  *****************************************************************************/
 void MT_SysReset( uint8 *pBuf )
 {
+#if OSAL_NV_CACHE
+  // The host may have written NV items just before asking for the reset.
+  (void)osal_nv_flush();
+#endif
+
   switch( pBuf[MT_RPC_POS_DAT0] )
   {
     case MT_SYS_RESET_HARD:
@@ -621,11 +753,7 @@ static uint8 MT_CheckNvId( uint16 nvId )
 #endif  /* MT_SYS_OSAL_NV_READ_CERTIFICATE_DATA */
 
 #if !MT_SYS_KEY_MANAGEMENT
-  if ( (nvId == ZCD_NV_NWK_ACTIVE_KEY_INFO) ||
-       (nvId == ZCD_NV_NWK_ALTERN_KEY_INFO) ||
-      ((nvId >= ZCD_NV_TCLK_TABLE_START) && (nvId <= ZCD_NV_TCLK_TABLE_END)) ||
-      ((nvId >= ZCD_NV_APS_LINK_KEY_DATA_START) && (nvId <= ZCD_NV_APS_LINK_KEY_DATA_END)) ||
-       (nvId == ZCD_NV_PRECFGKEY) )
+  if ( MT_CheckNvKeyId( nvId ) )
   {
     /* Access to Security Key Data is denied */
     return( ZInvalidParameter );
@@ -635,6 +763,26 @@ static uint8 MT_CheckNvId( uint16 nvId )
   return( ZSuccess );
 }
 
+#if !MT_SYS_KEY_MANAGEMENT
+/******************************************************************************
+ * @fn      MT_CheckNvKeyId
+ *
+ * @brief   Check whether an NV item holds Security Key Data
+ *
+ * @param   nvId - NV item ID
+ *
+ * @return  TRUE if it does
+ *****************************************************************************/
+static uint8 MT_CheckNvKeyId( uint16 nvId )
+{
+  return ( (nvId == ZCD_NV_NWK_ACTIVE_KEY_INFO) ||
+           (nvId == ZCD_NV_NWK_ALTERN_KEY_INFO) ||
+          ((nvId >= ZCD_NV_TCLK_TABLE_START) && (nvId <= ZCD_NV_TCLK_TABLE_END)) ||
+          ((nvId >= ZCD_NV_APS_LINK_KEY_DATA_START) && (nvId <= ZCD_NV_APS_LINK_KEY_DATA_END)) ||
+           (nvId == ZCD_NV_PRECFGKEY) );
+}
+#endif  /* !MT_SYS_KEY_MANAGEMENT */
+
 /******************************************************************************
  * @fn      MT_SysOsalNVRead
  *
@@ -998,6 +1146,621 @@ static void MT_SysOsalNVLength(uint8 *pBuf)
                                 sizeof(rsp), rsp);
 }
 
+#if MT_SYS_NV_STREAM && defined( OSAL_NV_EXTENDED )
+/******************************************************************************
+ * @fn      MT_SysOsalNVReadStream
+ *
+ * @brief   Start streaming an NV item (extended item ID) to the host in
+ *          MT_SYS_OSAL_NV_STREAM_IND, so that an item larger than an MT
+ *          frame is read with one request. A new request replaces the
+ *          stream in progress, if any.
+ *          Request: table ID (2), sub ID (2), offset (2), length (2, 0 for
+ *          the rest of the item). Response: status, item length (2).
+ *          Only reads are streamed: a host writes a large item in pieces,
+ *          one MT_SYS_NV_WRITE (FEATURE_NVEXID) per frame at its offset,
+ *          each SRSP pacing the next one to the flash writes.
+ *
+ * @param   pBuf - pointer to the data
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysOsalNVReadStream(uint8 *pBuf)
+{
+  uint8 rsp[3];
+  uint16 dataOfs;
+  uint16 dataLen;
+  uint16 nvItemLen;
+
+  /* Skip over RPC header */
+  pBuf += MT_RPC_FRAME_HDR_SZ;
+
+  mtSysNvStream.id = osal_build_uint16( pBuf );
+  mtSysNvStream.subId = osal_build_uint16( pBuf+2 );
+  dataOfs = osal_build_uint16( pBuf+4 );
+  dataLen = osal_build_uint16( pBuf+6 );
+
+  nvItemLen = osal_nv_item_len_ex( mtSysNvStream.id, mtSysNvStream.subId );
+
+  if( (mtSysNvStream.id == ZCD_NV_EX_LEGACY) && (MT_CheckNvId( mtSysNvStream.subId ) != ZSuccess) )
+  {
+    rsp[0] = ZInvalidParameter;
+  }
+  else if( nvItemLen <= dataOfs )
+  {
+    /* Missing item, or offset is past end of data */
+    rsp[0] = ZInvalidParameter;
+  }
+  else
+  {
+    rsp[0] = ZSuccess;
+  }
+
+  if( rsp[0] == ZSuccess )
+  {
+    if( (dataLen == 0) || (dataLen > (nvItemLen - dataOfs)) )
+    {
+      dataLen = nvItemLen - dataOfs;
+    }
+    mtSysNvStream.ofs = dataOfs;
+    mtSysNvStream.len = dataLen;
+  }
+  else
+  {
+    mtSysNvStream.len = 0;
+  }
+
+  rsp[1] = LO_UINT16( nvItemLen );
+  rsp[2] = HI_UINT16( nvItemLen );
+
+  /* Build and send back the response before the first indication */
+  MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_OSAL_NV_READ_STREAM,
+                                sizeof(rsp), rsp);
+
+  if( mtSysNvStream.len != 0 )
+  {
+    osal_stop_timerEx( MT_TaskID, MT_SYS_NV_STREAM_EVT );
+    osal_set_event( MT_TaskID, MT_SYS_NV_STREAM_EVT );
+  }
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvStreamItem
+ *
+ * @brief   Send the next MT_SYS_OSAL_NV_STREAM_IND of the NV item being
+ *          streamed: status, table ID (2), sub ID (2), offset (2), data
+ *          length, data. A failed read ends the stream with an indication
+ *          that carries its status and no data.
+ *
+ * @param   None
+ *
+ * @return  TRUE if there is more of the item to send
+ *****************************************************************************/
+static uint8 MT_SysNvStreamItem(void)
+{
+  uint8 *pRetBuf;
+  uint8 dataLen;
+
+  dataLen = (mtSysNvStream.len > MT_SYS_NV_STREAM_LEN) ? MT_SYS_NV_STREAM_LEN
+                                                       : (uint8)mtSysNvStream.len;
+
+  pRetBuf = osal_mem_alloc( 8 + dataLen );
+  if( pRetBuf == NULL )
+  {
+    /* Try again later rather than leave a hole in the item */
+    return TRUE;
+  }
+
+  pRetBuf[0] = osal_nv_read_ex( mtSysNvStream.id, mtSysNvStream.subId,
+                                mtSysNvStream.ofs, dataLen, pRetBuf+8 );
+  pRetBuf[1] = LO_UINT16( mtSysNvStream.id );
+  pRetBuf[2] = HI_UINT16( mtSysNvStream.id );
+  pRetBuf[3] = LO_UINT16( mtSysNvStream.subId );
+  pRetBuf[4] = HI_UINT16( mtSysNvStream.subId );
+  pRetBuf[5] = LO_UINT16( mtSysNvStream.ofs );
+  pRetBuf[6] = HI_UINT16( mtSysNvStream.ofs );
+
+  if( pRetBuf[0] == SUCCESS )
+  {
+    pRetBuf[7] = dataLen;
+    mtSysNvStream.ofs += dataLen;
+    mtSysNvStream.len -= dataLen;
+  }
+  else
+  {
+    pRetBuf[7] = dataLen = 0;
+    mtSysNvStream.len = 0;
+  }
+
+  MT_BuildAndSendZToolResponse( MT_ARSP_SYS, MT_SYS_OSAL_NV_STREAM_IND,
+                                8 + dataLen, pRetBuf );
+  osal_mem_free( pRetBuf );
+
+  return ( mtSysNvStream.len != 0 );
+}
+#endif /* OSAL_NV_EXTENDED */
+
+#if MT_SYS_NV_STREAM && OSAL_NV_SNAPSHOT
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotExport
+ *
+ * @brief   Start sending a snapshot of all of the NV items readable over MT
+ *          to the host in MT_SYS_NV_SNAPSHOT_IND, replacing the one in
+ *          progress, if any. The snapshot is a series of records, each the
+ *          item ID (2), the item length (2) and the item data.
+ *          Request: flags, optional (MT_SYS_NV_SNAPSHOT_SECURITY with
+ *          MT_SYS_NV_SNAPSHOT_KEYS). Response: status, item count (2),
+ *          snapshot length (4).
+ *
+ * @param   pBuf - pointer to the data
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysNvSnapshotExport(uint8 *pBuf)
+{
+  uint8 rsp[7];
+  uint32 total = 0;
+  uint16 items = 0;
+  uint16 id;
+
+  mtSysNvExport.keys = FALSE;
+#if MT_SYS_NV_SNAPSHOT_KEYS
+  if( (pBuf[MT_RPC_POS_LEN] != 0) &&
+      (pBuf[MT_RPC_FRAME_HDR_SZ] & MT_SYS_NV_SNAPSHOT_SECURITY) )
+  {
+    mtSysNvExport.keys = TRUE;
+  }
+#else
+  (void)pBuf;
+#endif
+
+  for( id = MT_SysNvSnapshotNext( 0 ); id != 0; id = MT_SysNvSnapshotNext( id ) )
+  {
+    total += MT_SYS_NV_SNAPSHOT_HDR + osal_nv_item_len( id );
+    items++;
+  }
+
+  mtSysNvExport.id = MT_SysNvSnapshotNext( 0 );
+  mtSysNvExport.len = (mtSysNvExport.id != 0) ? osal_nv_item_len( mtSysNvExport.id ) : 0;
+  mtSysNvExport.pos = 0;
+  mtSysNvExport.seq = 0;
+  mtSysNvExport.crc = 0xFFFF;
+  mtSysNvExport.changes = osal_nv_changes();
+  mtSysNvExport.active = TRUE;
+
+  rsp[0] = ZSuccess;
+  rsp[1] = LO_UINT16( items );
+  rsp[2] = HI_UINT16( items );
+  osal_buffer_uint32( &rsp[3], total );
+
+  /* Build and send back the response before the first indication */
+  MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_NV_SNAPSHOT_EXPORT,
+                                sizeof(rsp), rsp );
+
+  osal_stop_timerEx( MT_TaskID, MT_SYS_NV_STREAM_EVT );
+  osal_set_event( MT_TaskID, MT_SYS_NV_STREAM_EVT );
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotSend
+ *
+ * @brief   Send the next MT_SYS_NV_SNAPSHOT_IND of the NV snapshot: sequence
+ *          number (2), data length, data. The last one has no data and
+ *          carries the status and the CRC (2) of the snapshot instead; the
+ *          status is NV_OPER_FAILED if an NV item changed since the
+ *          snapshot was started, and the host has to start it over.
+ *
+ * @param   None
+ *
+ * @return  TRUE if there is more of the snapshot to send
+ *****************************************************************************/
+static uint8 MT_SysNvSnapshotSend(void)
+{
+  uint8 *pRetBuf;
+  uint8 status = SUCCESS;
+  uint8 dataLen = 0;
+
+  pRetBuf = osal_mem_alloc( 3 + MT_SYS_NV_SNAPSHOT_LEN );
+  if( pRetBuf == NULL )
+  {
+    return TRUE;
+  }
+
+  if( osal_nv_changes() != mtSysNvExport.changes )
+  {
+    status = NV_OPER_FAILED;
+  }
+
+  while( (status == SUCCESS) && (mtSysNvExport.id != 0) && (dataLen < MT_SYS_NV_SNAPSHOT_LEN) )
+  {
+    if( mtSysNvExport.pos < MT_SYS_NV_SNAPSHOT_HDR )
+    {
+      uint16 tmp = (mtSysNvExport.pos < 2) ? mtSysNvExport.id : mtSysNvExport.len;
+
+      pRetBuf[3 + dataLen++] = (mtSysNvExport.pos & 1) ? HI_UINT16( tmp ) : LO_UINT16( tmp );
+      mtSysNvExport.pos++;
+    }
+    else
+    {
+      uint16 cnt = MT_SYS_NV_SNAPSHOT_HDR + mtSysNvExport.len - mtSysNvExport.pos;
+
+      if( cnt > (MT_SYS_NV_SNAPSHOT_LEN - dataLen) )
+      {
+        cnt = MT_SYS_NV_SNAPSHOT_LEN - dataLen;
+      }
+
+      status = osal_nv_read( mtSysNvExport.id, mtSysNvExport.pos - MT_SYS_NV_SNAPSHOT_HDR,
+                             cnt, pRetBuf + 3 + dataLen );
+      dataLen += (uint8)cnt;
+      mtSysNvExport.pos += cnt;
+    }
+
+    if( mtSysNvExport.pos == (MT_SYS_NV_SNAPSHOT_HDR + mtSysNvExport.len) )
+    {
+      mtSysNvExport.id = MT_SysNvSnapshotNext( mtSysNvExport.id );
+      mtSysNvExport.len = (mtSysNvExport.id != 0) ? osal_nv_item_len( mtSysNvExport.id ) : 0;
+      mtSysNvExport.pos = 0;
+    }
+  }
+
+  pRetBuf[0] = LO_UINT16( mtSysNvExport.seq );
+  pRetBuf[1] = HI_UINT16( mtSysNvExport.seq );
+  mtSysNvExport.seq++;
+
+  if( (status == SUCCESS) && (dataLen != 0) )
+  {
+    pRetBuf[2] = dataLen;
+    mtSysNvExport.crc = MT_SysNvSnapshotCrc( mtSysNvExport.crc, pRetBuf + 3, dataLen );
+  }
+  else
+  {
+    pRetBuf[2] = dataLen = 0;
+    pRetBuf[3] = status;
+    pRetBuf[4] = LO_UINT16( mtSysNvExport.crc );
+    pRetBuf[5] = HI_UINT16( mtSysNvExport.crc );
+    mtSysNvExport.active = FALSE;
+  }
+
+  MT_BuildAndSendZToolResponse( MT_ARSP_SYS, MT_SYS_NV_SNAPSHOT_IND,
+                                3 + ((dataLen != 0) ? dataLen : 3), pRetBuf );
+  osal_mem_free( pRetBuf );
+
+  return mtSysNvExport.active;
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotImport
+ *
+ * @brief   Write the next part of an NV snapshot, as sent by
+ *          MT_SYS_NV_SNAPSHOT_IND, to NV: sequence number (2), data length,
+ *          data. Sequence number 0 starts a new import; a part with no data
+ *          carries the status and the CRC (2) of the snapshot and ends it.
+ *          Sent as an SREQ, each part gets a response: status, next
+ *          sequence number (2). Sent as AREQs, up to
+ *          MT_SYS_NV_SNAPSHOT_WINDOW parts get one MT_SYS_NV_SNAPSHOT_ACK
+ *          with the same fields, as do the last part and any failure.
+ *          A failed import stops there, leaving the items written so far.
+ *
+ * @param   pBuf - pointer to the data
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysNvSnapshotImport(uint8 *pBuf)
+{
+  uint8 cmd0 = pBuf[MT_RPC_POS_CMD0];
+  uint8 frameLen = pBuf[MT_RPC_POS_LEN];
+  uint8 status = SUCCESS;
+  uint16 seq;
+  uint8 dataLen;
+  uint8 last;
+
+  /* Skip over RPC header */
+  pBuf += MT_RPC_FRAME_HDR_SZ;
+
+  /* The data, or the status and CRC of the last part, must be in the frame */
+  if( (frameLen < 3) || (frameLen - 3 < ((pBuf[2] == 0) ? 3 : pBuf[2])) )
+  {
+    MT_SysNvSnapshotAck( cmd0, ZInvalidParameter );
+    return;
+  }
+
+  seq = osal_build_uint16( pBuf );
+  dataLen = pBuf[2];
+  last = (dataLen == 0);
+  pBuf += 3;
+
+  if( seq == 0 )
+  {
+    if( mtSysNvImport.pData != NULL )
+    {
+      osal_mem_free( mtSysNvImport.pData );
+      mtSysNvImport.pData = NULL;
+    }
+    mtSysNvImport.pos = 0;
+    mtSysNvImport.seq = 0;
+    mtSysNvImport.crc = 0xFFFF;
+    mtSysNvImport.active = TRUE;
+  }
+
+  if( !mtSysNvImport.active || (seq != mtSysNvImport.seq) )
+  {
+    MT_SysNvSnapshotAck( cmd0, ZInvalidParameter );
+    return;
+  }
+  mtSysNvImport.seq++;
+
+  if( last )
+  {
+    /* The end of the snapshot: nothing may be left of a record */
+    if( (mtSysNvImport.pos != 0) || (pBuf[0] != SUCCESS) ||
+        (osal_build_uint16( pBuf+1 ) != mtSysNvImport.crc) )
+    {
+      status = NV_OPER_FAILED;
+    }
+  }
+  else
+  {
+    mtSysNvImport.crc = MT_SysNvSnapshotCrc( mtSysNvImport.crc, pBuf, dataLen );
+  }
+
+  while( (status == SUCCESS) && (dataLen != 0) )
+  {
+    if( mtSysNvImport.pos < MT_SYS_NV_SNAPSHOT_HDR )
+    {
+      mtSysNvImport.hdr[mtSysNvImport.pos++] = *pBuf++;
+      dataLen--;
+
+      if( mtSysNvImport.pos == MT_SYS_NV_SNAPSHOT_HDR )
+      {
+        mtSysNvImport.id = osal_build_uint16( mtSysNvImport.hdr );
+        mtSysNvImport.len = osal_build_uint16( mtSysNvImport.hdr+2 );
+
+        /* Items that MT may not read are not written either, the keys aside if allowed */
+        mtSysNvImport.skip = (mtSysNvImport.id == 0) ||
+                             !MT_SysNvSnapshotAllowed( mtSysNvImport.id, MT_SYS_NV_SNAPSHOT_KEYS );
+
+        if( !mtSysNvImport.skip && (mtSysNvImport.len != 0) )
+        {
+          /* Write the item once, when all of its data is in, unless it is too big for the heap */
+          mtSysNvImport.pData = osal_mem_alloc( mtSysNvImport.len );
+          if( mtSysNvImport.pData == NULL )
+          {
+            status = MT_SysNvSnapshotItem( mtSysNvImport.id, mtSysNvImport.len, NULL );
+          }
+        }
+      }
+    }
+    else
+    {
+      uint16 ofs = mtSysNvImport.pos - MT_SYS_NV_SNAPSHOT_HDR;
+      uint16 cnt = mtSysNvImport.len - ofs;
+
+      if( cnt > dataLen )
+      {
+        cnt = dataLen;
+      }
+
+      if( mtSysNvImport.pData != NULL )
+      {
+        osal_memcpy( mtSysNvImport.pData + ofs, pBuf, cnt );
+      }
+      else if( !mtSysNvImport.skip )
+      {
+        status = osal_nv_write( mtSysNvImport.id, ofs, cnt, pBuf );
+      }
+      mtSysNvImport.pos += cnt;
+      pBuf += cnt;
+      dataLen -= (uint8)cnt;
+    }
+
+    if( mtSysNvImport.pos == (MT_SYS_NV_SNAPSHOT_HDR + mtSysNvImport.len) )
+    {
+      if( mtSysNvImport.pData != NULL )
+      {
+        status = MT_SysNvSnapshotItem( mtSysNvImport.id, mtSysNvImport.len, mtSysNvImport.pData );
+        osal_mem_free( mtSysNvImport.pData );
+        mtSysNvImport.pData = NULL;
+      }
+      else if( !mtSysNvImport.skip && (mtSysNvImport.len == 0) )
+      {
+        status = MT_SysNvSnapshotItem( mtSysNvImport.id, 0, NULL );
+      }
+      mtSysNvImport.pos = 0;
+    }
+  }
+
+  if( (status != SUCCESS) || last )
+  {
+    if( mtSysNvImport.pData != NULL )
+    {
+      osal_mem_free( mtSysNvImport.pData );
+      mtSysNvImport.pData = NULL;
+    }
+    mtSysNvImport.active = FALSE;
+  }
+
+  if( !mtSysNvImport.active || ((mtSysNvImport.seq % MT_SYS_NV_SNAPSHOT_WINDOW) == 0) ||
+      ((cmd0 & MT_RPC_CMD_TYPE_MASK) == MT_RPC_CMD_SREQ) )
+  {
+    MT_SysNvSnapshotAck( cmd0, status );
+  }
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotItem
+ *
+ * @brief   Create, or resize, an NV item of an imported snapshot and write
+ *          its data.
+ *
+ * @param   id - NV item ID
+ * @param   len - item length
+ * @param   pData - item data, or NULL to only create the item
+ *
+ * @return  status
+ *****************************************************************************/
+static uint8 MT_SysNvSnapshotItem(uint16 id, uint16 len, uint8 *pData)
+{
+  uint16 nvItemLen = osal_nv_item_len( id );
+
+  if( nvItemLen != len )
+  {
+    if( (nvItemLen != 0) && (osal_nv_delete( id, nvItemLen ) != SUCCESS) )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    return ( (osal_nv_item_init( id, len, pData ) == NV_ITEM_UNINIT) ? SUCCESS : NV_OPER_FAILED );
+  }
+  else if( (pData != NULL) && (len != 0) )
+  {
+    /* Unchanged data is not written again */
+    return osal_nv_write( id, 0, len, pData );
+  }
+
+  return SUCCESS;
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotAck
+ *
+ * @brief   Acknowledge MT_SYS_NV_SNAPSHOT_IMPORT: status, next sequence
+ *          number (2), in its SRSP or in an MT_SYS_NV_SNAPSHOT_ACK.
+ *
+ * @param   cmd0 - command type of the request
+ * @param   status - import status
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysNvSnapshotAck(uint8 cmd0, uint8 status)
+{
+  uint8 rsp[3];
+
+  rsp[0] = status;
+  rsp[1] = LO_UINT16( mtSysNvImport.seq );
+  rsp[2] = HI_UINT16( mtSysNvImport.seq );
+
+  if( (cmd0 & MT_RPC_CMD_TYPE_MASK) == MT_RPC_CMD_SREQ )
+  {
+    MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_NV_SNAPSHOT_IMPORT, sizeof(rsp), rsp );
+  }
+  else
+  {
+    MT_BuildAndSendZToolResponse( MT_ARSP_SYS, MT_SYS_NV_SNAPSHOT_ACK, sizeof(rsp), rsp );
+  }
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotAllowed
+ *
+ * @brief   Check whether an NV item may be in a snapshot: MT may read it,
+ *          or it holds Security Key Data and 'keys' lets those through.
+ *
+ * @param   id - NV item ID
+ * @param   keys - TRUE to allow the security key items
+ *
+ * @return  TRUE if it may
+ *****************************************************************************/
+static uint8 MT_SysNvSnapshotAllowed(uint16 id, uint8 keys)
+{
+  if( MT_CheckNvId( id ) == ZSuccess )
+  {
+    return TRUE;
+  }
+#if MT_SYS_NV_SNAPSHOT_KEYS && !MT_SYS_KEY_MANAGEMENT
+  return ( keys && MT_CheckNvKeyId( id ) );
+#else
+  (void)keys;
+  return FALSE;
+#endif
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotNext
+ *
+ * @brief   Get the next NV item of the snapshot being exported, skipping the
+ *          ones it may not hold.
+ *
+ * @param   id - NV item ID, 0 for the first one
+ *
+ * @return  The ID of the next item, 0 past the last one
+ *****************************************************************************/
+static uint16 MT_SysNvSnapshotNext(uint16 id)
+{
+  do
+  {
+    id = osal_nv_next_id( id );
+  } while( (id != 0) && !MT_SysNvSnapshotAllowed( id, mtSysNvExport.keys ) );
+
+  return id;
+}
+
+/******************************************************************************
+ * @fn      MT_SysNvSnapshotCrc
+ *
+ * @brief   Add bytes to the CRC-16/CCITT (polynomial 0x1021, initial value
+ *          0xFFFF) of a snapshot.
+ *
+ * @param   crc - CRC of the bytes before
+ * @param   pBuf - pointer to the bytes
+ * @param   len - number of bytes
+ *
+ * @return  The updated CRC
+ *****************************************************************************/
+static uint16 MT_SysNvSnapshotCrc(uint16 crc, uint8 *pBuf, uint16 len)
+{
+  uint8 bit;
+
+  while( len-- )
+  {
+    crc ^= (uint16)(*pBuf++) << 8;
+
+    for( bit = 0; bit < 8; bit++ )
+    {
+      crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+  }
+
+  return crc;
+}
+#endif /* OSAL_NV_SNAPSHOT */
+
+#if MT_SYS_NV_STREAM
+/******************************************************************************
+ * @fn      MT_SysNvStream
+ *
+ * @brief   Send the next indication of the NV snapshot, or else of the NV
+ *          item, being streamed to the host, and time the one after.
+ *
+ * @param   None
+ *
+ * @return  None
+ *****************************************************************************/
+void MT_SysNvStream(void)
+{
+  uint8 more = FALSE;
+
+#if OSAL_NV_SNAPSHOT
+  if( mtSysNvExport.active )
+  {
+    more = MT_SysNvSnapshotSend();
+  }
+#endif
+#if defined( OSAL_NV_EXTENDED )
+  if( !more && (mtSysNvStream.len != 0) )
+  {
+    more = MT_SysNvStreamItem();
+  }
+#endif
+
+  if( more )
+  {
+    if( ZSuccess != osal_start_timerEx( MT_TaskID, MT_SYS_NV_STREAM_EVT, MT_SYS_NV_STREAM_DLY ) )
+    {
+      osal_set_event( MT_TaskID, MT_SYS_NV_STREAM_EVT );
+    }
+  }
+}
+#endif /* MT_SYS_NV_STREAM */
+
 #if defined( FEATURE_NVEXID )
 /******************************************************************************
  * @fn      MT_ParseNvExtId
@@ -1881,6 +2644,185 @@ static void MT_SysZDiagsSaveStatsToNV(void)
                                 sizeof(retBuf), retBuf);
 }
 #endif /* FEATURE_SYSTEM_STATS */
+
+#if ( OSAL_MSG_POOLS )
+/******************************************************************************
+ * @fn      MT_SysMsgPoolStats
+ *
+ * @brief   Report the usage and high-water mark of each OSAL message pool.
+ *          Response: pool count, then per pool the block length (2 bytes),
+ *          block count, blocks in use, high-water mark and the number of
+ *          heap fallbacks (2 bytes).
+ *
+ * @param   None
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysMsgPoolStats(void)
+{
+  uint8 retBuf[1 + (OSAL_MSG_POOL_CNT * 7)];
+  uint8 *pBuf = retBuf;
+  osalMsgPoolStat_t stat;
+  uint8 pool;
+
+  *pBuf++ = OSAL_MSG_POOL_CNT;
+
+  for ( pool = 0; pool < OSAL_MSG_POOL_CNT; pool++ )
+  {
+    (void)osal_msg_pool_stat( pool, &stat );
+
+    *pBuf++ = LO_UINT16( stat.len );
+    *pBuf++ = HI_UINT16( stat.len );
+    *pBuf++ = stat.blkCnt;
+    *pBuf++ = stat.used;
+    *pBuf++ = stat.maxUsed;
+    *pBuf++ = LO_UINT16( stat.fallback );
+    *pBuf++ = HI_UINT16( stat.fallback );
+  }
+
+  /* Build and send back the response */
+  MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_MSG_POOL_STATS,
+                                sizeof(retBuf), retBuf);
+}
+#endif /* OSAL_MSG_POOLS */
+
+#if ( OSAL_PROFILE )
+/******************************************************************************
+ * @fn      MT_SysTaskProfile
+ *
+ * @brief   Report the profile of one OSAL task and optionally clear the
+ *          profiles of all tasks afterwards.
+ *          Request: task ID, reset flag (non-zero to clear).
+ *          Response: status, task ID, tick length in microseconds (2 bytes),
+ *          run count, cumulative run time and longest run time (4 bytes
+ *          each), then the longest latency of each event bit (2 bytes each).
+ *
+ * @param   pBuf - pointer to the data
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysTaskProfile(uint8 *pBuf)
+{
+  uint8 retBuf[4 + 12 + (OSAL_PROFILE_EVENT_BITS * 2)];
+  uint8 *pRsp = retBuf;
+  osalProfileStat_t stat;
+  uint8 taskId;
+  uint8 bit;
+
+  /* Skip over RPC header */
+  pBuf += MT_RPC_FRAME_HDR_SZ;
+
+  taskId = pBuf[0];
+
+  osal_memset( &stat, 0, sizeof( stat ) );
+  *pRsp++ = osal_profile_get( taskId, &stat );
+  *pRsp++ = taskId;
+  *pRsp++ = LO_UINT16( OSAL_PROFILE_TICK_US );
+  *pRsp++ = HI_UINT16( OSAL_PROFILE_TICK_US );
+
+  pRsp = osal_buffer_uint32( pRsp, stat.runCnt );
+  pRsp = osal_buffer_uint32( pRsp, stat.runTime );
+  pRsp = osal_buffer_uint32( pRsp, stat.maxRunTime );
+
+  for ( bit = 0; bit < OSAL_PROFILE_EVENT_BITS; bit++ )
+  {
+    *pRsp++ = LO_UINT16( stat.maxLatency[bit] );
+    *pRsp++ = HI_UINT16( stat.maxLatency[bit] );
+  }
+
+  if ( pBuf[1] )
+  {
+    osal_profile_reset();
+  }
+
+  /* Build and send back the response */
+  MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_TASK_PROFILE,
+                                sizeof(retBuf), retBuf);
+}
+#endif /* OSAL_PROFILE */
+
+#if ( OSALMEM_SITE_TAGS )
+/******************************************************************************
+ * @fn      MT_SysHeapMap
+ *
+ * @brief   Walk the OSAL heap and report its fragmentation and owners.
+ *          Response (2-byte fields unless noted): status (1 byte), the
+ *          rest only on success: free fragment count,
+ *          free bytes, largest free fragment, blocks held on size class
+ *          free lists, the free fragment histogram (OSALMEM_MAP_BUCKETS
+ *          counts), allocated block count and bytes, long-lived block
+ *          count and bytes, site count (1 byte), bytes of untracked
+ *          sites, then per top site its file hash, line, block count and
+ *          bytes.
+ *
+ * @param   None
+ *
+ * @return  None
+ *****************************************************************************/
+static void MT_SysHeapMap(void)
+{
+  uint8 retBuf[20 + (OSALMEM_MAP_BUCKETS * 2) + (OSALMEM_MAP_SITES * 8)];
+  uint8 *pBuf = retBuf;
+  osalMemMap_t *pMap;
+  uint8 idx;
+
+  if ( (pMap = osal_mem_alloc( sizeof( osalMemMap_t ) )) == NULL )
+  {
+    *pBuf = ZMemError;
+    MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_HEAP_MAP, 1, retBuf );
+    return;
+  }
+
+  osal_heap_map( pMap );
+
+  *pBuf++ = ZSuccess;
+
+  *pBuf++ = LO_UINT16( pMap->freeCnt );
+  *pBuf++ = HI_UINT16( pMap->freeCnt );
+  *pBuf++ = LO_UINT16( pMap->freeBytes );
+  *pBuf++ = HI_UINT16( pMap->freeBytes );
+  *pBuf++ = LO_UINT16( pMap->largestFree );
+  *pBuf++ = HI_UINT16( pMap->largestFree );
+  *pBuf++ = LO_UINT16( pMap->heldCnt );
+  *pBuf++ = HI_UINT16( pMap->heldCnt );
+
+  for ( idx = 0; idx < OSALMEM_MAP_BUCKETS; idx++ )
+  {
+    *pBuf++ = LO_UINT16( pMap->freeHist[idx] );
+    *pBuf++ = HI_UINT16( pMap->freeHist[idx] );
+  }
+
+  *pBuf++ = LO_UINT16( pMap->usedCnt );
+  *pBuf++ = HI_UINT16( pMap->usedCnt );
+  *pBuf++ = LO_UINT16( pMap->usedBytes );
+  *pBuf++ = HI_UINT16( pMap->usedBytes );
+  *pBuf++ = LO_UINT16( pMap->longCnt );
+  *pBuf++ = HI_UINT16( pMap->longCnt );
+  *pBuf++ = LO_UINT16( pMap->longBytes );
+  *pBuf++ = HI_UINT16( pMap->longBytes );
+  *pBuf++ = pMap->siteCnt;
+  *pBuf++ = LO_UINT16( pMap->otherBytes );
+  *pBuf++ = HI_UINT16( pMap->otherBytes );
+
+  for ( idx = 0; idx < OSALMEM_MAP_SITES; idx++ )
+  {
+    *pBuf++ = LO_UINT16( pMap->site[idx].file );
+    *pBuf++ = HI_UINT16( pMap->site[idx].file );
+    *pBuf++ = LO_UINT16( pMap->site[idx].line );
+    *pBuf++ = HI_UINT16( pMap->site[idx].line );
+    *pBuf++ = LO_UINT16( pMap->site[idx].blkCnt );
+    *pBuf++ = HI_UINT16( pMap->site[idx].blkCnt );
+    *pBuf++ = LO_UINT16( pMap->site[idx].bytes );
+    *pBuf++ = HI_UINT16( pMap->site[idx].bytes );
+  }
+
+  osal_mem_free( pMap );
+
+  /* Build and send back the response */
+  MT_BuildAndSendZToolResponse( MT_SRSP_SYS, MT_SYS_HEAP_MAP,
+                                (uint8)(pBuf - retBuf), retBuf);
+}
+#endif /* OSALMEM_SITE_TAGS */
 #endif /* MT_SYS_FUNC */
 
 /******************************************************************************
@@ -48,6 +48,28 @@ extern "C"
  * DEFINES
  ***************************************************************************************************/
 
+/* MT_SYS_OSAL_NV_READ_STREAM and NV snapshots: their state, MT_SysNvStream() and
+ * the MT_SYS_NV_STREAM_EVT handling of the MT (or ZNP) task */
+#if defined ( MT_SYS_FUNC ) && ( defined ( OSAL_NV_EXTENDED ) || OSAL_NV_SNAPSHOT ) && !defined ( CC253X_MACNP )
+#define MT_SYS_NV_STREAM  TRUE
+#else
+#define MT_SYS_NV_STREAM  FALSE
+#endif
+
+/* NV snapshots that carry the security keys. The key items (network keys, TC and APS link
+ * keys, the preconfigured key) are hidden from MT unless MT_SYS_KEY_MANAGEMENT is set, and
+ * by default a snapshot leaves them out too. With MT_SYS_NV_SNAPSHOT_KEYS, an
+ * MT_SYS_NV_SNAPSHOT_EXPORT whose flags byte has MT_SYS_NV_SNAPSHOT_SECURITY set exports
+ * them, and MT_SYS_NV_SNAPSHOT_IMPORT writes the ones a snapshot holds. Only a build for a
+ * trusted host, as for a device backup or a factory clone, should set it. The certificate
+ * items stay under MT_SYS_OSAL_NV_READ_CERTIFICATE_DATA. */
+#if !defined ( MT_SYS_NV_SNAPSHOT_KEYS )
+#define MT_SYS_NV_SNAPSHOT_KEYS  FALSE
+#endif
+
+/* MT_SYS_NV_SNAPSHOT_EXPORT flags */
+#define MT_SYS_NV_SNAPSHOT_SECURITY  0x01  // Export the security key items too
+
 typedef enum {
   STK_TX_PWR,
   STK_RX_ON_IDLE  // If 2nd parameter value is not TRUE or FALSE, then makes a ZMacGet request vice set.
@@ -74,6 +96,13 @@ extern void MT_SysResetInd( void );
  */
 extern void MT_SysOsalTimerExpired(uint8 Id);
 
+#if MT_SYS_NV_STREAM
+/*
+ * Send the next chunk of an NV item or NV snapshot being streamed
+ */
+extern void MT_SysNvStream(void);
+#endif
+
 #if defined ( MT_SYS_JAMMER_FEATURE )
 extern void MT_SysJammerInd( uint8 jammerInd );
 extern void jammerInit( uint8 taskId );
@@ -61,6 +61,9 @@
  ***************************************************************************************************/
 
 static void MT_ProcessIncomingCommand( mtOSALSerialData_t *msg );
+#if (defined MT_TASK) && (defined HAL_UART_TXQ) && (HAL_UART_TXQ == TRUE)
+static void MT_TransportFree(uint8 *msgPtr);
+#endif
 #ifdef MT_SRNG
 void MT_ProcessSrngEvent(void); 
 #endif
@@ -147,6 +150,14 @@ UINT16 MT_ProcessEvent(uint8 task_id, uint16 events)
   }
 #endif  /* NONWK */
 
+#if MT_SYS_NV_STREAM
+  if ( events & MT_SYS_NV_STREAM_EVT )
+  {
+    MT_SysNvStream();
+    return (events ^ MT_SYS_NV_STREAM_EVT);
+  }
+#endif
+
   /* Handle MT_SYS_OSAL_START_TIMER callbacks */
 #if defined MT_SYS_FUNC
   if ( events & (MT_SYS_OSAL_EVENT_MASK))
@@ -363,12 +374,38 @@ void MT_TransportSend(uint8 *pBuf)
 
   /* Send to UART */
 #ifdef MT_UART_DEFAULT_PORT
+#if (defined HAL_UART_TXQ) && (HAL_UART_TXQ == TRUE)
+  /* Sent in place and deallocated by the UART driver, unless its Tx queue is full */
+  if (HalUARTWriteQueue(MT_UART_DEFAULT_PORT, msgPtr, dataLen + SPI_0DATA_MSG_LEN,
+                        MT_TransportFree))
+  {
+    return;
+  }
+
+  /* Else copied into the Tx buffer, which the driver sends ahead of its queue */
+#endif
   HalUARTWrite(MT_UART_DEFAULT_PORT, msgPtr, dataLen + SPI_0DATA_MSG_LEN);
 #endif
 
   /* Deallocate */
   osal_msg_deallocate(msgPtr);
 }
+
+#if (defined HAL_UART_TXQ) && (HAL_UART_TXQ == TRUE)
+/***************************************************************************************************
+ * @fn      MT_TransportFree
+ *
+ * @brief   Deallocate a msg once the UART driver has sent it
+ *
+ * @param   uint8 *msgPtr - pointer to the SOP of the msg
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void MT_TransportFree(uint8 *msgPtr)
+{
+  osal_msg_deallocate(msgPtr);
+}
+#endif
 #endif /* MT_TASK */
 /***************************************************************************************************
  ***************************************************************************************************/
@@ -77,6 +77,17 @@ uint8  FSC_Token;
 mtOSALSerialData_t  *pMsg;
 uint8  tempDataLen;
 
+#if (defined HAL_UART_SPAN) && (HAL_UART_SPAN == TRUE)
+/* FCS of the frame being received, computed as the bytes arrive */
+static uint8 fcsCalc;
+
+#if MT_PIPE_SUPPORT
+/* Bytes of the frames parsed before the pipe filled up, left in the Rx buffer
+ * until it drains: releasing them would re-enable the Rx flow */
+static uint16 heldLen;
+#endif
+#endif
+
 #if defined (ZAPP_P1) || defined (ZAPP_P2)
 uint16  MT_UartMaxZAppBufLen;
 bool    MT_UartZAppRxStatus;
@@ -120,8 +131,11 @@ void MT_UartInit ()
   uartConfig.callBackFunc         = NULL;
 #endif
 
-  /* Start UART */
+  /* Start UART, with nothing held in its emptied Rx buffer */
 #if defined (MT_UART_DEFAULT_PORT)
+#if (defined HAL_UART_SPAN) && (HAL_UART_SPAN == TRUE) && MT_PIPE_SUPPORT
+  heldLen = 0;
+#endif
   HalUARTOpen (MT_UART_DEFAULT_PORT, &uartConfig);
 #else
   /* Silence IAR compiler warning */
@@ -186,12 +200,177 @@ byte MT_UartCalcFCS( uint8 *msg_ptr, uint8 len )
  *          Parses the data and determine either is SPI or just simply serial data
  *          then send the data to correct place (MT or APP)
  *
+ *          With HAL_UART_SPAN, the frame is parsed in place in the Rx buffer and
+ *          copied once, the FCS being computed as it goes.
+ *
+ *          While the host is out of credits for pipelined requests, no new frame is
+ *          taken from the Rx buffer: the UART flow control holds the host off and the
+ *          next Rx poll resumes parsing once a request has been processed.
+ *
  * @param   port     - UART port
  *          event    - Event that causes the callback
  *
  *
  * @return  None
  ***************************************************************************************************/
+#if (defined HAL_UART_SPAN) && (HAL_UART_SPAN == TRUE)
+void MT_UartProcessZToolData ( uint8 port, uint8 event )
+{
+  halUARTSpan_t span;
+  uint8 *pData;
+  uint16 idx;
+  uint8  ch;
+
+  (void)event;  // Intentionally unreferenced parameter
+
+#if MT_PIPE_SUPPORT
+  /* Leave the next frames in the Rx buffer until a pipelined request completes */
+  if ((state == SOP_STATE) && MT_PipeFull())
+  {
+    return;
+  }
+  if (heldLen != 0)
+  {
+    /* Never more than the Rx buffer still holds: the port may have been reopened meanwhile */
+    uint16 rxLen = Hal_UART_RxBufLen (port);
+
+    HalUARTConsume (port, (heldLen < rxLen) ? heldLen : rxLen);
+    heldLen = 0;
+  }
+#endif
+
+  /* Parse the bytes in place in the Rx buffer and release each span once done */
+  while (HalUARTPeek (port, &span))
+  {
+    pData = span.pData;
+    idx = 0;
+
+    while (idx < span.len)
+    {
+      if (state == DATA_STATE)
+      {
+        /* Copy as much of the data as the span holds, folding it into the FCS */
+        uint8 *pBuf = &pMsg->msg[MT_RPC_FRAME_HDR_SZ + tempDataLen];
+        uint16 cnt = span.len - idx;
+
+        if (cnt > (uint16)(LEN_Token - tempDataLen))
+        {
+          cnt = LEN_Token - tempDataLen;
+        }
+        tempDataLen += cnt;
+        idx += cnt;
+
+        while (cnt--)
+        {
+          ch = *pData;
+          pData += span.stride;
+          *pBuf++ = ch;
+          fcsCalc ^= ch;
+        }
+
+        if (tempDataLen == LEN_Token)
+        {
+          state = FCS_STATE;
+        }
+        continue;
+      }
+
+      ch = *pData;
+      pData += span.stride;
+      idx++;
+
+      switch (state)
+      {
+        case SOP_STATE:
+          if (ch == MT_UART_SOF)
+            state = LEN_STATE;
+          break;
+
+        case LEN_STATE:
+          LEN_Token = ch;
+          fcsCalc = ch;
+
+          tempDataLen = 0;
+
+          /* Allocate memory for the data */
+          pMsg = (mtOSALSerialData_t *)osal_msg_allocate( sizeof ( mtOSALSerialData_t ) +
+                                                          MT_RPC_FRAME_HDR_SZ + LEN_Token );
+
+          if (pMsg)
+          {
+            /* Fill up what we can */
+            pMsg->hdr.event = CMD_SERIAL_MSG;
+            pMsg->msg = (uint8*)(pMsg+1);
+            pMsg->msg[MT_RPC_POS_LEN] = LEN_Token;
+            state = CMD_STATE1;
+          }
+          else
+          {
+            state = SOP_STATE;
+            HalUARTConsume (port, idx);
+            return;
+          }
+          break;
+
+        case CMD_STATE1:
+          pMsg->msg[MT_RPC_POS_CMD0] = ch;
+          fcsCalc ^= ch;
+          state = CMD_STATE2;
+          break;
+
+        case CMD_STATE2:
+          pMsg->msg[MT_RPC_POS_CMD1] = ch;
+          fcsCalc ^= ch;
+          /* If there is no data, skip to FCS state */
+          if (LEN_Token)
+          {
+            state = DATA_STATE;
+          }
+          else
+          {
+            state = FCS_STATE;
+          }
+          break;
+
+        case FCS_STATE:
+
+          FSC_Token = ch;
+
+          /* Make sure it's correct */
+          if (fcsCalc == FSC_Token)
+          {
+#if MT_PIPE_SUPPORT
+            MT_PipeQueued (pMsg->msg);
+#endif
+            osal_msg_send( App_TaskID, (byte *)pMsg );
+          }
+          else
+          {
+            /* deallocate the msg */
+            osal_msg_deallocate ( (uint8 *)pMsg );
+          }
+
+          /* Reset the state, send or discard the buffers at this point */
+          state = SOP_STATE;
+
+#if MT_PIPE_SUPPORT
+          if (MT_PipeFull())
+          {
+            heldLen = idx;
+            return;
+          }
+#endif
+          break;
+
+        default:
+         break;
+      }
+    }
+
+    HalUARTConsume (port, span.len);
+  }
+}
+#else
 void MT_UartProcessZToolData ( uint8 port, uint8 event )
 {
   uint8  ch;
@@ -201,6 +380,13 @@ void MT_UartProcessZToolData ( uint8 port, uint8 event )
 
   while (Hal_UART_RxBufLen(port))
   {
+#if MT_PIPE_SUPPORT
+    if ((state == SOP_STATE) && MT_PipeFull())
+    {
+      return;
+    }
+#endif
+
     HalUARTRead (port, &ch, 1);
 
     switch (state)
@@ -285,6 +471,9 @@ void MT_UartProcessZToolData ( uint8 port, uint8 event )
         /* Make sure it's correct */
         if ((MT_UartCalcFCS ((uint8*)&pMsg->msg[0], MT_RPC_FRAME_HDR_SZ + LEN_Token) == FSC_Token))
         {
+#if MT_PIPE_SUPPORT
+          MT_PipeQueued (pMsg->msg);
+#endif
           osal_msg_send( App_TaskID, (byte *)pMsg );
         }
         else
@@ -303,6 +492,7 @@ void MT_UartProcessZToolData ( uint8 port, uint8 event )
     }
   }
 }
+#endif
 
 #if defined (ZAPP_P1) || defined (ZAPP_P2)
 /***************************************************************************************************
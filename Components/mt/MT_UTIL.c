@@ -87,6 +87,30 @@
 #define MT_APSME_LINKKEY_GET_RSP_LEN (MT_UTIL_STATUS_LEN + SEC_KEY_LEN + (MT_UTIL_FRM_CTR_LEN * 2))
 // Status + NV id
 #define MT_APSME_LINKKEY_NV_ID_GET_RSP_LEN (MT_UTIL_STATUS_LEN + 2)
+// index + action + cmd0 + cmd1 + endpoint + profile + cluster range + srcAddr + srcMask
+#define MT_UTIL_CB_FILTER_SET_LEN  15
+// Status + default action + pass count + drop count + rule count + rule match counts
+#define MT_UTIL_CB_FILTER_STATS_RSP_LEN (MT_UTIL_STATUS_LEN + 1 + 4 + 4 + 1 + (MT_UTIL_CB_FILTER_MAX * 2))
+
+/***************************************************************************************************
+ * TYPEDEFS
+ ***************************************************************************************************/
+#if defined MT_UTIL_CB_FILTER
+/* A callback filter rule; each field that is not a wildcard must match the callback */
+typedef struct
+{
+  uint8  action;      // MT_UTIL_CB_FILTER_NONE/PASS/DROP
+  uint8  cmd0;        // 0x00 matches any
+  uint8  cmd1;        // 0xFF matches any
+  uint8  endpoint;    // 0xFF matches any
+  uint16 profileId;   // 0xFFFF matches any
+  uint16 clusterMin;  // Inclusive cluster range, 0x0000-0xFFFF matches any
+  uint16 clusterMax;
+  uint16 srcAddr;     // Matches when (source & srcMask) == srcAddr, a zero mask matches any
+  uint16 srcMask;
+  uint16 matchCnt;
+} mtUtilCbRule_t;
+#endif
 
 /***************************************************************************************************
  * LOCAL VARIABLES
@@ -100,6 +124,13 @@ uint8 zcl_key_establish_task_id;
 __no_init const __xdata char ieeeMac[1] @ 0x780C;
 #endif
 
+#if defined MT_UTIL_CB_FILTER
+static mtUtilCbRule_t mtUtilCbRules[MT_UTIL_CB_FILTER_MAX];
+static uint8 mtUtilCbDefault = MT_UTIL_CB_FILTER_PASS;
+static uint32 mtUtilCbPassCnt;
+static uint32 mtUtilCbDropCnt;
+#endif
+
 /***************************************************************************************************
  * LOCAL FUNCTIONS
  ***************************************************************************************************/
@@ -116,6 +147,12 @@ static void MT_UtilSetChannels(uint8 *pBuf);
 static void MT_UtilSetSecLevel(uint8 *pBuf);
 static void MT_UtilSetPreCfgKey(uint8 *pBuf);
 static void MT_UtilCallbackSub(uint8 *pData);
+#if defined MT_UTIL_CB_FILTER
+static uint8 MT_UtilCbFilterSet(uint8 *pBuf);
+static uint8 MT_UtilCbFilterReset(uint8 *pBuf);
+static uint8 MT_UtilCbFilterStats(uint8 *pBuf);
+static uint8 MT_UtilCbRuleMatch(mtUtilCbRule_t *pRule, mtUtilCbKey_t *pKey);
+#endif
 static void MT_UtilTimeAlive(void);
 static void MT_UtilSrcMatchEnable (uint8 *pBuf);
 static void MT_UtilSrcMatchAddEntry (uint8 *pBuf);
@@ -341,6 +378,20 @@ uint8 MT_UtilCommandProcessing(uint8 *pBuf)
     break;
 #endif
 
+#if defined MT_UTIL_CB_FILTER
+  case MT_UTIL_CB_FILTER_SET:
+    status = MT_UtilCbFilterSet(pBuf);
+    break;
+
+  case MT_UTIL_CB_FILTER_RESET:
+    status = MT_UtilCbFilterReset(pBuf);
+    break;
+
+  case MT_UTIL_CB_FILTER_STATS:
+    status = MT_UtilCbFilterStats(pBuf);
+    break;
+#endif
+
   default:
     status = MT_RPC_ERR_COMMAND_ID;
     break;
@@ -810,6 +861,232 @@ void MT_UtilCallbackSub(uint8 *pBuf)
   MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_UTIL), cmdId, 1, &retValue );
 }
 
+#if defined MT_UTIL_CB_FILTER
+/***************************************************************************************************
+ * @fn      MT_UtilCbFilterSet
+ *
+ * @brief   Write one rule of the callback filter table and clear its match count. Rules are
+ *          evaluated in index order and the first match decides. A rule for a cmd0 that the
+ *          filter does not see (see MT_UTIL_CB_FILTER_CMD0) is refused.
+ *
+ * @param   pBuf - | index | action | cmd0 | cmd1 | endpoint | profile(2) | clusterMin(2) |
+ *                   clusterMax(2) | srcAddr(2) | srcMask(2) |
+ *
+ * @return  MT_RPC_ERR_LENGTH for a short frame, else MT_RPC_SUCCESS with the SRSP sent
+ ***************************************************************************************************/
+static uint8 MT_UtilCbFilterSet(uint8 *pBuf)
+{
+  uint8 cmdId = pBuf[MT_RPC_POS_CMD1];
+  uint8 retValue = ZInvalidParameter;
+  mtUtilCbRule_t rule;
+  uint8 idx;
+
+  if (pBuf[MT_RPC_POS_LEN] < MT_UTIL_CB_FILTER_SET_LEN)
+  {
+    return MT_RPC_ERR_LENGTH;
+  }
+  pBuf += MT_RPC_FRAME_HDR_SZ;
+
+  idx = *pBuf++;
+  rule.action = *pBuf++;
+  rule.cmd0 = *pBuf++;
+  rule.cmd1 = *pBuf++;
+  rule.endpoint = *pBuf++;
+  rule.profileId = osal_build_uint16(pBuf);
+  rule.clusterMin = osal_build_uint16(pBuf+2);
+  rule.clusterMax = osal_build_uint16(pBuf+4);
+  rule.srcMask = osal_build_uint16(pBuf+8);
+  rule.srcAddr = osal_build_uint16(pBuf+6) & rule.srcMask;
+  rule.matchCnt = 0;
+
+  if ((idx < MT_UTIL_CB_FILTER_MAX) &&
+      (rule.action <= MT_UTIL_CB_FILTER_DROP) &&
+      (rule.clusterMin <= rule.clusterMax) &&
+      ((rule.cmd0 == 0x00) || MT_UTIL_CB_FILTER_CMD0(rule.cmd0)))
+  {
+    mtUtilCbRules[idx] = rule;
+    retValue = ZSuccess;
+  }
+
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_UTIL), cmdId, 1, &retValue);
+
+  return MT_RPC_SUCCESS;
+}
+
+/***************************************************************************************************
+ * @fn      MT_UtilCbFilterReset
+ *
+ * @brief   Remove all rules of the callback filter, set the action for callbacks that match no
+ *          rule and clear the counters.
+ *
+ * @param   pBuf - | defaultAction |
+ *
+ * @return  MT_RPC_ERR_LENGTH for a short frame, else MT_RPC_SUCCESS with the SRSP sent
+ ***************************************************************************************************/
+static uint8 MT_UtilCbFilterReset(uint8 *pBuf)
+{
+  uint8 cmdId = pBuf[MT_RPC_POS_CMD1];
+  uint8 action = pBuf[MT_RPC_POS_DAT0];
+  uint8 retValue = ZInvalidParameter;
+
+  if (pBuf[MT_RPC_POS_LEN] < 1)
+  {
+    return MT_RPC_ERR_LENGTH;
+  }
+
+  if ((action == MT_UTIL_CB_FILTER_PASS) || (action == MT_UTIL_CB_FILTER_DROP))
+  {
+    (void)osal_memset(mtUtilCbRules, 0, sizeof(mtUtilCbRules));
+    mtUtilCbDefault = action;
+    mtUtilCbPassCnt = 0;
+    mtUtilCbDropCnt = 0;
+    retValue = ZSuccess;
+  }
+
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_UTIL), cmdId, 1, &retValue);
+
+  return MT_RPC_SUCCESS;
+}
+
+/***************************************************************************************************
+ * @fn      MT_UtilCbFilterStats
+ *
+ * @brief   Report the callback filter counters.
+ *
+ * @param   pBuf - | clear | - non-zero to clear the counters once reported
+ *
+ * @return  MT_RPC_ERR_LENGTH for a short frame, else MT_RPC_SUCCESS with the SRSP sent:
+ *          | status | defaultAction | passCnt(4) | dropCnt(4) | ruleCnt | matchCnt(2) * ruleCnt |
+ ***************************************************************************************************/
+static uint8 MT_UtilCbFilterStats(uint8 *pBuf)
+{
+  uint8 cmdId = pBuf[MT_RPC_POS_CMD1];
+  uint8 clear = pBuf[MT_RPC_POS_DAT0];
+  uint8 retArray[MT_UTIL_CB_FILTER_STATS_RSP_LEN];
+  uint8 *pTmp = retArray;
+  uint8 idx;
+
+  if (pBuf[MT_RPC_POS_LEN] < 1)
+  {
+    return MT_RPC_ERR_LENGTH;
+  }
+
+  *pTmp++ = ZSuccess;
+  *pTmp++ = mtUtilCbDefault;
+  pTmp = osal_buffer_uint32(pTmp, mtUtilCbPassCnt);
+  pTmp = osal_buffer_uint32(pTmp, mtUtilCbDropCnt);
+  *pTmp++ = MT_UTIL_CB_FILTER_MAX;
+
+  for (idx = 0; idx < MT_UTIL_CB_FILTER_MAX; idx++)
+  {
+    *pTmp++ = LO_UINT16(mtUtilCbRules[idx].matchCnt);
+    *pTmp++ = HI_UINT16(mtUtilCbRules[idx].matchCnt);
+
+    if (clear)
+    {
+      mtUtilCbRules[idx].matchCnt = 0;
+    }
+  }
+
+  if (clear)
+  {
+    mtUtilCbPassCnt = 0;
+    mtUtilCbDropCnt = 0;
+  }
+
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_UTIL), cmdId,
+                               MT_UTIL_CB_FILTER_STATS_RSP_LEN, retArray);
+
+  return MT_RPC_SUCCESS;
+}
+
+/***************************************************************************************************
+ * @fn      MT_UtilCbRuleMatch
+ *
+ * @brief   Check a callback against one filter rule. A rule that constrains a field which is not
+ *          known for the callback does not match it.
+ *
+ * @param   pRule - the rule
+ * @param   pKey - the callback
+ *
+ * @return  TRUE if the rule matches
+ ***************************************************************************************************/
+static uint8 MT_UtilCbRuleMatch(mtUtilCbRule_t *pRule, mtUtilCbKey_t *pKey)
+{
+  if ((pRule->cmd0 != 0x00) && (pRule->cmd0 != pKey->cmd0))
+  {
+    return FALSE;
+  }
+
+  if ((pRule->cmd1 != 0xFF) && (pRule->cmd1 != pKey->cmd1))
+  {
+    return FALSE;
+  }
+
+  if ((pRule->endpoint != 0xFF) &&
+      (!(pKey->known & MT_UTIL_CB_KEY_EP) || (pRule->endpoint != pKey->endpoint)))
+  {
+    return FALSE;
+  }
+
+  if ((pRule->profileId != 0xFFFF) &&
+      (!(pKey->known & MT_UTIL_CB_KEY_PROFILE) || (pRule->profileId != pKey->profileId)))
+  {
+    return FALSE;
+  }
+
+  if (((pRule->clusterMin != 0x0000) || (pRule->clusterMax != 0xFFFF)) &&
+      (!(pKey->known & MT_UTIL_CB_KEY_CLUSTER) ||
+       (pKey->clusterId < pRule->clusterMin) || (pKey->clusterId > pRule->clusterMax)))
+  {
+    return FALSE;
+  }
+
+  if ((pRule->srcMask != 0x0000) &&
+      (!(pKey->known & MT_UTIL_CB_KEY_SRC) || ((pKey->srcAddr & pRule->srcMask) != pRule->srcAddr)))
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/***************************************************************************************************
+ * @fn      MT_UtilCbFilter
+ *
+ * @brief   Run a callback through the filter table before its frame is built.
+ *
+ * @param   pKey - the command and the fields of the callback
+ *
+ * @return  TRUE if the callback is to be sent, FALSE if it is dropped
+ ***************************************************************************************************/
+uint8 MT_UtilCbFilter(mtUtilCbKey_t *pKey)
+{
+  uint8 action = mtUtilCbDefault;
+  uint8 idx;
+
+  for (idx = 0; idx < MT_UTIL_CB_FILTER_MAX; idx++)
+  {
+    if ((mtUtilCbRules[idx].action != MT_UTIL_CB_FILTER_NONE) &&
+        MT_UtilCbRuleMatch(&mtUtilCbRules[idx], pKey))
+    {
+      mtUtilCbRules[idx].matchCnt++;
+      action = mtUtilCbRules[idx].action;
+      break;
+    }
+  }
+
+  if (action == MT_UTIL_CB_FILTER_DROP)
+  {
+    mtUtilCbDropCnt++;
+    return FALSE;
+  }
+
+  mtUtilCbPassCnt++;
+  return TRUE;
+}
+#endif /* MT_UTIL_CB_FILTER */
+
 #if (defined HAL_KEY) && (HAL_KEY == TRUE)
 /***************************************************************************************************
  * @fn      MT_UtilKeyEvent
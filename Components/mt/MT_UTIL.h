@@ -50,6 +50,57 @@ extern "C"
 {
 #endif
 
+/***************************************************************************************************
+ * CONSTANTS
+ ***************************************************************************************************/
+
+#if defined MT_UTIL_CB_FILTER && !defined MT_UTIL_FUNC
+#error "MT_UTIL_CB_FILTER is configured with MT_UTIL commands and requires MT_UTIL_FUNC"
+#endif
+
+/* Number of rules in the callback filter table */
+#if !defined MT_UTIL_CB_FILTER_MAX
+#define MT_UTIL_CB_FILTER_MAX  8
+#endif
+
+/* The callbacks that go through the filter, the only ones its rules can match:
+ *   MT_AF   - AF_DATA_CONFIRM, AF_INCOMING_MSG and AF_INCOMING_MSG_EXT
+ *   MT_ZDO  - the ZDO_*_RSP that MT_ZdoDirectCB() builds from the air, other than those of
+ *             MT_ZdoHandleExceptions(), and ZDO_MSG_CB_INCOMING
+ * Every other AREQ, from these subsystems or any other, is sent unfiltered, and a rule for the
+ * cmd0 of another subsystem is refused.
+ */
+#define MT_UTIL_CB_FILTER_CMD0(cmd0) \
+  (((cmd0) == ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_AF)) || \
+   ((cmd0) == ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_ZDO)))
+
+/* Callback filter rule actions */
+#define MT_UTIL_CB_FILTER_NONE  0   // Rule is unused (table entries only)
+#define MT_UTIL_CB_FILTER_PASS  1   // Build and send the callback
+#define MT_UTIL_CB_FILTER_DROP  2   // Drop the callback before its frame is built
+
+/* Fields of mtUtilCbKey_t that are known for a callback */
+#define MT_UTIL_CB_KEY_EP       0x01
+#define MT_UTIL_CB_KEY_PROFILE  0x02
+#define MT_UTIL_CB_KEY_CLUSTER  0x04
+#define MT_UTIL_CB_KEY_SRC      0x08
+
+/***************************************************************************************************
+ * TYPEDEFS
+ ***************************************************************************************************/
+
+/* Describes a callback to the filter, before any of its frame is built */
+typedef struct
+{
+  uint8  cmd0;       // MT_RPC_CMD_AREQ | subsystem
+  uint8  cmd1;       // Callback command ID
+  uint8  known;      // MT_UTIL_CB_KEY_ bits of the fields below that are valid
+  uint8  endpoint;
+  uint16 profileId;
+  uint16 clusterId;
+  uint16 srcAddr;    // Network address of the sender
+} mtUtilCbKey_t;
+
 /***************************************************************************************************
  * EXTERNAL FUNCTIONS
  ***************************************************************************************************/
@@ -72,6 +123,19 @@ extern uint8 MT_UtilCommandProcessing(uint8 *pBuf);
  ***************************************************************************************************/
 void MT_UtilKeyEstablishInd(zclKE_StatusInd_t *pInd);
 #endif
+
+#if defined MT_UTIL_CB_FILTER
+/***************************************************************************************************
+ * @fn      MT_UtilCbFilter
+ *
+ * @brief   Run a callback through the filter table before its frame is built.
+ *
+ * @param   pKey - the command and the fields of the callback
+ *
+ * @return  TRUE if the callback is to be sent, FALSE if it is dropped
+ ***************************************************************************************************/
+extern uint8 MT_UtilCbFilter(mtUtilCbKey_t *pKey);
+#endif
 #endif /* MT_UTIL_FUNC */
 
 #ifdef __cplusplus
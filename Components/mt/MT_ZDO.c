@@ -64,6 +64,10 @@
 
 #include "nwk_util.h"
 
+#if defined MT_UTIL_CB_FILTER
+#include "MT_UTIL.h"
+#endif
+
 /**************************************************************************************************
  * CONSTANTS
  **************************************************************************************************/
@@ -191,6 +195,10 @@ static void MT_ZdoExtSetParams( uint8 *pBuf );
 extern ZStatus_t ZDSecMgrEntryLookupExt( uint8* extAddr, ZDSecMgrEntry_t** entry );
 #endif // MT_ZDO_EXTENSIONS
 
+#if defined MT_UTIL_CB_FILTER
+static uint8 MT_ZdoCbFilter( uint8 cmd, uint16 clusterId, uint8 srcAddrMode, uint16 srcAddr );
+#endif
+
 #if defined (MT_ZDO_FUNC)
 /***************************************************************************************************
  * @fn      MT_ZdoInit
@@ -2176,6 +2184,14 @@ void MT_ZdoDirectCB( afIncomingMSGPacket_t *pData, zdoIncomingMsg_t *inMsg )
     return;  // Handled somewhere else or not needed.
   }
 
+#if defined MT_UTIL_CB_FILTER
+  if ( !MT_ZdoCbFilter( MT_ZDO_CID_TO_AREQ_ID(pData->clusterId), pData->clusterId,
+                        pData->srcAddr.addrMode, pData->srcAddr.addr.shortAddr ) )
+  {
+    return;
+  }
+#endif
+
   /* ZDO data starts after one-byte sequence number and the msg buffer length includes
    * two bytes for srcAddr.
    */
@@ -2479,6 +2495,40 @@ void *MT_ZdoPermitJoinInd( void *duration )
 }
 #endif // MT_ZDO_CB_FUNC
 
+#if defined MT_UTIL_CB_FILTER
+/***************************************************************************************************
+ * @fn      MT_ZdoCbFilter
+ *
+ * @brief   Describe a ZDO callback to the MT_UTIL callback filter.
+ *
+ * @param   cmd - MT_ZDO callback command ID
+ * @param   clusterId - ZDO cluster of the message
+ * @param   srcAddrMode - address mode of the sender
+ * @param   srcAddr - network address of the sender, not used with a 64-bit address
+ *
+ * @return  TRUE if the callback is to be sent
+ ***************************************************************************************************/
+static uint8 MT_ZdoCbFilter( uint8 cmd, uint16 clusterId, uint8 srcAddrMode, uint16 srcAddr )
+{
+  mtUtilCbKey_t key;
+
+  key.cmd0 = (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_ZDO;
+  key.cmd1 = cmd;
+  key.known = MT_UTIL_CB_KEY_EP | MT_UTIL_CB_KEY_PROFILE | MT_UTIL_CB_KEY_CLUSTER;
+  key.endpoint = ZDO_EP;
+  key.profileId = ZDO_PROFILE_ID;
+  key.clusterId = clusterId;
+
+  if ( srcAddrMode != Addr64Bit )
+  {
+    key.known |= MT_UTIL_CB_KEY_SRC;
+    key.srcAddr = srcAddr;
+  }
+
+  return MT_UtilCbFilter( &key );
+}
+#endif
+
 /***************************************************************************************************
  * @fn      MT_ZdoSendMsgCB
  *
@@ -2491,9 +2541,17 @@ void *MT_ZdoPermitJoinInd( void *duration )
 void MT_ZdoSendMsgCB(zdoIncomingMsg_t *pMsg)
 {
   uint8 len = pMsg->asduLen + 9;
-  uint8 *pBuf = (uint8 *)osal_mem_alloc(len);
+  uint8 *pBuf;
+
+#if defined MT_UTIL_CB_FILTER
+  if (!MT_ZdoCbFilter(MT_ZDO_MSG_CB_INCOMING, pMsg->clusterID,
+                      pMsg->srcAddr.addrMode, pMsg->srcAddr.addr.shortAddr))
+  {
+    return;
+  }
+#endif
 
-  if (pBuf != NULL)
+  if ((pBuf = (uint8 *)osal_mem_alloc(len)) != NULL)
   {
     uint8 *pTmp = pBuf;
 
@@ -295,6 +295,9 @@ static void znpBasicCfg(uint8 *pBuf)
   {
     pBuf[0] = ZCD_STARTOPT_DEFAULT_NETWORK_STATE;
     (void)osal_nv_write(ZCD_NV_STARTUP_OPTION, 0, 1, pBuf);
+#if OSAL_NV_CACHE
+    (void)osal_nv_flush();  // Also the channel list, PAN ID and logical type written above.
+#endif
 #if defined CC2531ZNP
     SystemResetSoft();
 #else
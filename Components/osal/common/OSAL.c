@@ -56,6 +56,7 @@
 #include "OnBoard.h"
 
 /* HAL */
+#include "hal_assert.h"
 #include "hal_drivers.h"
 
 #ifdef IAR_ARMCM3_LM
@@ -71,9 +72,41 @@
  * MACROS
  */
 
+// Ready-task bitmap maintenance - bit n is set while task n may have events pending.
+#define OSAL_READY_SET( idx )     (tasksReady[(idx) >> 3] |= BV( (idx) & 0x07 ))
+#define OSAL_READY_CLR( idx )     (tasksReady[(idx) >> 3] &= ~BV( (idx) & 0x07 ))
+
+#if ( OSAL_MSG_POOLS )
+// Size of one pool block (message header plus payload) in halDataAlign_t units
+#define OSAL_MSG_POOL_STRIDE( len ) \
+  (((len) + sizeof( osal_msg_hdr_t ) + sizeof( halDataAlign_t ) - 1) / sizeof( halDataAlign_t ))
+
+// Pools are searched in order for the first one that fits a request
+#if ( OSAL_MSG_POOL_SMALL_LEN > OSAL_MSG_POOL_MEDIUM_LEN ) || \
+    ( OSAL_MSG_POOL_MEDIUM_LEN > OSAL_MSG_POOL_LARGE_LEN )
+  #error "OSAL message pool lengths must be in ascending order."
+#endif
+#endif
+
 /*********************************************************************
  * CONSTANTS
  */
+
+// Maximum number of ready tasks serviced by one osal_run_system() pass before it returns to
+// poll the HAL and check for power saving. The default of 1 services only the highest priority
+// ready task per pass; larger values drain a backlog of ready tasks with fewer loop overheads.
+#if !defined OSAL_TASKS_PER_PASS
+#define OSAL_TASKS_PER_PASS       1
+#endif
+
+#if ( OSAL_PROFILE )
+// Free-running timestamp used for task profiling, in OSAL_PROFILE_TICK_US units. The default is
+// the 320us MAC timer count; a board with a finer free-running counter can override both.
+#if !defined OSAL_PROFILE_TIMESTAMP
+#define OSAL_PROFILE_TIMESTAMP()  macMcuPrecisionCount()
+#endif
+#endif
+
 #ifdef USE_ICALL
 // A bit mask to use to indicate a proxy OSAL task ID.
 #define OSAL_PROXY_ID_FLAG       0x80
@@ -83,13 +116,56 @@
  * TYPEDEFS
  */
 
+// Per-task message queue - head for receive/push, tail for O(1) append
+typedef struct
+{
+  osal_msg_q_t head;
+  osal_msg_q_t tail;
+} osal_task_q_t;
+
+#if ( OSAL_PROFILE )
+// Per-task profile - statistics plus the time each pending event bit was first set
+typedef struct
+{
+  osalProfileStat_t stat;
+  uint16 setTime[OSAL_PROFILE_EVENT_BITS];
+} osal_profile_t;
+#endif
+
+#if ( OSAL_MSG_SHARED )
+// Reference count kept in front of the header of a shared message, sized to keep the header aligned
+typedef union
+{
+  uint8 refCnt;
+  void *align;
+} osal_msg_ref_t;
+
+// A queue entry with a zero length is a link to a shared message rather than a message itself
+#define OSAL_MSG_IS_LINK( msg_ptr )   (OSAL_MSG_LEN( msg_ptr ) == 0)
+#define OSAL_MSG_LINK_TARGET( msg_ptr ) (*(uint8 **)(msg_ptr))
+#define OSAL_MSG_REF( msg_ptr ) \
+  ((osal_msg_ref_t *)((uint8 *)(msg_ptr) - sizeof( osal_msg_hdr_t )) - 1)
+#endif
+
+#if ( OSAL_MSG_POOLS )
+// Fixed-size message pool - free blocks are linked through their message header
+typedef struct
+{
+  halDataAlign_t *base;
+  osal_msg_hdr_t *freeList;
+  uint16 len;
+  uint16 stride;
+  uint8  blkCnt;
+  uint8  used;
+  uint8  maxUsed;
+  uint16 fallback;
+} osal_msg_pool_t;
+#endif
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
 
-// Message Pool Definitions
-osal_msg_q_t osal_qHead;
-
 #ifdef USE_ICALL
 // OSAL event loop hook function pointer 
 void (*osal_eventloop_hook)(void) = NULL;
@@ -102,6 +178,9 @@ void (*osal_eventloop_hook)(void) = NULL;
 /*********************************************************************
  * EXTERNAL FUNCTIONS
  */
+#if ( OSAL_PROFILE )
+extern uint32 macMcuPrecisionCount(void);
+#endif
 
 /*********************************************************************
  * LOCAL VARIABLES
@@ -110,6 +189,33 @@ void (*osal_eventloop_hook)(void) = NULL;
 // Index of active task
 static uint8 activeTaskID = TASK_NO_TASK;
 
+// Message queues, one per task (tasksCnt entries)
+static osal_task_q_t *osal_taskQ;
+
+// Ready-task bitmap, one bit per task ((tasksCnt + 7) / 8 bytes)
+static uint8 *tasksReady;
+
+// Index of the lowest set bit in a nibble
+static const uint8 osalFirstBit[16] = { 0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+
+#if ( OSAL_PROFILE )
+// Task profiles, one per task (tasksCnt entries)
+static osal_profile_t *osalProfile;
+#endif
+
+#if ( OSAL_MSG_POOLS )
+// Reserved message pool RAM
+static halDataAlign_t osalMsgPoolSmall[OSAL_MSG_POOL_STRIDE( OSAL_MSG_POOL_SMALL_LEN ) *
+                                       OSAL_MSG_POOL_SMALL_CNT];
+static halDataAlign_t osalMsgPoolMedium[OSAL_MSG_POOL_STRIDE( OSAL_MSG_POOL_MEDIUM_LEN ) *
+                                        OSAL_MSG_POOL_MEDIUM_CNT];
+static halDataAlign_t osalMsgPoolLarge[OSAL_MSG_POOL_STRIDE( OSAL_MSG_POOL_LARGE_LEN ) *
+                                       OSAL_MSG_POOL_LARGE_CNT];
+
+// Message pool descriptors, indexed by OSAL_MSG_POOL_xxx
+static osal_msg_pool_t osalMsgPool[OSAL_MSG_POOL_CNT];
+#endif
+
 #ifdef USE_ICALL
 // Maximum number of proxy tasks
 #ifndef OSAL_MAX_NUM_PROXY_TASKS
@@ -156,6 +262,17 @@ static uint8 osal_notask_entity;
 
 static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint8 urgent );
 
+#if ( OSAL_PROFILE )
+static void osal_profile_mark( uint8 task_id, uint16 event_flag );
+static uint32 osal_profile_dispatch( uint8 task_id, uint16 events );
+static void osal_profile_update( uint8 task_id, uint32 start );
+#endif
+
+#if ( OSAL_MSG_POOLS )
+static void osal_msg_pool_init( uint8 pool, halDataAlign_t *base, uint16 len, uint8 blkCnt );
+static uint8 osal_msg_pool_free( osal_msg_hdr_t *hdr );
+#endif
+
 #ifdef USE_ICALL
 static uint8 osal_alien2proxy(ICall_EntityID entity);
 static ICall_EntityID osal_proxy2alien(uint8 proxyid);
@@ -561,10 +678,24 @@ void osal_enroll_notasksender(ICall_EntityID dispatchid)
 uint8 * osal_msg_allocate( uint16 len )
 {
   osal_msg_hdr_t *hdr;
+#if ( OSAL_MSG_POOLS )
+  uint8 pool;
+#endif
 
   if ( len == 0 )
     return ( NULL );
 
+#if ( OSAL_MSG_POOLS )
+  // The smallest pool that fits serves the request in constant time
+  for ( pool = 0; pool < OSAL_MSG_POOL_CNT; pool++ )
+  {
+    if ( len <= osalMsgPool[pool].len )
+    {
+      return ( osal_msg_pool_allocate( pool, len ) );
+    }
+  }
+#endif
+
   hdr = (osal_msg_hdr_t *) osal_mem_alloc( (short)(len + sizeof( osal_msg_hdr_t )) );
   if ( hdr )
   {
@@ -598,17 +729,255 @@ uint8 osal_msg_deallocate( uint8 *msg_ptr )
   if ( msg_ptr == NULL )
     return ( INVALID_MSG_POINTER );
 
+#if ( OSAL_MSG_SHARED )
+  // A shared message is only freed when its last reference is dropped
+  if ( OSAL_MSG_ID( msg_ptr ) == OSAL_MSG_SHARED_ID )
+  {
+    halIntState_t intState;
+    uint8 refCnt;
+
+    HAL_ENTER_CRITICAL_SECTION( intState );
+    refCnt = --OSAL_MSG_REF( msg_ptr )->refCnt;
+    HAL_EXIT_CRITICAL_SECTION( intState );
+
+    if ( refCnt == 0 )
+    {
+      osal_mem_free( (void *)OSAL_MSG_REF( msg_ptr ) );
+    }
+    return ( SUCCESS );
+  }
+#endif
+
   // don't deallocate queued buffer
   if ( OSAL_MSG_ID( msg_ptr ) != TASK_NO_TASK )
     return ( MSG_BUFFER_NOT_AVAIL );
 
   x = (uint8 *)((uint8 *)msg_ptr - sizeof( osal_msg_hdr_t ));
 
+#if ( OSAL_MSG_POOLS )
+  // Pool blocks are recognized by their address and go back to their own pool
+  if ( osal_msg_pool_free( (osal_msg_hdr_t *)x ) )
+    return ( SUCCESS );
+#endif
+
   osal_mem_free( (void *)x );
 
   return ( SUCCESS );
 }
 
+#if ( OSAL_MSG_SHARED )
+/*********************************************************************
+ * @fn      osal_msg_allocate_shared
+ *
+ * @brief
+ *
+ *    This function allocates a reference counted message buffer.  The
+ *    caller holds the first reference.  Every osal_msg_send() or
+ *    osal_msg_push_front() of the buffer queues a small link to it and
+ *    takes another reference, so the same payload is delivered to each
+ *    destination task without being copied.  Each receiver, and the
+ *    caller once it has sent the message to all destinations, releases
+ *    its reference with osal_msg_deallocate(); the last one frees the
+ *    buffer.  Receivers must treat the payload as read-only.  A receiver
+ *    that forwards the message also takes a new reference for the next
+ *    task, so it must still deallocate its own after the send.
+ *
+ * @param   uint16 len - wanted buffer length
+ *
+ * @return  pointer to allocated buffer or NULL if allocation failed.
+ */
+uint8 *osal_msg_allocate_shared( uint16 len )
+{
+  osal_msg_ref_t *ref;
+  osal_msg_hdr_t *hdr;
+
+  if ( len == 0 )
+    return ( NULL );
+
+  ref = (osal_msg_ref_t *) osal_mem_alloc( (short)(len + sizeof( osal_msg_hdr_t ) +
+                                                   sizeof( osal_msg_ref_t )) );
+  if ( ref == NULL )
+    return ( NULL );
+
+  ref->refCnt = 1;
+
+  hdr = (osal_msg_hdr_t *)(ref + 1);
+  hdr->next = NULL;
+  hdr->len = len;
+  hdr->dest_id = OSAL_MSG_SHARED_ID;
+  return ( (uint8 *) (hdr + 1) );
+}
+#endif /* OSAL_MSG_SHARED */
+
+#if ( OSAL_MSG_POOLS )
+/*********************************************************************
+ * @fn      osal_msg_pool_allocate
+ *
+ * @brief
+ *
+ *    This function allocates a message buffer from a specific message
+ *    pool.  The buffer is used and released exactly like one from
+ *    osal_msg_allocate().  If the pool is empty the message is taken
+ *    from the next larger pool that has a free block, or from the heap
+ *    once they are all empty, and the pool's fallback counter is bumped.
+ *
+ * @param   uint8 pool - OSAL_MSG_POOL_SMALL, _MEDIUM or _LARGE
+ * @param   uint16 len - wanted buffer length, at most the pool's length
+ *
+ * @return  pointer to allocated buffer or NULL if allocation failed.
+ */
+uint8 *osal_msg_pool_allocate( uint8 pool, uint16 len )
+{
+  osal_msg_pool_t *pPool;
+  osal_msg_hdr_t *hdr = NULL;
+  halIntState_t intState;
+  uint8 idx;
+
+  if ( (pool >= OSAL_MSG_POOL_CNT) || (len == 0) || (len > osalMsgPool[pool].len) )
+    return ( NULL );
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+
+  for ( idx = pool; idx < OSAL_MSG_POOL_CNT; idx++ )
+  {
+    pPool = &osalMsgPool[idx];
+    hdr = pPool->freeList;
+    if ( hdr )
+    {
+      pPool->freeList = (osal_msg_hdr_t *)hdr->next;
+      if ( ++pPool->used > pPool->maxUsed )
+      {
+        pPool->maxUsed = pPool->used;
+      }
+      break;
+    }
+  }
+
+  if ( idx != pool )
+  {
+    osalMsgPool[pool].fallback++;
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  if ( hdr == NULL )
+  {
+    hdr = (osal_msg_hdr_t *) osal_mem_alloc( (short)(len + sizeof( osal_msg_hdr_t )) );
+    if ( hdr == NULL )
+      return ( NULL );
+  }
+
+  hdr->next = NULL;
+  hdr->len = len;
+  hdr->dest_id = TASK_NO_TASK;
+  return ( (uint8 *) (hdr + 1) );
+}
+
+/*********************************************************************
+ * @fn      osal_msg_pool_stat
+ *
+ * @brief
+ *
+ *    This function reports the usage of a message pool, including the
+ *    high-water mark of blocks in use since power-up.
+ *
+ * @param   uint8 pool - OSAL_MSG_POOL_SMALL, _MEDIUM or _LARGE
+ * @param   osalMsgPoolStat_t *pStat - filled in with the pool usage
+ *
+ * @return  SUCCESS, INVALIDPARAMETER
+ */
+uint8 osal_msg_pool_stat( uint8 pool, osalMsgPoolStat_t *pStat )
+{
+  halIntState_t intState;
+
+  if ( (pool >= OSAL_MSG_POOL_CNT) || (pStat == NULL) )
+    return ( INVALIDPARAMETER );
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+
+  pStat->len = osalMsgPool[pool].len;
+  pStat->blkCnt = osalMsgPool[pool].blkCnt;
+  pStat->used = osalMsgPool[pool].used;
+  pStat->maxUsed = osalMsgPool[pool].maxUsed;
+  pStat->fallback = osalMsgPool[pool].fallback;
+
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      osal_msg_pool_init
+ *
+ * @brief   Carve a message pool's reserved RAM into blocks and link
+ *          them onto its free list.
+ *
+ * @param   pool - OSAL_MSG_POOL_xxx index
+ * @param   base - start of the pool's RAM
+ * @param   len - payload length of each block
+ * @param   blkCnt - number of blocks in the pool
+ *
+ * @return  none
+ */
+static void osal_msg_pool_init( uint8 pool, halDataAlign_t *base, uint16 len, uint8 blkCnt )
+{
+  osal_msg_pool_t *pPool = &osalMsgPool[pool];
+  halDataAlign_t *blk = base;
+  uint8 cnt;
+
+  pPool->base = base;
+  pPool->freeList = NULL;
+  pPool->len = len;
+  pPool->stride = OSAL_MSG_POOL_STRIDE( len );
+  pPool->blkCnt = blkCnt;
+  pPool->used = 0;
+  pPool->maxUsed = 0;
+  pPool->fallback = 0;
+
+  for ( cnt = 0; cnt < blkCnt; cnt++ )
+  {
+    ((osal_msg_hdr_t *)blk)->next = pPool->freeList;
+    pPool->freeList = (osal_msg_hdr_t *)blk;
+    blk += pPool->stride;
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_msg_pool_free
+ *
+ * @brief   Return a message block to the pool that owns its address.
+ *
+ * @param   hdr - header of the message being deallocated
+ *
+ * @return  TRUE if the block belonged to a pool, FALSE if it is a heap block
+ */
+static uint8 osal_msg_pool_free( osal_msg_hdr_t *hdr )
+{
+  osal_msg_pool_t *pPool;
+  halIntState_t intState;
+  uint8 pool;
+
+  for ( pool = 0; pool < OSAL_MSG_POOL_CNT; pool++ )
+  {
+    pPool = &osalMsgPool[pool];
+
+    if ( ((halDataAlign_t *)hdr >= pPool->base) &&
+         ((halDataAlign_t *)hdr < (pPool->base + (pPool->stride * pPool->blkCnt))) )
+    {
+      HAL_ENTER_CRITICAL_SECTION( intState );
+      hdr->next = pPool->freeList;
+      pPool->freeList = hdr;
+      pPool->used--;
+      HAL_EXIT_CRITICAL_SECTION( intState );
+
+      return ( TRUE );
+    }
+  }
+
+  return ( FALSE );
+}
+#endif /* OSAL_MSG_POOLS */
+
 /*********************************************************************
  * @fn      osal_msg_send
  *
@@ -693,8 +1062,10 @@ uint8 osal_msg_push_front( uint8 destination_task, uint8 *msg_ptr )
  * @brief
  *
  *    This function is called by a task to either enqueue (append to
- *    queue) or push (prepend to queue) a command message to the OSAL
- *    queue. The destination_task field must refer to a valid task,
+ *    queue) or push (prepend to queue) a command message to the
+ *    destination task's OSAL queue. Both operations are O(1) since
+ *    each task keeps its own head and tail pointers.
+ *    The destination_task field must refer to a valid task,
  *    since the task ID will be used to send the message to. This 
  *    function will also set a message ready event in the destination
  *    task's event list.
@@ -703,10 +1074,14 @@ uint8 osal_msg_push_front( uint8 destination_task, uint8 *msg_ptr )
  * @param   uint8 *msg_ptr - pointer to message buffer
  * @param   uint8 push - TRUE to push, otherwise enqueue
  *
- * @return  SUCCESS, INVALID_TASK, INVALID_MSG_POINTER
+ * @return  SUCCESS, INVALID_TASK, INVALID_MSG_POINTER,
+ *          MSG_BUFFER_NOT_AVAIL (no link for a shared message)
  */
 static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint8 push )
 {
+  osal_task_q_t *q;
+  halIntState_t intState;
+
   if ( msg_ptr == NULL )
   {
     return ( INVALID_MSG_POINTER );
@@ -719,6 +1094,35 @@ static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint
   }
 #endif /* USE_ICALL */
 
+#if ( OSAL_MSG_SHARED )
+  // A shared message is queued through a link of its own, leaving the payload untouched.
+  // A failed send takes no reference, so the sender's reference is left alone.
+  if ( OSAL_MSG_ID( msg_ptr ) == OSAL_MSG_SHARED_ID )
+  {
+    uint8 *link;
+
+    if ( destination_task >= tasksCnt )
+    {
+      return ( INVALID_TASK );
+    }
+
+    link = osal_msg_allocate( sizeof( uint8 * ) );
+    if ( link == NULL )
+    {
+      return ( MSG_BUFFER_NOT_AVAIL );
+    }
+
+    OSAL_MSG_LEN( link ) = 0;
+    OSAL_MSG_LINK_TARGET( link ) = msg_ptr;
+
+    HAL_ENTER_CRITICAL_SECTION(intState);
+    OSAL_MSG_REF( msg_ptr )->refCnt++;
+    HAL_EXIT_CRITICAL_SECTION(intState);
+
+    msg_ptr = link;
+  }
+#endif
+
   if ( destination_task >= tasksCnt )
   {
     osal_msg_deallocate( msg_ptr );
@@ -735,17 +1139,38 @@ static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint
 
   OSAL_MSG_ID( msg_ptr ) = destination_task;
 
+  q = &osal_taskQ[destination_task];
+
+  // Hold off interrupts
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
   if ( push == TRUE )
   {
     // prepend the message
-    osal_msg_push( &osal_qHead, msg_ptr );
+    OSAL_MSG_NEXT( msg_ptr ) = q->head;
+    q->head = msg_ptr;
+    if ( q->tail == NULL )
+    {
+      q->tail = msg_ptr;
+    }
   }
   else
   {
     // append the message
-    osal_msg_enqueue( &osal_qHead, msg_ptr );
+    if ( q->tail == NULL )
+    {
+      q->head = msg_ptr;
+    }
+    else
+    {
+      OSAL_MSG_NEXT( q->tail ) = msg_ptr;
+    }
+    q->tail = msg_ptr;
   }
 
+  // Re-enable interrupts
+  HAL_EXIT_CRITICAL_SECTION(intState);
+
   // Signal the task that a message is waiting
   osal_set_event( destination_task, SYS_EVENT_MSG );
 
@@ -767,42 +1192,38 @@ static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint
  */
 uint8 *osal_msg_receive( uint8 task_id )
 {
-  osal_msg_hdr_t *listHdr;
-  osal_msg_hdr_t *prevHdr = NULL;
-  osal_msg_hdr_t *foundHdr = NULL;
+  osal_task_q_t  *q;
+  osal_msg_hdr_t *foundHdr;
   halIntState_t   intState;
 
+  if ( task_id >= tasksCnt )
+  {
+    return ( NULL );
+  }
+
+  q = &osal_taskQ[task_id];
+
   // Hold off interrupts
   HAL_ENTER_CRITICAL_SECTION(intState);
 
-  // Point to the top of the queue
-  listHdr = osal_qHead;
+  // The first message in the task's own queue is the one to deliver
+  foundHdr = q->head;
 
-  // Look through the queue for a message that belongs to the asking task
-  while ( listHdr != NULL )
+  // Did we find a message?
+  if ( foundHdr != NULL )
   {
-    if ( (listHdr - 1)->dest_id == task_id )
+    // Take off the head of the task queue
+    q->head = OSAL_MSG_NEXT( foundHdr );
+    if ( q->head == NULL )
     {
-      if ( foundHdr == NULL )
-      {
-        // Save the first one
-        foundHdr = listHdr;
-      }
-      else
-      {
-        // Second msg found, stop looking
-        break;
-      }
-    }
-    if ( foundHdr == NULL )
-    {
-      prevHdr = listHdr;
+      q->tail = NULL;
     }
-    listHdr = OSAL_MSG_NEXT( listHdr );
+    OSAL_MSG_NEXT( foundHdr ) = NULL;
+    OSAL_MSG_ID( foundHdr ) = TASK_NO_TASK;
   }
 
   // Is there more than one?
-  if ( listHdr != NULL )
+  if ( q->head != NULL )
   {
     // Yes, Signal the task that a message is waiting
     osal_set_event( task_id, SYS_EVENT_MSG );
@@ -813,16 +1234,20 @@ uint8 *osal_msg_receive( uint8 task_id )
     osal_clear_event( task_id, SYS_EVENT_MSG );
   }
 
-  // Did we find a message?
-  if ( foundHdr != NULL )
-  {
-    // Take out of the link list
-    osal_msg_extract( &osal_qHead, foundHdr, prevHdr );
-  }
-
   // Release interrupts
   HAL_EXIT_CRITICAL_SECTION(intState);
 
+#if ( OSAL_MSG_SHARED )
+  // Hand out the shared message itself; the reference taken when it was sent passes to the caller
+  if ( (foundHdr != NULL) && OSAL_MSG_IS_LINK( foundHdr ) )
+  {
+    uint8 *msg_ptr = OSAL_MSG_LINK_TARGET( foundHdr );
+
+    osal_msg_deallocate( (uint8 *)foundHdr );
+    return ( msg_ptr );
+  }
+#endif
+
   return ( (uint8*) foundHdr );
 }
 
@@ -847,16 +1272,30 @@ uint8 *osal_msg_receive( uint8 task_id )
 osal_event_hdr_t *osal_msg_find(uint8 task_id, uint8 event)
 {
   osal_msg_hdr_t *pHdr;
+  osal_event_hdr_t *pMsg = NULL;
   halIntState_t intState;
 
+  if (task_id >= tasksCnt)
+  {
+    return NULL;
+  }
+
   HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
 
-  pHdr = osal_qHead;  // Point to the top of the queue.
+  pHdr = osal_taskQ[task_id].head;  // Point to the top of the task's queue.
 
-  // Look through the queue for a message that matches the task_id and event parameters.
+  // Look through the task's queue for a message that matches the event parameter.
   while (pHdr != NULL)
   {
-    if (((pHdr-1)->dest_id == task_id) && (((osal_event_hdr_t *)pHdr)->event == event))
+    pMsg = (osal_event_hdr_t *)pHdr;
+#if ( OSAL_MSG_SHARED )
+    if (OSAL_MSG_IS_LINK(pHdr))
+    {
+      pMsg = (osal_event_hdr_t *)OSAL_MSG_LINK_TARGET(pHdr);
+    }
+#endif
+
+    if (pMsg->event == event)
     {
       break;
     }
@@ -866,7 +1305,7 @@ osal_event_hdr_t *osal_msg_find(uint8 task_id, uint8 event)
 
   HAL_EXIT_CRITICAL_SECTION(intState);  // Release interrupts.
 
-  return (osal_event_hdr_t *)pHdr;
+  return ((pHdr != NULL) ? pMsg : NULL);
 }
 
 /**************************************************************************************************
@@ -892,17 +1331,30 @@ uint8 osal_msg_count( uint8 task_id, uint8 event )
 {
   uint8 count = 0;
   osal_msg_hdr_t *pHdr;
+  osal_event_hdr_t *pMsg;
   halIntState_t intState;
 
+  if ( task_id >= tasksCnt )
+  {
+    return ( 0 );
+  }
+
   HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
 
-  pHdr = osal_qHead;  // Point to the top of the queue.
+  pHdr = osal_taskQ[task_id].head;  // Point to the top of the task's queue.
 
-  // Look through the queue for a message that matches the task_id and event parameters.
+  // Look through the task's queue for a message that matches the event parameter.
   while (pHdr != NULL)
   {
-    if ( ((pHdr-1)->dest_id == task_id) 
-        && ((event == 0xFF) || (((osal_event_hdr_t *)pHdr)->event == event)) )
+    pMsg = (osal_event_hdr_t *)pHdr;
+#if ( OSAL_MSG_SHARED )
+    if (OSAL_MSG_IS_LINK(pHdr))
+    {
+      pMsg = (osal_event_hdr_t *)OSAL_MSG_LINK_TARGET(pHdr);
+    }
+#endif
+
+    if ( (event == 0xFF) || (pMsg->event == event) )
     {
       count++;
     }
@@ -1185,7 +1637,11 @@ uint8 osal_set_event( uint8 task_id, uint16 event_flag )
   {
     halIntState_t   intState;
     HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
+#if ( OSAL_PROFILE )
+    osal_profile_mark( task_id, (event_flag & ~tasksEvents[task_id]) );
+#endif
     tasksEvents[task_id] |= event_flag;  // Stuff the event bit(s)
+    OSAL_READY_SET( task_id );           // Mark the task ready
     HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
 #ifdef USE_ICALL
     ICall_signal(osal_semaphore);
@@ -1218,6 +1674,10 @@ uint8 osal_clear_event( uint8 task_id, uint16 event_flag )
     halIntState_t   intState;
     HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
     tasksEvents[task_id] &= ~(event_flag);   // Clear the event bit(s)
+    if ( tasksEvents[task_id] == 0 )
+    {
+      OSAL_READY_CLR( task_id );             // Nothing left pending
+    }
     HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
     return ( SUCCESS );
   }
@@ -1319,7 +1779,8 @@ uint8 osal_int_disable( uint8 interrupt_id )
  *
  * @param   void
  *
- * @return  SUCCESS
+ * @return  SUCCESS, or FAILURE if the heap cannot hold the task
+ *          bookkeeping (this also asserts).
  */
 uint8 osal_init_system( void )
 {
@@ -1328,8 +1789,42 @@ uint8 osal_init_system( void )
   osal_mem_init();
 #endif /* !defined USE_ICALL && !defined OSAL_PORT2TIRTOS */
 
-  // Initialize the message queue
-  osal_qHead = NULL;
+  // Initialize the per-task message queues
+  osal_taskQ = (osal_task_q_t *)osal_mem_alloc( sizeof( osal_task_q_t ) * tasksCnt );
+  HAL_ASSERT( osal_taskQ != NULL );
+  if ( osal_taskQ == NULL )
+  {
+    return ( FAILURE );  // A heap too small for the task queues cannot run the tasks.
+  }
+  osal_memset( osal_taskQ, 0, (sizeof( osal_task_q_t ) * tasksCnt) );
+
+  // Initialize the ready-task bitmap
+  tasksReady = (uint8 *)osal_mem_alloc( (tasksCnt + 7) >> 3 );
+  HAL_ASSERT( tasksReady != NULL );
+  if ( tasksReady == NULL )
+  {
+    return ( FAILURE );  // osal_run_system() scans this bitmap on every pass.
+  }
+  osal_memset( tasksReady, 0, ((tasksCnt + 7) >> 3) );
+
+#if ( OSAL_PROFILE )
+  // Initialize the task profiles
+  osalProfile = (osal_profile_t *)osal_mem_alloc( sizeof( osal_profile_t ) * tasksCnt );
+  if ( osalProfile )
+  {
+    osal_memset( osalProfile, 0, (sizeof( osal_profile_t ) * tasksCnt) );
+  }
+#endif
+
+#if ( OSAL_MSG_POOLS )
+  // Initialize the fixed-size message pools
+  osal_msg_pool_init( OSAL_MSG_POOL_SMALL, osalMsgPoolSmall,
+                      OSAL_MSG_POOL_SMALL_LEN, OSAL_MSG_POOL_SMALL_CNT );
+  osal_msg_pool_init( OSAL_MSG_POOL_MEDIUM, osalMsgPoolMedium,
+                      OSAL_MSG_POOL_MEDIUM_LEN, OSAL_MSG_POOL_MEDIUM_CNT );
+  osal_msg_pool_init( OSAL_MSG_POOL_LARGE, osalMsgPoolLarge,
+                      OSAL_MSG_POOL_LARGE_LEN, OSAL_MSG_POOL_LARGE_CNT );
+#endif
 
   // Initialize the timers
   osalTimerInit();
@@ -1538,15 +2033,278 @@ ICall_Errno osal_service_entry(ICall_FuncArgsHdr *args)
 }
 #endif /* USE_ICALL */
 
+#if ( OSAL_PROFILE )
+/*********************************************************************
+ * @fn      osal_profile_get
+ *
+ * @brief
+ *
+ *   This function reads the profile of a task: how often its event
+ *   handler ran, the cumulative and longest handler run time, and the
+ *   longest time from setting each event bit to the handler consuming
+ *   it.  Times are in OSAL_PROFILE_TICK_US units.
+ *
+ * @param   uint8 task_id - task to read
+ * @param   osalProfileStat_t *pStat - filled in with the task's profile
+ *
+ * @return  SUCCESS, INVALID_TASK, INVALIDPARAMETER
+ */
+uint8 osal_profile_get( uint8 task_id, osalProfileStat_t *pStat )
+{
+  halIntState_t intState;
+
+  if ( task_id >= tasksCnt )
+    return ( INVALID_TASK );
+
+  if ( (osalProfile == NULL) || (pStat == NULL) )
+    return ( INVALIDPARAMETER );
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+  *pStat = osalProfile[task_id].stat;
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      osal_profile_reset
+ *
+ * @brief
+ *
+ *   This function clears the profiles of all tasks.  Event bits that
+ *   are already pending keep the time they were set.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void osal_profile_reset( void )
+{
+  halIntState_t intState;
+  uint8 idx;
+
+  if ( osalProfile == NULL )
+    return;
+
+  for ( idx = 0; idx < tasksCnt; idx++ )
+  {
+    HAL_ENTER_CRITICAL_SECTION( intState );
+    osal_memset( &osalProfile[idx].stat, 0, sizeof( osalProfileStat_t ) );
+    HAL_EXIT_CRITICAL_SECTION( intState );
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_profile_mark
+ *
+ * @brief   Record when event bits became pending.  Called with
+ *          interrupts held off.
+ *
+ * @param   task_id - task the events were set for
+ * @param   event_flag - event bits that were not already pending
+ *
+ * @return  none
+ */
+static void osal_profile_mark( uint8 task_id, uint16 event_flag )
+{
+  uint16 now;
+  uint8 bit;
+
+  if ( (osalProfile == NULL) || (event_flag == 0) )
+    return;
+
+  now = (uint16)OSAL_PROFILE_TIMESTAMP();
+
+  for ( bit = 0; event_flag != 0; bit++, event_flag >>= 1 )
+  {
+    if ( event_flag & 0x0001 )
+    {
+      osalProfile[task_id].setTime[bit] = now;
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_profile_dispatch
+ *
+ * @brief   Record the latency of the event bits handed to a task's
+ *          event handler.  A bit the handler returns unprocessed is
+ *          measured again when it is next handed over, so the maximum
+ *          covers the whole time until it is consumed.  Called with
+ *          interrupts held off.
+ *
+ * @param   task_id - task whose handler is about to run
+ * @param   events - event bits handed to the handler
+ *
+ * @return  timestamp at dispatch, for osal_profile_update()
+ */
+static uint32 osal_profile_dispatch( uint8 task_id, uint16 events )
+{
+  uint32 now = OSAL_PROFILE_TIMESTAMP();
+  uint16 latency;
+  uint8 bit;
+
+  if ( osalProfile == NULL )
+    return ( now );
+
+  for ( bit = 0; events != 0; bit++, events >>= 1 )
+  {
+    if ( events & 0x0001 )
+    {
+      latency = (uint16)now - osalProfile[task_id].setTime[bit];
+      if ( latency > osalProfile[task_id].stat.maxLatency[bit] )
+      {
+        osalProfile[task_id].stat.maxLatency[bit] = latency;
+      }
+    }
+  }
+
+  return ( now );
+}
+
+/*********************************************************************
+ * @fn      osal_profile_update
+ *
+ * @brief   Account for one run of a task's event handler.
+ *
+ * @param   task_id - task whose handler ran
+ * @param   start - timestamp from osal_profile_dispatch()
+ *
+ * @return  none
+ */
+static void osal_profile_update( uint8 task_id, uint32 start )
+{
+  osalProfileStat_t *pStat;
+  uint32 runTime;
+
+  if ( osalProfile == NULL )
+    return;
+
+  runTime = OSAL_PROFILE_TIMESTAMP() - start;
+  pStat = &osalProfile[task_id].stat;
+
+  pStat->runCnt++;
+  pStat->runTime += runTime;
+  if ( runTime > pStat->maxRunTime )
+  {
+    pStat->maxRunTime = runTime;
+  }
+}
+#endif /* OSAL_PROFILE */
+
+/*********************************************************************
+ * @fn      osal_next_ready
+ *
+ * @brief
+ *
+ *   This function finds the highest priority task, at or below 'first'
+ *   in priority, that has an event pending, using the ready-task bitmap
+ *   instead of scanning the whole tasksEvents table. Stale bits, left by
+ *   code that cleared tasksEvents[] directly, are dropped on the way.
+ *
+ * @param   uint8 first - task ID to start the search from
+ *
+ * @return  task ID of the ready task, or TASK_NO_TASK if none is ready
+ */
+uint8 osal_next_ready( uint8 first )
+{
+  uint8 byteIdx;
+  uint8 idx;
+  uint8 bits;
+  uint8 mask = (uint8)(0xFF << (first & 0x07));
+  halIntState_t intState;
+
+  for ( byteIdx = (first >> 3); byteIdx < ((tasksCnt + 7) >> 3); byteIdx++ )
+  {
+    HAL_ENTER_CRITICAL_SECTION(intState);
+
+    while ( (bits = (tasksReady[byteIdx] & mask)) != 0 )
+    {
+      // Find first set
+      if ( bits & 0x0F )
+      {
+        idx = osalFirstBit[bits & 0x0F];
+      }
+      else
+      {
+        idx = osalFirstBit[bits >> 4] + 4;
+      }
+      idx += (byteIdx << 3);
+
+      if ( tasksEvents[idx] )
+      {
+        HAL_EXIT_CRITICAL_SECTION(intState);
+        return ( idx );
+      }
+
+      OSAL_READY_CLR( idx );
+    }
+
+    HAL_EXIT_CRITICAL_SECTION(intState);
+    mask = 0xFF;
+  }
+
+  return ( TASK_NO_TASK );
+}
+
+/*********************************************************************
+ * @fn      osal_run_task
+ *
+ * @brief
+ *
+ *   This function calls the task_event_processor() function of one task
+ *   with the events it has pending, keeping the ready-task bitmap, the
+ *   active task ID and the task profile up to date. It is the dispatch
+ *   step of osal_run_system(), for main loops of their own.
+ *
+ * @param   uint8 idx - task ID of a ready task, from osal_next_ready()
+ *
+ * @return  none
+ */
+void osal_run_task( uint8 idx )
+{
+  uint16 events;
+  halIntState_t intState;
+#if ( OSAL_PROFILE )
+  uint32 start;
+#endif
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+  events = tasksEvents[idx];
+  tasksEvents[idx] = 0;  // Clear the Events for this task.
+  OSAL_READY_CLR( idx );
+#if ( OSAL_PROFILE )
+  start = osal_profile_dispatch( idx, events );
+#endif
+  HAL_EXIT_CRITICAL_SECTION(intState);
+
+  activeTaskID = idx;
+  events = (tasksArr[idx])( idx, events );
+  activeTaskID = TASK_NO_TASK;
+
+#if ( OSAL_PROFILE )
+  osal_profile_update( idx, start );
+#endif
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+  if (events)
+  {
+    tasksEvents[idx] |= events;  // Add back unprocessed events to the current task.
+    OSAL_READY_SET( idx );
+  }
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
 /*********************************************************************
  * @fn      osal_run_system
  *
  * @brief
  *
- *   This function will make one pass through the OSAL taskEvents table
- *   and call the task_event_processor() function for the first task that
- *   is found with at least one event pending. If there are no pending
- *   events (all tasks), this function puts the processor into Sleep.
+ *   This function will make one pass through the OSAL ready-task bitmap
+ *   and call the task_event_processor() function for the highest priority
+ *   task that has at least one event pending, repeating for up to
+ *   OSAL_TASKS_PER_PASS tasks. If there are no pending events (all tasks),
+ *   this function puts the processor into Sleep.
  *
  * @param   void
  *
@@ -1554,7 +2312,8 @@ ICall_Errno osal_service_entry(ICall_FuncArgsHdr *args)
  */
 void osal_run_system( void )
 {
-  uint8 idx = 0;
+  uint8 idx;
+  uint8 cnt = 0;
 
 #ifdef USE_ICALL
   uint32 next_timeout_prior = osal_next_timeout();
@@ -1641,33 +2400,21 @@ void osal_run_system( void )
   }
 #endif /* USE_ICALL */
 
-  do {
-    if (tasksEvents[idx])  // Task is highest priority that is ready.
-    {
-      break;
-    }
-  } while (++idx < tasksCnt);
+  idx = osal_next_ready( 0 );  // Task is highest priority that is ready.
 
-  if (idx < tasksCnt)
+  while (idx < tasksCnt)
   {
-    uint16 events;
-    halIntState_t intState;
-
-    HAL_ENTER_CRITICAL_SECTION(intState);
-    events = tasksEvents[idx];
-    tasksEvents[idx] = 0;  // Clear the Events for this task.
-    HAL_EXIT_CRITICAL_SECTION(intState);
+    osal_run_task( idx );
 
-    activeTaskID = idx;
-    events = (tasksArr[idx])( idx, events );
-    activeTaskID = TASK_NO_TASK;
+    if (++cnt >= OSAL_TASKS_PER_PASS)
+    {
+      break;
+    }
 
-    HAL_ENTER_CRITICAL_SECTION(intState);
-    tasksEvents[idx] |= events;  // Add back unprocessed events to the current task.
-    HAL_EXIT_CRITICAL_SECTION(intState);
+    idx = osal_next_ready( 0 );  // Drain the next highest priority ready task.
   }
 #if defined( POWER_SAVING ) && !defined(USE_ICALL)
-  else  // Complete pass through all task events with no activity?
+  if (cnt == 0)  // Complete pass through all task events with no activity?
   {
     osal_pwrmgr_powerconserve();  // Put the processor/system into sleep
   }
@@ -64,6 +64,16 @@
 
 #define OSALMEM_HDRSZ              sizeof(osalMemHdr_t)
 
+#if OSALMEM_SITE_TAGS
+// The allocation site tag that follows the header of every block.
+#define OSALMEM_TAGSZ              OSALMEM_ROUND(sizeof(osalMemTag_t))
+#else
+#define OSALMEM_TAGSZ              0
+#endif
+
+// Per-allocation overhead: the block header and, if enabled, the site tag.
+#define OSALMEM_BLKOVH            (OSALMEM_HDRSZ + OSALMEM_TAGSZ)
+
 // Round a value up to the ceiling of OSALMEM_HDRSZ for critical dependencies on even multiples.
 #define OSALMEM_ROUND(X)       ((((X) + OSALMEM_HDRSZ - 1) / OSALMEM_HDRSZ) * OSALMEM_HDRSZ)
 
@@ -79,7 +89,7 @@
 
 #if !defined OSALMEM_LL_BLKSZ
 #if defined NONWK
-#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(6) + (1 * OSALMEM_HDRSZ))
+#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(6) + (1 * OSALMEM_BLKOVH))
 #else
 /*
  * Profiling the sample apps with default settings shows the following long-lived allocations
@@ -92,13 +102,13 @@
  * size of long-lived objects profiled by sample apps and long-lived objects added by application.
  */
 #if defined ZCL_KEY_ESTABLISH_OLD // CBKE no longer uses long lived memory allocations.
-#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(526) + (32 * OSALMEM_HDRSZ))
+#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(526) + (32 * OSALMEM_BLKOVH))
 #elif defined TC_LINKKEY_JOIN
-#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(454) + (21 * OSALMEM_HDRSZ))
+#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(454) + (21 * OSALMEM_BLKOVH))
 #elif ((defined SECURE) && (SECURE != 0))
-#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(418) + (19 * OSALMEM_HDRSZ))
+#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(418) + (19 * OSALMEM_BLKOVH))
 #else
-#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(417) + (19 * OSALMEM_HDRSZ))
+#define OSALMEM_LL_BLKSZ          (OSALMEM_ROUND(417) + (19 * OSALMEM_BLKOVH))
 #endif
 #endif
 #endif
@@ -115,6 +125,19 @@
 #define OSALMEM_SMALL_BLKCNT       8
 #endif
 
+#if OSALMEM_SIZE_CLASSES
+/* Block sizes, including the header, of the segregated size classes used for allocations that are
+ * too big for the small-block bucket. A request is rounded up to the first class that fits it and
+ * freed blocks of exactly a class size are kept on that class' free list for O(1) re-allocation.
+ * Larger requests fall back to the first-fit walk of the big-block region.
+ * List up to eight sizes in ascending order, each bigger than OSALMEM_SMALL_BLKSZ and an even
+ * multiple of OSALMEM_HDRSZ; the build fails otherwise.
+ */
+#if !defined OSALMEM_CLASS_SIZES
+#define OSALMEM_CLASS_SIZES        32, 64, 128
+#endif
+#endif
+
 /*
  * These numbers setup the size of the small-block bucket which is reserved at the front of the
  * heap for allocations of OSALMEM_SMALL_BLKSZ or smaller.
@@ -170,6 +193,19 @@ typedef union {
   osalMemHdrHdr_t hdr;
 } osalMemHdr_t;
 
+#if OSALMEM_SITE_TAGS
+typedef struct {
+  uint16 file;   // OSALMEM_SITE_FILE of the allocating source file.
+  uint16 line;   // Allocating source line; 0 while held on a size class free list.
+  uint16 birth;  // osal_GetSystemClock() / 1024 at allocation.
+} osalMemTag_t;
+
+#define OSALMEM_TAG(HDR)           ((osalMemTag_t *)((HDR) + 1))
+#endif
+
+// The first byte after the header and tag: what osal_mem_alloc() returns.
+#define OSALMEM_PAYLOAD(HDR)       ((void *)((uint8 *)((HDR) + 1) + OSALMEM_TAGSZ))
+
 /* ------------------------------------------------------------------------------------------------
  *                                           Local Variables
  * ------------------------------------------------------------------------------------------------
@@ -185,12 +221,42 @@ static osalMemHdr_t *ff1;  // First free block in the small-block bucket.
 
 static uint8 osalMemStat;            // Discrete status flags: 0x01 = kicked.
 
+#if OSALMEM_SIZE_CLASSES
+static const uint16 osalMemClassSz[] = { OSALMEM_CLASS_SIZES };
+#define OSALMEM_CLASS_CNT  (sizeof(osalMemClassSz) / sizeof(osalMemClassSz[0]))
+
+/* Compile-time check of OSALMEM_CLASS_SIZES: the list is padded with zeros to nine entries, every
+ * size must follow a smaller one and be an even multiple of OSALMEM_HDRSZ, and the ninth must be
+ * the padding. A failed check gives the typedef below a negative array size.
+ */
+#define OSALMEM_CLASS_NEXT(A, B) \
+  (((B) == 0) || (((A) != 0) && ((A) < (B)) && (((B) % OSALMEM_HDRSZ) == 0)))
+#define OSALMEM_CLASS_CHECK(A, B, C, D, E, F, G, H, I, ...) \
+  (((A) != 0) && OSALMEM_CLASS_NEXT(OSALMEM_SMALL_BLKSZ, A) && \
+   OSALMEM_CLASS_NEXT(A, B) && OSALMEM_CLASS_NEXT(B, C) && OSALMEM_CLASS_NEXT(C, D) && \
+   OSALMEM_CLASS_NEXT(D, E) && OSALMEM_CLASS_NEXT(E, F) && OSALMEM_CLASS_NEXT(F, G) && \
+   OSALMEM_CLASS_NEXT(G, H) && ((I) == 0))
+#define OSALMEM_CLASS_VALID(...)  OSALMEM_CLASS_CHECK(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+
+typedef char osalMemClassCheck_t[OSALMEM_CLASS_VALID(OSALMEM_CLASS_SIZES) ? 1 : -1];
+
+/* Free list heads of the size classes. A block on a free list keeps its 'inUse' flag set so that
+ * the first-fit walk neither allocates it nor coalesces it; the next link is kept in its payload.
+ */
+static osalMemHdr_t *classFree[OSALMEM_CLASS_CNT];
+#endif
+
 #if OSALMEM_METRICS
 static uint16 blkMax;  // Max cnt of all blocks ever seen at once.
 static uint16 blkCnt;  // Current cnt of all blocks.
 static uint16 blkFree; // Current cnt of free blocks.
 static uint16 memAlo;  // Current total memory allocated.
 static uint16 memMax;  // Max total memory ever allocated at once.
+#if OSALMEM_SIZE_CLASSES
+static uint16 classHit[OSALMEM_CLASS_CNT];   // Allocations served from the class free list.
+static uint16 classMiss[OSALMEM_CLASS_CNT];  // Class allocations that fell back to first-fit.
+static uint16 classCnt[OSALMEM_CLASS_CNT];   // Current cnt of blocks on the class free list.
+#endif
 #endif
 
 #if OSALMEM_PROFILER
@@ -207,6 +273,11 @@ static uint16 proTot[OSALMEM_PROMAX] = { 0 };
 static uint16 proSmallBlkMiss;
 #endif
 
+#if OSALMEM_SITE_TAGS
+// Allocation sites seen by the last osal_heap_map() walk; only the top OSALMEM_MAP_SITES are kept.
+static osalMemSiteStat_t mapSite[OSALMEM_MAP_SLOTS];
+#endif
+
 /* ------------------------------------------------------------------------------------------------
  *                                           Global Variables
  * ------------------------------------------------------------------------------------------------
@@ -216,6 +287,19 @@ static uint16 proSmallBlkMiss;
 extern int dprintf(const char *fmt, ...);
 #endif /* DPRINTF_HEAPTRACE */
 
+/* ------------------------------------------------------------------------------------------------
+ *                                           Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static osalMemHdr_t *osalMemFindFit(uint16 size);
+#if OSALMEM_SITE_TAGS
+static void osalMemMapSite(osalMemMap_t *pMap, uint8 *pCnt, osalMemTag_t *tag, uint16 len);
+#endif
+#if OSALMEM_SIZE_CLASSES
+static uint8 osalMemClassFlush(void);
+#endif
+
 /**************************************************************************************************
  * @fn          osal_mem_init
  *
@@ -254,6 +338,15 @@ void osal_mem_init(void)
   // Setup the wilderness.
   theHeap[OSALMEM_BIGBLK_IDX].val = OSALMEM_BIGBLK_SZ;  // Set 'len' & clear 'inUse' field.
 
+  // Not kicked yet, and nothing held on the size class free lists, also on a second power-up.
+  osalMemStat = 0;
+#if OSALMEM_SIZE_CLASSES
+  (void)osal_memset(classFree, 0, sizeof(classFree));
+#if OSALMEM_METRICS
+  (void)osal_memset(classCnt, 0, sizeof(classCnt));
+#endif
+#endif
+
 #if ( OSALMEM_METRICS )
   /* Start with the small-block bucket and the wilderness - don't count the
    * end-of-heap NULL block nor the end-of-small-block NULL block.
@@ -300,50 +393,27 @@ void osal_mem_kick(void)
 }
 
 /**************************************************************************************************
- * @fn          osal_mem_alloc
+ * @fn          osalMemFindFit
  *
- * @brief       This function implements the OSAL dynamic memory allocation functionality.
+ * @brief       First-fit search for a free block of at least 'size' bytes, coalescing adjacent free
+ *              blocks on the way. Ints must be disabled.
  *
  * input parameters
  *
- * @param size - the number of bytes to allocate from the HEAP.
+ * @param size - the block size, including the header.
  *
  * output parameters
  *
  * None.
  *
- * @return      None.
+ * @return      Pointer to the header of the free block found, NULL if none.
  */
-#ifdef DPRINTF_OSALHEAPTRACE
-void *osal_mem_alloc_dbg( uint16 size, const char *fname, unsigned lnum )
-#else /* DPRINTF_OSALHEAPTRACE */
-void *osal_mem_alloc( uint16 size )
-#endif /* DPRINTF_OSALHEAPTRACE */
+static osalMemHdr_t *osalMemFindFit(uint16 size)
 {
   osalMemHdr_t *prev = NULL;
   osalMemHdr_t *hdr;
-  halIntState_t intState;
   uint8 coal = 0;
 
-  size += OSALMEM_HDRSZ;
-
-  // Calculate required bytes to add to 'size' to align to halDataAlign_t.
-  if ( sizeof( halDataAlign_t ) == 2 )
-  {
-    size += (size & 0x01);
-  }
-  else if ( sizeof( halDataAlign_t ) != 1 )
-  {
-    const uint8 mod = size % sizeof( halDataAlign_t );
-
-    if ( mod != 0 )
-    {
-      size += (sizeof( halDataAlign_t ) - mod);
-    }
-  }
-
-  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
-
   // Smaller allocations are first attempted in the small-block bucket, and all long-lived
   // allocations are channeled into the LL block reserved within this bucket.
   if ((osalMemStat == 0) || (size <= OSALMEM_SMALL_BLKSZ))
@@ -399,37 +469,141 @@ void *osal_mem_alloc( uint16 size )
     }
   } while (1);
 
-  if ( hdr != NULL )
+  return hdr;
+}
+
+/**************************************************************************************************
+ * @fn          osal_mem_alloc
+ *
+ * @brief       This function implements the OSAL dynamic memory allocation functionality.
+ *
+ * input parameters
+ *
+ * @param size - the number of bytes to allocate from the HEAP.
+ * @param file - OSALMEM_SITE_FILE of the caller, when OSALMEM_SITE_TAGS is enabled.
+ * @param line - source line of the caller, when OSALMEM_SITE_TAGS is enabled.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ */
+#ifdef DPRINTF_OSALHEAPTRACE
+void *osal_mem_alloc_dbg( uint16 size, const char *fname, unsigned lnum )
+#elif OSALMEM_SITE_TAGS
+void *osal_mem_alloc_site( uint16 size, uint16 file, uint16 line )
+#else /* DPRINTF_OSALHEAPTRACE */
+void *osal_mem_alloc( uint16 size )
+#endif /* DPRINTF_OSALHEAPTRACE */
+{
+  osalMemHdr_t *hdr;
+  halIntState_t intState;
+#if OSALMEM_SIZE_CLASSES
+  uint8 cls = OSALMEM_CLASS_CNT;
+#endif
+
+  size += OSALMEM_BLKOVH;
+
+  // Calculate required bytes to add to 'size' to align to halDataAlign_t.
+  if ( sizeof( halDataAlign_t ) == 2 )
   {
-    uint16 tmp = hdr->hdr.len - size;
+    size += (size & 0x01);
+  }
+  else if ( sizeof( halDataAlign_t ) != 1 )
+  {
+    const uint8 mod = size % sizeof( halDataAlign_t );
 
-    // Determine whether the threshold for splitting is met.
-    if ( tmp >= OSALMEM_MIN_BLKSZ )
+    if ( mod != 0 )
     {
-      // Split the block before allocating it.
-      osalMemHdr_t *next = (osalMemHdr_t *)((uint8 *)hdr + size);
-      next->val = tmp;                     // Set 'len' & clear 'inUse' field.
-      hdr->val = (size | OSALMEM_IN_USE);  // Set 'len' & 'inUse' field.
+      size += (sizeof( halDataAlign_t ) - mod);
+    }
+  }
 
-#if ( OSALMEM_METRICS )
-      blkCnt++;
-      if ( blkMax < blkCnt )
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+#if OSALMEM_SIZE_CLASSES
+  // Mid-sized allocations are rounded up to their size class and served from its free list.
+  hdr = NULL;
+  if ((osalMemStat != 0) && (size > OSALMEM_SMALL_BLKSZ))
+  {
+    for (cls = 0; cls < OSALMEM_CLASS_CNT; cls++)
+    {
+      if (size <= osalMemClassSz[cls])
       {
-        blkMax = blkCnt;
+        size = osalMemClassSz[cls];
+        hdr = classFree[cls];
+        break;
       }
-      memAlo += size;
+    }
+  }
+
+  if (hdr != NULL)
+  {
+    classFree[cls] = *(osalMemHdr_t **)OSALMEM_PAYLOAD(hdr);
+
+#if ( OSALMEM_METRICS )
+    classHit[cls]++;
+    classCnt[cls]--;
+    memAlo += hdr->hdr.len;
+    blkFree--;
+#endif
+  }
+  else
 #endif
+  {
+#if ( OSALMEM_SIZE_CLASSES ) && ( OSALMEM_METRICS )
+    if (cls < OSALMEM_CLASS_CNT)
+    {
+      classMiss[cls]++;
     }
-    else
+#endif
+
+    hdr = osalMemFindFit(size);
+
+#if OSALMEM_SIZE_CLASSES
+    if ((hdr == NULL) && osalMemClassFlush())
     {
+      // Out of memory - the blocks held on the class free lists were returned to the heap.
+      hdr = osalMemFindFit(size);
+    }
+#endif
+
+    if ( hdr != NULL )
+    {
+      uint16 tmp = hdr->hdr.len - size;
+
+      // Determine whether the threshold for splitting is met.
+      if ( tmp >= OSALMEM_MIN_BLKSZ )
+      {
+        // Split the block before allocating it.
+        osalMemHdr_t *next = (osalMemHdr_t *)((uint8 *)hdr + size);
+        next->val = tmp;                     // Set 'len' & clear 'inUse' field.
+        hdr->val = (size | OSALMEM_IN_USE);  // Set 'len' & 'inUse' field.
+
+#if ( OSALMEM_METRICS )
+        blkCnt++;
+        if ( blkMax < blkCnt )
+        {
+          blkMax = blkCnt;
+        }
+        memAlo += size;
+#endif
+      }
+      else
+      {
 #if ( OSALMEM_METRICS )
-      memAlo += hdr->hdr.len;
-      blkFree--;
+        memAlo += hdr->hdr.len;
+        blkFree--;
 #endif
 
-      hdr->hdr.inUse = TRUE;
+        hdr->hdr.inUse = TRUE;
+      }
     }
+  }
 
+  if ( hdr != NULL )
+  {
 #if ( OSALMEM_METRICS )
     if ( memMax < memAlo )
     {
@@ -480,7 +654,13 @@ void *osal_mem_alloc( uint16 size )
       ff1 = (osalMemHdr_t *)((uint8 *)hdr + hdr->hdr.len);
     }
 
-    hdr++;
+#if OSALMEM_SITE_TAGS
+    OSALMEM_TAG(hdr)->file = file;
+    OSALMEM_TAG(hdr)->line = line;
+    OSALMEM_TAG(hdr)->birth = (uint16)(osal_GetSystemClock() >> 10);
+#endif
+
+    hdr = (osalMemHdr_t *)OSALMEM_PAYLOAD(hdr);
   }
 
   HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
@@ -493,6 +673,31 @@ void *osal_mem_alloc( uint16 size )
   return (void *)hdr;
 }
 
+#if OSALMEM_SITE_TAGS
+#undef osal_mem_alloc
+/**************************************************************************************************
+ * @fn          osal_mem_alloc
+ *
+ * @brief       The osal_mem_alloc() symbol for callers that do not see the site tagging macro, such
+ *              as libraries built without OSALMEM_SITE_TAGS or code calling through a function
+ *              pointer. Their blocks are tagged with the unknown site.
+ *
+ * input parameters
+ *
+ * @param size - the number of bytes to allocate from the HEAP.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      A pointer to the allocated memory or NULL on failure.
+ */
+void *osal_mem_alloc( uint16 size )
+{
+  return osal_mem_alloc_site( size, OSALMEM_SITE_UNKNOWN_FILE, OSALMEM_SITE_UNKNOWN_LINE );
+}
+#endif
+
 /**************************************************************************************************
  * @fn          osal_mem_free
  *
@@ -514,8 +719,11 @@ void osal_mem_free_dbg(void *ptr, const char *fname, unsigned lnum)
 void osal_mem_free(void *ptr)
 #endif /* DPRINTF_OSALHEAPTRACE */
 {
-  osalMemHdr_t *hdr = (osalMemHdr_t *)ptr - 1;
+  osalMemHdr_t *hdr = (osalMemHdr_t *)((uint8 *)ptr - OSALMEM_TAGSZ) - 1;
   halIntState_t intState;
+#if OSALMEM_SIZE_CLASSES
+  uint8 cls;
+#endif
 
 #ifdef DPRINTF_OSALHEAPTRACE
   dprintf("osal_mem_free(%lx):%s:%u\n", (unsigned) ptr, fname, lnum);
@@ -525,11 +733,29 @@ void osal_mem_free(void *ptr)
   HAL_ASSERT(hdr->hdr.inUse);
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
-  hdr->hdr.inUse = FALSE;
 
-  if (ff1 > hdr)
+#if OSALMEM_SIZE_CLASSES
+  cls = OSALMEM_CLASS_CNT;
+  if (osalMemStat != 0)
+  {
+    for (cls = 0; cls < OSALMEM_CLASS_CNT; cls++)
+    {
+      if (hdr->hdr.len == osalMemClassSz[cls])
+      {
+        break;
+      }
+    }
+  }
+
+  if (cls == OSALMEM_CLASS_CNT)
+#endif
   {
-    ff1 = hdr;
+    hdr->hdr.inUse = FALSE;
+
+    if (ff1 > hdr)
+    {
+      ff1 = hdr;
+    }
   }
 
 #if OSALMEM_PROFILER
@@ -557,9 +783,72 @@ void osal_mem_free(void *ptr)
   blkFree++;
 #endif
 
+#if OSALMEM_SIZE_CLASSES
+  if (cls < OSALMEM_CLASS_CNT)
+  {
+    // Keep the block, still marked in-use, on its class free list.
+#if OSALMEM_SITE_TAGS
+    OSALMEM_TAG(hdr)->line = 0;  // Not allocated: osal_heap_map() counts it as free.
+#endif
+    *(osalMemHdr_t **)OSALMEM_PAYLOAD(hdr) = classFree[cls];
+    classFree[cls] = hdr;
+#if OSALMEM_METRICS
+    classCnt[cls]++;
+#endif
+  }
+#endif
+
   HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
 }
 
+#if OSALMEM_SIZE_CLASSES
+/**************************************************************************************************
+ * @fn          osalMemClassFlush
+ *
+ * @brief       Return every block held on the size class free lists to the heap so that it can
+ *              be coalesced by the first-fit walk. Ints must be disabled.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if any block was returned to the heap, FALSE otherwise.
+ */
+static uint8 osalMemClassFlush(void)
+{
+  uint8 flushed = FALSE;
+  uint8 cls;
+
+  for (cls = 0; cls < OSALMEM_CLASS_CNT; cls++)
+  {
+    while (classFree[cls] != NULL)
+    {
+      osalMemHdr_t *hdr = classFree[cls];
+
+      classFree[cls] = *(osalMemHdr_t **)OSALMEM_PAYLOAD(hdr);
+      hdr->hdr.inUse = FALSE;
+
+      if (ff1 > hdr)
+      {
+        ff1 = hdr;
+      }
+
+      flushed = TRUE;
+    }
+
+#if OSALMEM_METRICS
+    classCnt[cls] = 0;
+#endif
+  }
+
+  return flushed;
+}
+#endif
+
 #if OSALMEM_METRICS
 /*********************************************************************
  * @fn      osal_heap_block_max
@@ -616,6 +905,268 @@ uint16 osal_heap_mem_used( void )
 {
   return memAlo;
 }
+
+/*********************************************************************
+ * @fn      osal_heap_largest_free
+ *
+ * @brief   Return the size of the largest block that could be allocated
+ *          right now, after coalescing adjacent free blocks.
+ *
+ * @param   pTotal - if not NULL, set to the total bytes of free memory,
+ *                   including blocks held on the size class free lists.
+ *
+ * @return  Size in bytes, including the block header.
+ */
+uint16 osal_heap_largest_free( uint16 *pTotal )
+{
+  osalMemHdr_t *hdr;
+  halIntState_t intState;
+  uint16 run = 0;
+  uint16 largest = 0;
+  uint16 total = 0;
+#if OSALMEM_SIZE_CLASSES
+  uint8 cls;
+#endif
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+  for ( hdr = theHeap; hdr->val != 0; hdr = (osalMemHdr_t *)((uint8 *)hdr + hdr->hdr.len) )
+  {
+    if ( hdr->hdr.inUse )
+    {
+      run = 0;
+    }
+    else
+    {
+      run += hdr->hdr.len;
+      total += hdr->hdr.len;
+      if ( largest < run )
+      {
+        largest = run;
+      }
+    }
+  }
+
+#if OSALMEM_SIZE_CLASSES
+  for ( cls = 0; cls < OSALMEM_CLASS_CNT; cls++ )
+  {
+    total += classCnt[cls] * osalMemClassSz[cls];
+  }
+#endif
+
+  HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
+
+  if ( pTotal != NULL )
+  {
+    *pTotal = total;
+  }
+
+  return largest;
+}
+
+/*********************************************************************
+ * @fn      osal_heap_fragmentation
+ *
+ * @brief   Return the heap fragmentation: the percentage of the free
+ *          memory that is not part of the largest free block.
+ *
+ * @param   none
+ *
+ * @return  Fragmentation, 0 to 100 percent.
+ */
+uint8 osal_heap_fragmentation( void )
+{
+  uint16 total;
+  uint16 largest = osal_heap_largest_free( &total );
+
+  if ( largest >= total )
+  {
+    return 0;
+  }
+
+  return (uint8)(100 - (((uint32)largest * 100) / total));
+}
+
+#if OSALMEM_SIZE_CLASSES
+/*********************************************************************
+ * @fn      osal_heap_class_stat
+ *
+ * @brief   Return the counters of one heap size class.
+ *
+ * @param   cls - index of the size class
+ * @param   pStat - pointer to the counters to fill in
+ *
+ * @return  FALSE if there is no such size class, TRUE otherwise.
+ */
+uint8 osal_heap_class_stat( uint8 cls, osalMemClassStat_t *pStat )
+{
+  halIntState_t intState;
+
+  if ( cls >= OSALMEM_CLASS_CNT )
+  {
+    return FALSE;
+  }
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+  pStat->blkSz = osalMemClassSz[cls];
+  pStat->hit = classHit[cls];
+  pStat->miss = classMiss[cls];
+  pStat->freeCnt = classCnt[cls];
+  HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
+
+  return TRUE;
+}
+#endif
+#endif
+
+#if OSALMEM_SITE_TAGS
+/*********************************************************************
+ * @fn      osal_heap_map
+ *
+ * @brief   Walk the heap and summarize it: the size distribution of
+ *          the free fragments, the allocated blocks by age, and the
+ *          allocation sites holding the most memory. Interrupts are
+ *          held off for the whole walk.
+ *
+ * @param   pMap - pointer to the summary to fill in
+ *
+ * @return  none
+ */
+void osal_heap_map( osalMemMap_t *pMap )
+{
+  osalMemHdr_t *hdr;
+  halIntState_t intState;
+  uint16 now;
+  uint16 run = 0;
+  uint8 siteCnt = 0;
+  uint8 idx;
+
+  (void)osal_memset( pMap, 0, sizeof( osalMemMap_t ) );
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+  now = (uint16)(osal_GetSystemClock() >> 10);
+
+  for ( hdr = theHeap; ; hdr = (osalMemHdr_t *)((uint8 *)hdr + hdr->hdr.len) )
+  {
+    if ( (hdr->val != 0) && !hdr->hdr.inUse )
+    {
+      run += hdr->hdr.len;
+      continue;
+    }
+
+    if ( run != 0 )
+    {
+      uint16 lim = 16;
+
+      for ( idx = 0; (idx < (OSALMEM_MAP_BUCKETS - 1)) && (run > lim); idx++ )
+      {
+        lim <<= 1;
+      }
+      pMap->freeHist[idx]++;
+      pMap->freeCnt++;
+      pMap->freeBytes += run;
+      if ( pMap->largestFree < run )
+      {
+        pMap->largestFree = run;
+      }
+      run = 0;
+    }
+
+    if ( hdr->val == 0 )
+    {
+      break;
+    }
+
+    if ( hdr->hdr.len == OSALMEM_HDRSZ )
+    {
+      continue;  // The zero-length block fencing off the small-block bucket.
+    }
+
+    if ( OSALMEM_TAG(hdr)->line == 0 )
+    {
+      pMap->heldCnt++;
+      pMap->freeBytes += hdr->hdr.len;
+      continue;
+    }
+
+    pMap->usedCnt++;
+    pMap->usedBytes += hdr->hdr.len;
+
+    if ( (uint16)(now - OSALMEM_TAG(hdr)->birth) >= OSALMEM_LONG_LIVED_AGE )
+    {
+      pMap->longCnt++;
+      pMap->longBytes += hdr->hdr.len;
+    }
+
+    osalMemMapSite( pMap, &siteCnt, OSALMEM_TAG(hdr), hdr->hdr.len );
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
+
+  pMap->siteCnt = siteCnt;
+
+  // Selection of the biggest sites; the table is small and this runs on request only.
+  for ( idx = 0; (idx < OSALMEM_MAP_SITES) && (idx < siteCnt); idx++ )
+  {
+    uint8 best = idx;
+    uint8 cnt;
+
+    for ( cnt = idx + 1; cnt < siteCnt; cnt++ )
+    {
+      if ( mapSite[cnt].bytes > mapSite[best].bytes )
+      {
+        best = cnt;
+      }
+    }
+
+    pMap->site[idx] = mapSite[best];
+    mapSite[best] = mapSite[idx];
+  }
+}
+
+/*********************************************************************
+ * @fn      osalMemMapSite
+ *
+ * @brief   Account an allocated block to its site during osal_heap_map().
+ *
+ * @param   pMap - pointer to the summary being filled in
+ * @param   pCnt - pointer to the number of sites tracked so far
+ * @param   tag - the site tag of the block
+ * @param   len - the block length
+ *
+ * @return  none
+ */
+static void osalMemMapSite( osalMemMap_t *pMap, uint8 *pCnt, osalMemTag_t *tag, uint16 len )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < *pCnt; idx++ )
+  {
+    if ( (mapSite[idx].line == tag->line) && (mapSite[idx].file == tag->file) )
+    {
+      break;
+    }
+  }
+
+  if ( idx == *pCnt )
+  {
+    if ( idx == OSALMEM_MAP_SLOTS )
+    {
+      pMap->otherBytes += len;
+      return;
+    }
+
+    mapSite[idx].file = tag->file;
+    mapSite[idx].line = tag->line;
+    mapSite[idx].blkCnt = 0;
+    mapSite[idx].bytes = 0;
+    (*pCnt)++;
+  }
+
+  mapSite[idx].blkCnt++;
+  mapSite[idx].bytes += len;
+}
 #endif
 
 #if defined (ZTOOL_P1) || defined (ZTOOL_P2)
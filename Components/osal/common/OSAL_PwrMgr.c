@@ -47,6 +47,7 @@
 #include "OSAL_Tasks.h"
 #include "OSAL_Timers.h"
 #include "OSAL_PwrMgr.h"
+#include "OSAL_Nv.h"
 
 #ifdef USE_ICALL
 #include <ICall.h>
@@ -242,12 +243,21 @@ void osal_pwrmgr_powerconserve( void )
       // Hold off interrupts.
       HAL_ENTER_CRITICAL_SECTION( intState );
 
-      // Get next time-out
+      // Get next time-out - with slack timers, the latest time that still
+      // serves every timer whose window has opened, so they share one wakeup
       next = osal_next_timeout();
 
       // Re-enable interrupts.
       HAL_EXIT_CRITICAL_SECTION( intState );
 
+#if OSAL_NV_CACHE
+      // Nothing may wake the device to flush cached NV items; write them now.
+      if ( next == 0 )
+      {
+        (void)osal_nv_flush();
+      }
+#endif
+
       // Put the processor into sleep mode
       OSAL_SET_CPU_INTO_SLEEP( next );
     }
@@ -51,26 +51,50 @@
  * MACROS
  */
 
+// Signed distance between two absolute times, safe across clock roll over.
+// Only correct while the times are less than 2^31 ms apart, which is why
+// osalAddTimer() clamps timeouts to OSAL_TIMERS_TIMEOUT_MAX.
+#define OSAL_TIMER_DIFF( a, b )     ((int32)((uint32)(a) - (uint32)(b)))
+
+#define OSAL_TIMER_HASH( task_id, event_flag ) \
+  (((task_id) + osalTimerFold( event_flag )) & (OSAL_TIMERS_HASH_SIZE - 1))
+
 /*********************************************************************
  * CONSTANTS
  */
 
+// Number of buckets used to look up a timer by task ID and event flag.
+// Must be a power of 2.
+#if !defined OSAL_TIMERS_HASH_SIZE
+#define OSAL_TIMERS_HASH_SIZE   16
+#endif
+
+// Number of heap slots added each time the deadline heap has to grow.
+#if !defined OSAL_TIMERS_HEAP_GROW
+#define OSAL_TIMERS_HEAP_GROW   8
+#endif
+
+// Most timers that can be active at once; the heap index is a uint16.
+#if !defined OSAL_TIMERS_HEAP_MAX
+#define OSAL_TIMERS_HEAP_MAX    0xFFFF
+#endif
+
+// Longest timeout (ms), about 24.8 days. A longer one is shortened to this,
+// since a deadline 2^31 ms or more ahead would look as if it had passed.
+#define OSAL_TIMERS_TIMEOUT_MAX 0x7FFFFFFFUL
+
 /*********************************************************************
  * TYPEDEFS
  */
 
-typedef union {
-  uint32 time32;
-  uint16 time16[2];
-  uint8 time8[4];
-} osalTime_t;
-
 typedef struct
 {
-  void   *next;
-  osalTime_t timeout;
+  void   *next;           // Next timer in the same hash bucket
+  uint32 deadline;        // Absolute expiry time, in osal_systemClock ms
   uint16 event_flag;
   uint8  task_id;
+  uint16 heapIdx;         // Position of this timer in timerHeap[]
+  uint16 slack;           // Allowed lateness (ms) so the expiry can share a wakeup
   uint32 reloadTimeout;
 } osalTimerRec_t;
 
@@ -78,8 +102,6 @@ typedef struct
  * GLOBAL VARIABLES
  */
 
-osalTimerRec_t *timerHead;
-
 /*********************************************************************
  * EXTERNAL VARIABLES
  */
@@ -94,6 +116,17 @@ osalTimerRec_t *timerHead;
 // Milliseconds since last reboot
 static uint32 osal_systemClock;
 
+// Binary min-heap of active timers ordered by deadline - the root expires first.
+static osalTimerRec_t **timerHeap;
+static uint16 timerHeapCnt;
+static uint16 timerHeapMax;
+
+// Number of active timers with a non-zero slack
+static uint16 timerSlackCnt;
+
+// Hash buckets for finding a timer by task ID and event flag.
+static osalTimerRec_t *timerHash[OSAL_TIMERS_HASH_SIZE];
+
 /*********************************************************************
  * LOCAL FUNCTION PROTOTYPES
  */
@@ -101,6 +134,13 @@ osalTimerRec_t  *osalAddTimer( uint8 task_id, uint16 event_flag, uint32 timeout
 osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag );
 void osalDeleteTimer( osalTimerRec_t *rmTimer );
 
+static uint8 osalTimerFold( uint16 event_flag );
+static void osalHeapSet( uint16 idx, osalTimerRec_t *tmr );
+static void osalHeapSiftUp( uint16 idx );
+static void osalHeapSiftDown( uint16 idx );
+static void osalHeapRemove( osalTimerRec_t *rmTimer );
+static void osalHashRemove( osalTimerRec_t *rmTimer );
+
 /*********************************************************************
  * FUNCTIONS
  *********************************************************************/
@@ -117,12 +157,188 @@ void osalDeleteTimer( osalTimerRec_t *rmTimer );
 void osalTimerInit( void )
 {
   osal_systemClock = 0;
+
+  // Forget the timers of an earlier power-up; osal_mem_init() took back their memory.
+  timerHeap = NULL;
+  timerHeapCnt = 0;
+  timerHeapMax = 0;
+  timerSlackCnt = 0;
+  osal_memset( timerHash, 0, sizeof( timerHash ) );
+}
+
+/*********************************************************************
+ * @fn      osalTimerFold
+ *
+ * @brief   Fold an event flag, usually a single bit, into a small
+ *          number for the timer hash.
+ *
+ * @param   event_flag
+ *
+ * @return  folded value
+ */
+static uint8 osalTimerFold( uint16 event_flag )
+{
+  uint8 fold = HI_UINT16( event_flag ) ^ LO_UINT16( event_flag );
+
+  return ( fold ^ (fold >> 4) );
+}
+
+/*********************************************************************
+ * @fn      osalHeapSet
+ *
+ * @brief   Place a timer in a heap slot and record the slot in the timer.
+ *          Ints must be disabled.
+ *
+ * @param   idx - heap slot
+ * @param   tmr - timer
+ *
+ * @return  none
+ */
+static void osalHeapSet( uint16 idx, osalTimerRec_t *tmr )
+{
+  timerHeap[idx] = tmr;
+  tmr->heapIdx = idx;
+}
+
+/*********************************************************************
+ * @fn      osalHeapSiftUp
+ *
+ * @brief   Move a timer towards the root until its parent expires first.
+ *          Ints must be disabled.
+ *
+ * @param   idx - heap slot of the timer to move
+ *
+ * @return  none
+ */
+static void osalHeapSiftUp( uint16 idx )
+{
+  osalTimerRec_t *tmr = timerHeap[idx];
+
+  while ( idx > 0 )
+  {
+    uint16 parent = (idx - 1) >> 1;
+
+    if ( OSAL_TIMER_DIFF( timerHeap[parent]->deadline, tmr->deadline ) <= 0 )
+    {
+      break;
+    }
+
+    osalHeapSet( idx, timerHeap[parent] );
+    idx = parent;
+  }
+
+  osalHeapSet( idx, tmr );
+}
+
+/*********************************************************************
+ * @fn      osalHeapSiftDown
+ *
+ * @brief   Move a timer away from the root until both children expire
+ *          after it.
+ *          Ints must be disabled.
+ *
+ * @param   idx - heap slot of the timer to move
+ *
+ * @return  none
+ */
+static void osalHeapSiftDown( uint16 idx )
+{
+  osalTimerRec_t *tmr = timerHeap[idx];
+
+  for ( ;; )
+  {
+    uint32 child = ((uint32)idx << 1) + 1;
+
+    if ( child >= timerHeapCnt )
+    {
+      break;
+    }
+
+    if ( (child + 1 < timerHeapCnt) &&
+         (OSAL_TIMER_DIFF( timerHeap[child + 1]->deadline, timerHeap[child]->deadline ) < 0) )
+    {
+      child++;
+    }
+
+    if ( OSAL_TIMER_DIFF( tmr->deadline, timerHeap[child]->deadline ) <= 0 )
+    {
+      break;
+    }
+
+    osalHeapSet( idx, timerHeap[child] );
+    idx = (uint16)child;
+  }
+
+  osalHeapSet( idx, tmr );
+}
+
+/*********************************************************************
+ * @fn      osalHeapRemove
+ *
+ * @brief   Take a timer out of the deadline heap.
+ *          Ints must be disabled.
+ *
+ * @param   rmTimer - timer to remove
+ *
+ * @return  none
+ */
+static void osalHeapRemove( osalTimerRec_t *rmTimer )
+{
+  uint16 idx = rmTimer->heapIdx;
+
+  timerHeapCnt--;
+
+  if ( idx != timerHeapCnt )
+  {
+    // Fill the hole with the last timer and restore the heap order
+    osalHeapSet( idx, timerHeap[timerHeapCnt] );
+
+    if ( (idx > 0) &&
+         (OSAL_TIMER_DIFF( timerHeap[(idx - 1) >> 1]->deadline, timerHeap[idx]->deadline ) > 0) )
+    {
+      osalHeapSiftUp( idx );
+    }
+    else
+    {
+      osalHeapSiftDown( idx );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      osalHashRemove
+ *
+ * @brief   Unlink a timer from its hash bucket.
+ *          Ints must be disabled.
+ *
+ * @param   rmTimer - timer to remove
+ *
+ * @return  none
+ */
+static void osalHashRemove( osalTimerRec_t *rmTimer )
+{
+  osalTimerRec_t **srchLink;
+
+  srchLink = &timerHash[OSAL_TIMER_HASH( rmTimer->task_id, rmTimer->event_flag )];
+
+  while ( *srchLink != NULL )
+  {
+    if ( *srchLink == rmTimer )
+    {
+      *srchLink = rmTimer->next;
+      break;
+    }
+
+    srchLink = (osalTimerRec_t **)&((*srchLink)->next);
+  }
+
+  rmTimer->next = NULL;
 }
 
 /*********************************************************************
  * @fn      osalAddTimer
  *
- * @brief   Add a timer to the timer list.
+ * @brief   Add a timer to the timer heap.
  *          Ints must be disabled.
  *
  * @param   task_id
@@ -134,63 +350,91 @@ void osalTimerInit( void )
 osalTimerRec_t * osalAddTimer( uint8 task_id, uint16 event_flag, uint32 timeout )
 {
   osalTimerRec_t *newTimer;
-  osalTimerRec_t *srchTimer;
+  uint8 bucket;
+
+  if ( timeout > OSAL_TIMERS_TIMEOUT_MAX )
+  {
+    timeout = OSAL_TIMERS_TIMEOUT_MAX;
+  }
 
   // Look for an existing timer first
   newTimer = osalFindTimer( task_id, event_flag );
   if ( newTimer )
   {
-    // Timer is found - update it.
-    newTimer->timeout.time32 = timeout;
+    // Timer is found - update it and move it to its new place in the heap.
+    if ( newTimer->slack )
+    {
+      newTimer->slack = 0;
+      timerSlackCnt--;
+    }
+    newTimer->deadline = osal_systemClock + timeout;
+    osalHeapSiftUp( newTimer->heapIdx );
+    osalHeapSiftDown( newTimer->heapIdx );
 
     return ( newTimer );
   }
-  else
+
+  // Make room in the heap if it is full
+  if ( timerHeapCnt == timerHeapMax )
   {
-    // New Timer
-    newTimer = osal_mem_alloc( sizeof( osalTimerRec_t ) );
+    osalTimerRec_t **newHeap;
+    uint32 newMax = (uint32)timerHeapMax + OSAL_TIMERS_HEAP_GROW;
 
-    if ( newTimer )
+    if ( newMax > OSAL_TIMERS_HEAP_MAX )
     {
-      // Fill in new timer
-      newTimer->task_id = task_id;
-      newTimer->event_flag = event_flag;
-      newTimer->timeout.time32 = timeout;
-      newTimer->next = (void *)NULL;
-      newTimer->reloadTimeout = 0;
-
-      // Does the timer list already exist
-      if ( timerHead == NULL )
-      {
-        // Start task list
-        timerHead = newTimer;
-      }
-      else
-      {
-        // Add it to the end of the timer list
-        srchTimer = timerHead;
-
-        // Stop at the last record
-        while ( srchTimer->next )
-          srchTimer = srchTimer->next;
-
-        // Add to the list
-        srchTimer->next = newTimer;
-      }
+      newMax = OSAL_TIMERS_HEAP_MAX;
+    }
 
-      return ( newTimer );
+    if ( newMax == timerHeapMax )
+    {
+      return ( (osalTimerRec_t *)NULL );
     }
-    else
+
+    newHeap = osal_mem_alloc( newMax * sizeof( osalTimerRec_t * ) );
+    if ( newHeap == NULL )
     {
       return ( (osalTimerRec_t *)NULL );
     }
+
+    if ( timerHeap != NULL )
+    {
+      VOID osal_memcpy( newHeap, timerHeap, timerHeapCnt * sizeof( osalTimerRec_t * ) );
+      osal_mem_free( timerHeap );
+    }
+
+    timerHeap = newHeap;
+    timerHeapMax = (uint16)newMax;
+  }
+
+  // New Timer
+  newTimer = osal_mem_alloc( sizeof( osalTimerRec_t ) );
+
+  if ( newTimer )
+  {
+    // Fill in new timer
+    newTimer->task_id = task_id;
+    newTimer->event_flag = event_flag;
+    newTimer->deadline = osal_systemClock + timeout;
+    newTimer->slack = 0;
+    newTimer->reloadTimeout = 0;
+
+    // Add it to the front of its hash bucket
+    bucket = OSAL_TIMER_HASH( task_id, event_flag );
+    newTimer->next = timerHash[bucket];
+    timerHash[bucket] = newTimer;
+
+    // Add it to the bottom of the heap and let it rise to its place
+    timerHeap[timerHeapCnt] = newTimer;
+    osalHeapSiftUp( timerHeapCnt++ );
   }
+
+  return ( newTimer );
 }
 
 /*********************************************************************
  * @fn      osalFindTimer
  *
- * @brief   Find a timer in a timer list.
+ * @brief   Find a timer in the timer hash.
  *          Ints must be disabled.
  *
  * @param   task_id
@@ -202,8 +446,8 @@ osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag )
 {
   osalTimerRec_t *srchTimer;
 
-  // Head of the timer list
-  srchTimer = timerHead;
+  // Head of the hash bucket
+  srchTimer = timerHash[OSAL_TIMER_HASH( task_id, event_flag )];
 
   // Stop when found or at the end
   while ( srchTimer )
@@ -224,21 +468,25 @@ osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag )
 /*********************************************************************
  * @fn      osalDeleteTimer
  *
- * @brief   Delete a timer from a timer list.
+ * @brief   Delete a timer from the timer heap and hash.
+ *          Ints must be disabled.
  *
- * @param   table
  * @param   rmTimer
  *
  * @return  none
  */
 void osalDeleteTimer( osalTimerRec_t *rmTimer )
 {
-  // Does the timer list really exist
+  // Does the timer really exist
   if ( rmTimer )
   {
-    // Clear the event flag and osalTimerUpdate() will delete
-    // the timer from the list.
-    rmTimer->event_flag = 0;
+    if ( rmTimer->slack )
+    {
+      timerSlackCnt--;
+    }
+    osalHeapRemove( rmTimer );
+    osalHashRemove( rmTimer );
+    osal_mem_free( rmTimer );
   }
 }
 
@@ -252,7 +500,8 @@ void osalDeleteTimer( osalTimerRec_t *rmTimer )
  *
  * @param   uint8 taskID - task id to set timer for
  * @param   uint16 event_id - event to be notified with
- * @param   uint32 timeout_value - in milliseconds.
+ * @param   uint32 timeout_value - in milliseconds, at most
+ *          OSAL_TIMERS_TIMEOUT_MAX (longer ones are shortened to it).
  *
  * @return  SUCCESS, or NO_TIMER_AVAIL.
  */
@@ -271,6 +520,46 @@ uint8 osal_start_timerEx( uint8 taskID, uint16 event_id, uint32 timeout_value )
   return ( (newTimer != NULL) ? SUCCESS : NO_TIMER_AVAIL );
 }
 
+/*********************************************************************
+ * @fn      osal_start_timerSlackEx
+ *
+ * @brief
+ *
+ *   This function is called to start a timer to expire in n mSecs, but
+ *   allows the expiry to be delayed by up to slack mSecs.  While the
+ *   device is awake the timer expires on time; when it sleeps, it sleeps
+ *   until the earliest time that is still inside every pending timer's
+ *   window, and all timers due by then expire on the same wakeup.
+ *   Restarting the timer with osal_start_timerEx() clears the slack.
+ *
+ * @param   uint8 taskID - task id to set timer for
+ * @param   uint16 event_id - event to be notified with
+ * @param   uint32 timeout_value - in milliseconds, at most
+ *          OSAL_TIMERS_TIMEOUT_MAX (longer ones are shortened to it).
+ * @param   uint16 slack - allowed lateness in milliseconds.
+ *
+ * @return  SUCCESS, or NO_TIMER_AVAIL.
+ */
+uint8 osal_start_timerSlackEx( uint8 taskID, uint16 event_id, uint32 timeout_value, uint16 slack )
+{
+  halIntState_t intState;
+  osalTimerRec_t *newTimer;
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+  // Add timer
+  newTimer = osalAddTimer( taskID, event_id, timeout_value );
+  if ( newTimer && slack )
+  {
+    newTimer->slack = slack;
+    timerSlackCnt++;
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+
+  return ( (newTimer != NULL) ? SUCCESS : NO_TIMER_AVAIL );
+}
+
 /*********************************************************************
  * @fn      osal_start_reload_timer
  *
@@ -282,7 +571,8 @@ uint8 osal_start_timerEx( uint8 taskID, uint16 event_id, uint32 timeout_value )
  *
  * @param   uint8 taskID - task id to set timer for
  * @param   uint16 event_id - event to be notified with
- * @param   UNINT16 timeout_value - in milliseconds.
+ * @param   uint32 timeout_value - in milliseconds, at most
+ *          OSAL_TIMERS_TIMEOUT_MAX (longer ones are shortened to it).
  *
  * @return  SUCCESS, or NO_TIMER_AVAIL.
  */
@@ -298,7 +588,8 @@ uint8 osal_start_reload_timer( uint8 taskID, uint16 event_id, uint32 timeout_val
   if ( newTimer )
   {
     // Load the reload timeout value
-    newTimer->reloadTimeout = timeout_value;
+    newTimer->reloadTimeout = (timeout_value > OSAL_TIMERS_TIMEOUT_MAX) ?
+                              OSAL_TIMERS_TIMEOUT_MAX : timeout_value;
   }
 
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
@@ -359,9 +650,9 @@ uint32 osal_get_timeoutEx( uint8 task_id, uint16 event_id )
 
   tmr = osalFindTimer( task_id, event_id );
 
-  if ( tmr )
+  if ( tmr && (OSAL_TIMER_DIFF( tmr->deadline, osal_systemClock ) > 0) )
   {
-    rtrn = tmr->timeout.time32;
+    rtrn = tmr->deadline - osal_systemClock;
   }
 
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
@@ -376,35 +667,18 @@ uint32 osal_get_timeoutEx( uint8 task_id, uint16 event_id )
  *
  *   This function counts the number of active timers.
  *
- * @return  uint8 - number of timers
+ * @return  uint16 - number of timers
  */
-uint8 osal_timer_num_active( void )
+uint16 osal_timer_num_active( void )
 {
-  halIntState_t intState;
-  uint8 num_timers = 0;
-  osalTimerRec_t *srchTimer;
-
-  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
-
-  // Head of the timer list
-  srchTimer = timerHead;
-
-  // Count timers in the list
-  while ( srchTimer != NULL )
-  {
-    num_timers++;
-    srchTimer = srchTimer->next;
-  }
-
-  HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
-
-  return num_timers;
+  return timerHeapCnt;
 }
 
 /*********************************************************************
  * @fn      osalTimerUpdate
  *
- * @brief   Update the timer structures for a timer tick.
+ * @brief   Update the timer structures for a timer tick. Only the
+ *          timers that expire are visited, in deadline order.
  *
  * @param   none
  *
@@ -414,113 +688,65 @@ void osalTimerUpdate( uint32 updateTime )
 {
   halIntState_t intState;
   osalTimerRec_t *srchTimer;
-  osalTimerRec_t *prevTimer;
-
-  osalTime_t timeUnion;
-  timeUnion.time32 = updateTime;
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
   // Update the system time
   osal_systemClock += updateTime;
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
 
-  // Look for open timer slot
-  if ( timerHead != NULL )
+  for ( ;; )
   {
-    // Add it to the end of the timer list
-    srchTimer = timerHead;
-    prevTimer = (void *)NULL;
+    osalTimerRec_t *freeTimer = NULL;
+    uint16 event_flag = 0;
+    uint8 task_id = 0;
 
-    // Look for open timer slot
-    while ( srchTimer )
-    {
-      osalTimerRec_t *freeTimer = NULL;
+    HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
 
-      HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+    // The root of the heap is the timer that expires first
+    srchTimer = (timerHeapCnt != 0) ? timerHeap[0] : NULL;
 
-      // To minimize time in this critical section, avoid 32-bit math
-      if ((timeUnion.time16[1] == 0) && (timeUnion.time8[1] == 0))
-      {
-        // If upper 24 bits are zero, check lower 8 bits for roll over
-        if (srchTimer->timeout.time8[0] >= timeUnion.time8[0])
-        {
-          // 8-bit math
-          srchTimer->timeout.time8[0] -= timeUnion.time8[0];
-        }
-        else
-        {
-          // 32-bit math
-          if (srchTimer->timeout.time32 > timeUnion.time32)
-          {
-            srchTimer->timeout.time32 -= timeUnion.time32;
-          }
-          else
-          {
-            srchTimer->timeout.time32 = 0;
-          }
-        }
-      }
-      else
-      {
-          // 32-bit math
-        if (srchTimer->timeout.time32 > timeUnion.time32)
-        {
-          srchTimer->timeout.time32 -= timeUnion.time32;
-        }
-        else
-        {
-          srchTimer->timeout.time32 = 0;
-        }
-      }
+    if ( (srchTimer != NULL) &&
+         (OSAL_TIMER_DIFF( srchTimer->deadline, osal_systemClock ) <= 0) )
+    {
+      task_id = srchTimer->task_id;
+      event_flag = srchTimer->event_flag;
 
-      // Check for reloading
-      if ( (srchTimer->timeout.time16[0] == 0) && (srchTimer->timeout.time16[1] == 0) &&
-           (srchTimer->reloadTimeout) && (srchTimer->event_flag) )
+      if ( srchTimer->reloadTimeout )
       {
-        // Notify the task of a timeout
-        osal_set_event( srchTimer->task_id, srchTimer->event_flag );
-
         // Reload the timer timeout value
-        srchTimer->timeout.time32 = srchTimer->reloadTimeout;
+        srchTimer->deadline = osal_systemClock + srchTimer->reloadTimeout;
+        osalHeapSiftDown( 0 );
       }
-
-      // When timeout or delete (event_flag == 0)
-      if ( ((srchTimer->timeout.time16[0] == 0) && (srchTimer->timeout.time16[1] == 0)) ||
-            (srchTimer->event_flag == 0) )
+      else
       {
-        // Take out of list
-        if ( prevTimer == NULL )
+        // Take out of the heap and hash, setup to free memory
+        if ( srchTimer->slack )
         {
-          timerHead = srchTimer->next;
+          timerSlackCnt--;
         }
-        else
-        {
-          prevTimer->next = srchTimer->next;
-        }
-
-        // Setup to free memory
+        osalHeapRemove( srchTimer );
+        osalHashRemove( srchTimer );
         freeTimer = srchTimer;
-
-        // Next
-        srchTimer = srchTimer->next;
-      }
-      else
-      {
-        // Get next
-        prevTimer = srchTimer;
-        srchTimer = srchTimer->next;
       }
+    }
+    else
+    {
+      srchTimer = NULL;
+    }
 
-      HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+    HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
 
-      if ( freeTimer )
-      {
-        if ( (freeTimer->timeout.time16[0] == 0) && (freeTimer->timeout.time16[1] == 0) )
-        {
-          osal_set_event( freeTimer->task_id, freeTimer->event_flag );
-        }
-        osal_mem_free( freeTimer );
-      }
+    if ( srchTimer == NULL )
+    {
+      break;
+    }
+
+    // Notify the task of a timeout
+    osal_set_event( task_id, event_flag );
+
+    if ( freeTimer )
+    {
+      osal_mem_free( freeTimer );
     }
   }
 }
@@ -539,7 +765,7 @@ void osal_adjust_timers( void )
 {
   uint32 eTime;
 
-  if ( timerHead != NULL )
+  if ( timerHeapCnt != 0 )
   {
     // Compute elapsed time (msec)
     eTime = TimerElapsed() / TICK_COUNT;
@@ -558,8 +784,12 @@ void osal_adjust_timers( void )
  *
  * @brief
  *
- *   Search timer table to return the lowest timeout value. If the
- *   timer list is empty, then the returned timeout will be zero.
+ *   Return the time until the next wakeup is needed. Without slack
+ *   timers this is the deadline at the root of the timer heap. With
+ *   them it is the earliest end of any timer's slack window, so that
+ *   every timer whose window has opened by then expires on the same
+ *   wakeup. If there are no timers, then the returned timeout will be
+ *   zero.
  *
  * @param   none
  *
@@ -568,24 +798,56 @@ void osal_adjust_timers( void )
 uint32 osal_next_timeout( void )
 {
   uint32 nextTimeout;
-  osalTimerRec_t *srchTimer;
+  halIntState_t intState;
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
 
-  if ( timerHead != NULL )
+  if ( timerHeapCnt != 0 )
   {
-    // Head of the timer list
-    srchTimer = timerHead;
-    nextTimeout = OSAL_TIMERS_MAX_TIMEOUT;
+    int32 remaining = OSAL_TIMER_DIFF( timerHeap[0]->deadline, osal_systemClock );
 
-    // Look for the next timeout timer
-    while ( srchTimer != NULL )
+    if ( timerSlackCnt != 0 )
     {
-      if (srchTimer->timeout.time32 < nextTimeout)
+      uint16 idx = 0;
+
+      // Start from the root's window; a timer not yet due by the best window end cannot beat it,
+      // and neither can any timer below it in the heap, so its whole subtree is skipped.
+      remaining += timerHeap[0]->slack;
+
+      for ( ;; )
       {
-        nextTimeout = srchTimer->timeout.time32;
+        int32 windowEnd = OSAL_TIMER_DIFF( timerHeap[idx]->deadline, osal_systemClock );
+
+        if ( windowEnd < remaining )
+        {
+          windowEnd += timerHeap[idx]->slack;
+          if ( windowEnd < remaining )
+          {
+            remaining = windowEnd;
+          }
+
+          // Descend to the first child
+          if ( ((uint32)idx << 1) + 1 < timerHeapCnt )
+          {
+            idx = (idx << 1) + 1;
+            continue;
+          }
+        }
+
+        // Climb out of finished subtrees to the next left child (odd index) with a right sibling
+        while ( (idx != 0) && (((idx & 1) == 0) || (idx + 1 >= timerHeapCnt)) )
+        {
+          idx = (idx - 1) >> 1;
+        }
+        if ( idx == 0 )
+        {
+          break;
+        }
+        idx++;
       }
-      // Check next timer
-      srchTimer = srchTimer->next;
     }
+
+    nextTimeout = (remaining > 0) ? (uint32)remaining : 0;
   }
   else
   {
@@ -593,6 +855,8 @@ uint32 osal_next_timeout( void )
     nextTimeout = 0;
   }
 
+  HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+
   return ( nextTimeout );
 }
 #endif // POWER_SAVING || USE_ICALL
@@ -90,6 +90,78 @@ extern "C"
 /*** Interrupts ***/
 #define INTS_ALL    0xFF
 
+/*** Message Pools ***/
+// Fixed-size message pools serve osal_msg_allocate() requests in O(1) from reserved RAM and
+// fall back to the heap only when the fitting pool is exhausted or the message is too large.
+#if !defined OSAL_MSG_POOLS
+  #define OSAL_MSG_POOLS            FALSE
+#endif
+
+#if ( OSAL_MSG_POOLS ) && defined USE_ICALL
+  #error "OSAL_MSG_POOLS is not supported with USE_ICALL - ICall owns the message buffers."
+#endif
+
+#define OSAL_MSG_POOL_SMALL         0   // keyChange_t, osal_event_hdr_t based events
+#define OSAL_MSG_POOL_MEDIUM        1   // zdoIncomingMsg_t, debug strings
+#define OSAL_MSG_POOL_LARGE         2   // afIncomingMSGPacket_t, mtOSALSerialData_t
+#define OSAL_MSG_POOL_CNT           3
+
+// Payload length (excluding the OSAL message header) and block count of each pool
+#if !defined OSAL_MSG_POOL_SMALL_LEN
+  #define OSAL_MSG_POOL_SMALL_LEN   8
+#endif
+#if !defined OSAL_MSG_POOL_SMALL_CNT
+  #define OSAL_MSG_POOL_SMALL_CNT   8
+#endif
+#if !defined OSAL_MSG_POOL_MEDIUM_LEN
+  #define OSAL_MSG_POOL_MEDIUM_LEN  48
+#endif
+#if !defined OSAL_MSG_POOL_MEDIUM_CNT
+  #define OSAL_MSG_POOL_MEDIUM_CNT  4
+#endif
+#if !defined OSAL_MSG_POOL_LARGE_LEN
+  #define OSAL_MSG_POOL_LARGE_LEN   128
+#endif
+#if !defined OSAL_MSG_POOL_LARGE_CNT
+  #define OSAL_MSG_POOL_LARGE_CNT   2
+#endif
+
+/*** Shared Messages ***/
+// Shared messages are reference counted so that one buffer can be sent to several tasks without
+// copying; each receiver gets the same read-only payload and the last deallocation frees it.
+#if !defined OSAL_MSG_SHARED
+  #define OSAL_MSG_SHARED           FALSE
+#endif
+
+#if ( OSAL_MSG_SHARED ) && defined USE_ICALL
+  #error "OSAL_MSG_SHARED is not supported with USE_ICALL - ICall owns the message buffers."
+#endif
+
+// Value of dest_id marking a shared message, which is never queued directly.
+// Sending a shared message never hands over the sender's reference: a receiver that forwards
+// one with osal_msg_send() must still osal_msg_deallocate() it afterwards, unlike a plain
+// message whose ownership moves with the send.
+#define OSAL_MSG_SHARED_ID          0xFE
+
+/*** Task Profiling ***/
+// Per-task handler run time and event latency accounting in osal_run_system().
+// Compiles out completely when FALSE.
+#if !defined OSAL_PROFILE
+  #define OSAL_PROFILE              FALSE
+#endif
+
+#if ( OSAL_PROFILE ) && defined USE_ICALL
+  #error "OSAL_PROFILE is not supported with USE_ICALL."
+#endif
+
+// Number of event bits tracked per task
+#define OSAL_PROFILE_EVENT_BITS     16
+
+// Resolution of profile times in microseconds - must match OSAL_PROFILE_TIMESTAMP() in OSAL.c
+#if !defined OSAL_PROFILE_TICK_US
+  #define OSAL_PROFILE_TICK_US      320
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -117,6 +189,29 @@ typedef struct
 
 typedef void * osal_msg_q_t;
 
+#if ( OSAL_MSG_POOLS )
+// Message pool usage, as reported by osal_msg_pool_stat()
+typedef struct
+{
+  uint16 len;        // Payload length of each block
+  uint8  blkCnt;     // Number of blocks reserved for the pool
+  uint8  used;       // Blocks currently allocated
+  uint8  maxUsed;    // High-water mark of allocated blocks
+  uint16 fallback;   // Allocations that went to a larger pool or the heap because the pool was empty
+} osalMsgPoolStat_t;
+#endif
+
+#if ( OSAL_PROFILE )
+// Task profile, as reported by osal_profile_get() - times are in OSAL_PROFILE_TICK_US units
+typedef struct
+{
+  uint32 runCnt;                                 // Handler invocations
+  uint32 runTime;                                // Cumulative handler run time
+  uint32 maxRunTime;                             // Longest single handler run
+  uint16 maxLatency[OSAL_PROFILE_EVENT_BITS];    // Longest set-to-serviced time per event bit
+} osalProfileStat_t;
+#endif
+
 #ifdef USE_ICALL
 /* High resolution timer callback function type */
 typedef void (*osal_highres_timer_cback_t)(void *arg);
@@ -199,11 +294,45 @@ extern void (*osal_eventloop_hook)(void);
    */
   extern void osal_msg_extract( osal_msg_q_t *q_ptr, void *msg_ptr, void *prev_ptr );
 
+#if ( OSAL_MSG_SHARED )
+  /*
+   * Allocate a reference counted Task Message that can be sent to several tasks
+   */
+  extern uint8 *osal_msg_allocate_shared( uint16 len );
+#endif
+
+#if ( OSAL_MSG_POOLS )
+  /*
+   * Allocate a Task Message from a specific message pool
+   */
+  extern uint8 *osal_msg_pool_allocate( uint8 pool, uint16 len );
+
+  /*
+   * Report the usage and high-water mark of a message pool
+   */
+  extern uint8 osal_msg_pool_stat( uint8 pool, osalMsgPoolStat_t *pStat );
+#endif
+
 #ifdef USE_ICALL
   extern ICall_Errno osal_service_entry(ICall_FuncArgsHdr *args);
 #endif /* USE_ICALL */
 
 
+/*** Task Profiling ***/
+
+#if ( OSAL_PROFILE )
+  /*
+   * Read the profile of a task
+   */
+  extern uint8 osal_profile_get( uint8 task_id, osalProfileStat_t *pStat );
+
+  /*
+   * Clear the profiles of all tasks
+   */
+  extern void osal_profile_reset( void );
+#endif
+
+
 /*** Task Synchronization  ***/
 
   /*
@@ -276,6 +405,16 @@ extern void (*osal_eventloop_hook)(void);
    */
   extern void osal_run_system( void );
 
+  /*
+   * Find the highest priority ready task, starting from a task ID
+   */
+  extern uint8 osal_next_ready( uint8 first );
+
+  /*
+   * Dispatch the pending events of one task, as osal_run_system() does
+   */
+  extern void osal_run_task( uint8 idx );
+
   /*
    * Get the active task ID
    */
@@ -58,16 +58,102 @@ extern "C"
   #define OSALMEM_METRICS  FALSE
 #endif
 
+// Segregated size class free lists for mid-sized allocations (see OSALMEM_CLASS_SIZES).
+#if !defined ( OSALMEM_SIZE_CLASSES )
+  #define OSALMEM_SIZE_CLASSES  FALSE
+#endif
+
+// Tag every heap block with its allocation site and age for osal_heap_map().
+#if !defined ( OSALMEM_SITE_TAGS )
+  #define OSALMEM_SITE_TAGS  FALSE
+#endif
+
+#if ( OSALMEM_SITE_TAGS )
+#if defined ( DPRINTF_OSALHEAPTRACE )
+  #error "OSALMEM_SITE_TAGS and DPRINTF_OSALHEAPTRACE both wrap osal_mem_alloc()."
+#endif
+
+// Allocation sites reported by osal_heap_map(), biggest first.
+#if !defined ( OSALMEM_MAP_SITES )
+  #define OSALMEM_MAP_SITES  4
+#endif
+
+// Distinct allocation sites tracked during one heap walk; the rest are lumped together.
+#if !defined ( OSALMEM_MAP_SLOTS )
+  #define OSALMEM_MAP_SLOTS  16
+#endif
+
+// Buckets of the free fragment histogram: up to 16, 32, 64, 128, 256 bytes and bigger.
+#define OSALMEM_MAP_BUCKETS  6
+
+// Allocated blocks at least this old, in units of 1.024 seconds, count as long-lived.
+#if !defined ( OSALMEM_LONG_LIVED_AGE )
+  #define OSALMEM_LONG_LIVED_AGE  60
+#endif
+#endif
+
 /*********************************************************************
  * MACROS
  */
   
 #define osal_stack_used()  OnBoard_stack_used()
 
+#if ( OSALMEM_SITE_TAGS )
+/* Identify the source file of an allocation site by hashing the six characters before its ".c".
+ * The indices are constant, so compilers fold this into an immediate operand.
+ */
+#define OSALMEM_FILE_CHR(n)  ((sizeof(__FILE__) > (n)) ? (uint16)(uint8)__FILE__[sizeof(__FILE__) - (n)] : 0)
+#define OSALMEM_SITE_FILE    ((uint16)((OSALMEM_FILE_CHR(4))      ^ (OSALMEM_FILE_CHR(5) << 2) ^ \
+                                       (OSALMEM_FILE_CHR(6) << 4) ^ (OSALMEM_FILE_CHR(7) << 6) ^ \
+                                       (OSALMEM_FILE_CHR(8) << 8) ^ (OSALMEM_FILE_CHR(9) << 10)))
+
+/* Site of the blocks allocated through the osal_mem_alloc() function rather than the macro, e.g. by
+ * a library built without OSALMEM_SITE_TAGS or through a function pointer.
+ */
+#define OSALMEM_SITE_UNKNOWN_FILE  0
+#define OSALMEM_SITE_UNKNOWN_LINE  0xFFFF
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+#if ( OSALMEM_METRICS ) && ( OSALMEM_SIZE_CLASSES )
+typedef struct
+{
+  uint16 blkSz;    // Block size of the class, including the header.
+  uint16 hit;      // Allocations served from the class free list.
+  uint16 miss;     // Class allocations that fell back to the first-fit walk.
+  uint16 freeCnt;  // Blocks currently held on the class free list.
+} osalMemClassStat_t;
+#endif
+
+#if ( OSALMEM_SITE_TAGS )
+typedef struct
+{
+  uint16 file;     // OSALMEM_SITE_FILE of the allocating source file.
+  uint16 line;     // Allocating source line.
+  uint16 blkCnt;   // Blocks currently allocated from the site.
+  uint16 bytes;    // Bytes currently allocated from the site, including block overhead.
+} osalMemSiteStat_t;
+
+typedef struct
+{
+  uint16 freeCnt;      // Free fragments, i.e. runs of adjacent free blocks.
+  uint16 freeBytes;    // Free bytes, including blocks held on the size class free lists.
+  uint16 largestFree;  // Size of the largest free fragment.
+  uint16 heldCnt;      // Blocks held on the size class free lists.
+  uint16 freeHist[OSALMEM_MAP_BUCKETS];  // Free fragments by size bucket.
+  uint16 usedCnt;      // Allocated blocks.
+  uint16 usedBytes;    // Allocated bytes, including block overhead.
+  uint16 longCnt;      // Allocated blocks at least OSALMEM_LONG_LIVED_AGE old.
+  uint16 longBytes;    // Bytes held by those blocks.
+  uint8  siteCnt;      // Distinct allocation sites tracked, at most OSALMEM_MAP_SLOTS.
+  uint16 otherBytes;   // Allocated bytes from sites beyond OSALMEM_MAP_SLOTS.
+  osalMemSiteStat_t site[OSALMEM_MAP_SITES];  // Sites holding the most bytes.
+} osalMemMap_t;
+#endif
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -92,6 +178,10 @@ extern "C"
 #ifdef DPRINTF_OSALHEAPTRACE
   void *osal_mem_alloc_dbg( uint16 size, const char *fname, unsigned lnum );
 #define osal_mem_alloc(_size ) osal_mem_alloc_dbg(_size, __FILE__, __LINE__)
+#elif ( OSALMEM_SITE_TAGS )
+  void *osal_mem_alloc_site( uint16 size, uint16 file, uint16 line );
+  void *osal_mem_alloc( uint16 size );
+#define osal_mem_alloc(_size ) osal_mem_alloc_site(_size, OSALMEM_SITE_FILE, __LINE__)
 #else /* DPRINTF_OSALHEAPTRACE */
   void *osal_mem_alloc( uint16 size );
 #endif /* DPRINTF_OSALHEAPTRACE */
@@ -126,6 +216,30 @@ extern "C"
   * Return the current number of bytes allocated.
   */
   uint16 osal_heap_mem_used( void );
+
+ /*
+  * Return the size of the largest block that could be allocated now.
+  */
+  uint16 osal_heap_largest_free( uint16 *pTotal );
+
+ /*
+  * Return the percentage of free memory outside the largest free block.
+  */
+  uint8 osal_heap_fragmentation( void );
+
+#if ( OSALMEM_SIZE_CLASSES )
+ /*
+  * Return the hit/miss counters of a heap size class.
+  */
+  uint8 osal_heap_class_stat( uint8 cls, osalMemClassStat_t *pStat );
+#endif
+#endif
+
+#if ( OSALMEM_SITE_TAGS )
+ /*
+  * Walk the heap and summarize fragmentation, block ages and allocation sites.
+  */
+  void osal_heap_map( osalMemMap_t *pMap );
 #endif
 
 #if defined (ZTOOL_P1) || defined (ZTOOL_P2)
@@ -55,6 +55,37 @@ extern "C"
  * CONSTANTS
  */
 
+// Write-back cache of NV items: osal_nv_write() updates a RAM copy that is written to flash later.
+#if !defined OSAL_NV_CACHE
+  #define OSAL_NV_CACHE  FALSE
+#endif
+
+// Compact NV pages in bounded steps from the NV task instead of within osal_nv_write().
+#if !defined OSAL_NV_BG_COMPACT
+  #define OSAL_NV_BG_COMPACT  FALSE
+#endif
+
+// Atomic multi-item updates: osal_nv_write() calls between osal_nv_txn_begin() and
+// osal_nv_txn_commit() reach flash all together or not at all.
+#if !defined OSAL_NV_TXN
+  #define OSAL_NV_TXN  FALSE
+#endif
+
+// Go through the NV items in Id order and count the changes to them, so that a copy of all of NV
+// can be checked for a change made while it was being read.
+#if !defined OSAL_NV_SNAPSHOT
+  #define OSAL_NV_SNAPSHOT  FALSE
+#endif
+
+// The NV task runs the flush deadline of the cache and the background compaction.
+#define OSAL_NV_TASK  ( OSAL_NV_CACHE || OSAL_NV_BG_COMPACT )
+
+#if OSAL_NV_TASK
+// Events of the NV task, osal_nv_process_event()
+#define OSAL_NV_FLUSH_EVT    0x0001
+#define OSAL_NV_COMPACT_EVT  0x0002
+#endif
+
 /*********************************************************************
  * MACROS
  */
@@ -101,6 +132,54 @@ extern uint16 osal_nv_item_len( uint16 id );
  */
 extern uint8 osal_nv_delete( uint16 id, uint16 len );
 
+#if OSAL_NV_CACHE
+/*
+ * Write all items held in the NV cache to flash.
+ */
+extern uint8 osal_nv_flush( void );
+#endif
+
+#if OSAL_NV_TXN
+/*
+ * Start staging NV writes to be committed together.
+ */
+extern uint8 osal_nv_txn_begin( void );
+
+/*
+ * Write the NV writes staged since osal_nv_txn_begin() to flash, all or none of them.
+ */
+extern uint8 osal_nv_txn_commit( void );
+
+/*
+ * Drop the NV writes staged since osal_nv_txn_begin().
+ */
+extern void osal_nv_txn_abort( void );
+#endif
+
+#if OSAL_NV_SNAPSHOT
+/*
+ * Get the lowest Id of an NV item above 'id', zero if none.
+ */
+extern uint16 osal_nv_next_id( uint16 id );
+
+/*
+ * Get the count, wrapping, of the calls that may have changed NV items.
+ */
+extern uint16 osal_nv_changes( void );
+#endif
+
+#if OSAL_NV_TASK
+/*
+ * Initialize the NV task, which flushes the NV cache and compacts pages in the background.
+ */
+extern void osal_nv_task_init( uint8 task_id );
+
+/*
+ * Process the events of the NV task.
+ */
+extern uint16 osal_nv_process_event( uint8 task_id, uint16 events );
+#endif
+
 #if defined ( OSAL_NV_EXTENDED )
 /*
  * Initialize an item in NV (extended format)
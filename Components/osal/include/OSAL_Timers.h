@@ -81,6 +81,12 @@ extern "C"
    * Set a Timer
    */
   extern uint8 osal_start_timerEx( uint8 task_id, uint16 event_id, uint32 timeout_value );
+
+  /*
+   * Set a Timer that may expire up to slack ms late to share a wakeup
+   */
+  extern uint8 osal_start_timerSlackEx( uint8 task_id, uint16 event_id,
+                                        uint32 timeout_value, uint16 slack );
   
   /*
    * Set a timer that reloads itself.
@@ -116,7 +122,7 @@ extern "C"
   /*
    * Count active timers
    */
-  extern uint8 osal_timer_num_active( void );
+  extern uint16 osal_timer_num_active( void );
 
   /*
    * Set the hardware timer interrupts for sleep mode.
@@ -50,7 +50,9 @@
 #include "hal_adc.h"
 #include "hal_flash.h"
 #include "hal_types.h"
+#include "OSAL.h"
 #include "OSAL_Nv.h"
+#include "OSAL_Tasks.h"
 #include "ZComDef.h"
 #ifdef HAL_MCU_CC2533
 #include "hal_batmon.h"
@@ -72,6 +74,13 @@
 // Reserve MSB of Id to signal a search for the "old" source copy (new write interrupted/failed.)
 #define OSAL_NV_SOURCE_ID       0x8000
 
+/* In flash, the MSB of an item header Id marks the records of the NV driver itself rather than
+ * user items: the commit record of a transaction and the boot checkpoint, with the Ids below.
+ */
+#define OSAL_NV_RSVD_ID         0x8000
+#define OSAL_NV_TXN_REC        (OSAL_NV_RSVD_ID | 0x7FFE)
+#define OSAL_NV_CP_ID          (OSAL_NV_RSVD_ID | 0x7FFD)
+
 // In case pages 0-1 are ever used, define a null page value.
 #define OSAL_NV_PAGE_NULL       0
 
@@ -89,6 +98,87 @@ static const uint16 hotIds[OSAL_NV_MAX_HOT] = {
   ZCD_NV_NWK_ALTERN_KEY_INFO,
 };
 
+/* RAM index of the item locations, sorted by Id, so that findItem() does not have to walk the
+ * page headers. It costs 4 bytes of RAM per entry; items beyond OSAL_NV_INDEX_CNT still work,
+ * but then an Id missing from the index must be looked for by walking the pages.
+ */
+#if !defined OSAL_NV_INDEX
+#define OSAL_NV_INDEX           FALSE
+#endif
+#if !defined OSAL_NV_INDEX_CNT
+#define OSAL_NV_INDEX_CNT       64
+#endif
+#if OSAL_NV_INDEX && ((OSAL_NV_PAGES_USED * OSAL_NV_PAGE_SIZE) > 65536UL)
+#error The NV index packs the page & offset of an item into 16 bits.
+#endif
+
+/* Each page compaction leaves a checkpoint of the page offsets and of the NV index on the page
+ * that it fills, as an item found at power-up by walking the item headers. A clean power-up loads
+ * it and only verifies the items written since, instead of the checksum of every item in NV.
+ */
+#if !defined OSAL_NV_CHECKPOINT
+#define OSAL_NV_CHECKPOINT      FALSE
+#endif
+#if OSAL_NV_CHECKPOINT && !OSAL_NV_INDEX
+#error The NV checkpoint is a copy of the NV index.
+#endif
+
+#if defined ( OSAL_NV_EXTENDED )
+/* The extended item (id, subId) of a table other than ZCD_NV_EX_LEGACY is kept as the item
+ * OSAL_NV_EX_BASE + ((id - 1) << OSAL_NV_EX_SUB_BITS) + subId, above the legacy Ids. The tables
+ * stop short of the Ids that OSAL_NV_RSVD_ID marks as reserved.
+ */
+#define OSAL_NV_EX_BASE         0x1000
+#define OSAL_NV_EX_SUB_BITS     10
+#define OSAL_NV_EX_TABLES     (((OSAL_NV_CP_ID & ~OSAL_NV_RSVD_ID) - OSAL_NV_EX_BASE) >> OSAL_NV_EX_SUB_BITS)
+#endif
+
+#if OSAL_NV_CACHE
+// Items that can be held in the write-back cache at once; each holds a heap copy of its item.
+#if !defined OSAL_NV_CACHE_CNT
+#define OSAL_NV_CACHE_CNT       4
+#endif
+// Larger items are always written straight to flash.
+#if !defined OSAL_NV_CACHE_MAX_LEN
+#define OSAL_NV_CACHE_MAX_LEN   128
+#endif
+// Longest time, in msecs, that a cached write waits for its flush once the NV task is running.
+#if !defined OSAL_NV_CACHE_DELAY
+#define OSAL_NV_CACHE_DELAY     5000
+#endif
+// Items that must reach flash when osal_nv_write() returns. The startup option is usually
+// written right before a reset, which the callers precede with osal_nv_flush() as well.
+#if !defined OSAL_NV_CACHE_BYPASS_IDS
+#define OSAL_NV_CACHE_BYPASS_IDS  ZCD_NV_EXTADDR, ZCD_NV_NIB, ZCD_NV_PRECFGKEY, \
+                                  ZCD_NV_NWK_ACTIVE_KEY_INFO, ZCD_NV_NWK_ALTERN_KEY_INFO, \
+                                  ZCD_NV_STARTUP_OPTION
+#endif
+static const uint16 cacheBypassIds[] = { OSAL_NV_CACHE_BYPASS_IDS };
+#define OSAL_NV_CACHE_BYPASS_CNT  (sizeof(cacheBypassIds) / sizeof(cacheBypassIds[0]))
+#endif
+
+#if OSAL_NV_TXN
+// Most items that one transaction can update.
+#if !defined OSAL_NV_TXN_CNT
+#define OSAL_NV_TXN_CNT           8
+#endif
+#endif
+
+#if OSAL_NV_BG_COMPACT
+// Background compaction starts when the erased space left outside the reserve page drops below this.
+#if !defined OSAL_NV_COMPACT_THRESHOLD
+#define OSAL_NV_COMPACT_THRESHOLD  OSAL_NV_PAGE_SIZE
+#endif
+// Fewest lost bytes on a page for compacting it in the background to be worth a page erase.
+#if !defined OSAL_NV_COMPACT_MIN_LOST
+#define OSAL_NV_COMPACT_MIN_LOST   (OSAL_NV_PAGE_SIZE / 4)
+#endif
+// Bytes of the reserve page verified as erased per step, before the first item is transferred.
+#if !defined OSAL_NV_COMPACT_CHECK_LEN
+#define OSAL_NV_COMPACT_CHECK_LEN  256
+#endif
+#endif
+
 /*********************************************************************
  * MACROS
  */
@@ -97,6 +187,8 @@ static const uint16 hotIds[OSAL_NV_MAX_HOT] = {
 #define OSAL_NV_CHECK_BUS_VOLTAGE  HalAdcCheckVdd(VDD_MIN_NV)
 #elif defined HAL_MCU_CC2533
 # define  OSAL_NV_CHECK_BUS_VOLTAGE  (HalBatMonRead( HAL_BATMON_MIN_FLASH ))
+#elif defined HAL_MCU_POSIX
+# define  OSAL_NV_CHECK_BUS_VOLTAGE  TRUE
 #else
 # warning No implementation of a low Vdd check.
 # define  OSAL_NV_CHECK_BUS_VOLTAGE
@@ -112,12 +204,29 @@ static const uint16 hotIds[OSAL_NV_MAX_HOT] = {
              ((uint16)(65536UL - OSAL_NV_WORD_SIZE))                     : \
   (((((LEN) + OSAL_NV_WORD_SIZE - 1) / OSAL_NV_WORD_SIZE) * OSAL_NV_WORD_SIZE) + OSAL_NV_HDR_SIZE))
 
+// An NV index location is the byte offset of the item data from the start of the NV pages.
+#define OSAL_NV_IDX_LOC( PG, OFF )  ((uint16)((PG) - OSAL_NV_PAGE_BEG) * OSAL_NV_PAGE_SIZE + (OFF))
+#define OSAL_NV_IDX_PG( LOC )       ((uint8)((LOC) / OSAL_NV_PAGE_SIZE) + OSAL_NV_PAGE_BEG)
+#define OSAL_NV_IDX_OFF( LOC )      ((uint16)((LOC) % OSAL_NV_PAGE_SIZE))
+
+// Return values of compactItem().
+#define OSAL_NV_XFER_FAIL  0
+#define OSAL_NV_XFER_MORE  1
+#define OSAL_NV_XFER_DONE  2
+
+#if OSAL_NV_CHECKPOINT
+#define CP_WRITE( COM_PG )  cpWrite( (COM_PG) )
+#else
+#define CP_WRITE( COM_PG )
+#endif
+
 #define COMPACT_PAGE_CLEANUP( COM_PG ) st ( \
   /* In order to recover from a page compaction that is interrupted,\
    * the logic in osal_nv_init() depends upon the following order:\
    * 1. State of the target of compaction is changed to ePgInUse.\
    * 2. Compacted page is erased.\
    */\
+  CP_WRITE( (COM_PG) );       /* Checkpoint the pages as they are once COM_PG is erased. */\
   setPageUse( pgRes, TRUE );  /* Mark the reserve page as being in use. */\
   erasePage( (COM_PG) ); \
   \
@@ -167,6 +276,42 @@ typedef enum
   eNvZero
 } eNvHdrEnum;
 
+#if OSAL_NV_INDEX
+typedef struct
+{
+  uint16 id;
+  uint16 loc;   // OSAL_NV_IDX_LOC() of the item data.
+} osalNvIdx_t;
+#endif
+
+#if OSAL_NV_CHECKPOINT
+// Data of the checkpoint item, followed by 'cnt' osalNvIdx_t.
+typedef struct
+{
+  uint16 res;                       // The reserve page once the compacted page is erased.
+  uint16 cnt;                       // Count of the NV index entries.
+  uint16 off[OSAL_NV_PAGES_USED];   // pgOff[] once the compacted page is erased.
+} osalNvCp_t;
+#endif
+
+#if OSAL_NV_TXN
+typedef struct
+{
+  uint16 id;
+  uint16 len;
+  uint8 *buf;   // The whole item as it will be committed.
+} osalNvTxn_t;
+#endif
+
+#if OSAL_NV_CACHE
+typedef struct
+{
+  uint16 id;    // OSAL_NV_ITEM_NULL if the entry is free.
+  uint16 len;
+  uint8 *buf;   // The whole item, newer than its copy in flash.
+} osalNvCache_t;
+#endif
+
 typedef enum
 {
   ePgActive,
@@ -206,6 +351,43 @@ static uint8 findPg;
 static uint8 hotPg[OSAL_NV_MAX_HOT];
 static uint16 hotOff[OSAL_NV_MAX_HOT];
 
+#if OSAL_NV_INDEX
+static osalNvIdx_t nvIdx[OSAL_NV_INDEX_CNT];
+static uint16 nvIdxCnt;
+static uint8 nvIdxFull;   // Some item could not be indexed: a miss does not prove absence.
+static uint8 nvIdxReady;  // Set once initNV() has built the index.
+#endif
+
+#if OSAL_NV_CACHE
+static osalNvCache_t nvCache[OSAL_NV_CACHE_CNT];
+static uint8 nvCacheVictim;             // Next entry to flush when a new item needs one.
+#endif
+
+#if OSAL_NV_CHECKPOINT
+static uint8 cpPg = OSAL_NV_PAGE_NULL;  // Page of the one checkpoint not zeroed, if any.
+static uint16 cpOff;                    // Offset into cpPg of the checkpoint data.
+#endif
+
+#if OSAL_NV_TXN
+static osalNvTxn_t nvTxn[OSAL_NV_TXN_CNT];
+static uint8 nvTxnCnt;
+static uint8 nvTxnOpen;
+#endif
+
+#if OSAL_NV_SNAPSHOT
+static uint16 nvChangeCnt;  // Bumped by every call that may change an item, see osal_nv_changes().
+#endif
+
+#if OSAL_NV_BG_COMPACT
+static uint8 bgPg = OSAL_NV_PAGE_NULL;  // Page being compacted onto pgRes by the NV task, if any.
+static uint16 bgChk;                    // Bytes of pgRes verified as erased for the compaction.
+static uint16 bgOff;                    // Offset into bgPg of the next item to transfer.
+#endif
+
+#if OSAL_NV_TASK
+static uint8 nvTaskId = TASK_NO_TASK;
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -216,6 +398,7 @@ static void   setPageUse( uint8 pg, uint8 inUse );
 static uint16 initPage( uint8 pg, uint16 id, uint8 findDups );
 static void   erasePage( uint8 pg );
 static uint8  compactPage( uint8 srcPg, uint16 skipId );
+static uint8  compactItem( uint8 srcPg, uint16 *pSrcOff, uint16 skipId );
 
 static uint16 findItem( uint16 id );
 static uint8  initItem( uint8 flag, uint16 id, uint16 len, void *buf );
@@ -235,6 +418,42 @@ static uint8  writeItem( uint8 pg, uint16 id, uint16 len, void *buf, uint8 flag
 static uint8  hotItem(uint16 id);
 static void   hotItemUpdate(uint8 pg, uint16 off, uint16 id);
 
+#if OSAL_NV_INDEX
+static uint16 idxFind( uint16 id );
+static void   idxUpdate( uint8 pg, uint16 off, uint16 id, uint8 replace );
+static void   idxRemove( uint16 id );
+static void   idxBuild( void );
+#endif
+#if OSAL_NV_CHECKPOINT
+static void   cpFind( void );
+static void   cpWrite( uint8 srcPg );
+static uint8  cpBoot( uint8 pg, uint16 off );
+static void   cpTail( uint8 pg );
+#endif
+
+static uint8  nvWrite( uint16 id, uint16 ndx, uint16 len, void *buf );
+#if defined ( OSAL_NV_EXTENDED )
+static uint16 exItemId( uint16 id, uint16 subId );
+#endif
+#if OSAL_NV_CACHE
+static osalNvCache_t *cacheFind( uint16 id );
+static osalNvCache_t *cacheGet( uint16 id );
+static uint8  cacheFlush( osalNvCache_t *pEnt );
+#endif
+#if OSAL_NV_TXN
+static osalNvTxn_t *txnFind( uint16 id );
+static uint8  txnStage( uint16 id, uint16 ndx, uint16 len, void *buf );
+static uint8  txnPage( uint16 sz );
+static void   txnApply( uint8 pg, uint16 recOff );
+static uint8  txnRecover( uint16 *pOff );
+static void   txnFree( void );
+#endif
+#if OSAL_NV_BG_COMPACT
+static void   bgCheck( void );
+static void   bgStep( void );
+static void   bgFinish( void );
+#endif
+
 /*********************************************************************
  * @fn      initNV
  *
@@ -252,6 +471,20 @@ static uint8 initNV( void )
   uint8 pg;
 
   pgRes = OSAL_NV_PAGE_NULL;
+#if OSAL_NV_INDEX
+  nvIdxReady = FALSE;
+#endif
+#if OSAL_NV_BG_COMPACT
+  bgPg = OSAL_NV_PAGE_NULL;  // An interrupted background compaction is recovered below like any other.
+#endif
+#if OSAL_NV_TXN
+  nvTxnCnt = 0;  // An interrupted commit is completed or dropped by txnRecover().
+  nvTxnOpen = FALSE;
+#endif
+#if OSAL_NV_CACHE
+  // Cached writes do not survive a reset; their buffers went with the heap.
+  (void)osal_memset( nvCache, 0, sizeof( nvCache ) );
+#endif
 
   for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
@@ -275,6 +508,10 @@ static uint8 initNV( void )
     }
   }
 
+#if OSAL_NV_CHECKPOINT
+  cpFind();
+#endif
+
   // If a page compaction was interrupted before the old page was erased.
   if ( oldPg != OSAL_NV_PAGE_NULL )
   {
@@ -297,6 +534,12 @@ static uint8 initNV( void )
   }
   else if ( pgRes != OSAL_NV_PAGE_NULL )
   {
+#if OSAL_NV_CHECKPOINT
+    if ( (cpPg != OSAL_NV_PAGE_NULL) && cpBoot( cpPg, cpOff ) )
+    {
+      return TRUE;
+    }
+#endif
     erasePage( pgRes );  // The last page erase could have been interrupted by a power-cycle.
   }
   /* else if there is no reserve page, COMPACT_PAGE_CLEANUP() must have succeeded to put the old
@@ -306,6 +549,15 @@ static uint8 initNV( void )
    * size less the page header.
    */
 
+#if OSAL_NV_CHECKPOINT
+  // A checkpoint not booted from is stale; unless its page was just erased, zero it before the walk.
+  if ( (cpPg != OSAL_NV_PAGE_NULL) && (cpPg != pgRes) )
+  {
+    setItem( cpPg, cpOff, eNvZero );
+  }
+  cpPg = OSAL_NV_PAGE_NULL;
+#endif
+
   for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
     // Calculate page offset and lost bytes - any "old" item triggers an N^2 re-scan from start.
@@ -351,6 +603,15 @@ static uint8 initNV( void )
     erasePage( pgRes );  // The last page erase had been interrupted by a power-cycle.
   }
 
+#if OSAL_NV_TXN
+  (void)txnRecover( NULL );
+#endif
+
+#if OSAL_NV_INDEX
+  idxBuild();
+  nvIdxReady = TRUE;
+#endif
+
   return TRUE;
 }
 
@@ -508,6 +769,25 @@ static void erasePage( uint8 pg )
 
   pgOff[pg - OSAL_NV_PAGE_BEG] = OSAL_NV_PAGE_HDR_SIZE;
   pgLost[pg - OSAL_NV_PAGE_BEG] = 0;
+
+#if OSAL_NV_INDEX
+  if ( nvIdxReady )
+  {
+    uint16 idx;
+
+    /* A successful compaction has already moved every entry off the page. Any entry left here
+     * comes from an aborted compaction or write, so re-index from what is really in flash.
+     */
+    for ( idx = 0; idx < nvIdxCnt; idx++ )
+    {
+      if ( OSAL_NV_IDX_PG( nvIdx[idx].loc ) == pg )
+      {
+        idxBuild();
+        break;
+      }
+    }
+  }
+#endif
 }
 
 /*********************************************************************
@@ -554,93 +834,102 @@ static uint8 compactPage( uint8 srcPg, uint16 skipId )
   }
 
   srcOff = OSAL_NV_PAGE_HDR_SIZE;
-  rtrn = TRUE;
 
-  while ( srcOff < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE ) )
+  while ( (rtrn = compactItem( srcPg, &srcOff, skipId )) == OSAL_NV_XFER_MORE );
+
+  if (rtrn == OSAL_NV_XFER_FAIL)
   {
-    osalNvHdr_t hdr;
-    uint16 sz, dstOff = pgOff[pgRes-OSAL_NV_PAGE_BEG];
+    erasePage(pgRes);
+    return FALSE;
+  }
+  else if (skipId == OSAL_NV_ITEM_NULL)
+  {
+    COMPACT_PAGE_CLEANUP(srcPg);
+  }
+  // else invoking function must cleanup.
 
-    HalFlashRead(srcPg, srcOff, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+  return TRUE;
+}
 
-    if ( hdr.id == OSAL_NV_ERASED_ID )
-    {
-      break;
-    }
+/*********************************************************************
+ * @fn      compactItem
+ *
+ * @brief   Transfers the next item of a page being compacted onto the 'pgRes'.
+ *
+ * @param   srcPg - Valid NV page being compacted.
+ * @param   pSrcOff - Offset into 'srcPg' of the item header; advanced past the item.
+ * @param   skipId - Item Id to not compact.
+ *
+ * @return  OSAL_NV_XFER_MORE if an item was transferred or skipped;
+ *          OSAL_NV_XFER_DONE if there are no more items on 'srcPg';
+ *          OSAL_NV_XFER_FAIL if the item could not be written to 'pgRes'.
+ */
+static uint8 compactItem( uint8 srcPg, uint16 *pSrcOff, uint16 skipId )
+{
+  osalNvHdr_t hdr;
+  uint16 sz, srcOff = *pSrcOff, dstOff = pgOff[pgRes-OSAL_NV_PAGE_BEG];
 
-    // Get the actual size in bytes which is the ceiling(hdr.len)
-    sz = OSAL_NV_DATA_SIZE( hdr.len );
+  if ( srcOff >= (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE) )
+  {
+    return OSAL_NV_XFER_DONE;
+  }
 
-    if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - srcOff) )
-    {
-      break;
-    }
+  HalFlashRead(srcPg, srcOff, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
 
-    if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - dstOff) )
-    {
-      rtrn = FALSE;
-      break;
-    }
+  if ( hdr.id == OSAL_NV_ERASED_ID )
+  {
+    return OSAL_NV_XFER_DONE;
+  }
 
-    srcOff += OSAL_NV_HDR_SIZE;
+  // Get the actual size in bytes which is the ceiling(hdr.len)
+  sz = OSAL_NV_DATA_SIZE( hdr.len );
 
-    if ( (hdr.id != OSAL_NV_ZEROED_ID) && (hdr.id != skipId) )
+  if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - srcOff) )
+  {
+    return OSAL_NV_XFER_DONE;
+  }
+
+  if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - dstOff) )
+  {
+    return OSAL_NV_XFER_FAIL;
+  }
+
+  srcOff += OSAL_NV_HDR_SIZE;
+
+  // A checkpoint only describes the pages as they were when it was written.
+  if ( (hdr.id != OSAL_NV_ZEROED_ID) && (hdr.id != skipId) && (hdr.id != OSAL_NV_CP_ID) )
+  {
+    if ( hdr.chk == calcChkF( srcPg, srcOff, hdr.len ) )
     {
-      if ( hdr.chk == calcChkF( srcPg, srcOff, hdr.len ) )
+      /* Prevent excessive re-writes to item header caused by numerous, rapid, & successive
+       * OSAL_Nv interruptions caused by resets.
+       */
+      if ( hdr.stat == OSAL_NV_ERASED_ID )
       {
-        /* Prevent excessive re-writes to item header caused by numerous, rapid, & successive
-         * OSAL_Nv interruptions caused by resets.
-         */
-        if ( hdr.stat == OSAL_NV_ERASED_ID )
-        {
-          setItem( srcPg, srcOff, eNvXfer );
-        }
+        setItem( srcPg, srcOff, eNvXfer );
+      }
 
-        if ( writeItem( pgRes, hdr.id, hdr.len, NULL, FALSE ) )
-        {
-          dstOff += OSAL_NV_HDR_SIZE;
-          xferBuf( srcPg, srcOff, pgRes, dstOff, sz );
-          // Calculate and write the new checksum.
-          if (hdr.chk == calcChkF(pgRes, dstOff, hdr.len))
-          {
-            if ( hdr.chk != setChk( pgRes, dstOff, hdr.chk ) )
-            {
-              rtrn = FALSE;
-              break;
-            }
-            else
-            {
-              hotItemUpdate(pgRes, dstOff, hdr.id);
-            }
-          }
-          else
-          {
-            rtrn = FALSE;
-            break;
-          }
-        }
-        else
-        {
-          rtrn = FALSE;
-          break;
-        }
+      if ( !writeItem( pgRes, hdr.id, hdr.len, NULL, FALSE ) )
+      {
+        return OSAL_NV_XFER_FAIL;
       }
-    }
 
-    srcOff += sz;
-  }
+      dstOff += OSAL_NV_HDR_SIZE;
+      xferBuf( srcPg, srcOff, pgRes, dstOff, sz );
+      // Calculate and write the new checksum.
+      if ( (hdr.chk != calcChkF( pgRes, dstOff, hdr.len )) ||
+           (hdr.chk != setChk( pgRes, dstOff, hdr.chk )) )
+      {
+        return OSAL_NV_XFER_FAIL;
+      }
 
-  if (rtrn == FALSE)
-  {
-    erasePage(pgRes);
-  }
-  else if (skipId == OSAL_NV_ITEM_NULL)
-  {
-    COMPACT_PAGE_CLEANUP(srcPg);
+      hotItemUpdate(pgRes, dstOff, hdr.id);
+    }
   }
-  // else invoking function must cleanup.
 
-  return rtrn;
+  *pSrcOff = srcOff + sz;
+
+  return OSAL_NV_XFER_MORE;
 }
 
 /*********************************************************************
@@ -662,6 +951,24 @@ static uint16 findItem( uint16 id )
   uint16 off;
   uint8 pg;
 
+#if OSAL_NV_INDEX
+  if ( nvIdxReady && ((id & OSAL_NV_SOURCE_ID) == 0) )
+  {
+    uint16 idx = idxFind( id );
+
+    if ( (idx < nvIdxCnt) && (nvIdx[idx].id == id) )
+    {
+      findPg = OSAL_NV_IDX_PG( nvIdx[idx].loc );
+      return OSAL_NV_IDX_OFF( nvIdx[idx].loc );
+    }
+    else if ( !nvIdxFull )
+    {
+      findPg = OSAL_NV_PAGE_NULL;
+      return OSAL_NV_ITEM_NULL;
+    }
+  }
+#endif
+
   for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
     if ( (off = initPage( pg, id, FALSE )) != OSAL_NV_ITEM_NULL )
@@ -707,12 +1014,33 @@ static uint8 initItem( uint8 flag, uint16 id, uint16 len, void *buf )
   uint8 rtrn = OSAL_NV_PAGE_NULL;
   uint8 cnt = OSAL_NV_PAGES_USED;
   uint8 pg = pgRes+1;  // Set to 1 after the reserve page to even wear across all available pages.
+#if OSAL_NV_BG_COMPACT
+  uint8 lost = FALSE;  // Set for the second pass, which counts the bytes a compaction would free.
+#endif
 
   do {
     if (pg >= OSAL_NV_PAGE_BEG+OSAL_NV_PAGES_USED)
     {
       pg = OSAL_NV_PAGE_BEG;
     }
+#if OSAL_NV_BG_COMPACT
+    if ( (pg != pgRes) && (pg != bgPg) )
+    {
+      uint8 idx = pg - OSAL_NV_PAGE_BEG;
+      // Erased space is used up first, leaving the compactions to the NV task.
+      if ( sz <= (OSAL_NV_PAGE_SIZE - pgOff[idx] + (lost ? pgLost[idx] : 0)) )
+      {
+        break;
+      }
+    }
+    pg++;
+
+    if ( (cnt == 1) && !lost )
+    {
+      lost = TRUE;
+      cnt = OSAL_NV_PAGES_USED + 1;
+    }
+#else
     if ( pg != pgRes )
     {
       uint8 idx = pg - OSAL_NV_PAGE_BEG;
@@ -722,8 +1050,21 @@ static uint8 initItem( uint8 flag, uint16 id, uint16 len, void *buf )
       }
     }
     pg++;
+#endif
   } while (--cnt);
 
+#if OSAL_NV_BG_COMPACT
+  /* A synchronous compaction needs the reserve page, so a background one must be finished first -
+   * after which its page may hold the space that was needed.
+   */
+  if ( (bgPg != OSAL_NV_PAGE_NULL) &&
+       ((cnt == 0) || (sz > (OSAL_NV_PAGE_SIZE - pgOff[pg - OSAL_NV_PAGE_BEG]))) )
+  {
+    bgFinish();
+    return initItem( flag, id, len, buf );
+  }
+#endif
+
   if (cnt)
   {
     // Item fits if an old page is compacted.
@@ -1174,6 +1515,7 @@ static uint8 hotItem(uint16 id)
  * @fn      hotItemUpdate
  *
  * @brief   If the parameter 'id' is a hot item, update the corresponding hot item data.
+ *          Also record the new location in the NV index, if enabled.
  *
  * @param   pg - The new NV page corresponding to the hot item.
  * @param   off - The new NV page offset corresponding to the hot item.
@@ -1192,321 +1534,2048 @@ static void hotItemUpdate(uint8 pg, uint16 off, uint16 id)
       hotOff[hotIdx] = off;
     }
   }
+
+#if OSAL_NV_INDEX
+  if ( nvIdxReady && ((id & OSAL_NV_RSVD_ID) == 0) )
+  {
+    idxUpdate( pg, off, id, TRUE );
+  }
+#endif
 }
 
+#if OSAL_NV_INDEX
 /*********************************************************************
- * @fn      osal_nv_init
+ * @fn      idxFind
  *
- * @brief   Initialize NV service.
+ * @brief   Binary search of the NV index for an item Id.
  *
- * @param   p - Not used.
+ * @param   id - A valid NV item Id.
  *
- * @return  none
+ * @return  The entry of the item if it is indexed; otherwise the entry
+ *          where it would be inserted, possibly nvIdxCnt.
  */
-void osal_nv_init( void *p )
+static uint16 idxFind( uint16 id )
 {
-  (void)p;  // Suppress Lint warning.
-  (void)initNV();  // Always returns TRUE after pages have been erased.
+  uint16 lo = 0;
+  uint16 hi = nvIdxCnt;
+
+  while ( lo < hi )
+  {
+    uint16 mid = (lo + hi) / 2;
+
+    if ( nvIdx[mid].id < id )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return lo;
 }
 
 /*********************************************************************
- * @fn      osal_nv_item_init
+ * @fn      idxUpdate
  *
- * @brief   If the NV item does not already exist, it is created and
- *          initialized with the data passed to the function, if any.
- *          This function must be called before calling osal_nv_read() or
- *          osal_nv_write().
+ * @brief   Set the location of an item in the NV index, inserting it if new.
  *
- * @param   id  - Valid NV item Id.
- * @param   len - Item length.
- * @param  *buf - Pointer to item initalization data. Set to NULL if none.
+ * @param   pg - The NV page of the item.
+ * @param   off - The offset of the item data in the page.
+ * @param   id - A valid NV item Id.
+ * @param   replace - FALSE to keep the location of an Id that is already indexed.
  *
- * @return  NV_ITEM_UNINIT - Id did not exist and was created successfully.
- *          SUCCESS        - Id already existed, no action taken.
- *          NV_OPER_FAILED - Failure to find or create Id.
+ * @return  none
  */
-uint8 osal_nv_item_init( uint16 id, uint16 len, void *buf )
+static void idxUpdate( uint8 pg, uint16 off, uint16 id, uint8 replace )
 {
-  uint16 offset;
+  uint16 idx = idxFind( id );
 
-  if ( !OSAL_NV_CHECK_BUS_VOLTAGE )
+  if ( (idx < nvIdxCnt) && (nvIdx[idx].id == id) )
   {
-    return NV_OPER_FAILED;
+    if ( !replace )
+    {
+      return;
+    }
   }
-  else if ((offset = findItem(id)) != OSAL_NV_ITEM_NULL)
+  else if ( nvIdxCnt < OSAL_NV_INDEX_CNT )
   {
-    // Re-populate the NV hot item data if the corresponding items are already established.
-    hotItemUpdate(findPg, offset, id);
+    uint16 cnt;
 
-    return SUCCESS;
-  }
-  else if ( initItem( TRUE, id, len, buf ) != OSAL_NV_PAGE_NULL )
-  {
-    return NV_ITEM_UNINIT;
+    for ( cnt = nvIdxCnt; cnt > idx; cnt-- )
+    {
+      nvIdx[cnt] = nvIdx[cnt-1];
+    }
+    nvIdx[idx].id = id;
+    nvIdxCnt++;
   }
   else
   {
-    return NV_OPER_FAILED;
+    nvIdxFull = TRUE;
+    return;
   }
+
+  nvIdx[idx].loc = OSAL_NV_IDX_LOC( pg, off );
 }
 
 /*********************************************************************
- * @fn      osal_nv_item_len
+ * @fn      idxRemove
  *
- * @brief   Get the data length of the item stored in NV memory.
+ * @brief   Remove a deleted item from the NV index.
  *
- * @param   id  - Valid NV item Id.
+ * @param   id - A valid NV item Id.
  *
- * @return  Item length, if found; zero otherwise.
+ * @return  none
  */
-uint16 osal_nv_item_len( uint16 id )
+static void idxRemove( uint16 id )
 {
-  osalNvHdr_t hdr;
-  uint16 offset;
-  uint8 hotIdx;
+  uint16 idx = idxFind( id );
 
-  if ((hotIdx = hotItem(id)) < OSAL_NV_MAX_HOT)
-  {
-    findPg = hotPg[hotIdx];
-    offset = hotOff[hotIdx];
-  }
-  else if ((offset = findItem(id)) == OSAL_NV_ITEM_NULL)
+  if ( (idx < nvIdxCnt) && (nvIdx[idx].id == id) )
   {
-    return 0;
-  }
+    nvIdxCnt--;
 
-  HalFlashRead(findPg, (offset - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
-  return hdr.len;
+    for ( ; idx < nvIdxCnt; idx++ )
+    {
+      nvIdx[idx] = nvIdx[idx+1];
+    }
+  }
 }
 
 /*********************************************************************
- * @fn      osal_nv_write
+ * @fn      idxBuild
  *
- * @brief   Write a data item to NV. Function can write an entire item to NV or
- *          an element of an item by indexing into the item with an offset.
+ * @brief   Build the NV index by walking the item headers of every page.
+ *          Where a write in progress left two copies of an item, the
+ *          index prefers the new one, as findItem() does by walking.
  *
- * @param   id  - Valid NV item Id.
- * @param   ndx - Index offset into item
- * @param   len - Length of data to write.
- * @param  *buf - Data to write.
+ * @param   none
  *
- * @return  SUCCESS if successful, NV_ITEM_UNINIT if item did not
- *          exist in NV and offset is non-zero, NV_OPER_FAILED if failure.
+ * @return  none
  */
-uint8 osal_nv_write( uint16 id, uint16 ndx, uint16 len, void *buf )
+static void idxBuild( void )
 {
-  uint8 rtrn = SUCCESS;
+  uint8 pg;
 
-  if ( !OSAL_NV_CHECK_BUS_VOLTAGE )
-  {
-    return NV_OPER_FAILED;
-  }
-  else if ( len != 0 )
+  nvIdxCnt = 0;
+  nvIdxFull = FALSE;
+
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
-    osalNvHdr_t hdr;
-    uint16 origOff, srcOff;
-    uint16 cnt, chk;
-    uint8 *ptr, srcPg;
+    uint16 offset = OSAL_NV_PAGE_HDR_SIZE;
 
-    origOff = srcOff = findItem( id );
-    srcPg = findPg;
-    if ( srcOff == OSAL_NV_ITEM_NULL )
+    while ( offset < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE) )
     {
-      return NV_ITEM_UNINIT;
-    }
+      osalNvHdr_t hdr;
+      uint16 sz;
 
-    HalFlashRead(srcPg, (srcOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
-    if ( hdr.len < (ndx + len) )
-    {
-      return NV_OPER_FAILED;
-    }
+      HalFlashRead(pg, offset, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
 
-    srcOff += ndx;
-    ptr = buf;
-    cnt = len;
-    chk = 0;
-    while ( cnt-- )
-    {
-      uint8 tmp;
-      HalFlashRead(srcPg, srcOff, &tmp, 1);
-      if ( tmp != *ptr )
+      if ( hdr.id == OSAL_NV_ERASED_ID )
       {
-        chk = 1;  // Mark that at least one byte is different.
-        // Calculate expected checksum after transferring old data and writing new data.
-        hdr.chk -= tmp;
-        hdr.chk += *ptr;
+        break;
       }
-      srcOff++;
-      ptr++;
-    }
 
-    if ( chk != 0 )  // If the buffer to write is different in one or more bytes.
-    {
-      uint8 comPg = OSAL_NV_PAGE_NULL;
-      uint8 dstPg = initItem( FALSE, id, hdr.len, &comPg );
+      sz = OSAL_NV_DATA_SIZE( hdr.len );
+      if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - offset) )
+      {
+        break;
+      }
 
-      if ( dstPg != OSAL_NV_PAGE_NULL )
+      offset += OSAL_NV_HDR_SIZE;
+
+      if ( (hdr.id != OSAL_NV_ZEROED_ID) && ((hdr.id & OSAL_NV_RSVD_ID) == 0) )
       {
-        uint16 tmp = OSAL_NV_DATA_SIZE( hdr.len );
-        uint16 dstOff = pgOff[dstPg-OSAL_NV_PAGE_BEG] - tmp;
-        srcOff = origOff;
+        // A current copy (status still erased) takes precedence over a transferred source copy.
+        idxUpdate( pg, offset, hdr.id, (hdr.stat == OSAL_NV_ERASED_ID) );
+      }
 
-        /* Prevent excessive re-writes to item header caused by numerous, rapid, & successive
-         * OSAL_Nv interruptions caused by resets.
-         */
-        if ( hdr.stat == OSAL_NV_ERASED_ID )
-        {
-          setItem( srcPg, srcOff, eNvXfer );
-        }
+      offset += sz;
+    }
+  }
+}
+#endif
 
-        xferBuf( srcPg, srcOff, dstPg, dstOff, ndx );
-        srcOff += ndx;
-        dstOff += ndx;
+#if OSAL_NV_CHECKPOINT
+/*********************************************************************
+ * @fn      cpFind
+ *
+ * @brief   Walk the item headers of the pages in use for the checkpoint
+ *          not zeroed, of which cpWrite() leaves at most one. It is the
+ *          item after the ones compacted onto its page, so only the pages
+ *          up to it are walked.
+ *
+ * @param   none
+ *
+ * @return  none; cpPg and cpOff are set to the checkpoint, if found.
+ */
+static void cpFind( void )
+{
+  uint8 pg;
 
-        writeBuf( dstPg, dstOff, len, buf );
-        srcOff += len;
-        dstOff += len;
+  cpPg = OSAL_NV_PAGE_NULL;
 
-        xferBuf( srcPg, srcOff, dstPg, dstOff, (hdr.len-ndx-len) );
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
+  {
+    uint16 offset = OSAL_NV_PAGE_HDR_SIZE;
 
-        // Calculate and write the new checksum.
-        dstOff = pgOff[dstPg-OSAL_NV_PAGE_BEG] - tmp;
+    while ( (pg != pgRes) && (offset < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE)) )
+    {
+      osalNvHdr_t hdr;
+      uint16 sz;
 
-        if ( hdr.chk == calcChkF( dstPg, dstOff, hdr.len ) )
-        {
-          if ( hdr.chk != setChk( dstPg, dstOff, hdr.chk ) )
-          {
-            rtrn = NV_OPER_FAILED;
-          }
-          else
-          {
-            hotItemUpdate(dstPg, dstOff, hdr.id);
-          }
-        }
-        else
-        {
-          rtrn = NV_OPER_FAILED;
-        }
-      }
-      else
+      HalFlashRead(pg, offset, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+
+      if ( hdr.id == OSAL_NV_ERASED_ID )
       {
-        rtrn = NV_OPER_FAILED;
+        break;
       }
 
-      if ( comPg != OSAL_NV_PAGE_NULL )
+      sz = OSAL_NV_DATA_SIZE( hdr.len );
+      if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - offset) )
       {
-        /* Even though the page compaction succeeded, if the new item is coming from the compacted
-         * page and writing the new value failed, then the compaction must be aborted.
-         */
-        if ( (srcPg == comPg) && (rtrn == NV_OPER_FAILED) )
-        {
-          erasePage( pgRes );
-        }
-        else
-        {
-          COMPACT_PAGE_CLEANUP( comPg );
-        }
+        break;
       }
 
-      /* Zero of the old item must wait until after compact page cleanup has finished - if the item
-       * is zeroed before and cleanup is interrupted by a power-cycle, the new item can be lost.
-       */
-      if ( (srcPg != comPg) && (rtrn != NV_OPER_FAILED) )
+      offset += OSAL_NV_HDR_SIZE;
+
+      if ( hdr.id == OSAL_NV_CP_ID )
       {
-        setItem( srcPg, origOff, eNvZero );
+        cpPg = pg;
+        cpOff = offset;
+        return;
       }
+
+      offset += sz;
     }
   }
-
-  return rtrn;
 }
 
 /*********************************************************************
- * @fn      osal_nv_read
+ * @fn      cpWrite
  *
- * @brief   Read data from NV. This function can be used to read an entire item from NV or
- *          an element of an item by indexing into the item with an offset.
- *          Read data is copied into *buf.
+ * @brief   Write the checkpoint of a page compaction, just before the
+ *          reserve page is put in use. The older checkpoint is zeroed
+ *          first, so a checkpoint that could not be written leaves none.
+ *          No page header word is written: the checkpoint is an item.
  *
- * @param   id  - Valid NV item Id.
- * @param   ndx - Index offset into item
- * @param   len - Length of data to read.
- * @param  *buf - Data is read into this buffer.
+ * @param   srcPg - Valid NV page compacted, about to become the reserve page.
  *
- * @return  SUCCESS if NV data was copied to the parameter 'buf'.
- *          Otherwise, NV_OPER_FAILED for failure.
+ * @return  none
  */
-uint8 osal_nv_read( uint16 id, uint16 ndx, uint16 len, void *buf )
+static void cpWrite( uint8 srcPg )
 {
-  uint16 offset;
-  uint8 hotIdx;
+  osalNvHdr_t hdr;
+  osalNvCp_t cp;
+  uint16 len, off, chk;
+  uint8 pg;
 
-  if ((hotIdx = hotItem(id)) < OSAL_NV_MAX_HOT)
+  // Even on 'srcPg', which a reset could leave un-erased. Already counted as lost, so no setItem().
+  if ( cpPg != OSAL_NV_PAGE_NULL )
   {
-    HalFlashRead(hotPg[hotIdx], hotOff[hotIdx]+ndx, buf, len);
-    return SUCCESS;
+    HalFlashRead(cpPg, (cpOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+    hdr.id = OSAL_NV_ZEROED_ID;
+    writeWord( cpPg, (cpOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr) );
+    cpPg = OSAL_NV_PAGE_NULL;
   }
 
-  if ((offset = findItem(id)) == OSAL_NV_ITEM_NULL)
+  len = sizeof( osalNvCp_t ) + (nvIdxCnt * sizeof( osalNvIdx_t ));
+  off = pgOff[pgRes - OSAL_NV_PAGE_BEG];
+
+  // When NV is nearly full, the space is worth more than a faster power-up.
+  if ( !nvIdxReady || nvIdxFull || (OSAL_NV_ITEM_SIZE( len ) > ((OSAL_NV_PAGE_SIZE - off) / 2)) ||
+       !writeItem( pgRes, OSAL_NV_CP_ID, len, NULL, FALSE ) )
   {
-    return NV_OPER_FAILED;
+    return;
   }
-  else
+
+  cp.res = srcPg;
+  cp.cnt = nvIdxCnt;
+  for ( pg = 0; pg < OSAL_NV_PAGES_USED; pg++ )
   {
-    HalFlashRead(findPg, offset+ndx, buf, len);
-    return SUCCESS;
+    cp.off[pg] = pgOff[pg];
   }
+  cp.off[srcPg - OSAL_NV_PAGE_BEG] = OSAL_NV_PAGE_HDR_SIZE;
+
+  off += OSAL_NV_HDR_SIZE;
+  writeBuf( pgRes, off, sizeof( cp ), (uint8 *)(&cp) );
+  writeBuf( pgRes, off + sizeof( cp ), (nvIdxCnt * sizeof( osalNvIdx_t )), (uint8 *)nvIdx );
+
+  // Not an item to keep: count it as lost, as cpBoot() does.
+  pgLost[pgRes - OSAL_NV_PAGE_BEG] += OSAL_NV_ITEM_SIZE( len );
+
+  // Whether or not its checksum sets, the next checkpoint zeroes this one.
+  cpPg = pgRes;
+  cpOff = off;
+
+  chk = calcChkF( pgRes, off, len );
+  (void)setChk( pgRes, off, chk );
 }
 
 /*********************************************************************
- * @fn      osal_nv_delete
+ * @fn      cpBoot
  *
- * @brief   Delete item from NV. This function will fail if the length
- *          parameter does not match the length of the item in NV.
+ * @brief   Initialize the NV pages and index from the checkpoint, then
+ *          from the items written after it. The reserve page is only
+ *          read back, since erasing it would take longer than all the rest.
  *
- * @param   id  - Valid NV item Id.
- * @param   len - Length of item to delete.
+ * @param   pg - Valid NV page of the checkpoint.
+ * @param   off - Offset into the page of the checkpoint data.
  *
- * @return  SUCCESS if item was deleted,
- *          NV_ITEM_UNINIT if item did not exist in NV,
- *          NV_BAD_ITEM_LEN if length parameter not correct,
- *          NV_OPER_FAILED if attempted deletion failed.
+ * @return  TRUE if done; FALSE if the checkpoint is not usable and
+ *          nothing has been changed.
  */
-uint8 osal_nv_delete( uint16 id, uint16 len )
+static uint8 cpBoot( uint8 pg, uint16 off )
 {
-  uint16 length;
-  uint16 offset;
+  osalNvHdr_t hdr;
+  osalNvCp_t cp;
+  uint16 resOff;
+  uint16 idx, cnt;
 
-  offset = findItem( id );
-  if ( offset == OSAL_NV_ITEM_NULL )
+  if ( (off < (OSAL_NV_PAGE_HDR_SIZE + OSAL_NV_HDR_SIZE)) ||
+       (off > (OSAL_NV_PAGE_SIZE - sizeof( cp ))) )
   {
-    // NV item does not exist
-    return NV_ITEM_UNINIT;
+    return FALSE;
   }
 
-  length = osal_nv_item_len( id );
-  if ( length != len )
+  HalFlashRead(pg, (off - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+  HalFlashRead(pg, off, (uint8 *)(&cp), sizeof( cp ));
+
+  if ( (hdr.id != OSAL_NV_CP_ID) || (cp.res != pgRes) || (cp.cnt > OSAL_NV_INDEX_CNT) ||
+       (hdr.len != (sizeof( cp ) + (cp.cnt * sizeof( osalNvIdx_t )))) ||
+       (OSAL_NV_DATA_SIZE( hdr.len ) > (OSAL_NV_PAGE_SIZE - off)) ||
+       (hdr.chk != calcChkF( pg, off, hdr.len )) )
   {
-    // NV item has different length
-    return NV_BAD_ITEM_LEN;
+    return FALSE;
   }
 
-  // Set item header ID to zero to 'delete' the item
-  setItem( findPg, offset, eNvZero );
+  for ( resOff = 0; resOff < OSAL_NV_PAGE_SIZE; resOff += OSAL_NV_HDR_SIZE )
+  {
+    HalFlashRead(pgRes, resOff, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+    if ( (hdr.id & hdr.len & hdr.chk & hdr.stat) != OSAL_NV_ERASED_ID )
+    {
+      return FALSE;
+    }
+  }
 
-  // Verify that item has been removed
-  offset = findItem( id );
-  if ( offset != OSAL_NV_ITEM_NULL )
+  HalFlashRead(pg, (off + sizeof( cp )), (uint8 *)nvIdx, (cp.cnt * sizeof( osalNvIdx_t )));
+
+  for ( idx = 0; idx < OSAL_NV_PAGES_USED; idx++ )
   {
-    // Still there
-    return NV_OPER_FAILED;
+    pgOff[idx] = cp.off[idx];
+    pgLost[idx] = cp.off[idx] - OSAL_NV_PAGE_HDR_SIZE;
   }
-  else
+
+  // Drop the items deleted or re-written since; whatever else was below the offsets is lost.
+  for ( idx = cnt = 0; idx < cp.cnt; idx++ )
   {
-    // Yes, it's gone
-    return SUCCESS;
+    pg = OSAL_NV_IDX_PG( nvIdx[idx].loc );
+    off = OSAL_NV_IDX_OFF( nvIdx[idx].loc );
+
+    HalFlashRead(pg, (off - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+    if ( hdr.id == nvIdx[idx].id )
+    {
+      pgLost[pg - OSAL_NV_PAGE_BEG] -= OSAL_NV_ITEM_SIZE( hdr.len );
+      nvIdx[cnt++] = nvIdx[idx];
+    }
+  }
+
+  nvIdxCnt = cnt;
+  nvIdxFull = FALSE;
+  nvIdxReady = TRUE;
+
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
+  {
+    cpTail( pg );
+  }
+
+#if OSAL_NV_TXN
+  // The items after the checkpoint indexed both copies of an interrupted commit.
+  if ( txnRecover( cp.off ) )
+  {
+    idxBuild();
   }
+#endif
+
+  return TRUE;
 }
 
+/*********************************************************************
+ * @fn      cpTail
+ *
+ * @brief   Verify and index the items written to a page after the
+ *          checkpoint, doing for them what initPage() and idxBuild()
+ *          do for whole pages.
+ *
+ * @param   pg - Valid NV page, with pgOff[] set from the checkpoint.
+ *
+ * @return  none
+ */
+static void cpTail( uint8 pg )
+{
+  uint16 offset = pgOff[pg - OSAL_NV_PAGE_BEG];
+  osalNvHdr_t hdr;
+
+  while ( offset < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE) )
+  {
+    uint16 sz;
+
+    HalFlashRead(pg, offset, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+
+    if ( hdr.id == OSAL_NV_ERASED_ID )
+    {
+      break;
+    }
+
+    sz = OSAL_NV_DATA_SIZE( hdr.len );
+
+    // A bad 'len' write has blown away the rest of the page.
+    if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - offset) )
+    {
+      pgLost[pg - OSAL_NV_PAGE_BEG] += (OSAL_NV_PAGE_SIZE - offset);
+      offset = OSAL_NV_PAGE_SIZE;
+      break;
+    }
+
+    offset += OSAL_NV_HDR_SIZE;
+
+    if ( hdr.id == OSAL_NV_ZEROED_ID )
+    {
+      pgLost[pg - OSAL_NV_PAGE_BEG] += (OSAL_NV_HDR_SIZE + sz);
+    }
+    else if ( hdr.chk != calcChkF( pg, offset, hdr.len ) )
+    {
+      setItem( pg, offset, eNvZero );  // Mark bad checksum as invalid; counted as lost by setItem().
+    }
+    else if ( (hdr.id & OSAL_NV_RSVD_ID) == 0 )
+    {
+      uint16 off = findItem( hdr.id );
+      uint8 live = (hdr.stat == OSAL_NV_ERASED_ID);
+
+      if ( off != OSAL_NV_ITEM_NULL )
+      {
+        uint16 stat;
+
+        /* Of the two copies left by an interrupted write, keep the one whose status is still
+         * erased and zero the source copy, as the findDups pass of initNV() does.
+         */
+        HalFlashRead(findPg, (off - OSAL_NV_HDR_SIZE + OSAL_NV_HDR_STAT), (uint8 *)(&stat),
+                     sizeof( stat ));
+
+        if ( live && (stat != OSAL_NV_ERASED_ID) )
+        {
+          setItem( findPg, off, eNvZero );
+        }
+        else if ( !live && (stat == OSAL_NV_ERASED_ID) )
+        {
+          setItem( pg, offset, eNvZero );
+          offset += sz;
+          continue;
+        }
+      }
+
+      idxUpdate( pg, offset, hdr.id, live );
+    }
+
+    offset += sz;
+  }
+
+  pgOff[pg - OSAL_NV_PAGE_BEG] = offset;
+}
+#endif
+
+/*********************************************************************
+ * @fn      osal_nv_init
+ *
+ * @brief   Initialize NV service.
+ *
+ * @param   p - Not used.
+ *
+ * @return  none
+ */
+void osal_nv_init( void *p )
+{
+  (void)p;  // Suppress Lint warning.
+  (void)initNV();  // Always returns TRUE after pages have been erased.
+}
+
+/*********************************************************************
+ * @fn      osal_nv_item_init
+ *
+ * @brief   If the NV item does not already exist, it is created and
+ *          initialized with the data passed to the function, if any.
+ *          This function must be called before calling osal_nv_read() or
+ *          osal_nv_write().
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   len - Item length.
+ * @param  *buf - Pointer to item initalization data. Set to NULL if none.
+ *
+ * @return  NV_ITEM_UNINIT - Id did not exist and was created successfully.
+ *          SUCCESS        - Id already existed, no action taken.
+ *          NV_OPER_FAILED - Failure to find or create Id, or a reserved Id.
+ */
+uint8 osal_nv_item_init( uint16 id, uint16 len, void *buf )
+{
+  uint16 offset;
+
+  // The Ids with OSAL_NV_RSVD_ID set are the reserved ones, never user items.
+  if ( !OSAL_NV_CHECK_BUS_VOLTAGE || (id & OSAL_NV_RSVD_ID) )
+  {
+    return NV_OPER_FAILED;
+  }
+  else if ((offset = findItem(id)) != OSAL_NV_ITEM_NULL)
+  {
+    // Re-populate the NV hot item data if the corresponding items are already established.
+    hotItemUpdate(findPg, offset, id);
+
+    return SUCCESS;
+  }
+  else if ( initItem( TRUE, id, len, buf ) != OSAL_NV_PAGE_NULL )
+  {
+#if OSAL_NV_SNAPSHOT
+    nvChangeCnt++;
+#endif
+#if OSAL_NV_BG_COMPACT
+    bgCheck();
+#endif
+    return NV_ITEM_UNINIT;
+  }
+  else
+  {
+    return NV_OPER_FAILED;
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_nv_item_len
+ *
+ * @brief   Get the data length of the item stored in NV memory.
+ *
+ * @param   id  - Valid NV item Id.
+ *
+ * @return  Item length, if found; zero otherwise.
+ */
+uint16 osal_nv_item_len( uint16 id )
+{
+  osalNvHdr_t hdr;
+  uint16 offset;
+  uint8 hotIdx;
+
+  if ((hotIdx = hotItem(id)) < OSAL_NV_MAX_HOT)
+  {
+    findPg = hotPg[hotIdx];
+    offset = hotOff[hotIdx];
+  }
+  else if ((offset = findItem(id)) == OSAL_NV_ITEM_NULL)
+  {
+    return 0;
+  }
+
+  HalFlashRead(findPg, (offset - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+  return hdr.len;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_write
+ *
+ * @brief   Write a data item to NV. Function can write an entire item to NV or
+ *          an element of an item by indexing into the item with an offset.
+ *          With OSAL_NV_CACHE, the write may only update the cached copy of
+ *          the item; see osal_nv_flush(). Between osal_nv_txn_begin() and
+ *          osal_nv_txn_commit(), the write is only staged.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   ndx - Index offset into item
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_ITEM_UNINIT if item did not
+ *          exist in NV and offset is non-zero, NV_OPER_FAILED if failure or a reserved Id.
+ */
+uint8 osal_nv_write( uint16 id, uint16 ndx, uint16 len, void *buf )
+{
+#if OSAL_NV_CACHE
+  osalNvCache_t *pEnt;
+#endif
+
+  if ( id & OSAL_NV_RSVD_ID )
+  {
+    return NV_OPER_FAILED;
+  }
+
+#if OSAL_NV_SNAPSHOT
+  nvChangeCnt++;
+#endif
+
+#if OSAL_NV_TXN
+  if ( nvTxnOpen && (len != 0) )
+  {
+    return txnStage( id, ndx, len, buf );
+  }
+#endif
+
+#if OSAL_NV_CACHE
+
+  if ( (len != 0) && ((pEnt = cacheGet( id )) != NULL) )
+  {
+    if ( (uint32)ndx + len > pEnt->len )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    osal_memcpy( pEnt->buf + ndx, buf, len );
+    return SUCCESS;
+  }
+#endif
+
+  return nvWrite( id, ndx, len, buf );
+}
+
+/*********************************************************************
+ * @fn      nvWrite
+ *
+ * @brief   Write a data item to NV flash; the body of osal_nv_write().
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   ndx - Index offset into item
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_ITEM_UNINIT if item did not
+ *          exist in NV and offset is non-zero, NV_OPER_FAILED if failure.
+ */
+static uint8 nvWrite( uint16 id, uint16 ndx, uint16 len, void *buf )
+{
+  uint8 rtrn = SUCCESS;
+
+  if ( !OSAL_NV_CHECK_BUS_VOLTAGE )
+  {
+    return NV_OPER_FAILED;
+  }
+  else if ( len != 0 )
+  {
+    osalNvHdr_t hdr;
+    uint16 origOff, srcOff;
+    uint16 cnt, chk;
+    uint8 *ptr, srcPg;
+
+    origOff = srcOff = findItem( id );
+    srcPg = findPg;
+#if OSAL_NV_BG_COMPACT
+    /* The xfer-marked copy on the page being compacted would be transferred again by the recovery
+     * of a reset before the compaction finishes, so such an item is only rewritten after it has.
+     */
+    if ( (bgPg != OSAL_NV_PAGE_NULL) && ((srcPg == bgPg) || (srcPg == pgRes)) )
+    {
+      bgFinish();
+      origOff = srcOff = findItem( id );
+      srcPg = findPg;
+    }
+#endif
+    if ( srcOff == OSAL_NV_ITEM_NULL )
+    {
+      return NV_ITEM_UNINIT;
+    }
+
+    HalFlashRead(srcPg, (srcOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+    if ( hdr.len < (ndx + len) )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    srcOff += ndx;
+    ptr = buf;
+    cnt = len;
+    chk = 0;
+    while ( cnt-- )
+    {
+      uint8 tmp;
+      HalFlashRead(srcPg, srcOff, &tmp, 1);
+      if ( tmp != *ptr )
+      {
+        chk = 1;  // Mark that at least one byte is different.
+        // Calculate expected checksum after transferring old data and writing new data.
+        hdr.chk -= tmp;
+        hdr.chk += *ptr;
+      }
+      srcOff++;
+      ptr++;
+    }
+
+    if ( chk != 0 )  // If the buffer to write is different in one or more bytes.
+    {
+      uint8 comPg = OSAL_NV_PAGE_NULL;
+      uint8 dstPg = initItem( FALSE, id, hdr.len, &comPg );
+
+      if ( dstPg != OSAL_NV_PAGE_NULL )
+      {
+        uint16 tmp = OSAL_NV_DATA_SIZE( hdr.len );
+        uint16 dstOff = pgOff[dstPg-OSAL_NV_PAGE_BEG] - tmp;
+        srcOff = origOff;
+
+        /* Prevent excessive re-writes to item header caused by numerous, rapid, & successive
+         * OSAL_Nv interruptions caused by resets.
+         */
+        if ( hdr.stat == OSAL_NV_ERASED_ID )
+        {
+          setItem( srcPg, srcOff, eNvXfer );
+        }
+
+        /* Each word of the new copy is put together before it is programmed, rather than once
+         * for the old data before 'ndx', once for 'buf' and once for the old data after it.
+         */
+        for ( cnt = 0; cnt < hdr.len; cnt += OSAL_NV_WORD_SIZE )
+        {
+          uint8 word[OSAL_NV_WORD_SIZE];
+          uint8 idx;
+
+          HalFlashRead(srcPg, (srcOff + cnt), word, OSAL_NV_WORD_SIZE);
+          for ( idx = 0; idx < OSAL_NV_WORD_SIZE; idx++ )
+          {
+            if ( ((cnt + idx) >= ndx) && ((cnt + idx) < (ndx + len)) )
+            {
+              word[idx] = ((uint8 *)buf)[cnt + idx - ndx];
+            }
+          }
+
+          writeWord( dstPg, (dstOff + cnt), word );
+        }
+
+        // Calculate and write the new checksum.
+        if ( hdr.chk == calcChkF( dstPg, dstOff, hdr.len ) )
+        {
+          if ( hdr.chk != setChk( dstPg, dstOff, hdr.chk ) )
+          {
+            rtrn = NV_OPER_FAILED;
+          }
+          else
+          {
+            hotItemUpdate(dstPg, dstOff, hdr.id);
+          }
+        }
+        else
+        {
+          rtrn = NV_OPER_FAILED;
+        }
+      }
+      else
+      {
+        rtrn = NV_OPER_FAILED;
+      }
+
+      if ( comPg != OSAL_NV_PAGE_NULL )
+      {
+        /* Even though the page compaction succeeded, if the new item is coming from the compacted
+         * page and writing the new value failed, then the compaction must be aborted.
+         */
+        if ( (srcPg == comPg) && (rtrn == NV_OPER_FAILED) )
+        {
+          erasePage( pgRes );
+        }
+        else
+        {
+          COMPACT_PAGE_CLEANUP( comPg );
+        }
+      }
+
+      /* Zero of the old item must wait until after compact page cleanup has finished - if the item
+       * is zeroed before and cleanup is interrupted by a power-cycle, the new item can be lost.
+       */
+      if ( (srcPg != comPg) && (rtrn != NV_OPER_FAILED) )
+      {
+        setItem( srcPg, origOff, eNvZero );
+      }
+
+#if OSAL_NV_BG_COMPACT
+      bgCheck();
+#endif
+    }
+  }
+
+  return rtrn;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_read
+ *
+ * @brief   Read data from NV. This function can be used to read an entire item from NV or
+ *          an element of an item by indexing into the item with an offset.
+ *          Read data is copied into *buf.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   ndx - Index offset into item
+ * @param   len - Length of data to read.
+ * @param  *buf - Data is read into this buffer.
+ *
+ * @return  SUCCESS if NV data was copied to the parameter 'buf'.
+ *          Otherwise, NV_OPER_FAILED for failure.
+ */
+uint8 osal_nv_read( uint16 id, uint16 ndx, uint16 len, void *buf )
+{
+  uint16 offset;
+  uint8 hotIdx;
+#if OSAL_NV_TXN
+  osalNvTxn_t *pTxn;
+#endif
+#if OSAL_NV_CACHE
+  osalNvCache_t *pEnt;
+#endif
+
+#if OSAL_NV_TXN
+  if ( nvTxnOpen && ((pTxn = txnFind( id )) != NULL) )
+  {
+    if ( (uint32)ndx + len > pTxn->len )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    osal_memcpy( buf, pTxn->buf + ndx, len );
+    return SUCCESS;
+  }
+#endif
+
+#if OSAL_NV_CACHE
+  if ( (pEnt = cacheFind( id )) != NULL )
+  {
+    if ( (uint32)ndx + len > pEnt->len )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    osal_memcpy( buf, pEnt->buf + ndx, len );
+    return SUCCESS;
+  }
+#endif
+
+  if ((hotIdx = hotItem(id)) < OSAL_NV_MAX_HOT)
+  {
+    HalFlashRead(hotPg[hotIdx], hotOff[hotIdx]+ndx, buf, len);
+    return SUCCESS;
+  }
+
+  if ((offset = findItem(id)) == OSAL_NV_ITEM_NULL)
+  {
+    return NV_OPER_FAILED;
+  }
+  else
+  {
+    HalFlashRead(findPg, offset+ndx, buf, len);
+    return SUCCESS;
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_nv_delete
+ *
+ * @brief   Delete item from NV. This function will fail if the length
+ *          parameter does not match the length of the item in NV.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   len - Length of item to delete.
+ *
+ * @return  SUCCESS if item was deleted,
+ *          NV_ITEM_UNINIT if item did not exist in NV,
+ *          NV_BAD_ITEM_LEN if length parameter not correct,
+ *          NV_OPER_FAILED if attempted deletion failed or the Id is reserved.
+ */
+uint8 osal_nv_delete( uint16 id, uint16 len )
+{
+  uint16 length;
+  uint16 offset;
+#if OSAL_NV_CACHE
+  osalNvCache_t *pEnt;
+#endif
+
+  if ( id & OSAL_NV_RSVD_ID )
+  {
+    return NV_OPER_FAILED;
+  }
+
+  offset = findItem( id );
+#if OSAL_NV_BG_COMPACT
+  // As in nvWrite(), an item is not zeroed while a compaction could resurrect its other copy.
+  if ( (bgPg != OSAL_NV_PAGE_NULL) && ((findPg == bgPg) || (findPg == pgRes)) )
+  {
+    bgFinish();
+    offset = findItem( id );
+  }
+#endif
+  if ( offset == OSAL_NV_ITEM_NULL )
+  {
+    // NV item does not exist
+    return NV_ITEM_UNINIT;
+  }
+
+  length = osal_nv_item_len( id );
+  if ( length != len )
+  {
+    // NV item has different length
+    return NV_BAD_ITEM_LEN;
+  }
+
+#if OSAL_NV_TXN
+  // Staged changes to a deleted item are dropped, not committed.
+  if ( nvTxnOpen )
+  {
+    osalNvTxn_t *pTxn = txnFind( id );
+
+    if ( pTxn != NULL )
+    {
+      osal_mem_free( pTxn->buf );
+      *pTxn = nvTxn[--nvTxnCnt];
+    }
+  }
+#endif
+
+#if OSAL_NV_CACHE
+  // Cached changes to a deleted item are dropped.
+  if ( (pEnt = cacheFind( id )) != NULL )
+  {
+    osal_mem_free( pEnt->buf );
+    pEnt->id = OSAL_NV_ITEM_NULL;
+  }
+#endif
+
+#if OSAL_NV_SNAPSHOT
+  nvChangeCnt++;
+#endif
+
+  // Set item header ID to zero to 'delete' the item
+  setItem( findPg, offset, eNvZero );
+#if OSAL_NV_INDEX
+  idxRemove( id );
+#endif
+
+  // Verify that item has been removed
+  offset = findItem( id );
+  if ( offset != OSAL_NV_ITEM_NULL )
+  {
+    // Still there
+    return NV_OPER_FAILED;
+  }
+  else
+  {
+    // Yes, it's gone
+    return SUCCESS;
+  }
+}
+
+#if OSAL_NV_SNAPSHOT
+/*********************************************************************
+ * @fn      osal_nv_next_id
+ *
+ * @brief   Get the Id of the item that follows 'id' in Id order, for
+ *          going through all of the items in NV.
+ *
+ * @param   id - An item Id, or zero to get the first item.
+ *
+ * @return  The lowest Id above 'id' of an item in NV; zero if none.
+ */
+uint16 osal_nv_next_id( uint16 id )
+{
+  uint16 next;
+  uint8 pg;
+
+  if ( id >= (OSAL_NV_RSVD_ID - 1) )
+  {
+    return OSAL_NV_ZEROED_ID;
+  }
+
+#if OSAL_NV_INDEX
+  if ( nvIdxReady && !nvIdxFull )
+  {
+    uint16 idx = idxFind( id + 1 );
+
+    if ( (idx < nvIdxCnt) && ((nvIdx[idx].id & OSAL_NV_RSVD_ID) == 0) )
+    {
+      return nvIdx[idx].id;
+    }
+
+    return OSAL_NV_ZEROED_ID;
+  }
+#endif
+
+  while ( TRUE )
+  {
+    // The Ids with OSAL_NV_RSVD_ID set are the reserved ones, never reported.
+    next = OSAL_NV_RSVD_ID;
+
+    for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
+    {
+      uint16 offset = OSAL_NV_PAGE_HDR_SIZE;
+
+      while ( offset < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE) )
+      {
+        osalNvHdr_t hdr;
+        uint16 sz;
+
+        HalFlashRead(pg, offset, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+
+        if ( hdr.id == OSAL_NV_ERASED_ID )
+        {
+          break;
+        }
+
+        sz = OSAL_NV_DATA_SIZE( hdr.len );
+        if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - offset) )
+        {
+          break;
+        }
+
+        if ( (hdr.id > id) && (hdr.id < next) )
+        {
+          next = hdr.id;
+        }
+
+        offset += OSAL_NV_HDR_SIZE + sz;
+      }
+    }
+
+    if ( next == OSAL_NV_RSVD_ID )
+    {
+      return OSAL_NV_ZEROED_ID;
+    }
+
+    // A header found by the walk may be that of a copy which findItem() does not accept.
+    if ( osal_nv_item_len( next ) != 0 )
+    {
+      return next;
+    }
+
+    id = next;
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_nv_changes
+ *
+ * @brief   Get the count of the calls that may have changed NV items:
+ *          a series of reads with the same count before and after it
+ *          saw one consistent NV.
+ *
+ * @param   none
+ *
+ * @return  The change count, which wraps around.
+ */
+uint16 osal_nv_changes( void )
+{
+  return nvChangeCnt;
+}
+#endif
+
+#if defined ( OSAL_NV_EXTENDED )
+/*********************************************************************
+ * @fn      exItemId
+ *
+ * @brief   Get the Id of the item that holds an extended NV item.
+ *
+ * @param   id - Table Id, ZCD_NV_EX_LEGACY for a legacy item.
+ * @param   subId - Item within the table; the legacy item Id for ZCD_NV_EX_LEGACY.
+ *
+ * @return  The NV item Id; OSAL_NV_ITEM_NULL if out of range.
+ */
+static uint16 exItemId( uint16 id, uint16 subId )
+{
+  if ( id == ZCD_NV_EX_LEGACY )
+  {
+    return ( (subId < OSAL_NV_EX_BASE) ? subId : OSAL_NV_ITEM_NULL );
+  }
+  else if ( (id > OSAL_NV_EX_TABLES) || (subId >= (1 << OSAL_NV_EX_SUB_BITS)) )
+  {
+    return OSAL_NV_ITEM_NULL;
+  }
+
+  return ( OSAL_NV_EX_BASE + ((id - 1) << OSAL_NV_EX_SUB_BITS) + subId );
+}
+
+/*********************************************************************
+ * @fn      osal_nv_item_init_ex
+ *
+ * @brief   osal_nv_item_init() of an extended NV item.
+ *
+ * @param   id  - Table Id.
+ * @param   subId - Item within the table.
+ * @param   len - Item length.
+ * @param  *buf - Pointer to item initalization data. Set to NULL if none.
+ *
+ * @return  As osal_nv_item_init(); NV_OPER_FAILED for an Id out of range.
+ */
+uint8 osal_nv_item_init_ex( uint16 id, uint16 subId, uint16 len, void *buf )
+{
+  uint16 nvId = exItemId( id, subId );
+
+  return ( (nvId == OSAL_NV_ITEM_NULL) ? NV_OPER_FAILED : osal_nv_item_init( nvId, len, buf ) );
+}
+
+/*********************************************************************
+ * @fn      osal_nv_read_ex
+ *
+ * @brief   Read 'len' bytes of an extended NV item from 'offset'. An item
+ *          can be as large as an NV page less the headers, so a large one
+ *          is read in chunks at increasing offsets.
+ *
+ * @param   id  - Table Id.
+ * @param   subId - Item within the table.
+ * @param   offset - Index into the item data.
+ * @param   len - Length of data to read.
+ * @param  *buf - Data is read into this buffer.
+ *
+ * @return  As osal_nv_read(); NV_OPER_FAILED for an Id out of range.
+ */
+uint8 osal_nv_read_ex( uint16 id, uint16 subId, uint16 offset, uint16 len, void *buf )
+{
+  uint16 nvId = exItemId( id, subId );
+
+  return ( (nvId == OSAL_NV_ITEM_NULL) ? NV_OPER_FAILED : osal_nv_read( nvId, offset, len, buf ) );
+}
+
+/*********************************************************************
+ * @fn      osal_nv_write_ex
+ *
+ * @brief   Write 'len' bytes of an extended NV item from 'offset'.
+ *
+ * @param   id  - Table Id.
+ * @param   subId - Item within the table.
+ * @param   offset - Index into the item data.
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  As osal_nv_write(); NV_OPER_FAILED for an Id out of range.
+ */
+uint8 osal_nv_write_ex( uint16 id, uint16 subId, uint16 offset, uint16 len, void *buf )
+{
+  uint16 nvId = exItemId( id, subId );
+
+  return ( (nvId == OSAL_NV_ITEM_NULL) ? NV_OPER_FAILED : osal_nv_write( nvId, offset, len, buf ) );
+}
+
+/*********************************************************************
+ * @fn      osal_nv_item_len_ex
+ *
+ * @brief   Get the data length of an extended NV item.
+ *
+ * @param   id  - Table Id.
+ * @param   subId - Item within the table.
+ *
+ * @return  The item length, if found; zero otherwise.
+ */
+uint16 osal_nv_item_len_ex( uint16 id, uint16 subId )
+{
+  uint16 nvId = exItemId( id, subId );
+
+  return ( (nvId == OSAL_NV_ITEM_NULL) ? 0 : osal_nv_item_len( nvId ) );
+}
+
+/*********************************************************************
+ * @fn      osal_nv_delete_ex
+ *
+ * @brief   Delete an extended NV item.
+ *
+ * @param   id  - Table Id.
+ * @param   subId - Item within the table.
+ * @param   len - Length of the item.
+ *
+ * @return  As osal_nv_delete(); NV_OPER_FAILED for an Id out of range.
+ */
+uint8 osal_nv_delete_ex( uint16 id, uint16 subId, uint16 len )
+{
+  uint16 nvId = exItemId( id, subId );
+
+  return ( (nvId == OSAL_NV_ITEM_NULL) ? NV_OPER_FAILED : osal_nv_delete( nvId, len ) );
+}
+#endif
+
+#if OSAL_NV_CACHE
+/*********************************************************************
+ * @fn      cacheFind
+ *
+ * @brief   Look for an item in the NV cache.
+ *
+ * @param   id - Valid NV item Id.
+ *
+ * @return  The cache entry holding the item; NULL if it is not cached.
+ */
+static osalNvCache_t *cacheFind( uint16 id )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < OSAL_NV_CACHE_CNT; idx++ )
+  {
+    if ( nvCache[idx].id == id )
+    {
+      return &nvCache[idx];
+    }
+  }
+
+  return NULL;
+}
+
+/*********************************************************************
+ * @fn      cacheGet
+ *
+ * @brief   Find or create the NV cache entry that a write to an item
+ *          should update. A new entry is loaded with the item from flash
+ *          and starts the flush deadline if it is the only one.
+ *
+ * @param   id - Valid NV item Id.
+ *
+ * @return  The cache entry; NULL if the write must go straight to flash
+ *          (the item opts out, is too long, does not exist, or there is
+ *          no room to cache it).
+ */
+static osalNvCache_t *cacheGet( uint16 id )
+{
+  osalNvCache_t *pEnt;
+  uint16 len;
+  uint8 idx, used = 0;
+
+  if ( (pEnt = cacheFind( id )) != NULL )
+  {
+    return pEnt;
+  }
+
+  for ( idx = 0; idx < OSAL_NV_CACHE_BYPASS_CNT; idx++ )
+  {
+    if ( cacheBypassIds[idx] == id )
+    {
+      return NULL;
+    }
+  }
+
+  len = osal_nv_item_len( id );
+  if ( (len == 0) || (len > OSAL_NV_CACHE_MAX_LEN) )
+  {
+    return NULL;
+  }
+
+  for ( idx = 0; idx < OSAL_NV_CACHE_CNT; idx++ )
+  {
+    if ( nvCache[idx].id == OSAL_NV_ITEM_NULL )
+    {
+      pEnt = &nvCache[idx];
+    }
+    else
+    {
+      used++;
+    }
+  }
+
+  if ( pEnt == NULL )
+  {
+    // Every entry is taken: make room by flushing the entries in turn.
+    pEnt = &nvCache[nvCacheVictim];
+    nvCacheVictim = (nvCacheVictim + 1) % OSAL_NV_CACHE_CNT;
+
+    if ( cacheFlush( pEnt ) != SUCCESS )
+    {
+      return NULL;
+    }
+    used--;
+  }
+
+  if ( (pEnt->buf = osal_mem_alloc( len )) == NULL )
+  {
+    return NULL;
+  }
+
+  (void)osal_nv_read( id, 0, len, pEnt->buf );
+  pEnt->id = id;
+  pEnt->len = len;
+
+  if ( (used == 0) && (nvTaskId != TASK_NO_TASK) )
+  {
+    (void)osal_start_timerEx( nvTaskId, OSAL_NV_FLUSH_EVT, OSAL_NV_CACHE_DELAY );
+  }
+
+  return pEnt;
+}
+
+/*********************************************************************
+ * @fn      cacheFlush
+ *
+ * @brief   Write a cached item to flash and free its cache entry.
+ *
+ * @param   pEnt - A cache entry in use.
+ *
+ * @return  SUCCESS, or the failure of the flash write - then the entry
+ *          stays in use.
+ */
+static uint8 cacheFlush( osalNvCache_t *pEnt )
+{
+  uint8 rtrn = nvWrite( pEnt->id, 0, pEnt->len, pEnt->buf );
+
+  if ( rtrn == SUCCESS )
+  {
+    osal_mem_free( pEnt->buf );
+    pEnt->id = OSAL_NV_ITEM_NULL;
+  }
+
+  return rtrn;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_flush
+ *
+ * @brief   Write every item held in the NV cache to flash. Repeated
+ *          writes to a cached item since the last flush cost one item
+ *          write here.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS if the cache is empty; NV_OPER_FAILED if some item
+ *          could not be written - it stays cached to be retried.
+ */
+uint8 osal_nv_flush( void )
+{
+  uint8 rtrn = SUCCESS;
+  uint8 idx;
+
+  for ( idx = 0; idx < OSAL_NV_CACHE_CNT; idx++ )
+  {
+    if ( (nvCache[idx].id != OSAL_NV_ITEM_NULL) && (cacheFlush( &nvCache[idx] ) != SUCCESS) )
+    {
+      rtrn = NV_OPER_FAILED;
+    }
+  }
+
+  if ( nvTaskId != TASK_NO_TASK )
+  {
+    if ( rtrn == SUCCESS )
+    {
+      (void)osal_stop_timerEx( nvTaskId, OSAL_NV_FLUSH_EVT );
+    }
+    else
+    {
+      (void)osal_start_timerEx( nvTaskId, OSAL_NV_FLUSH_EVT, OSAL_NV_CACHE_DELAY );
+    }
+  }
+
+  return rtrn;
+}
+#endif
+
+#if OSAL_NV_TXN
+/*********************************************************************
+ * @fn      osal_nv_txn_begin
+ *
+ * @brief   Start staging NV writes: until osal_nv_txn_commit() or
+ *          osal_nv_txn_abort(), osal_nv_write() only updates a RAM copy
+ *          of the whole item, which osal_nv_read() returns.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS, or NV_OPER_FAILED if a transaction is already open.
+ */
+uint8 osal_nv_txn_begin( void )
+{
+  if ( nvTxnOpen )
+  {
+    return NV_OPER_FAILED;
+  }
+
+  nvTxnOpen = TRUE;
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_txn_commit
+ *
+ * @brief   Write the items staged since osal_nv_txn_begin() to flash in
+ *          one pass onto a single page, behind a commit record that lists
+ *          them. Setting the status of the record commits the new copies;
+ *          only then are the old ones zeroed. If a reset interrupts the
+ *          commit, initNV() completes it if the record was set and
+ *          otherwise drops every new copy. No header word is programmed
+ *          more than twice between erases, as the flash requires.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS if all items were written; NV_OPER_FAILED if none
+ *          were, because the items do not fit on one page or the flash
+ *          write failed. The staged items are dropped either way.
+ */
+uint8 osal_nv_txn_commit( void )
+{
+  uint8 rtrn = SUCCESS;
+
+  if ( !nvTxnOpen )
+  {
+    return NV_OPER_FAILED;
+  }
+  nvTxnOpen = FALSE;
+#if OSAL_NV_SNAPSHOT
+  nvChangeCnt++;
+#endif
+
+  if ( nvTxnCnt != 0 )
+  {
+    uint16 loc[OSAL_NV_TXN_CNT];
+    uint16 sz;
+    uint8 idx, pg = OSAL_NV_PAGE_NULL;
+
+    // As with osal_nv_write(), an item rewritten with its contents in flash needs no new copy.
+    for ( idx = 0; idx < nvTxnCnt; )
+    {
+      uint16 off = findItem( nvTxn[idx].id );
+
+      for ( sz = 0; (off != OSAL_NV_ITEM_NULL) && (sz < nvTxn[idx].len); sz++ )
+      {
+        uint8 tmp;
+        HalFlashRead(findPg, off+sz, &tmp, 1);
+        if ( tmp != nvTxn[idx].buf[sz] )
+        {
+          break;
+        }
+      }
+
+      if ( (off == OSAL_NV_ITEM_NULL) || (sz != nvTxn[idx].len) )
+      {
+        idx++;
+        continue;
+      }
+
+#if OSAL_NV_CACHE
+      {
+        osalNvCache_t *pEnt = cacheFind( nvTxn[idx].id );
+
+        if ( pEnt != NULL )
+        {
+          osal_mem_free( pEnt->buf );
+          pEnt->id = OSAL_NV_ITEM_NULL;
+        }
+      }
+#endif
+      osal_mem_free( nvTxn[idx].buf );
+      nvTxn[idx] = nvTxn[--nvTxnCnt];
+    }
+
+    sz = OSAL_NV_ITEM_SIZE( nvTxnCnt * sizeof( uint16 ) );
+    for ( idx = 0; idx < nvTxnCnt; idx++ )
+    {
+      sz += OSAL_NV_ITEM_SIZE( nvTxn[idx].len );
+    }
+
+    if ( (nvTxnCnt != 0) && OSAL_NV_CHECK_BUS_VOLTAGE &&
+         (sz <= (OSAL_NV_PAGE_SIZE - OSAL_NV_PAGE_HDR_SIZE)) )
+    {
+#if OSAL_NV_BG_COMPACT
+      bgFinish();  // The old copies are zeroed below, which must not race a compaction.
+#endif
+      pg = txnPage( sz );
+    }
+
+    if ( nvTxnCnt == 0 )
+    {
+      // Nothing changed.
+    }
+    else if ( pg == OSAL_NV_PAGE_NULL )
+    {
+      rtrn = NV_OPER_FAILED;
+    }
+    else
+    {
+      uint16 old[OSAL_NV_TXN_CNT];
+      uint8 oldPg[OSAL_NV_TXN_CNT];
+      uint16 recOff = pgOff[pg - OSAL_NV_PAGE_BEG] + OSAL_NV_HDR_SIZE;
+      uint8 commit = FALSE;
+      osalNvHdr_t hdr;
+
+      // The commit record comes first, listing where the new copies are to be written after it.
+      sz = recOff + OSAL_NV_DATA_SIZE( nvTxnCnt * sizeof( uint16 ) );
+      for ( idx = 0; idx < nvTxnCnt; idx++ )
+      {
+        loc[idx] = sz + OSAL_NV_HDR_SIZE;
+        sz += OSAL_NV_ITEM_SIZE( nvTxn[idx].len );
+
+        old[idx] = findItem( nvTxn[idx].id );
+        oldPg[idx] = findPg;
+      }
+
+      if ( writeItem( pg, OSAL_NV_TXN_REC, (nvTxnCnt * sizeof( uint16 )), loc, TRUE ) )
+      {
+        for ( idx = 0; idx < nvTxnCnt; idx++ )
+        {
+          if ( !writeItem( pg, nvTxn[idx].id, nvTxn[idx].len, nvTxn[idx].buf, TRUE ) )
+          {
+            break;
+          }
+        }
+
+        // Setting the status of the commit record is the one flash write that commits them all.
+        if ( idx == nvTxnCnt )
+        {
+          setItem( pg, recOff, eNvXfer );
+          HalFlashRead(pg, (recOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+          commit = (hdr.stat != OSAL_NV_ERASED_ID);
+        }
+      }
+
+      if ( commit )
+      {
+        for ( idx = 0; idx < nvTxnCnt; idx++ )
+        {
+          if ( old[idx] != OSAL_NV_ITEM_NULL )
+          {
+            setItem( oldPg[idx], old[idx], eNvZero );
+          }
+        }
+
+#if OSAL_NV_CACHE
+        // The committed copies include, and so replace, any cached changes.
+        for ( idx = 0; idx < nvTxnCnt; idx++ )
+        {
+          osalNvCache_t *pEnt = cacheFind( nvTxn[idx].id );
+
+          if ( pEnt != NULL )
+          {
+            osal_mem_free( pEnt->buf );
+            pEnt->id = OSAL_NV_ITEM_NULL;
+          }
+        }
+#endif
+      }
+      else
+      {
+        // Drop whatever new copies were written, and put the old ones back in the index.
+        for ( idx = 0; idx < nvTxnCnt; idx++ )
+        {
+          HalFlashRead(pg, (loc[idx] - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+          if ( hdr.id == nvTxn[idx].id )
+          {
+            setItem( pg, loc[idx], eNvZero );
+          }
+
+          if ( old[idx] != OSAL_NV_ITEM_NULL )
+          {
+            hotItemUpdate( oldPg[idx], old[idx], nvTxn[idx].id );
+          }
+#if OSAL_NV_INDEX
+          else
+          {
+            idxRemove( nvTxn[idx].id );
+          }
+#endif
+        }
+
+        rtrn = NV_OPER_FAILED;
+      }
+
+      // Last, so that a reset before it leaves txnRecover() to finish either of the above.
+      HalFlashRead(pg, (recOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+      if ( hdr.id == OSAL_NV_TXN_REC )
+      {
+        setItem( pg, recOff, eNvZero );
+      }
+    }
+  }
+
+  txnFree();
+#if OSAL_NV_BG_COMPACT
+  bgCheck();
+#endif
+
+  return rtrn;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_txn_abort
+ *
+ * @brief   Drop the items staged since osal_nv_txn_begin().
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osal_nv_txn_abort( void )
+{
+  txnFree();
+  nvTxnOpen = FALSE;
+}
+
+/*********************************************************************
+ * @fn      txnFind
+ *
+ * @brief   Find the staged copy of an item.
+ *
+ * @param   id - Valid NV item Id.
+ *
+ * @return  Pointer to the staged item, or NULL if it is not staged.
+ */
+static osalNvTxn_t *txnFind( uint16 id )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < nvTxnCnt; idx++ )
+  {
+    if ( nvTxn[idx].id == id )
+    {
+      return &nvTxn[idx];
+    }
+  }
+
+  return NULL;
+}
+
+/*********************************************************************
+ * @fn      txnStage
+ *
+ * @brief   Stage a write to an item; the first one copies the current
+ *          item contents into RAM.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   ndx - Index offset into item
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  SUCCESS if staged, NV_ITEM_UNINIT if the item does not exist,
+ *          NV_OPER_FAILED if out of range or out of staging space.
+ */
+static uint8 txnStage( uint16 id, uint16 ndx, uint16 len, void *buf )
+{
+  osalNvTxn_t *pTxn = txnFind( id );
+
+  if ( pTxn == NULL )
+  {
+    uint16 itemLen = osal_nv_item_len( id );
+
+    if ( itemLen == 0 )
+    {
+      return NV_ITEM_UNINIT;
+    }
+    else if ( nvTxnCnt == OSAL_NV_TXN_CNT )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    pTxn = &nvTxn[nvTxnCnt];
+    if ( (pTxn->buf = osal_mem_alloc( itemLen )) == NULL )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    // Not yet counted, so the read returns the cached or flash contents.
+    if ( osal_nv_read( id, 0, itemLen, pTxn->buf ) != SUCCESS )
+    {
+      osal_mem_free( pTxn->buf );
+      return NV_OPER_FAILED;
+    }
+
+    pTxn->id = id;
+    pTxn->len = itemLen;
+    nvTxnCnt++;
+  }
+
+  if ( (uint32)ndx + len > pTxn->len )
+  {
+    return NV_OPER_FAILED;
+  }
+
+  osal_memcpy( pTxn->buf + ndx, buf, len );
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      txnPage
+ *
+ * @brief   Find a page with 'sz' erased bytes for a transaction,
+ *          compacting one if that is the only way to get them.
+ *
+ * @param   sz - Bytes needed, headers included.
+ *
+ * @return  The page, or OSAL_NV_PAGE_NULL if there is no room.
+ */
+static uint8 txnPage( uint16 sz )
+{
+  uint8 cnt, pg = pgRes+1, comPg = OSAL_NV_PAGE_NULL;
+
+  for ( cnt = 0; cnt < OSAL_NV_PAGES_USED; cnt++, pg++ )
+  {
+    if (pg >= OSAL_NV_PAGE_BEG+OSAL_NV_PAGES_USED)
+    {
+      pg = OSAL_NV_PAGE_BEG;
+    }
+
+    if ( pg != pgRes )
+    {
+      uint8 idx = pg - OSAL_NV_PAGE_BEG;
+
+      if ( sz <= (OSAL_NV_PAGE_SIZE - pgOff[idx]) )
+      {
+        return pg;
+      }
+      else if ( (comPg == OSAL_NV_PAGE_NULL) &&
+                (sz <= (OSAL_NV_PAGE_SIZE - pgOff[idx] + pgLost[idx])) )
+      {
+        comPg = pg;
+      }
+    }
+  }
+
+  // The compacted items land on the reserve page, leaving the rest of it for the transaction.
+  pg = pgRes;
+  if ( (comPg != OSAL_NV_PAGE_NULL) && compactPage( comPg, OSAL_NV_ITEM_NULL ) &&
+       (sz <= (OSAL_NV_PAGE_SIZE - pgOff[pg - OSAL_NV_PAGE_BEG])) )
+  {
+    return pg;
+  }
+
+  return OSAL_NV_PAGE_NULL;
+}
+
+/*********************************************************************
+ * @fn      txnApply
+ *
+ * @brief   At power-up, finish a commit that a reset interrupted: if the
+ *          record was set, zero every other current copy of the items it
+ *          lists; if not, zero the listed copies. Then zero the record.
+ *
+ * @param   pg - Valid NV page of the commit record.
+ * @param   recOff - Offset into the page of the commit record data.
+ *
+ * @return  none
+ */
+static void txnApply( uint8 pg, uint16 recOff )
+{
+  osalNvHdr_t hdr;
+  uint16 cnt;
+
+  HalFlashRead(pg, (recOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+
+  for ( cnt = 0; cnt < hdr.len; cnt += sizeof( uint16 ) )
+  {
+    osalNvHdr_t item;
+    uint16 loc;
+
+    HalFlashRead(pg, (recOff + cnt), (uint8 *)(&loc), sizeof( loc ));
+
+    // The copies follow the record on its page; any other location is not one that it wrote.
+    if ( (loc < (recOff + OSAL_NV_DATA_SIZE( hdr.len ) + OSAL_NV_HDR_SIZE)) ||
+         (loc > (OSAL_NV_PAGE_SIZE - OSAL_NV_WORD_SIZE)) || ((loc % OSAL_NV_WORD_SIZE) != 0) )
+    {
+      continue;
+    }
+
+    HalFlashRead(pg, (loc - OSAL_NV_HDR_SIZE), (uint8 *)(&item), OSAL_NV_HDR_SIZE);
+
+    if ( (item.id == OSAL_NV_ERASED_ID) || (item.id == OSAL_NV_ZEROED_ID) ||
+         (item.id & OSAL_NV_RSVD_ID) || (OSAL_NV_DATA_SIZE( item.len ) > (OSAL_NV_PAGE_SIZE - loc)) )
+    {
+      continue;
+    }
+
+    if ( hdr.stat == OSAL_NV_ERASED_ID )
+    {
+      setItem( pg, loc, eNvZero );
+    }
+    else
+    {
+      uint8 oldPg;
+
+      // On its page, the new copy is the last one written; an old copy can only come before it.
+      for ( oldPg = OSAL_NV_PAGE_BEG; oldPg <= OSAL_NV_PAGE_END; oldPg++ )
+      {
+        uint16 off;
+
+        while ( ((off = initPage( oldPg, item.id, FALSE )) != OSAL_NV_ITEM_NULL) &&
+                ((oldPg != pg) || (off != loc)) )
+        {
+          setItem( oldPg, off, eNvZero );
+        }
+      }
+    }
+  }
+
+  setItem( pg, recOff, eNvZero );
+}
+
+/*********************************************************************
+ * @fn      txnRecover
+ *
+ * @brief   At power-up, finish every commit that a reset interrupted.
+ *          A commit record with a bad checksum has already been zeroed
+ *          by initPage(), before any of its copies was written.
+ *
+ * @param   pOff - Offset into each page of the first item that can be
+ *                 part of a transaction, or NULL to walk whole pages.
+ *
+ * @return  TRUE if a commit was finished, which changes the current
+ *          copies of its items; FALSE otherwise.
+ */
+static uint8 txnRecover( uint16 *pOff )
+{
+  uint8 pg, rtrn = FALSE;
+
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
+  {
+    uint16 offset = (pOff == NULL) ? OSAL_NV_PAGE_HDR_SIZE : pOff[pg - OSAL_NV_PAGE_BEG];
+
+    while ( offset < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE) )
+    {
+      osalNvHdr_t hdr;
+      uint16 sz;
+
+      HalFlashRead(pg, offset, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+
+      if ( hdr.id == OSAL_NV_ERASED_ID )
+      {
+        break;
+      }
+
+      sz = OSAL_NV_DATA_SIZE( hdr.len );
+      if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - offset) )
+      {
+        break;
+      }
+
+      offset += OSAL_NV_HDR_SIZE;
+
+      if ( hdr.id == OSAL_NV_TXN_REC )
+      {
+        txnApply( pg, offset );
+        rtrn = TRUE;
+      }
+
+      offset += sz;
+    }
+  }
+
+  return rtrn;
+}
+
+/*********************************************************************
+ * @fn      txnFree
+ *
+ * @brief   Free the staged items.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void txnFree( void )
+{
+  while ( nvTxnCnt != 0 )
+  {
+    osal_mem_free( nvTxn[--nvTxnCnt].buf );
+  }
+}
+#endif
+
+#if OSAL_NV_BG_COMPACT
+/*********************************************************************
+ * @fn      bgCheck
+ *
+ * @brief   Start compacting a page in the background when the erased
+ *          space outside of the reserve page runs low. Only the NV task
+ *          runs the compaction, so nothing is started without it.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void bgCheck( void )
+{
+  uint32 space = 0;
+  uint16 lost = 0;
+  uint8 idx, pg = OSAL_NV_PAGE_NULL;
+
+  if ( (nvTaskId == TASK_NO_TASK) || (bgPg != OSAL_NV_PAGE_NULL) )
+  {
+    return;
+  }
+
+  for ( idx = 0; idx < OSAL_NV_PAGES_USED; idx++ )
+  {
+    if ( (idx + OSAL_NV_PAGE_BEG) != pgRes )
+    {
+      space += (OSAL_NV_PAGE_SIZE - pgOff[idx]);
+
+      if ( pgLost[idx] > lost )
+      {
+        lost = pgLost[idx];
+        pg = idx + OSAL_NV_PAGE_BEG;
+      }
+    }
+  }
+
+  if ( (space < OSAL_NV_COMPACT_THRESHOLD) && (lost >= OSAL_NV_COMPACT_MIN_LOST) )
+  {
+    bgPg = pg;
+    bgChk = 0;
+    bgOff = OSAL_NV_PAGE_HDR_SIZE;
+    (void)osal_set_event( nvTaskId, OSAL_NV_COMPACT_EVT );
+  }
+}
+
+/*********************************************************************
+ * @fn      bgStep
+ *
+ * @brief   Run one bounded step of the background compaction of 'bgPg':
+ *          verify part of the reserve page as erased, transfer one item,
+ *          or finally put the reserve page in use and erase 'bgPg'.
+ *          The flash is left in the same states, in the same order, as
+ *          by compactPage(), so initNV() recovers from a reset between
+ *          any two steps.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void bgStep( void )
+{
+  uint8 rtrn;
+
+  if ( bgChk < OSAL_NV_PAGE_SIZE )
+  {
+    uint16 end = bgChk + OSAL_NV_COMPACT_CHECK_LEN;
+
+    for ( ; (bgChk < end) && (bgChk < OSAL_NV_PAGE_SIZE); bgChk++ )
+    {
+      HalFlashRead(pgRes, bgChk, &rtrn, 1);
+      if (rtrn != OSAL_NV_ERASED)
+      {
+        erasePage(pgRes);
+        bgPg = OSAL_NV_PAGE_NULL;
+        return;
+      }
+    }
+
+    if ( bgChk == OSAL_NV_PAGE_SIZE )
+    {
+      osalNvPgHdr_t pgHdr;
+
+      HalFlashRead(bgPg, OSAL_NV_PAGE_HDR_OFFSET, (uint8 *)(&pgHdr), OSAL_NV_PAGE_HDR_SIZE);
+      if ( pgHdr.xfer == OSAL_NV_ERASED_ID )
+      {
+        // Mark the old page as being in process of compaction.
+        uint16 xfer = OSAL_NV_ZEROED_ID;
+        writeWordH( bgPg, OSAL_NV_PG_XFER, (uint8*)(&xfer) );
+      }
+    }
+  }
+  else if ( (rtrn = compactItem( bgPg, &bgOff, OSAL_NV_ITEM_NULL )) != OSAL_NV_XFER_MORE )
+  {
+    if ( rtrn == OSAL_NV_XFER_DONE )
+    {
+      COMPACT_PAGE_CLEANUP( bgPg );
+    }
+    else
+    {
+      erasePage(pgRes);
+
+      // Hot items already transferred are found again on the page that was to be compacted.
+      for ( rtrn = 0; rtrn < OSAL_NV_MAX_HOT; rtrn++ )
+      {
+        if ( hotPg[rtrn] == pgRes )
+        {
+          uint16 off = findItem( hotIds[rtrn] );
+
+          if ( off != OSAL_NV_ITEM_NULL )
+          {
+            hotItemUpdate( findPg, off, hotIds[rtrn] );
+          }
+        }
+      }
+    }
+
+    bgPg = OSAL_NV_PAGE_NULL;
+  }
+}
+
+/*********************************************************************
+ * @fn      bgFinish
+ *
+ * @brief   Run the background compaction, if any, to its end.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void bgFinish( void )
+{
+  while ( bgPg != OSAL_NV_PAGE_NULL )
+  {
+    bgStep();
+  }
+}
+#endif
+
+#if OSAL_NV_TASK
+/*********************************************************************
+ * @fn      osal_nv_task_init
+ *
+ * @brief   Initialize the NV task. Without it, the NV cache is only
+ *          flushed when it is full, before an untimed sleep and by
+ *          osal_nv_flush(), and pages are only compacted by the write
+ *          that needs the space. Add it as the last entry of tasksArr[]
+ *          so that it runs only when no other task has work.
+ *
+ * @param   task_id - The OSAL task Id of the NV task.
+ *
+ * @return  none
+ */
+void osal_nv_task_init( uint8 task_id )
+{
+  nvTaskId = task_id;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_process_event
+ *
+ * @brief   Process the events of the NV task.
+ *
+ * @param   task_id - The OSAL task Id of the NV task.
+ * @param   events - The events to process.
+ *
+ * @return  The events not processed.
+ */
+uint16 osal_nv_process_event( uint8 task_id, uint16 events )
+{
+  (void)task_id;  // Intentionally unreferenced parameter
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *msgPtr;
+
+    while ( (msgPtr = osal_msg_receive( nvTaskId )) != NULL )
+    {
+      (void)osal_msg_deallocate( msgPtr );
+    }
+
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+#if OSAL_NV_CACHE
+  if ( events & OSAL_NV_FLUSH_EVT )
+  {
+    (void)osal_nv_flush();
+    return ( events ^ OSAL_NV_FLUSH_EVT );
+  }
+#endif
+
+#if OSAL_NV_BG_COMPACT
+  if ( events & OSAL_NV_COMPACT_EVT )
+  {
+    // The compaction may already have been finished by a write that needed its page.
+    if ( bgPg != OSAL_NV_PAGE_NULL )
+    {
+      bgStep();
+    }
+
+    if ( bgPg != OSAL_NV_PAGE_NULL )
+    {
+      // Yield to the other tasks before the next step.
+      (void)osal_set_event( nvTaskId, OSAL_NV_COMPACT_EVT );
+    }
+
+    return ( events ^ OSAL_NV_COMPACT_EVT );
+  }
+#endif
+
+  return 0;
+}
+#endif
+
 /*********************************************************************
  */
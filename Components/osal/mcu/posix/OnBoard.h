@@ -0,0 +1,157 @@
+/**************************************************************************************************
+  Filename:       OnBoard.h
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    OnBoard definitions for the POSIX host port.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+#ifndef ONBOARD_H
+#define ONBOARD_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "hal_board_cfg.h"
+#include "hal_mcu.h"
+#include "hal_uart.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// 64-bit Extended Address of this device
+extern uint8 aExtendedAddress[8];
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* OSAL timer defines */
+#define TICK_TIME   1000   // Timer per tick - in micro-sec
+#define TICK_COUNT  1
+
+/* Reset reasons, as on the CC2530 */
+#define RESETPO    0x00  // Power-On reset
+#define RESETEX    0x08  // External reset
+#define RESETWD    0x10  // WatchDog reset
+
+/* OSAL heap size */
+#if !defined INT_HEAP_LEN
+  #define INT_HEAP_LEN  3072
+#endif
+#define MAXMEMHEAP INT_HEAP_LEN
+
+/* Serial Port Definitions */
+#if defined (ZAPP_P1)
+  #define ZAPP_PORT HAL_UART_PORT_0
+#elif defined (ZAPP_P2)
+  #define ZAPP_PORT HAL_UART_PORT_1
+#else
+  #undef ZAPP_PORT
+#endif
+#if defined (ZTOOL_P1)
+  #define ZTOOL_PORT HAL_UART_PORT_0
+#elif defined (ZTOOL_P2)
+  #define ZTOOL_PORT HAL_UART_PORT_1
+#else
+  #undef ZTOOL_PORT
+#endif
+
+#if !defined MT_UART_TX_BUFF_MAX
+  #define MT_UART_TX_BUFF_MAX  HAL_POSIX_UART_TX_MAX
+#endif
+#define MT_UART_RX_BUFF_MAX  HAL_POSIX_UART_RX_MAX
+#define MT_UART_THRESHOLD   (MT_UART_RX_BUFF_MAX / 2)
+#define MT_UART_IDLE_TIMEOUT 6
+
+#define KEY_CHANGE_SHIFT_IDX 1
+#define KEY_CHANGE_KEYS_IDX  2
+
+// Initialization levels
+#define OB_COLD  0
+#define OB_WARM  1
+#define OB_READY 2
+
+/*********************************************************************
+ * MACROS
+ */
+
+#define SystemReset()       halPosixReset()
+#define SystemResetSoft()   halPosixReset()
+#define ResetReason()       RESETPO
+
+#define WatchDogEnable(wdti)
+#define FeedWatchDog()
+
+// Busy waits consume virtual time only
+#define MicroWait(t) osalPosixAdvance(t)
+
+// Sleeping moves the virtual clock to the next timer expiry
+#define OSAL_SET_CPU_INTO_SLEEP(timeout) osalPosixSleep(timeout); /* Called from OSAL_PwrMgr */
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+  /*
+   * Get elapsed timer clock counts
+   */
+  extern uint32 TimerElapsed( void );
+
+  /*
+   * Get a random number
+   */
+  extern uint16 Onboard_rand( void );
+
+  /*
+   * Read the MAC backoff timer count (320us ticks) - the OSAL clock source
+   */
+  extern uint32 macMcuPrecisionCount( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ONBOARD_H
@@ -0,0 +1,258 @@
+/**************************************************************************************************
+  Filename:       bench_flash.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of flash writes that overlap with the work of the
+CPU: blocks programmed one at a time, or queued to the DMA (HAL_FLASH_ASYNC)
+at several queue depths, in virtual time per block.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "hal_board_cfg.h"
+#include "hal_flash.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_FLASH_FILE   "bench_flash.bin"
+
+// Blocks of 64 bytes, as HalOTAWrite() gets them, over the pages below NV.
+#define BENCH_BLK_WORDS    16
+#define BENCH_BLK_CNT      256
+#define BENCH_BLK_PAGES    (BENCH_BLK_CNT * BENCH_BLK_WORDS * HAL_FLASH_WORD_SIZE / HAL_FLASH_PAGE_SIZE)
+#define BENCH_BLK_PAGE     (HAL_NV_PAGE_BEG - BENCH_BLK_PAGES)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// CPU time to receive each block, in usecs.
+static const uint16 benchWork[] = { 100, 320, 600 };
+
+#if HAL_FLASH_ASYNC
+// Queue depths tried, up to HAL_FLASH_ASYNC_CNT
+static const uint8 benchDepth[] = { 1, 2, HAL_FLASH_ASYNC_CNT };
+
+// One buffer per queued write: the DMA reads it until the write is done.
+static uint8 benchBuf[HAL_FLASH_ASYNC_CNT][BENCH_BLK_WORDS * HAL_FLASH_WORD_SIZE];
+#else
+static uint8 benchBuf[1][BENCH_BLK_WORDS * HAL_FLASH_WORD_SIZE];
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = {
+  benchTask,
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+  (void)events;
+  return 0;
+}
+
+static void benchErase( void )
+{
+  uint8 pg;
+
+  for ( pg = 0; pg < BENCH_BLK_PAGES; pg++ )
+  {
+    HalFlashErase( BENCH_BLK_PAGE + pg );
+  }
+}
+
+/*
+ * Receive a block into 'pBuf': 'work' usecs of CPU time.
+ */
+static void benchReceive( uint8 *pBuf, uint16 blk, uint16 work )
+{
+  uint8 k;
+
+  for ( k = 0; k < (BENCH_BLK_WORDS * HAL_FLASH_WORD_SIZE); k++ )
+  {
+    pBuf[k] = (uint8)(blk + k);
+  }
+  osalPosixAdvance( work );
+}
+
+static uint16 benchAddr( uint16 blk )
+{
+  return (uint16)((uint32)BENCH_BLK_PAGE * (HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE) +
+                  (uint32)blk * BENCH_BLK_WORDS);
+}
+
+/*
+ * Each block programmed as soon as it is in, the CPU waiting for it.
+ */
+static double benchSync( uint16 work )
+{
+  uint64 start;
+  uint16 blk;
+
+  benchErase();
+  start = osalPosixTime();
+  for ( blk = 0; blk < BENCH_BLK_CNT; blk++ )
+  {
+    benchReceive( benchBuf[0], blk, work );
+    HalFlashWrite( benchAddr( blk ), benchBuf[0], BENCH_BLK_WORDS );
+  }
+
+  return (double)(osalPosixTime() - start) / BENCH_BLK_CNT;
+}
+
+#if HAL_FLASH_ASYNC
+/*
+ * Each block queued as soon as it is in, with up to 'depth' writes in
+ * flight; the CPU waits only for a free buffer.
+ */
+static double benchAsync( uint16 work, uint8 depth )
+{
+  uint64 start;
+  uint16 blk;
+  uint8 *pBuf;
+
+  benchErase();
+  start = osalPosixTime();
+  for ( blk = 0; blk < BENCH_BLK_CNT; blk++ )
+  {
+    while ( HalFlashBusy() >= depth )
+    {
+      osalPosixAdvance( (uint32)(halPosixFlashDue() - osalPosixTime()) );
+    }
+
+    pBuf = benchBuf[blk % depth];
+    benchReceive( pBuf, blk, work );
+    (void)HalFlashWriteAsync( benchAddr( blk ), pBuf, BENCH_BLK_WORDS, TASK_NO_TASK, 0 );
+  }
+  HalFlashWait();
+
+  return (double)(osalPosixTime() - start) / BENCH_BLK_CNT;
+}
+#endif
+
+/*
+ * Check that every block made it to flash.
+ */
+static uint8 benchCheck( void )
+{
+  uint8 buf[BENCH_BLK_WORDS * HAL_FLASH_WORD_SIZE];
+  uint16 blk;
+  uint8 k;
+
+  for ( blk = 0; blk < BENCH_BLK_CNT; blk++ )
+  {
+    HalFlashRead( BENCH_BLK_PAGE + (blk * sizeof( buf ) / HAL_FLASH_PAGE_SIZE),
+                  (blk * sizeof( buf )) % HAL_FLASH_PAGE_SIZE, buf, sizeof( buf ) );
+    for ( k = 0; k < sizeof( buf ); k++ )
+    {
+      if ( buf[k] != (uint8)(blk + k) )
+      {
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+int main( void )
+{
+  double perBlk;
+  uint8 idx;
+#if HAL_FLASH_ASYNC
+  uint8 d;
+#endif
+
+  remove( BENCH_FLASH_FILE );
+  (void)halPosixFlashOpen( BENCH_FLASH_FILE );
+  (void)osal_init_system();
+
+  printf( "flash: %u blocks of %u bytes, %u us to program each\n", BENCH_BLK_CNT,
+          BENCH_BLK_WORDS * HAL_FLASH_WORD_SIZE, BENCH_BLK_WORDS * HAL_POSIX_FLASH_WORD_US );
+  for ( idx = 0; idx < sizeof( benchWork ) / sizeof( benchWork[0] ); idx++ )
+  {
+    perBlk = benchSync( benchWork[idx] );
+    printf( "  %3u us work: sync %6.1f us/blk %s", benchWork[idx], perBlk,
+            benchCheck() ? "ok" : "FAILED" );
+#if HAL_FLASH_ASYNC
+    // Depth 1 has a single buffer, which the next block cannot be received into until written.
+    for ( d = 0; d < sizeof( benchDepth ); d++ )
+    {
+      perBlk = benchAsync( benchWork[idx], benchDepth[d] );
+      printf( ", depth %u %6.1f us/blk %s", benchDepth[d], perBlk, benchCheck() ? "ok" : "FAILED" );
+    }
+#endif
+    printf( "\n" );
+  }
+
+  halPosixFlashClose();
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,414 @@
+/**************************************************************************************************
+  Filename:       bench_msg.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of OSAL message buffers: the message pools against
+osal_mem_alloc() under a mixed packet workload, in host nanoseconds per
+allocate and free, and a shared message against a copy per subscriber for
+one AF indication delivered to three tasks.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Memory.h"
+#include "OSAL_Tasks.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Most messages waiting to be freed at once, as in a task's queue.
+#define BENCH_WINDOW_MAX   6
+
+// Long-lived blocks left in the heap to fragment it: timers, tables and the like.
+#define BENCH_FRAG_CNT     40
+
+// Subscriber tasks of the fan-out run and the length of the message they all get.
+#define BENCH_SUB_CNT      3
+#define BENCH_FAN_LEN      100
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+/*
+ * The mixed workload: event headers and key changes, ZDO callbacks and AF
+ * indications, in the proportions of a busy coordinator.
+ */
+static const uint16 benchLens[] = { 2, 2, 4, 2, 40, 100, 2, 100, 40, 100 };
+
+static uint32 benchSeed;
+static void *benchFrag[BENCH_FRAG_CNT];
+#if ( OSAL_MSG_SHARED )
+static uint32 benchHeld;
+static uint8 benchSrc[BENCH_FAN_LEN];
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[BENCH_SUB_CNT] = { benchTask, benchTask, benchTask };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * A subscriber: release every message it is given.
+ */
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  uint8 *pMsg;
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+#if ( OSAL_MSG_SHARED )
+      benchHeld--;
+#endif
+      (void)osal_msg_deallocate( pMsg );
+    }
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  return 0;
+}
+
+static double benchNow( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+static uint32 benchRand( void )
+{
+  benchSeed = benchSeed * 1103515245UL + 12345UL;
+  return ( benchSeed >> 16 );
+}
+
+/*
+ * Allocate 'cnt' messages of the mixed workload, each freed once up to
+ * BENCH_WINDOW_MAX newer ones are outstanding, with osal_msg_allocate()
+ * or with osal_mem_alloc() of the same block. Returns the host time per
+ * allocate and free, or 0 if an allocation failed.
+ */
+static double benchRun( uint32 cnt, uint8 useMsg )
+{
+  uint8 *pMsg[BENCH_WINDOW_MAX + 1];
+  uint8 head = 0;
+  uint8 tail = 0;
+  uint8 held = 0;
+  uint32 idx;
+  double start;
+
+  benchSeed = 1;
+  start = benchNow();
+
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    uint16 len = benchLens[benchRand() % (sizeof( benchLens ) / sizeof( benchLens[0] ))];
+
+    if ( useMsg )
+    {
+      pMsg[head] = osal_msg_allocate( len );
+    }
+    else
+    {
+      pMsg[head] = osal_mem_alloc( len + sizeof( osal_msg_hdr_t ) );
+    }
+    if ( pMsg[head] == NULL )
+    {
+      return 0;
+    }
+    head = (head + 1) % (BENCH_WINDOW_MAX + 1);
+
+    // Free the oldest messages down to a window that wanders between 0 and the maximum.
+    if ( ++held > (benchRand() % (BENCH_WINDOW_MAX + 1)) )
+    {
+      uint8 drop = held - (uint8)(benchRand() % held);
+
+      while ( drop-- != 0 )
+      {
+        if ( useMsg )
+        {
+          (void)osal_msg_deallocate( pMsg[tail] );
+        }
+        else
+        {
+          osal_mem_free( pMsg[tail] );
+        }
+        tail = (tail + 1) % (BENCH_WINDOW_MAX + 1);
+        held--;
+      }
+    }
+  }
+
+  while ( held-- != 0 )
+  {
+    if ( useMsg )
+    {
+      (void)osal_msg_deallocate( pMsg[tail] );
+    }
+    else
+    {
+      osal_mem_free( pMsg[tail] );
+    }
+    tail = (tail + 1) % (BENCH_WINDOW_MAX + 1);
+  }
+
+  return ( (benchNow() - start) / cnt );
+}
+
+/*
+ * Fill the heap with long-lived blocks of 12 to 30 bytes and free every
+ * other one, leaving holes that are too small for most messages in front
+ * of the free space.
+ */
+static uint16 benchFragment( void )
+{
+  uint16 idx;
+  uint16 kept = 0;
+
+  for ( idx = 0; idx < BENCH_FRAG_CNT; idx++ )
+  {
+    benchFrag[idx] = osal_mem_alloc( 12 + (idx % 10) * 2 );
+  }
+  for ( idx = 0; idx < BENCH_FRAG_CNT; idx += 2 )
+  {
+    if ( benchFrag[idx] != NULL )
+    {
+      osal_mem_free( benchFrag[idx] );
+    }
+  }
+  for ( idx = 1; idx < BENCH_FRAG_CNT; idx += 2 )
+  {
+    kept += (benchFrag[idx] != NULL);
+  }
+
+  return ( kept );
+}
+
+/*
+ * Free the long-lived blocks of benchFragment().
+ */
+static void benchUnfragment( void )
+{
+  uint16 idx;
+
+  for ( idx = 1; idx < BENCH_FRAG_CNT; idx += 2 )
+  {
+    if ( benchFrag[idx] != NULL )
+    {
+      osal_mem_free( benchFrag[idx] );
+    }
+  }
+}
+
+#if ( OSAL_MSG_SHARED )
+/*
+ * Return the RAM held by messages: heap bytes in use and blocks in use in
+ * the message pools.
+ */
+static uint16 benchMsgRam( void )
+{
+  uint16 ram = 0;
+#if ( OSALMEM_METRICS )
+  ram = osal_heap_mem_used();
+#endif
+#if ( OSAL_MSG_POOLS )
+  {
+    osalMsgPoolStat_t stat;
+    uint8 pool;
+
+    for ( pool = 0; pool < OSAL_MSG_POOL_CNT; pool++ )
+    {
+      (void)osal_msg_pool_stat( pool, &stat );
+      ram += stat.used * (stat.len + sizeof( osal_msg_hdr_t ));
+    }
+  }
+#endif
+
+  return ( ram );
+}
+
+/*
+ * Deliver one BENCH_FAN_LEN byte message to every subscriber 'cnt' times,
+ * as one shared message or as a copy per subscriber. Returns the host time
+ * per delivery to all subscribers; 'pRam' gets the RAM the messages held
+ * once they were all sent.
+ */
+static double benchFanOut( uint32 cnt, uint8 shared, uint16 *pRam )
+{
+  uint16 base = benchMsgRam();
+  uint32 idx;
+  uint8 task;
+  double start;
+
+  *pRam = 0;
+  start = benchNow();
+
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    if ( shared )
+    {
+      uint8 *pMsg = osal_msg_allocate_shared( BENCH_FAN_LEN );
+
+      if ( pMsg == NULL )
+      {
+        return 0;
+      }
+      osal_memcpy( pMsg, benchSrc, BENCH_FAN_LEN );
+      for ( task = 0; task < BENCH_SUB_CNT; task++ )
+      {
+        (void)osal_msg_send( task, pMsg );
+      }
+      (void)osal_msg_deallocate( pMsg );
+    }
+    else
+    {
+      for ( task = 0; task < BENCH_SUB_CNT; task++ )
+      {
+        uint8 *pMsg = osal_msg_allocate( BENCH_FAN_LEN );
+
+        if ( pMsg == NULL )
+        {
+          return 0;
+        }
+        osal_memcpy( pMsg, benchSrc, BENCH_FAN_LEN );
+        (void)osal_msg_send( task, pMsg );
+      }
+    }
+    benchHeld += BENCH_SUB_CNT;
+
+    if ( idx == 0 )
+    {
+      *pRam = benchMsgRam() - base;
+    }
+
+    while ( benchHeld != 0 )
+    {
+      osal_run_system();
+    }
+  }
+
+  return ( (benchNow() - start) / cnt );
+}
+#endif
+
+int main( int argc, char **argv )
+{
+  uint32 cnt = (argc > 1) ? (uint32)atol( argv[1] ) : 1000000UL;
+  double heap[2];
+  double msg[2];
+  uint16 kept;
+#if ( OSAL_MSG_SHARED )
+  uint16 ram[2];
+#endif
+#if ( OSAL_MSG_POOLS )
+  osalMsgPoolStat_t stat;
+  uint8 pool;
+#endif
+
+  (void)osal_init_system();
+
+  // Each allocator runs on an empty heap, then again behind the long-lived blocks.
+  heap[0] = benchRun( cnt, FALSE );
+  kept = benchFragment();
+  heap[1] = benchRun( cnt, FALSE );
+  benchUnfragment();
+
+  msg[0] = benchRun( cnt, TRUE );
+  (void)benchFragment();
+  msg[1] = benchRun( cnt, TRUE );
+  benchUnfragment();
+
+  printf( "%lu messages, up to %u outstanding, %u long-lived blocks when fragmented\n",
+          (unsigned long)cnt, BENCH_WINDOW_MAX, kept );
+  printf( "                    empty heap   fragmented heap\n" );
+  printf( "osal_mem_alloc      %7.1f ns   %7.1f ns\n", heap[0], heap[1] );
+#if ( OSAL_MSG_POOLS )
+  printf( "osal_msg_allocate   %7.1f ns   %7.1f ns   (message pools)\n", msg[0], msg[1] );
+  for ( pool = 0; pool < OSAL_MSG_POOL_CNT; pool++ )
+  {
+    (void)osal_msg_pool_stat( pool, &stat );
+    printf( "  pool %u: %3u bytes x %u, high-water %u, fallbacks %u\n", pool,
+            stat.len, stat.blkCnt, stat.maxUsed, stat.fallback );
+  }
+#else
+  printf( "osal_msg_allocate   %7.1f ns   %7.1f ns   (heap)\n", msg[0], msg[1] );
+#endif
+
+#if ( OSAL_MSG_SHARED )
+  msg[0] = benchFanOut( cnt, FALSE, &ram[0] );
+  msg[1] = benchFanOut( cnt, TRUE, &ram[1] );
+
+  printf( "\n%u byte message to %u subscribers   time       message RAM\n",
+          BENCH_FAN_LEN, BENCH_SUB_CNT );
+  printf( "a copy each                       %7.1f ns   %4u bytes\n", msg[0], ram[0] );
+  printf( "shared                            %7.1f ns   %4u bytes\n", msg[1], ram[1] );
+#endif
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
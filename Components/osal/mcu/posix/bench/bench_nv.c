@@ -0,0 +1,240 @@
+/**************************************************************************************************
+  Filename:       bench_nv.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of the CC2530 NV driver over the simulated flash:
+host time and flash traffic per item write and read, the
+cost of the power-up scan of a full NV, and read latency at 50,
+200 and 500 items.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_NV_BASE      0x0500
+#define BENCH_NV_FILE      "bench_nv.bin"
+
+// Reads timed at each item count of the read sweep.
+#define BENCH_SWEEP_READS  20000
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Item counts of the read sweep.
+static const uint16 benchSweep[] = { 50, 200, 500 };
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = {
+  benchTask,
+#if OSAL_NV_TASK
+  osal_nv_process_event,
+#endif
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+#if OSAL_NV_TASK
+  osal_nv_task_init( 1 );
+#endif
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+  (void)events;
+  return 0;
+}
+
+static double benchNow( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+static void benchBoot( void )
+{
+  (void)halPosixFlashOpen( BENCH_NV_FILE );
+  (void)osal_init_system();
+  osal_nv_init( NULL );
+}
+
+/*
+ * Fill a fresh NV with 'itemCnt' items of 4 bytes and time random reads of
+ * them, in host ns and in virtual flash time per read.
+ */
+static void benchReadSweep( uint16 itemCnt )
+{
+  halPosixFlashStat_t stat;
+  uint8 buf[4] = { 0 };
+  uint64 vStart;
+  double start;
+  uint32 idx;
+
+  halPosixFlashClose();
+  remove( BENCH_NV_FILE );
+  benchBoot();
+
+  for ( idx = 0; idx < itemCnt; idx++ )
+  {
+    if ( osal_nv_item_init( BENCH_NV_BASE + idx, sizeof( buf ), buf ) != NV_ITEM_UNINIT )
+    {
+      printf( "%8u items: NV full\n", itemCnt );
+      return;
+    }
+  }
+  halPosixFlashGetStat( &stat, TRUE );
+
+  start = benchNow();
+  vStart = osalPosixTime();
+  for ( idx = 0; idx < BENCH_SWEEP_READS; idx++ )
+  {
+    (void)osal_nv_read( BENCH_NV_BASE + (rand() % itemCnt), 0, sizeof( buf ), buf );
+  }
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "%8u items %8.1f ns %8.2f us %8.2f flash reads\n", itemCnt,
+          (benchNow() - start) / BENCH_SWEEP_READS,
+          (double)(osalPosixTime() - vStart) / BENCH_SWEEP_READS,
+          (double)stat.readCnt / BENCH_SWEEP_READS );
+}
+
+int main( int argc, char **argv )
+{
+  uint16 itemCnt = (argc > 1) ? (uint16)atoi( argv[1] ) : 100;
+  uint32 writeCnt = (argc > 2) ? (uint32)atol( argv[2] ) : 20000UL;
+  halPosixFlashStat_t stat;
+  uint8 buf[32];
+  uint32 idx;
+  double start;
+
+  remove( BENCH_NV_FILE );
+  benchBoot();
+  srand( 9 );
+
+  for ( idx = 0; idx < itemCnt; idx++ )
+  {
+    osal_memset( buf, (uint8)idx, sizeof( buf ) );
+    (void)osal_nv_item_init( BENCH_NV_BASE + idx, 4 + (idx % 28), buf );
+  }
+#if OSAL_NV_CACHE
+  (void)osal_nv_flush();
+#endif
+  halPosixFlashGetStat( &stat, TRUE );
+
+  // Item writes, as a stack would make them: a few hot items and a long tail.
+  start = benchNow();
+  for ( idx = 0; idx < writeCnt; idx++ )
+  {
+    uint16 item = ((rand() % 4) != 0) ? (rand() % 8) : (rand() % itemCnt);
+
+    buf[0] = (uint8)idx;
+    (void)osal_nv_write( BENCH_NV_BASE + item, 0, 4, buf );
+    if ( (idx % 64) == 0 )
+    {
+      osalPosixRun( 1 );  // Give the NV task its turn.
+    }
+  }
+#if OSAL_NV_CACHE
+  (void)osal_nv_flush();
+#endif
+  printf( "items %u, %lu writes\n", itemCnt, (unsigned long)writeCnt );
+  printf( "write             %8.1f ns\n", (benchNow() - start) / writeCnt );
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "  flash words     %8.2f per write\n", (double)stat.wordCnt / writeCnt );
+  printf( "  page erases     %8lu\n", (unsigned long)stat.eraseCnt );
+
+  start = benchNow();
+  for ( idx = 0; idx < writeCnt; idx++ )
+  {
+    (void)osal_nv_read( BENCH_NV_BASE + (rand() % itemCnt), 0, 4, buf );
+  }
+  printf( "read              %8.1f ns\n", (benchNow() - start) / writeCnt );
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "  flash reads     %8.2f per read\n", (double)stat.readCnt / writeCnt );
+
+  start = benchNow();
+  benchBoot();
+  printf( "power-up scan     %8.1f us\n", (benchNow() - start) / 1000 );
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "  flash reads     %8lu\n", (unsigned long)stat.readCnt );
+
+  // Read latency against the number of items, in host time and virtual flash time per read.
+  printf( "\nread sweep           host    virtual\n" );
+  for ( idx = 0; idx < sizeof( benchSweep ) / sizeof( benchSweep[0] ); idx++ )
+  {
+    benchReadSweep( benchSweep[idx] );
+  }
+
+  halPosixFlashClose();
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,752 @@
+/**************************************************************************************************
+  Filename:       bench_nvwork.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Replay of NV workloads on the simulated flash, reporting
+flash words programmed, page erases and write latency in virtual time:
+the churn of a few items rewritten every 100 ms, the latency of single
+writes while the pages are compacted, updates of several items at once
+as separate writes or as a transaction, the time of osal_nv_init() on
+a device that is often reset, and the NV traffic of a coordinator.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "comdef.h"
+#include "hal_board_cfg.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_NV_BASE      0x0500
+#define BENCH_NV_FILE      "bench_nvwork.bin"
+
+#define BENCH_TICK_EVT     0x0001
+
+// Churn: hot items rewritten every tick, plus one of the others every 10th tick.
+#define BENCH_CHURN_HOT    3
+#define BENCH_CHURN_CNT    20
+#define BENCH_CHURN_LEN    48
+#define BENCH_CHURN_TICK   100
+#define BENCH_CHURN_TIME   (10UL * 60UL * 1000UL)
+
+// Latency: the churn on twice the items, each write timed, for half an hour.
+#define BENCH_LAT_CNT      40
+#define BENCH_LAT_TIME     (30UL * 60UL * 1000UL)
+#define BENCH_LAT_MAX      ((BENCH_LAT_TIME / BENCH_CHURN_TICK) * (BENCH_CHURN_HOT + 1))
+#define BENCH_LAT_SLOW_US  5000
+
+// Transactions: updates of 5 of the items, all bytes of each.
+#define BENCH_TXN_CNT      40
+#define BENCH_TXN_LEN      24
+#define BENCH_TXN_ITEMS    5
+#define BENCH_TXN_UPDATES  2000
+
+// Boot: writes to 60 items of random lengths, with a reset every 97th.
+#define BENCH_BOOT_CNT     60
+#define BENCH_BOOT_WRITES  10000
+#define BENCH_BOOT_EVERY   97
+#define BENCH_BOOT_SLOW_US 10000
+
+// Coordinator: one event per millisecond.
+#define BENCH_COORD_EVENTS 20000
+#define BENCH_COORD_LEN    196
+
+#define BENCH_MODEL_CNT    BENCH_BOOT_CNT
+#define BENCH_MODEL_LEN    BENCH_CHURN_LEN
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  const char *name;
+  void (*pfnRun)( void );
+} benchWork_t;
+
+// A group of coordinator NV items
+typedef struct
+{
+  uint16 id;
+  uint16 len;
+  uint8 cnt;
+} benchItems_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint32 benchSeed;
+static uint32 benchTicks;
+static uint8 benchWriteThrough;
+static void (*benchTickCB)( void );
+
+static uint8 benchModel[BENCH_MODEL_CNT][BENCH_MODEL_LEN];
+
+// Virtual time of every write, in microseconds
+static uint32 benchLat[BENCH_LAT_MAX];
+static uint32 benchLatCnt;
+
+// The coordinator's items, as ZDApp, the binding table and the scenes keep them
+static const benchItems_t benchCoordItems[] = {
+  { 0x0021, 116, 1 },   // NIB
+  { 0x0201,   4, 1 },   // Frame counter
+  { 0x0300, 196, 8 },   // Binding table
+  { 0x0400,  40, 16 },  // Scenes
+  { 0x0500,  20, 32 },  // Device records
+};
+
+#define BENCH_COORD_NIB    0
+#define BENCH_COORD_FC     1
+#define BENCH_COORD_BIND   2
+#define BENCH_COORD_SCENE  3
+#define BENCH_COORD_DEV    4
+#define BENCH_COORD_GROUPS (sizeof( benchCoordItems ) / sizeof( benchCoordItems[0] ))
+
+static uint8 benchCoordModel[BENCH_COORD_GROUPS][32][BENCH_COORD_LEN];
+static uint64 benchCoordTime, benchCoordMax;
+static uint32 benchCoordWrites;
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+static void benchChurn( void );
+static void benchLatency( void );
+static void benchTxn( void );
+static void benchBootTime( void );
+static void benchCoord( void );
+
+static const benchWork_t benchWorks[] = {
+  { "churn",   benchChurn },
+  { "latency", benchLatency },
+  { "txn",     benchTxn },
+  { "boot",    benchBootTime },
+  { "coord",   benchCoord },
+  { NULL,     NULL }
+};
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = {
+  benchTask,
+#if OSAL_NV_TASK
+  osal_nv_process_event,
+#endif
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+#if OSAL_NV_TASK
+  osal_nv_task_init( 1 );
+#endif
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * The application task: run the workload's tick callback on every tick.
+ */
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  if ( events & BENCH_TICK_EVT )
+  {
+    benchTicks++;
+    if ( benchTickCB != NULL )
+    {
+      benchTickCB();
+    }
+    return ( events ^ BENCH_TICK_EVT );
+  }
+
+  return 0;
+}
+
+static uint32 benchRand( void )
+{
+  benchSeed = benchSeed * 1103515245UL + 12345UL;
+  return ( benchSeed >> 16 );
+}
+
+/*
+ * Power up on a blank NV.
+ */
+static void benchBoot( void )
+{
+  remove( BENCH_NV_FILE );
+  (void)halPosixFlashOpen( BENCH_NV_FILE );
+  (void)osal_init_system();
+  osal_nv_init( NULL );
+  benchSeed = 1;
+  benchTicks = 0;
+  benchTickCB = NULL;
+}
+
+/*
+ * Write an item as the stack does; in write-through runs, push it out of
+ * the NV cache at once.
+ */
+static void benchWrite( uint16 id, uint16 len, void *buf )
+{
+  (void)osal_nv_write( id, 0, len, buf );
+#if OSAL_NV_CACHE
+  if ( benchWriteThrough )
+  {
+    (void)osal_nv_flush();
+  }
+#endif
+}
+
+/*
+ * Flush the NV cache and check every item of the workload against its model.
+ */
+static uint8 benchCheck( uint16 cnt, uint16 len )
+{
+  uint8 buf[BENCH_MODEL_LEN];
+  uint16 idx;
+
+#if OSAL_NV_CACHE
+  (void)osal_nv_flush();
+#endif
+
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    if ( (osal_nv_read( BENCH_NV_BASE + idx, 0, len, buf ) != SUCCESS) ||
+         (memcmp( buf, benchModel[idx], len ) != 0) )
+    {
+      printf( "  item 0x%04X does not match its model\n", BENCH_NV_BASE + idx );
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+static void benchChurnTick( void )
+{
+  uint16 idx;
+
+  for ( idx = 0; idx < BENCH_CHURN_HOT; idx++ )
+  {
+    benchModel[idx][benchTicks % BENCH_CHURN_LEN] = (uint8)benchTicks;
+    benchWrite( BENCH_NV_BASE + idx, BENCH_CHURN_LEN, benchModel[idx] );
+  }
+
+  if ( (benchTicks % 10) == 0 )
+  {
+    idx = BENCH_CHURN_HOT + (benchRand() % (BENCH_CHURN_CNT - BENCH_CHURN_HOT));
+    benchModel[idx][benchRand() % BENCH_CHURN_LEN] = (uint8)benchRand();
+    benchWrite( BENCH_NV_BASE + idx, BENCH_CHURN_LEN, benchModel[idx] );
+  }
+
+  (void)osal_start_timerEx( 0, BENCH_TICK_EVT, BENCH_CHURN_TICK );
+}
+
+/*
+ * Churn: BENCH_CHURN_HOT items of BENCH_CHURN_LEN bytes rewritten every
+ * BENCH_CHURN_TICK ms for BENCH_CHURN_TIME, and one of the other items every
+ * 10th tick, as diagnostics counters and frame counters are next to the
+ * rest of the tables. With the NV cache, it runs once write-back and once
+ * flushed after every write.
+ */
+static void benchChurnRun( void )
+{
+  halPosixFlashStat_t stat;
+  uint16 idx;
+
+  benchBoot();
+  osal_memset( benchModel, 0, sizeof( benchModel ) );
+  for ( idx = 0; idx < BENCH_CHURN_CNT; idx++ )
+  {
+    (void)osal_nv_item_init( BENCH_NV_BASE + idx, BENCH_CHURN_LEN, benchModel[idx] );
+  }
+  halPosixFlashGetStat( &stat, TRUE );
+
+  benchTickCB = benchChurnTick;
+  (void)osal_start_timerEx( 0, BENCH_TICK_EVT, BENCH_CHURN_TICK );
+  osalPosixRun( BENCH_CHURN_TIME );
+  (void)osal_stop_timerEx( 0, BENCH_TICK_EVT );
+
+  idx = benchCheck( BENCH_CHURN_CNT, BENCH_CHURN_LEN );
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "  %-14s %8lu ticks %9lu words %6lu erases   %s\n",
+          benchWriteThrough ? "write-through" : "write-back", (unsigned long)benchTicks,
+          (unsigned long)stat.wordCnt, (unsigned long)stat.eraseCnt, idx ? "ok" : "FAILED" );
+  halPosixFlashClose();
+}
+
+static void benchChurn( void )
+{
+  printf( "churn: %u items of %u bytes every %u ms for %lu s, 1 of %u others every 10th\n",
+          BENCH_CHURN_HOT, BENCH_CHURN_LEN, BENCH_CHURN_TICK, BENCH_CHURN_TIME / 1000,
+          BENCH_CHURN_CNT - BENCH_CHURN_HOT );
+  benchWriteThrough = TRUE;
+  benchChurnRun();
+#if OSAL_NV_CACHE
+  benchWriteThrough = FALSE;
+  benchChurnRun();
+#endif
+}
+
+static int benchLatCmp( const void *a, const void *b )
+{
+  uint32 x = *(const uint32 *)a;
+  uint32 y = *(const uint32 *)b;
+
+  return ( (x < y) ? -1 : (x > y) );
+}
+
+/*
+ * Time a write of len bytes at ndx, flushed through the NV cache.
+ */
+static void benchLatWrite( uint16 idx, uint16 ndx, uint16 len )
+{
+  uint64 start = osalPosixTime();
+
+  (void)osal_nv_write( BENCH_NV_BASE + idx, ndx, len, benchModel[idx] + ndx );
+#if OSAL_NV_CACHE
+  (void)osal_nv_flush();
+#endif
+
+  if ( benchLatCnt < BENCH_LAT_MAX )
+  {
+    benchLat[benchLatCnt++] = (uint32)(osalPosixTime() - start);
+  }
+}
+
+static void benchLatencyTick( void )
+{
+  uint16 ndx = benchTicks % BENCH_MODEL_LEN;
+  uint16 idx;
+
+  for ( idx = 0; idx < BENCH_CHURN_HOT; idx++ )
+  {
+    benchModel[idx][ndx] = (uint8)(benchTicks + idx);
+    benchLatWrite( idx, ndx, 1 );
+  }
+
+  if ( (benchTicks % 10) == 0 )
+  {
+    idx = BENCH_CHURN_HOT + (benchRand() % (BENCH_LAT_CNT - BENCH_CHURN_HOT));
+    for ( ndx = 0; ndx < BENCH_MODEL_LEN; ndx++ )
+    {
+      benchModel[idx][ndx] = (uint8)benchRand();
+    }
+    benchLatWrite( idx, 0, BENCH_MODEL_LEN );
+  }
+
+  (void)osal_start_timerEx( 0, BENCH_TICK_EVT, BENCH_CHURN_TICK );
+}
+
+/*
+ * Latency: the virtual time of each osal_nv_write() (and its flush) while
+ * the churn keeps the pages compacting. A synchronous compaction lands in
+ * the write that runs out of room; in the background, it runs as steps of
+ * the NV task, and the longest of those is reported as well, since it
+ * holds off every other task.
+ */
+static void benchLatency( void )
+{
+  halPosixFlashStat_t stat;
+#if OSAL_PROFILE
+  osalProfileStat_t prof;
+#endif
+  uint32 slow = 0;
+  uint16 idx;
+
+  printf( "latency: %u items of %u bytes, %u written every %u ms for %lu s, flushed\n",
+          BENCH_LAT_CNT, BENCH_MODEL_LEN, BENCH_CHURN_HOT, BENCH_CHURN_TICK,
+          BENCH_LAT_TIME / 1000 );
+
+  benchBoot();
+  osal_memset( benchModel, 0, sizeof( benchModel ) );
+  for ( idx = 0; idx < BENCH_LAT_CNT; idx++ )
+  {
+    (void)osal_nv_item_init( BENCH_NV_BASE + idx, BENCH_MODEL_LEN, benchModel[idx] );
+  }
+  halPosixFlashGetStat( &stat, TRUE );
+#if OSAL_PROFILE
+  osal_profile_reset();
+#endif
+  benchLatCnt = 0;
+
+  benchTickCB = benchLatencyTick;
+  (void)osal_start_timerEx( 0, BENCH_TICK_EVT, BENCH_CHURN_TICK );
+  osalPosixRun( BENCH_LAT_TIME );
+  (void)osal_stop_timerEx( 0, BENCH_TICK_EVT );
+
+  idx = benchCheck( BENCH_LAT_CNT, BENCH_MODEL_LEN );
+  halPosixFlashGetStat( &stat, TRUE );
+  qsort( benchLat, benchLatCnt, sizeof( benchLat[0] ), benchLatCmp );
+  while ( (slow < benchLatCnt) && (benchLat[benchLatCnt - 1 - slow] > BENCH_LAT_SLOW_US) )
+  {
+    slow++;
+  }
+  printf( "  %lu writes: median %lu us, p99 %lu us, p99.9 %lu us, max %lu us\n",
+          (unsigned long)benchLatCnt, (unsigned long)benchLat[benchLatCnt / 2],
+          (unsigned long)benchLat[benchLatCnt * 99 / 100],
+          (unsigned long)benchLat[benchLatCnt * 999 / 1000],
+          (unsigned long)benchLat[benchLatCnt - 1] );
+  printf( "  %lu writes over %u us\n", (unsigned long)slow, BENCH_LAT_SLOW_US );
+#if OSAL_PROFILE && OSAL_NV_TASK
+  (void)osal_profile_get( 1, &prof );
+  printf( "  longest NV task pass %lu us\n",
+          (unsigned long)prof.maxRunTime * OSAL_PROFILE_TICK_US );
+#endif
+  printf( "  %lu words %lu erases   %s\n", (unsigned long)stat.wordCnt,
+          (unsigned long)stat.eraseCnt, idx ? "ok" : "FAILED" );
+  halPosixFlashClose();
+}
+
+/*
+ * Make BENCH_TXN_UPDATES updates of BENCH_TXN_ITEMS different items, flushed
+ * after each, as a transaction or as separate writes.
+ */
+static void benchTxnRun( uint8 txn )
+{
+  halPosixFlashStat_t stat;
+  uint64 start, spent = 0;
+  uint16 update, cnt, idx, ndx;
+
+  benchBoot();
+  osal_memset( benchModel, 0, sizeof( benchModel ) );
+  for ( idx = 0; idx < BENCH_TXN_CNT; idx++ )
+  {
+    (void)osal_nv_item_init( BENCH_NV_BASE + idx, BENCH_TXN_LEN, benchModel[idx] );
+  }
+  halPosixFlashGetStat( &stat, TRUE );
+
+  for ( update = 0; update < BENCH_TXN_UPDATES; update++ )
+  {
+    start = osalPosixTime();
+#if OSAL_NV_TXN
+    if ( txn )
+    {
+      (void)osal_nv_txn_begin();
+    }
+#endif
+
+    // Items a fixed stride apart, so that the five are all different.
+    idx = benchRand() % BENCH_TXN_CNT;
+    for ( cnt = 0; cnt < BENCH_TXN_ITEMS; cnt++ )
+    {
+      idx = (idx + (BENCH_TXN_CNT / BENCH_TXN_ITEMS)) % BENCH_TXN_CNT;
+      for ( ndx = 0; ndx < BENCH_TXN_LEN; ndx++ )
+      {
+        benchModel[idx][ndx] = (uint8)benchRand();
+      }
+      (void)osal_nv_write( BENCH_NV_BASE + idx, 0, BENCH_TXN_LEN, benchModel[idx] );
+    }
+
+#if OSAL_NV_TXN
+    if ( txn )
+    {
+      (void)osal_nv_txn_commit();
+    }
+#endif
+#if OSAL_NV_CACHE
+    (void)osal_nv_flush();
+#endif
+    spent += osalPosixTime() - start;
+#if OSAL_NV_BG_COMPACT
+    osalPosixRun( 1 );
+#endif
+  }
+
+  idx = benchCheck( BENCH_TXN_CNT, BENCH_TXN_LEN );
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "  %-14s %6.1f words %6.2f ms per update, %lu erases   %s\n",
+          txn ? "transaction" : "separate", (double)stat.wordCnt / BENCH_TXN_UPDATES,
+          (double)spent / 1000.0 / BENCH_TXN_UPDATES, (unsigned long)stat.eraseCnt,
+          idx ? "ok" : "FAILED" );
+  halPosixFlashClose();
+}
+
+/*
+ * Transactions: the flash words and virtual time of updating BENCH_TXN_ITEMS
+ * items at once. The time is that of the writes, the commit and the flush;
+ * background compaction runs in the millisecond after each update and is
+ * not counted.
+ */
+static void benchTxn( void )
+{
+  printf( "txn: %u updates of %u of %u items of %u bytes, flushed\n", BENCH_TXN_UPDATES,
+          BENCH_TXN_ITEMS, BENCH_TXN_CNT, BENCH_TXN_LEN );
+  benchTxnRun( FALSE );
+#if OSAL_NV_TXN
+  benchTxnRun( TRUE );
+#endif
+}
+
+/*
+ * Boot: BENCH_BOOT_WRITES whole-item writes to BENCH_BOOT_CNT items of 4 to
+ * 43 bytes, each created at its first write, and a reset every
+ * BENCH_BOOT_EVERY writes. Each write is flushed, as a reset loses the NV
+ * cache. Reported is the virtual time of the osal_nv_init() after each
+ * reset, which with OSAL_NV_CHECKPOINT mostly starts from a checkpoint
+ * rather than a scan of every page.
+ */
+static void benchBootTime( void )
+{
+  uint16 len[BENCH_BOOT_CNT];
+  uint8 buf[BENCH_MODEL_LEN];
+  uint64 start, total = 0, most = 0;
+  uint16 boots = 0, slow = 0, write, idx, ndx;
+
+  printf( "boot: %u writes to %u items, reset every %u\n", BENCH_BOOT_WRITES,
+          BENCH_BOOT_CNT, BENCH_BOOT_EVERY );
+
+  benchBoot();
+  osal_memset( len, 0, sizeof( len ) );
+
+  for ( write = 1; write <= BENCH_BOOT_WRITES; write++ )
+  {
+    idx = benchRand() % BENCH_BOOT_CNT;
+    for ( ndx = 0; ndx < BENCH_MODEL_LEN; ndx++ )
+    {
+      benchModel[idx][ndx] = (uint8)benchRand();
+    }
+
+    if ( len[idx] == 0 )
+    {
+      len[idx] = 4 + (benchRand() % 40);
+      (void)osal_nv_item_init( BENCH_NV_BASE + idx, len[idx], benchModel[idx] );
+    }
+    else
+    {
+      (void)osal_nv_write( BENCH_NV_BASE + idx, 0, len[idx], benchModel[idx] );
+    }
+#if OSAL_NV_CACHE
+    (void)osal_nv_flush();
+#endif
+#if OSAL_NV_BG_COMPACT
+    osalPosixRun( 1 );
+#endif
+
+    if ( (write % BENCH_BOOT_EVERY) == 0 )
+    {
+      halPosixFlashClose();
+      (void)halPosixFlashOpen( BENCH_NV_FILE );
+      start = osalPosixTime();
+      osal_nv_init( NULL );
+      start = osalPosixTime() - start;
+      total += start;
+      most = (start > most) ? start : most;
+      slow += (start > BENCH_BOOT_SLOW_US);
+      boots++;
+    }
+  }
+
+  for ( idx = 0; idx < BENCH_BOOT_CNT; idx++ )
+  {
+    if ( (len[idx] != 0) &&
+         ((osal_nv_read( BENCH_NV_BASE + idx, 0, len[idx], buf ) != SUCCESS) ||
+          (memcmp( buf, benchModel[idx], len[idx] ) != 0)) )
+    {
+      break;
+    }
+  }
+
+  printf( "  %u boots: mean %.2f ms, max %.2f ms, %u over %u us   %s\n", boots,
+          (double)total / 1000.0 / boots, (double)most / 1000.0, slow, BENCH_BOOT_SLOW_US,
+          (idx == BENCH_BOOT_CNT) ? "ok" : "FAILED" );
+  halPosixFlashClose();
+}
+
+/*
+ * Write new contents to one of the items of a group, picked at random.
+ */
+static void benchCoordWrite( uint8 grp )
+{
+  const benchItems_t *pItems = benchCoordItems + grp;
+  uint8 *pBuf;
+  uint64 start;
+  uint16 idx, ndx;
+
+  idx = benchRand() % pItems->cnt;
+  pBuf = benchCoordModel[grp][idx];
+  for ( ndx = 0; ndx < pItems->len; ndx++ )
+  {
+    pBuf[ndx] = (uint8)benchRand();
+  }
+
+  start = osalPosixTime();
+  benchWrite( pItems->id + idx, pItems->len, pBuf );
+  start = osalPosixTime() - start;
+
+  benchCoordTime += start;
+  benchCoordMax = (start > benchCoordMax) ? start : benchCoordMax;
+  benchCoordWrites++;
+}
+
+static void benchCoordRun( void )
+{
+  halPosixFlashStat_t stat;
+  uint32 wear[HAL_NV_PAGE_CNT];
+  uint8 buf[BENCH_COORD_LEN];
+  uint8 grp, idx, ok = TRUE;
+  uint16 event, pg;
+
+  benchBoot();
+  osal_memset( benchCoordModel, 0, sizeof( benchCoordModel ) );
+  for ( grp = 0; grp < BENCH_COORD_GROUPS; grp++ )
+  {
+    for ( idx = 0; idx < benchCoordItems[grp].cnt; idx++ )
+    {
+      (void)osal_nv_item_init( benchCoordItems[grp].id + idx, benchCoordItems[grp].len,
+                               benchCoordModel[grp][idx] );
+    }
+  }
+  halPosixFlashGetStat( &stat, TRUE );
+  for ( pg = 0; pg < HAL_NV_PAGE_CNT; pg++ )
+  {
+    wear[pg] = halPosixFlashWear( (uint8)(HAL_NV_PAGE_BEG + pg) );
+  }
+  benchCoordTime = benchCoordMax = 0;
+  benchCoordWrites = 0;
+
+  for ( event = 0; event < BENCH_COORD_EVENTS; event++ )
+  {
+    idx = benchRand() % 100;
+    if ( idx < 60 )
+    {
+      benchCoordWrite( BENCH_COORD_FC );
+    }
+    else if ( idx < 75 )
+    {
+      // A join: the NIB and a device record
+      benchCoordWrite( BENCH_COORD_NIB );
+      benchCoordWrite( BENCH_COORD_DEV );
+    }
+    else if ( idx < 85 )
+    {
+      benchCoordWrite( BENCH_COORD_BIND );
+    }
+    else
+    {
+      benchCoordWrite( BENCH_COORD_SCENE );
+    }
+    osalPosixRun( 1 );
+  }
+
+#if OSAL_NV_CACHE
+  (void)osal_nv_flush();
+#endif
+  for ( grp = 0; grp < BENCH_COORD_GROUPS; grp++ )
+  {
+    for ( idx = 0; idx < benchCoordItems[grp].cnt; idx++ )
+    {
+      if ( (osal_nv_read( benchCoordItems[grp].id + idx, 0, benchCoordItems[grp].len,
+                          buf ) != SUCCESS) ||
+           (memcmp( buf, benchCoordModel[grp][idx], benchCoordItems[grp].len ) != 0) )
+      {
+        ok = FALSE;
+      }
+    }
+  }
+
+  halPosixFlashGetStat( &stat, TRUE );
+  printf( "  %-14s %lu writes: mean %.2f ms, max %.2f ms, %lu words, %lu erases   %s\n",
+          benchWriteThrough ? "write-through" : "write-back",
+          (unsigned long)benchCoordWrites,
+          (double)benchCoordTime / 1000.0 / benchCoordWrites, (double)benchCoordMax / 1000.0,
+          (unsigned long)stat.wordCnt, (unsigned long)stat.eraseCnt, ok ? "ok" : "FAILED" );
+  printf( "  %-14s erases per page:", "" );
+  for ( pg = 0; pg < HAL_NV_PAGE_CNT; pg++ )
+  {
+    printf( " %lu", (unsigned long)(halPosixFlashWear( (uint8)(HAL_NV_PAGE_BEG + pg) ) - wear[pg]) );
+  }
+  printf( "\n" );
+  halPosixFlashClose();
+}
+
+/*
+ * Coordinator: BENCH_COORD_EVENTS events, one per millisecond: 60% frame
+ * counter updates, 15% joins (the NIB and a device record), 10% binds and
+ * 15% scene stores. Each write is timed; the erases per page are those of
+ * the whole run. With the NV cache, it runs once flushed after every write
+ * and once leaving the cache to its flush timer.
+ */
+static void benchCoord( void )
+{
+  printf( "coord: %u events, one per ms: 60%% frame counter, 15%% join, 10%% bind, 15%% scene\n",
+          BENCH_COORD_EVENTS );
+  benchWriteThrough = TRUE;
+  benchCoordRun();
+#if OSAL_NV_CACHE
+  benchWriteThrough = FALSE;
+  benchCoordRun();
+#endif
+}
+
+int main( int argc, char **argv )
+{
+  const benchWork_t *pWork;
+
+  for ( pWork = benchWorks; pWork->name != NULL; pWork++ )
+  {
+    if ( (argc < 2) || (strcmp( argv[1], pWork->name ) == 0) )
+    {
+      pWork->pfnRun();
+    }
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,290 @@
+/**************************************************************************************************
+  Filename:       bench_osal.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of the OSAL scheduler: event dispatch and message
+ping-pong between tasks, and the message queue cost as the queue depth grows,
+in host nanoseconds per operation.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Number of tasks handing the token round: 8, 16 or 32.
+#if !defined BENCH_TASK_CNT
+#define BENCH_TASK_CNT     16
+#endif
+#if (BENCH_TASK_CNT != 8) && (BENCH_TASK_CNT != 16) && (BENCH_TASK_CNT != 32)
+#error BENCH_TASK_CNT must be 8, 16 or 32.
+#endif
+#define BENCH_PING_EVT     0x0001
+
+// Deepest message queue measured.
+#define BENCH_Q_DEPTH_MAX  512
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// A message with its OSAL header, kept out of the heap so that any depth fits.
+typedef struct
+{
+  osal_msg_hdr_t   hdr;
+  osal_event_hdr_t msg;
+} benchMsg_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint32 benchLeft;
+static benchMsg_t benchMsgs[BENCH_Q_DEPTH_MAX + 1];
+static const uint16 benchDepths[] = { 1, 8, 64, 256, BENCH_Q_DEPTH_MAX };
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+#define BENCH_TASKS_8 \
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+
+const pTaskEventHandlerFn tasksArr[BENCH_TASK_CNT] = {
+  BENCH_TASKS_8
+#if BENCH_TASK_CNT > 8
+  BENCH_TASKS_8
+#endif
+#if BENCH_TASK_CNT > 16
+  BENCH_TASKS_8
+  BENCH_TASKS_8
+#endif
+};
+
+const uint8 tasksCnt = BENCH_TASK_CNT;
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Pass the token on to the "next" task: the lowest priority task hands
+ * it back to the highest, so that every dispatch picks a different task.
+ */
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  uint8 next = (task_id == 0) ? (BENCH_TASK_CNT - 1) : (task_id - 1);
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *pMsg;
+
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+      if ( benchLeft != 0 )
+      {
+        benchLeft--;
+        (void)osal_msg_send( next, pMsg );
+      }
+      else
+      {
+        (void)osal_msg_deallocate( pMsg );
+      }
+    }
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  if ( (events & BENCH_PING_EVT) && (benchLeft != 0) )
+  {
+    benchLeft--;
+    (void)osal_set_event( next, BENCH_PING_EVT );
+  }
+
+  return 0;
+}
+
+static double benchNow( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+/*
+ * Run 'cnt' hand-overs and return the host time per hand-over.
+ */
+static double benchRun( uint32 cnt, uint8 useMsg )
+{
+  double start;
+
+  benchLeft = cnt;
+
+  if ( useMsg )
+  {
+    uint8 *pMsg = osal_msg_allocate( sizeof( osal_event_hdr_t ) );
+
+    ((osal_event_hdr_t *)pMsg)->event = 1;
+    (void)osal_msg_send( BENCH_TASK_CNT - 1, pMsg );
+  }
+  else
+  {
+    (void)osal_set_event( BENCH_TASK_CNT - 1, BENCH_PING_EVT );
+  }
+
+  start = benchNow();
+  while ( benchLeft != 0 )
+  {
+    osal_run_system();
+  }
+  osal_run_system();
+
+  return ( (benchNow() - start) / cnt );
+}
+
+/*
+ * Queue 'depth' messages to task 0 and receive them all back, about 'cnt'
+ * messages in total. If 'other' is set, the 'depth' messages are left queued
+ * to task 1 instead and task 0 sends and receives one message of its own
+ * 'cnt' times, as an idle task does next to a busy one.
+ * Returns the host time per send and receive.
+ */
+static double benchQueue( uint16 depth, uint32 cnt, uint8 other )
+{
+  benchMsg_t *pOwn = &benchMsgs[BENCH_Q_DEPTH_MAX];
+  uint32 rounds = other ? cnt : ((cnt + depth - 1) / depth);
+  uint32 ops = 0;
+  double start;
+  uint16 idx;
+
+  for ( idx = 0; idx <= BENCH_Q_DEPTH_MAX; idx++ )
+  {
+    benchMsgs[idx].hdr.next = NULL;
+    benchMsgs[idx].hdr.len = sizeof( osal_event_hdr_t );
+    benchMsgs[idx].hdr.dest_id = TASK_NO_TASK;
+    benchMsgs[idx].msg.event = 1;
+  }
+
+  if ( other )
+  {
+    for ( idx = 0; idx < depth; idx++ )
+    {
+      (void)osal_msg_send( 1, (uint8 *)&benchMsgs[idx].msg );
+    }
+  }
+
+  start = benchNow();
+  while ( rounds-- != 0 )
+  {
+    if ( other )
+    {
+      (void)osal_msg_send( 0, (uint8 *)&pOwn->msg );
+      (void)osal_msg_receive( 0 );
+      ops++;
+    }
+    else
+    {
+      for ( idx = 0; idx < depth; idx++ )
+      {
+        (void)osal_msg_send( 0, (uint8 *)&benchMsgs[idx].msg );
+      }
+      for ( idx = 0; idx < depth; idx++ )
+      {
+        (void)osal_msg_receive( 0 );
+      }
+      ops += depth;
+    }
+  }
+  start = benchNow() - start;
+
+  while ( osal_msg_receive( 1 ) != NULL )
+  {
+  }
+  osal_clear_event( 0, SYS_EVENT_MSG );
+  osal_clear_event( 1, SYS_EVENT_MSG );
+
+  return ( start / ops );
+}
+
+int main( int argc, char **argv )
+{
+  uint32 cnt = (argc > 1) ? (uint32)atol( argv[1] ) : 1000000UL;
+  uint8 idx;
+
+  (void)osal_init_system();
+
+  printf( "tasks %u, %lu hand-overs\n", BENCH_TASK_CNT, (unsigned long)cnt );
+  printf( "event dispatch    %8.1f ns\n", benchRun( cnt, FALSE ) );
+  printf( "message dispatch  %8.1f ns\n", benchRun( cnt, TRUE ) );
+
+  printf( "\nqueue depth   send+receive   behind another task's backlog\n" );
+  for ( idx = 0; idx < sizeof( benchDepths ) / sizeof( benchDepths[0] ); idx++ )
+  {
+    uint16 depth = benchDepths[idx];
+    double own = benchQueue( depth, cnt, FALSE );
+
+    printf( "%11u   %9.1f ns   %9.1f ns\n", depth, own, benchQueue( depth, cnt, TRUE ) );
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,358 @@
+/**************************************************************************************************
+  Filename:       bench_pipe.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of the pipelined SREQs of MT: MT_SYS_PING sent over the
+                  UART model one at a time, waiting for each SRSP, then as
+                  MT_SYS_PIPE_REQ with windows of 1 to 8, for a few link latencies
+                  and processing times.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "MT.h"
+#include "MT_RPC.h"
+#include "MT_TASK.h"
+#include "MT_UART.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_PIPE_REQS      300
+
+// Most requests the host has outstanding, and on its line, at once
+#define BENCH_PIPE_OUT_MAX   8
+
+// MT_SYS_PIPE_REQ: | seq | MT_SYS_PING SREQ |, on the line with its SOF and FCS
+#define BENCH_PIPE_REQ_LEN   (1 + MT_RPC_FRAME_HDR_SZ)
+#define BENCH_PIPE_FRAME_MAX (SPI_0DATA_MSG_LEN + BENCH_PIPE_REQ_LEN)
+
+// The line at the 115200 baud of MT_UART_DEFAULT_BAUDRATE, in nsecs per byte
+#define BENCH_PIPE_BYTE_NS   86806UL
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint64 due;        // When its last byte reaches the Rx buffer
+  uint8 len;
+  uint8 buf[BENCH_PIPE_FRAME_MAX];
+} benchPipeOut_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// One-way link latency and MT processing time of each request, in usecs
+static const uint16 benchLat[] = { 0, 0, 1000, 1000 };
+static const uint16 benchProc[] = { 0, 500, 0, 500 };
+
+// Windows of pipelined requests; 0 is the host waiting for each SRSP
+static const uint8 benchWindow[] = { 0, 1, 2, 4, 8 };
+
+static uint32 benchLatUs;
+static uint32 benchProcUs;
+static uint8 benchW;
+
+// Requests sent, and answered as the host has seen so far
+static uint16 benchSent;
+static uint16 benchDone;
+static uint16 benchBad;      // Answered out of order or not as asked
+static uint8 benchCfgDone;
+
+// Frames on the host line, oldest first; the first may be partly in the Rx buffer.
+static benchPipeOut_t benchOut[BENCH_PIPE_OUT_MAX];
+static uint8 benchOutHead;
+static uint8 benchOutCnt;
+static uint8 benchOutSent;   // Bytes of the first already taken by the Rx buffer
+static uint64 benchLineFree;
+
+// Answers on their way back to the host, as the time they reach it
+static uint64 benchIn[BENCH_PIPE_OUT_MAX];
+static uint8 benchInHead;
+static uint8 benchInCnt;
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchMtEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = {
+  benchMtEvent,
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+
+  MT_TaskInit( 0 );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * MT, taking benchProcUs over each request.
+ */
+static uint16 benchMtEvent( uint8 task_id, uint16 events )
+{
+  if ( events & SYS_EVENT_MSG )
+  {
+    osalPosixAdvance( benchProcUs );
+  }
+
+  return MT_ProcessEvent( task_id, events );
+}
+
+/*
+ * Put a frame of the SYS subsystem on the host line, after any frame
+ * already on it.
+ */
+static void benchSend( uint8 cmdType, uint8 cmdId, uint8 len, const uint8 *pData )
+{
+  benchPipeOut_t *pOut = benchOut + (benchOutHead + benchOutCnt) % BENCH_PIPE_OUT_MAX;
+  uint64 now = osalPosixTime();
+
+  pOut->buf[0] = MT_UART_SOF;
+  pOut->buf[1 + MT_RPC_POS_LEN] = len;
+  pOut->buf[1 + MT_RPC_POS_CMD0] = cmdType | (uint8)MT_RPC_SYS_SYS;
+  pOut->buf[1 + MT_RPC_POS_CMD1] = cmdId;
+  osal_memcpy( pOut->buf + 1 + MT_RPC_FRAME_HDR_SZ, pData, len );
+  pOut->buf[1 + MT_RPC_FRAME_HDR_SZ + len] = MT_UartCalcFCS( pOut->buf + 1, MT_RPC_FRAME_HDR_SZ + len );
+  pOut->len = len + SPI_0DATA_MSG_LEN;
+
+  if ( benchLineFree < now )
+  {
+    benchLineFree = now;
+  }
+  benchLineFree += (pOut->len * BENCH_PIPE_BYTE_NS + 999) / 1000;
+  pOut->due = benchLineFree + benchLatUs;
+  benchOutCnt++;
+}
+
+/*
+ * The host, on every scheduler pass: hand the frames due to the Rx buffer,
+ * as much of them as it takes, take in the answers due and keep the window
+ * of requests outstanding.
+ */
+static void benchHost( void )
+{
+  uint64 now = osalPosixTime();
+
+  while ( (benchOutCnt != 0) && (benchOut[benchOutHead].due <= now) )
+  {
+    benchPipeOut_t *pOut = benchOut + benchOutHead;
+
+    benchOutSent += halPosixUartRx( MT_UART_DEFAULT_PORT, pOut->buf + benchOutSent,
+                                    pOut->len - benchOutSent );
+    if ( benchOutSent < pOut->len )
+    {
+      break;  // Held off by the flow control
+    }
+    benchOutSent = 0;
+    benchOutHead = (benchOutHead + 1) % BENCH_PIPE_OUT_MAX;
+    benchOutCnt--;
+  }
+
+  while ( (benchInCnt != 0) && (benchIn[benchInHead] <= now) )
+  {
+    benchInHead = (benchInHead + 1) % BENCH_PIPE_OUT_MAX;
+    benchInCnt--;
+    benchDone++;
+  }
+
+  while ( (benchSent < BENCH_PIPE_REQS) && (benchSent - benchDone < ((benchW != 0) ? benchW : 1)) )
+  {
+    if ( benchW == 0 )
+    {
+      benchSend( (uint8)MT_RPC_CMD_SREQ, MT_SYS_PING, 0, NULL );
+    }
+    else
+    {
+      uint8 req[BENCH_PIPE_REQ_LEN];
+
+      req[0] = (uint8)benchSent;
+      req[1 + MT_RPC_POS_LEN] = 0;
+      req[1 + MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS;
+      req[1 + MT_RPC_POS_CMD1] = MT_SYS_PING;
+      benchSend( (uint8)MT_RPC_CMD_AREQ, MT_SYS_PIPE_REQ, BENCH_PIPE_REQ_LEN, req );
+    }
+    benchSent++;
+  }
+}
+
+/*
+ * The host end of the UART: the answers to the requests start back to it,
+ * in the order the requests were sent.
+ */
+static void benchRx( uint8 port, uint8 *pBuf, uint16 len )
+{
+  (void)port;
+  while ( len != 0 )
+  {
+    uint8 dataLen = pBuf[1 + MT_RPC_POS_LEN];
+    uint8 cmd0 = pBuf[1 + MT_RPC_POS_CMD0];
+    uint8 cmd1 = pBuf[1 + MT_RPC_POS_CMD1];
+    uint8 *pData = pBuf + 1 + MT_RPC_POS_DAT0;
+    uint16 idx = benchDone + benchInCnt;
+
+    if ( (cmd0 == ((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS)) && (cmd1 == MT_SYS_PIPE_CFG) )
+    {
+      benchCfgDone = TRUE;
+    }
+    else if ( (cmd0 == ((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS)) ||
+              ((cmd0 == ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS)) && (cmd1 == MT_SYS_PIPE_RSP)) )
+    {
+      if ( (benchW == 0) ? (cmd1 != MT_SYS_PING)
+                         : ((cmd1 != MT_SYS_PIPE_RSP) || (pData[0] != (uint8)idx) ||
+                            (pData[1] > benchW) || (pData[3] != MT_SYS_PING)) )
+      {
+        benchBad++;
+      }
+      benchIn[(benchInHead + benchInCnt) % BENCH_PIPE_OUT_MAX] = osalPosixTime() + benchLatUs;
+      benchInCnt++;
+    }
+
+    pBuf += dataLen + SPI_0DATA_MSG_LEN;
+    len -= dataLen + SPI_0DATA_MSG_LEN;
+  }
+}
+
+/*
+ * Send the requests with the given window, at the given latency and
+ * processing time; returns the requests per second.
+ */
+static double benchRun( uint8 w, uint32 latUs, uint32 procUs )
+{
+  uint64 start;
+
+  benchLatUs = latUs;
+  benchProcUs = 0;
+  benchW = 0;
+  benchSent = BENCH_PIPE_REQS;
+  benchDone = BENCH_PIPE_REQS;
+  benchBad = 0;
+
+  // MT_SYS_PIPE_CFG: | window |, 0 only reads it
+  benchCfgDone = FALSE;
+  benchSend( (uint8)MT_RPC_CMD_SREQ, MT_SYS_PIPE_CFG, 1, &w );
+  while ( !benchCfgDone )
+  {
+    osalPosixRun( 1 );
+  }
+
+  benchProcUs = procUs;
+  benchW = w;
+  benchSent = 0;
+  benchDone = 0;
+  start = osalPosixTime();
+  while ( (benchDone < BENCH_PIPE_REQS) && (osalPosixTime() - start < 60000000UL) )
+  {
+    osalPosixRun( 1 );
+  }
+
+  if ( (benchDone < BENCH_PIPE_REQS) || (benchBad != 0) )
+  {
+    return -1.0;
+  }
+  return ( BENCH_PIPE_REQS * 1000000.0 / (double)(osalPosixTime() - start) );
+}
+
+int main( void )
+{
+  uint8 k, w;
+
+  HalUARTInit();
+  halPosixUartSetTx( MT_UART_DEFAULT_PORT, benchRx );
+  (void)osal_init_system();
+  osalPosixSetPoll( benchHost );
+
+  // MT_SYS_RESET_IND
+  osalPosixRun( 10 );
+
+  printf( "pipe: %u MT_SYS_PING at 115200 baud, requests/s\n", BENCH_PIPE_REQS );
+  printf( "  link latency / proc  sync" );
+  for ( w = 1; w < sizeof( benchWindow ); w++ )
+  {
+    printf( "   W=%u", benchWindow[w] );
+  }
+  printf( "\n" );
+
+  for ( k = 0; k < sizeof( benchLat ) / sizeof( benchLat[0] ); k++ )
+  {
+    printf( "  %4u / %3u us       ", benchLat[k], benchProc[k] );
+    for ( w = 0; w < sizeof( benchWindow ); w++ )
+    {
+      double rate = benchRun( benchWindow[w], benchLat[k], benchProc[k] );
+
+      if ( rate < 0 )
+      {
+        printf( " FAILED" );
+      }
+      else
+      {
+        printf( " %5.0f", rate );
+      }
+    }
+    printf( "\n" );
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,198 @@
+/**************************************************************************************************
+  Filename:       bench_slack.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Measures what timer slack saves a sleeping device: wakeups per
+hour and sleep residency of a battery powered end device over one hour of
+the virtual clock, with its periodic timers started without and with slack.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_PwrMgr.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_TASK_CNT     4
+#define BENCH_TICK_EVT     0x0001
+
+// Virtual CPU time taken by each timer event, in microseconds
+#define BENCH_WORK_US      300
+
+// Length of a run, in ms
+#define BENCH_RUN_MS       (60UL * 60 * 1000)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  const char *name;
+  uint32 period;          // ms
+  uint16 slack;           // ms of lateness the task accepts
+} benchTimer_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// A sleepy end device: the parent poll is the only timer that must be on time.
+static const benchTimer_t benchTimers[BENCH_TASK_CNT] = {
+  { "parent poll",   1000,    0 },
+  { "sensor sample", 1500,  500 },
+  { "battery check", 7000, 2000 },
+  { "led heartbeat", 2300,  700 },
+};
+
+static uint8 benchUseSlack;
+static uint32 benchFireCnt;
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[BENCH_TASK_CNT] = {
+  benchTask, benchTask, benchTask, benchTask,
+};
+
+const uint8 tasksCnt = BENCH_TASK_CNT;
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void benchStart( uint8 task_id )
+{
+  const benchTimer_t *pTmr = &benchTimers[task_id];
+
+  if ( benchUseSlack && pTmr->slack )
+  {
+    (void)osal_start_timerSlackEx( task_id, BENCH_TICK_EVT, pTmr->period, pTmr->slack );
+  }
+  else
+  {
+    (void)osal_start_timerEx( task_id, BENCH_TICK_EVT, pTmr->period );
+  }
+}
+
+// Each task does its work and restarts its timer, as the applications do.
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  if ( events & BENCH_TICK_EVT )
+  {
+    benchFireCnt++;
+    osalPosixAdvance( BENCH_WORK_US );
+    benchStart( task_id );
+    return ( events ^ BENCH_TICK_EVT );
+  }
+
+  return 0;
+}
+
+static void benchRun( uint8 useSlack )
+{
+  osalPosixStat_t stat;
+  uint64 start;
+  uint8 idx;
+
+  benchUseSlack = useSlack;
+  benchFireCnt = 0;
+  for ( idx = 0; idx < BENCH_TASK_CNT; idx++ )
+  {
+    benchStart( idx );
+  }
+
+  start = osalPosixTime();
+  osalPosixGetStat( &stat, TRUE );
+  osalPosixRun( BENCH_RUN_MS );
+  osalPosixGetStat( &stat, TRUE );
+
+  printf( "%-8s %10lu %10lu %9.3f%%\n", useSlack ? "slack" : "no slack",
+          (unsigned long)stat.sleepCnt, (unsigned long)benchFireCnt,
+          100.0 * stat.sleepTime / (osalPosixTime() - start) );
+
+  for ( idx = 0; idx < BENCH_TASK_CNT; idx++ )
+  {
+    (void)osal_stop_timerEx( idx, BENCH_TICK_EVT );
+  }
+}
+
+int main( void )
+{
+  uint8 idx;
+
+  (void)osal_init_system();
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+
+  printf( "one hour, timers:" );
+  for ( idx = 0; idx < BENCH_TASK_CNT; idx++ )
+  {
+    printf( " %s %lu+%u ms%s", benchTimers[idx].name, (unsigned long)benchTimers[idx].period,
+            benchTimers[idx].slack, (idx + 1 < BENCH_TASK_CNT) ? "," : "\n" );
+  }
+  printf( "run       wakeups/h   events/h  residency\n" );
+  benchRun( FALSE );
+  benchRun( TRUE );
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
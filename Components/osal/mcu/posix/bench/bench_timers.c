@@ -0,0 +1,264 @@
+/**************************************************************************************************
+  Filename:       bench_timers.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of the OSAL timers: the cost of a timer tick, of
+restarting a timer and of osal_next_timeout() with 10, 100 and 1000 live
+timers, in host nanoseconds per call.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "osal_posix.h"
+
+void *benchTimerAlloc( uint16 size );
+void benchTimerFree( void *ptr );
+
+/*
+ * On the host a timer record and its block header take 32 bytes, so the
+ * 32 KB that an OSAL heap can manage holds fewer than 1000 timers (on the
+ * CC2530 a record is half that size). The timers under test therefore get
+ * their memory from the host; the timer code itself is unchanged.
+ */
+#undef osal_mem_alloc
+#undef osal_mem_free
+#define osal_mem_alloc  benchTimerAlloc
+#define osal_mem_free   benchTimerFree
+#include "../../../common/OSAL_Timers.c"
+#undef osal_mem_alloc
+#undef osal_mem_free
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// 16 timers per task (one per event bit): 63 tasks hold 1008 timers.
+#define BENCH_TASK_CNT     63
+#define BENCH_TIMER_MAX    (BENCH_TASK_CNT * 16)
+
+// Slack given to every timer in the slack runs, in ms
+#define BENCH_SLACK        50
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[BENCH_TASK_CNT] = {
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+  benchTask, benchTask, benchTask, benchTask, benchTask, benchTask, benchTask,
+};
+
+const uint8 tasksCnt = BENCH_TASK_CNT;
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)calloc( tasksCnt, sizeof( uint16 ) );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+void *benchTimerAlloc( uint16 size )
+{
+  return ( malloc( size ) );
+}
+
+void benchTimerFree( void *ptr )
+{
+  free( ptr );
+}
+
+// The timers only set events; the scheduler is never run.
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+  return ( events );
+}
+
+static double benchNow( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+static void benchStopAll( void )
+{
+  uint16 idx;
+
+  for ( idx = 0; idx < BENCH_TIMER_MAX; idx++ )
+  {
+    (void)osal_stop_timerEx( idx / 16, BV( idx % 16 ) );
+  }
+}
+
+/*
+ * Start 'timerCnt' reload timers of period 'timerCnt' ms, one per ms, so
+ * that from then on exactly one of them is due at every 1 ms tick.
+ */
+static void benchStartReload( uint16 timerCnt )
+{
+  uint16 idx;
+
+  for ( idx = 0; idx < timerCnt; idx++ )
+  {
+    (void)osal_start_reload_timer( idx / 16, BV( idx % 16 ), timerCnt );
+    osalTimerUpdate( 1 );
+  }
+}
+
+/*
+ * Start 'timerCnt' one-shot timers spread over the next 'timerCnt' seconds,
+ * with 'slack' ms of allowed lateness each.
+ */
+static void benchStartSpread( uint16 timerCnt, uint16 slack )
+{
+  uint16 idx;
+
+  for ( idx = 0; idx < timerCnt; idx++ )
+  {
+    // Interleave the deadlines so that the heap is not built in order
+    uint32 timeout = 1000UL * (((uint32)idx * 7919) % timerCnt + 1);
+
+    (void)osal_start_timerSlackEx( idx / 16, BV( idx % 16 ), timeout, slack );
+  }
+}
+
+static void benchRun( uint16 timerCnt, uint32 cnt )
+{
+  volatile uint32 sink = 0;
+  double start, tickIdle, tickDue, restart, next, nextSlack;
+  uint32 idx;
+
+  // A tick with one timer due: expiry, event and reload
+  benchStartReload( timerCnt );
+  start = benchNow();
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    osalTimerUpdate( 1 );
+  }
+  tickDue = (benchNow() - start) / cnt;
+  benchStopAll();
+
+  // A tick with nothing due, and a restart of an existing timer
+  benchStartSpread( timerCnt, 0 );
+  if ( osal_timer_num_active() != timerCnt )
+  {
+    printf( "only %u of %u timers started\n", osal_timer_num_active(), timerCnt );
+    exit( 1 );
+  }
+  start = benchNow();
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    osalTimerUpdate( 1 );
+  }
+  tickIdle = (benchNow() - start) / cnt;
+
+  start = benchNow();
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    uint16 tmr = (uint16)((idx * 7919) % timerCnt);
+
+    (void)osal_start_timerEx( tmr / 16, BV( tmr % 16 ), 1000UL * (idx % timerCnt + 1) );
+  }
+  restart = (benchNow() - start) / cnt;
+
+  start = benchNow();
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    sink += osal_next_timeout();
+  }
+  next = (benchNow() - start) / cnt;
+  benchStopAll();
+
+  // osal_next_timeout() when every timer has slack
+  benchStartSpread( timerCnt, BENCH_SLACK );
+  start = benchNow();
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    sink += osal_next_timeout();
+  }
+  nextSlack = (benchNow() - start) / cnt;
+  benchStopAll();
+
+  (void)sink;
+  printf( "%6u %10.1f %10.1f %10.1f %10.1f %10.1f\n", timerCnt,
+          tickIdle, tickDue, restart, next, nextSlack );
+}
+
+int main( int argc, char **argv )
+{
+  static const uint16 timerCnts[] = { 10, 100, 1000 };
+  uint32 cnt = (argc > 1) ? (uint32)atol( argv[1] ) : 1000000UL;
+  uint8 idx;
+
+  (void)osal_init_system();
+
+  printf( "ns per call, %lu calls each\n", (unsigned long)cnt );
+  printf( "timers  tick-idle   tick-due    restart  next-tmo  next-slack\n" );
+  for ( idx = 0; idx < sizeof( timerCnts ) / sizeof( timerCnts[0] ); idx++ )
+  {
+    benchRun( timerCnts[idx], cnt );
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,275 @@
+/**************************************************************************************************
+  Filename:       bench_uart.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Benchmark of the UART Tx paths: bursts of MT-sized frames copied
+                  into the Tx buffer by HalUARTWrite(), or with HAL_UART_TXQ queued
+                  in place by HalUARTWriteQueue() and copied only when the queue is
+                  full, as MT_TransportSend() does.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "hal_board_cfg.h"
+#include "hal_uart.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_UART_PORT    HAL_UART_PORT_0
+#define BENCH_UART_BURSTS  200
+#define BENCH_UART_BURST_MAX 12
+
+// Frame header: SOF, length, then the index of the frame
+#define BENCH_UART_SOF     0xFE
+#define BENCH_UART_HDR     4
+
+// The line at 115200 baud; a burst comes every time the line takes to send it at 80% load.
+#define BENCH_UART_BYTE_NS 86806UL
+#define BENCH_UART_LOAD    80
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint16 sent;
+  uint16 lost;       // Refused by the driver
+  uint16 got;        // At the host
+  uint64 latSum;     // Usecs from the write to the last byte at the host
+  uint32 latMax;
+} benchUartRes_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Frames per burst and bytes per frame
+static const uint8 benchBurst[] = { 2, 4, 8, BENCH_UART_BURST_MAX };
+static const uint8 benchSize[] = { 16, 48, 120 };
+
+static uint64 benchSentAt[BENCH_UART_BURSTS * BENCH_UART_BURST_MAX];
+static benchUartRes_t benchRes;
+
+#if HAL_UART_TXQ
+// One buffer per queued frame: the driver reads it until it is sent.
+static uint8 benchBuf[HAL_POSIX_UART_TXQ_CNT][HAL_POSIX_UART_TX_MAX];
+static uint8 benchBufUsed[HAL_POSIX_UART_TXQ_CNT];
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = {
+  benchTask,
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint16 benchTask( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+  (void)events;
+  return 0;
+}
+
+/*
+ * The host end of the line: time each frame from its write.
+ */
+static void benchHost( uint8 port, uint8 *pBuf, uint16 len )
+{
+  uint32 lat;
+
+  (void)port;
+  while ( len >= BENCH_UART_HDR )
+  {
+    lat = (uint32)(osalPosixTime() - benchSentAt[BUILD_UINT16( pBuf[2], pBuf[3] )]);
+    benchRes.got++;
+    benchRes.latSum += lat;
+    if ( lat > benchRes.latMax )
+    {
+      benchRes.latMax = lat;
+    }
+
+    len -= pBuf[1];
+    pBuf += pBuf[1];
+  }
+}
+
+static void benchFrame( uint8 *pBuf, uint16 idx, uint8 size )
+{
+  (void)memset( pBuf, (uint8)idx, size );
+  pBuf[0] = BENCH_UART_SOF;
+  pBuf[1] = size;
+  pBuf[2] = LO_UINT16( idx );
+  pBuf[3] = HI_UINT16( idx );
+}
+
+#if HAL_UART_TXQ
+static void benchFree( uint8 *pBuf )
+{
+  benchBufUsed[(pBuf - benchBuf[0]) / HAL_POSIX_UART_TX_MAX] = FALSE;
+}
+#endif
+
+/*
+ * Send the bursts, each frame queued if 'queue' and the queue has room,
+ * else copied.
+ */
+static void benchRun( uint8 burst, uint8 size, uint8 queue )
+{
+  uint32 periodMs = (uint32)(((uint64)burst * size * BENCH_UART_BYTE_NS * 100 /
+                              BENCH_UART_LOAD + 999999) / 1000000);
+  uint8 frame[HAL_POSIX_UART_TX_MAX];
+  uint16 idx = 0;
+  uint16 b;
+  uint8 k;
+
+  (void)memset( &benchRes, 0, sizeof( benchRes ) );
+  for ( b = 0; b < BENCH_UART_BURSTS; b++ )
+  {
+    for ( k = 0; k < burst; k++, idx++ )
+    {
+      benchSentAt[idx] = osalPosixTime();
+      benchRes.sent++;
+
+#if HAL_UART_TXQ
+      if ( queue )
+      {
+        uint8 buf;
+
+        for ( buf = 0; (buf < HAL_POSIX_UART_TXQ_CNT) && benchBufUsed[buf]; buf++ );
+        if ( buf < HAL_POSIX_UART_TXQ_CNT )
+        {
+          benchFrame( benchBuf[buf], idx, size );
+          benchBufUsed[buf] = TRUE;
+          if ( HalUARTWriteQueue( BENCH_UART_PORT, benchBuf[buf], size, benchFree ) )
+          {
+            continue;
+          }
+          benchBufUsed[buf] = FALSE;
+        }
+      }
+#else
+      (void)queue;
+#endif
+
+      benchFrame( frame, idx, size );
+      if ( HalUARTWrite( BENCH_UART_PORT, frame, size ) == 0 )
+      {
+        benchRes.lost++;
+      }
+    }
+    osalPosixRun( periodMs );
+  }
+  halPosixUartFlush( BENCH_UART_PORT );
+}
+
+static void benchPrint( const char *name )
+{
+  printf( ", %s lost %3u/%u lat %6.0f/%6lu us %s", name, benchRes.lost, benchRes.sent,
+          benchRes.got ? (double)benchRes.latSum / benchRes.got : 0.0,
+          (unsigned long)benchRes.latMax,
+          (benchRes.got == benchRes.sent - benchRes.lost) ? "ok" : "FAILED" );
+}
+
+int main( void )
+{
+  halUARTCfg_t config;
+  uint8 b, s;
+
+  (void)osal_init_system();
+  HalUARTInit();
+  (void)memset( &config, 0, sizeof( config ) );
+  config.baudRate = HAL_UART_BR_115200;
+  (void)HalUARTOpen( BENCH_UART_PORT, &config );
+  halPosixUartSetTx( BENCH_UART_PORT, benchHost );
+
+  printf( "uart: %u bursts at %u%% load of 115200 baud, %u byte Tx buffer",
+          BENCH_UART_BURSTS, BENCH_UART_LOAD, HAL_POSIX_UART_TX_MAX );
+#if HAL_UART_TXQ
+  printf( ", %u deep Tx queue", HAL_POSIX_UART_TXQ_CNT );
+#endif
+  printf( "; latency mean/max\n" );
+
+  for ( s = 0; s < sizeof( benchSize ); s++ )
+  {
+    for ( b = 0; b < sizeof( benchBurst ); b++ )
+    {
+      printf( "  %2u x %3u bytes", benchBurst[b], benchSize[s] );
+      benchRun( benchBurst[b], benchSize[s], FALSE );
+      benchPrint( "copy" );
+#if HAL_UART_TXQ
+      benchRun( benchBurst[b], benchSize[s], TRUE );
+      benchPrint( "queue" );
+#endif
+      printf( "\n" );
+    }
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
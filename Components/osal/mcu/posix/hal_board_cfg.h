@@ -0,0 +1,227 @@
+/**************************************************************************************************
+  Filename:       hal_board_cfg.h
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Board configuration for the POSIX host port. The flash geometry
+matches the CC2530F256 so that the CC2530 OSAL NV driver runs
+unchanged against the file-backed flash in hal_flash.c.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+#ifndef HAL_BOARD_CFG_H
+#define HAL_BOARD_CFG_H
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#include "hal_mcu.h"
+#include "hal_defs.h"
+#include "hal_types.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Board Indentifier
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#define HAL_BOARD_POSIX
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Clock Speed
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#define HAL_CPU_CLOCK_MHZ     32
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Flash
+ * ------------------------------------------------------------------------------------------------
+ */
+
+// The geometry defaults to the CC2530F256; a host build may change it to model another part.
+#define HAL_FLASH_PAGE_PER_BANK    16
+#if !defined HAL_FLASH_PAGE_SIZE
+#define HAL_FLASH_PAGE_SIZE        2048
+#endif
+#if !defined HAL_FLASH_WORD_SIZE
+#define HAL_FLASH_WORD_SIZE        4
+#endif
+#if !defined HAL_FLASH_PAGE_CNT
+#define HAL_FLASH_PAGE_CNT         128
+#endif
+
+// Flash is partitioned into 8 banks of 32 KB or 16 pages.
+#define HAL_FLASH_LOCK_BITS        16
+#define HAL_NV_PAGE_END           (HAL_FLASH_PAGE_CNT - 2)
+#if !defined HAL_NV_PAGE_CNT
+#define HAL_NV_PAGE_CNT            6
+#endif
+
+#define HAL_FLASH_IEEE_SIZE        8
+#define HAL_FLASH_IEEE_PAGE       (HAL_NV_PAGE_END+1)
+#define HAL_FLASH_IEEE_OSET       (HAL_FLASH_PAGE_SIZE - HAL_FLASH_LOCK_BITS - HAL_FLASH_IEEE_SIZE)
+
+#define HAL_NV_PAGE_BEG           (HAL_NV_PAGE_END-HAL_NV_PAGE_CNT+1)
+
+// File backing the flash image when the test does not name one with halPosixFlashOpen().
+#if !defined HAL_POSIX_FLASH_FILE
+#define HAL_POSIX_FLASH_FILE      "osal_flash.bin"
+#endif
+
+// Virtual time, in nsecs, taken by each HalFlashRead() call and by each byte it copies.
+#if !defined HAL_POSIX_FLASH_READ_CALL_NS
+#define HAL_POSIX_FLASH_READ_CALL_NS  2000
+#endif
+#if !defined HAL_POSIX_FLASH_READ_BYTE_NS
+#define HAL_POSIX_FLASH_READ_BYTE_NS  600
+#endif
+
+// Virtual time, in usecs, taken by programming one flash word and by erasing one page.
+#if !defined HAL_POSIX_FLASH_WORD_US
+#define HAL_POSIX_FLASH_WORD_US   20
+#endif
+#if !defined HAL_POSIX_FLASH_ERASE_US
+#define HAL_POSIX_FLASH_ERASE_US  20000
+#endif
+
+// Times that a flash word may be programmed between erases: twice, on the CC2530.
+#if !defined HAL_POSIX_FLASH_WORD_PROGS
+#define HAL_POSIX_FLASH_WORD_PROGS  2
+#endif
+
+// Writes queued by HalFlashWriteAsync() complete on the virtual clock, as the DMA would program them.
+#if !defined HAL_FLASH_ASYNC
+#define HAL_FLASH_ASYNC           FALSE
+#endif
+#if !defined HAL_FLASH_ASYNC_CNT
+#define HAL_FLASH_ASYNC_CNT       4
+#endif
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                            XNV
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* The SPI Xtra-NV of the CC2530EB, an M25PE20, is modelled in RAM by hal_xnv.c. Each byte on the
+ * bus takes HAL_POSIX_XNV_BYTE_NS of virtual time and the device is busy for the typical time of
+ * a Page Program, Page Write, Page Erase or Sector Erase.
+ */
+#if !defined HAL_POSIX_XNV_SIZE
+#define HAL_POSIX_XNV_SIZE        0x40000UL
+#endif
+#if !defined HAL_POSIX_XNV_BYTE_NS
+#define HAL_POSIX_XNV_BYTE_NS     1000
+#endif
+#if !defined HAL_POSIX_XNV_PP_US
+#define HAL_POSIX_XNV_PP_US       800
+#endif
+#if !defined HAL_POSIX_XNV_PW_US
+#define HAL_POSIX_XNV_PW_US       11000
+#endif
+#if !defined HAL_POSIX_XNV_PE_US
+#define HAL_POSIX_XNV_PE_US       10000
+#endif
+#if !defined HAL_POSIX_XNV_SE_US
+#define HAL_POSIX_XNV_SE_US       1000000
+#endif
+
+extern void halPosixXnvBegin(void);
+extern void halPosixXnvTx(uint8 ch);
+extern uint8 halPosixXnvRx(void);
+extern void halPosixXnvEnd(void);
+
+#define XNV_SPI_BEGIN()             halPosixXnvBegin()
+#define XNV_SPI_TX(x)               halPosixXnvTx(x)
+#define XNV_SPI_RX()                halPosixXnvRx()
+#define XNV_SPI_WAIT_RXRDY()
+#define XNV_SPI_END()               halPosixXnvEnd()
+#define XNV_SPI_INIT()
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                             UART
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* hal_uart.c models the DMA driver of the CC2530: an Rx ring that stores each byte next to its
+ * marker, a Tx buffer filled by HalUARTWrite() and, with HAL_UART_TXQ, a queue of buffers sent
+ * in place. The options default as on the CC2530EB.
+ */
+#if !defined HAL_POSIX_UART_RX_MAX
+#define HAL_POSIX_UART_RX_MAX     128
+#endif
+#if !defined HAL_POSIX_UART_TX_MAX
+#define HAL_POSIX_UART_TX_MAX     128
+#endif
+#if !defined HAL_POSIX_UART_STRIDE
+#define HAL_POSIX_UART_STRIDE     2
+#endif
+#if !defined HAL_POSIX_UART_TXQ_CNT
+#define HAL_POSIX_UART_TXQ_CNT    8
+#endif
+
+#ifndef HAL_UART_SPAN
+#define HAL_UART_SPAN  FALSE
+#endif
+#ifndef HAL_UART_TXQ
+#define HAL_UART_TXQ  FALSE
+#endif
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Driver Configuration
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* Only the flash and UART drivers, and the SPI Xtra-NV of hal_ota.c, exist on the host. */
+#define HAL_FLASH    TRUE
+#define HAL_ADC      FALSE
+#define HAL_AES      FALSE
+#define HAL_DMA      FALSE
+#define HAL_KEY      FALSE
+#define HAL_LCD      FALSE
+#define HAL_LED      FALSE
+#define HAL_TIMER    FALSE
+#define HAL_UART     TRUE
+#define HAL_HID      FALSE
+
+
+/*******************************************************************************************************
+*/
+#endif
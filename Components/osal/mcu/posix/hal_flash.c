@@ -0,0 +1,705 @@
+/**************************************************************************************************
+  Filename:       hal_flash.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    File-backed flash for the POSIX host port. The image is held in
+RAM and written through to a file so that NV contents survive a
+host "reset". Writes follow NOR semantics: bits can only be
+cleared, and only an erase sets them again. Accesses are counted
+and timed on the virtual clock, and a power cut can be injected
+into any write or erase.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal_assert.h"
+#include "hal_board_cfg.h"
+#include "hal_flash.h"
+#include "hal_mcu.h"
+#include "hal_types.h"
+#include "osal_posix.h"
+#if HAL_FLASH_ASYNC
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Constants
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#define HAL_POSIX_FLASH_SIZE  ((uint32)HAL_FLASH_PAGE_CNT * HAL_FLASH_PAGE_SIZE)
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Typedefs
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#if HAL_FLASH_ASYNC
+typedef struct
+{
+  uint64 done;     // Virtual time at which the write is programmed.
+  uint16 event;
+  uint8 taskId;
+} flashReq_t;
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static uint8 flashImage[HAL_POSIX_FLASH_SIZE];
+static FILE *flashFile;
+static uint8 flashLoaded;  // Set once the image has been loaded, even if RAM-only.
+static uint32 flashReadNs; // Read time not yet added to the virtual clock.
+
+static halPosixFlashStat_t flashStat;
+static uint32 flashWear[HAL_FLASH_PAGE_CNT];
+// Times each word was programmed since its page was erased; kept over a re-open of the same image.
+static uint8 flashProgs[HAL_POSIX_FLASH_SIZE / HAL_FLASH_WORD_SIZE];
+static uint32 flashCutOps;                 // Writes and erases left before the power cut.
+static halPosixFlashCutCB_t flashCutCB;    // Non-NULL while a power cut is armed.
+
+#if HAL_FLASH_ASYNC
+// Writes queued by HalFlashWriteAsync(); their data is in the image as soon as they are queued.
+static flashReq_t flashQ[HAL_FLASH_ASYNC_CNT];
+static uint8 flashQHead;
+static uint8 flashQCnt;
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void flashSync(uint32 addr, uint32 len);
+static uint8 flashCutDue(void);
+static void flashCutDone(void);
+static uint16 flashProgram(uint16 addr, uint8 *buf, uint16 cnt, uint8 sync);
+
+/**************************************************************************************************
+ * @fn          halPosixFlashOpen
+ *
+ * @brief       Load the flash image from 'path', creating an erased image if the file does not
+ *              exist. Called implicitly with NULL by the first flash access.
+ *
+ * input parameters
+ *
+ * @param       path - File name, or NULL for HAL_POSIX_FLASH_FILE.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the file could be opened, FALSE to run with a RAM-only image.
+ **************************************************************************************************
+ */
+uint8 halPosixFlashOpen(const char *path)
+{
+  size_t len = 0;
+
+  halPosixFlashClose();
+
+  if (path == NULL)
+  {
+    path = HAL_POSIX_FLASH_FILE;
+  }
+
+  (void)memset(flashImage, 0xFF, sizeof(flashImage));
+  flashLoaded = TRUE;
+#if HAL_FLASH_ASYNC
+  flashQCnt = 0;  // A power cycle loses whatever was not programmed yet.
+#endif
+
+  if ((flashFile = fopen(path, "r+b")) != NULL)
+  {
+    len = fread(flashImage, 1, sizeof(flashImage), flashFile);
+  }
+  else if ((flashFile = fopen(path, "w+b")) == NULL)
+  {
+    return FALSE;
+  }
+
+  if (len != sizeof(flashImage))
+  {
+    // New or truncated file: pad it out to the full erased size.
+    flashSync(0, HAL_POSIX_FLASH_SIZE);
+    (void)memset(flashProgs, 0, sizeof(flashProgs));
+  }
+
+  return TRUE;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixFlashClose
+ *
+ * @brief       Flush and close the flash file.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixFlashClose(void)
+{
+  if (flashFile != NULL)
+  {
+    (void)fclose(flashFile);
+    flashFile = NULL;
+  }
+}
+
+/**************************************************************************************************
+ * @fn          flashSync
+ *
+ * @brief       Write a range of the RAM image through to the flash file.
+ *
+ * input parameters
+ *
+ * @param       addr - Byte address into the image.
+ * @param       len - Number of bytes.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void flashSync(uint32 addr, uint32 len)
+{
+  if (flashFile != NULL)
+  {
+    (void)fseek(flashFile, (long)addr, SEEK_SET);
+    (void)fwrite(flashImage + addr, 1, len, flashFile);
+    (void)fflush(flashFile);
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixFlashGetStat
+ *
+ * @brief       Copy the flash access statistics and optionally clear them.
+ *
+ * input parameters
+ *
+ * @param       clear - TRUE to clear the statistics once copied.
+ *
+ * output parameters
+ *
+ * @param       pStat - The statistics.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixFlashGetStat(halPosixFlashStat_t *pStat, uint8 clear)
+{
+  *pStat = flashStat;
+
+  if (clear)
+  {
+    (void)memset(&flashStat, 0, sizeof(flashStat));
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixFlashWear
+ *
+ * @brief       Get the erase count of a flash page. Unlike the statistics, it is never cleared,
+ *              so it shows the wear that a whole run put on each page.
+ *
+ * input parameters
+ *
+ * @param       pg - A valid flash page number.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The count of the erases of the page, cut ones included.
+ **************************************************************************************************
+ */
+uint32 halPosixFlashWear(uint8 pg)
+{
+  HAL_ASSERT(pg < HAL_FLASH_PAGE_CNT);
+  return flashWear[pg];
+}
+
+/**************************************************************************************************
+ * @fn          halPosixFlashCut
+ *
+ * @brief       Arm a power cut: the next 'ops' writes and erases complete, then the following one
+ *              is torn. A torn write programs only the first half of its words and a torn erase
+ *              only erases the first half of its page. 'pfnCut' is then called, normally to
+ *              longjmp() back to where the host "powers up" the device again; if it returns, the
+ *              flash call returns as if it had completed.
+ *
+ * input parameters
+ *
+ * @param       ops - Count of the writes and erases to complete before the cut.
+ * @param       pfnCut - Power cut callback, or NULL to disarm.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixFlashCut(uint32 ops, halPosixFlashCutCB_t pfnCut)
+{
+  flashCutOps = ops;
+  flashCutCB = pfnCut;
+}
+
+/**************************************************************************************************
+ * @fn          flashCutDue
+ *
+ * @brief       Count a write or erase against an armed power cut.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if this write or erase is to be torn.
+ **************************************************************************************************
+ */
+static uint8 flashCutDue(void)
+{
+  if (flashCutCB == NULL)
+  {
+    return FALSE;
+  }
+  else if (flashCutOps != 0)
+  {
+    flashCutOps--;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**************************************************************************************************
+ * @fn          flashCutDone
+ *
+ * @brief       Disarm the power cut that tore the current write or erase and call its callback.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void flashCutDone(void)
+{
+  halPosixFlashCutCB_t pfnCut = flashCutCB;
+
+  flashCutCB = NULL;
+  flashStat.cutCnt++;
+  pfnCut();
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashRead
+ *
+ * @brief       This function reads 'cnt' bytes from the internal flash.
+ *
+ * input parameters
+ *
+ * @param       pg - A valid flash page number.
+ * @param       offset - A valid offset into the page.
+ * @param       buf - A valid buffer space at least as big as the 'cnt' parameter.
+ * @param       cnt - A valid number of bytes to read.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
+{
+  uint32 addr = (uint32)pg * HAL_FLASH_PAGE_SIZE + offset;
+
+  if (!flashLoaded)
+  {
+    (void)halPosixFlashOpen(NULL);
+  }
+
+#if HAL_FLASH_ASYNC
+  HalFlashWait();
+#endif
+
+  HAL_ASSERT((addr + cnt) <= HAL_POSIX_FLASH_SIZE);
+  (void)memcpy(buf, flashImage + addr, cnt);
+
+  flashStat.readCnt++;
+  flashReadNs += HAL_POSIX_FLASH_READ_CALL_NS + (uint32)cnt * HAL_POSIX_FLASH_READ_BYTE_NS;
+  osalPosixAdvance(flashReadNs / 1000);
+  flashReadNs %= 1000;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashWrite
+ *
+ * @brief       This function writes 'cnt' bytes to the internal flash.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4.
+ * @param       cnt - Number of 4-byte blocks to write.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt)
+{
+#if HAL_FLASH_ASYNC
+  HalFlashWait();
+#endif
+
+  (void)flashProgram(addr, buf, cnt, TRUE);
+}
+
+#if HAL_FLASH_ASYNC
+/**************************************************************************************************
+ * @fn          HalFlashWriteAsync
+ *
+ * @brief       This function queues a write of 'cnt' 4-byte blocks to the internal flash. The
+ *              data reaches the image at once, but the write is done, and the task signalled,
+ *              only once the virtual clock has run for its programming time.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4.
+ * @param       cnt - Number of 4-byte blocks to write.
+ * @param       taskId - OSAL task to signal when the write is done, or TASK_NO_TASK.
+ * @param       event - OSAL event to set for the task.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the write was queued; FALSE if the queue is full.
+ **************************************************************************************************
+ */
+uint8 HalFlashWriteAsync(uint16 addr, uint8 *buf, uint16 cnt, uint8 taskId, uint16 event)
+{
+  flashReq_t *pReq;
+  uint64 start = osalPosixTime();
+
+  halPosixFlashPoll();
+
+  if (flashQCnt == HAL_FLASH_ASYNC_CNT)
+  {
+    return FALSE;
+  }
+
+  if (flashQCnt != 0)
+  {
+    start = flashQ[(flashQHead + flashQCnt - 1) % HAL_FLASH_ASYNC_CNT].done;
+  }
+
+  pReq = flashQ + ((flashQHead + flashQCnt) % HAL_FLASH_ASYNC_CNT);
+  pReq->done = start + (uint64)flashProgram(addr, buf, cnt, FALSE) * HAL_POSIX_FLASH_WORD_US;
+  pReq->event = event;
+  pReq->taskId = taskId;
+  flashQCnt++;
+
+  return TRUE;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashBusy
+ *
+ * @brief       This function counts the writes queued by HalFlashWriteAsync() not yet done.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The number of queued writes, zero when the flash is idle.
+ **************************************************************************************************
+ */
+uint8 HalFlashBusy(void)
+{
+  halPosixFlashPoll();
+
+  return flashQCnt;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashWait
+ *
+ * @brief       This function waits until the writes queued by HalFlashWriteAsync() are done:
+ *              the virtual clock moves on to the end of the last one.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashWait(void)
+{
+  halPosixFlashPoll();
+
+  if (flashQCnt != 0)
+  {
+    uint64 done = flashQ[(flashQHead + flashQCnt - 1) % HAL_FLASH_ASYNC_CNT].done;
+
+    osalPosixAdvance((uint32)(done - osalPosixTime()));
+    halPosixFlashPoll();
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixFlashPoll
+ *
+ * @brief       Retire the queued writes done by now and signal their tasks - the work of the
+ *              DMA ISR on the target. Called from Hal_ProcessPoll().
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixFlashPoll(void)
+{
+  while ((flashQCnt != 0) && (flashQ[flashQHead].done <= osalPosixTime()))
+  {
+    if (flashQ[flashQHead].taskId != TASK_NO_TASK)
+    {
+      (void)osal_set_event(flashQ[flashQHead].taskId, flashQ[flashQHead].event);
+    }
+
+    flashQHead = (flashQHead + 1) % HAL_FLASH_ASYNC_CNT;
+    flashQCnt--;
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixFlashDue
+ *
+ * @brief       Get the virtual time at which the next queued write is done, so that a sleep
+ *              ends there as the DMA interrupt would end it.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The virtual time, in usecs; zero if no write is queued.
+ **************************************************************************************************
+ */
+uint64 halPosixFlashDue(void)
+{
+  return (flashQCnt != 0) ? flashQ[flashQHead].done : 0;
+}
+#endif
+
+/**************************************************************************************************
+ * @fn          flashProgram
+ *
+ * @brief       Program 'cnt' 4-byte blocks into the image, or half of them if a power cut is due.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4.
+ * @param       cnt - Number of 4-byte blocks to write.
+ * @param       sync - TRUE to run the virtual clock for the programming time.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The number of 4-byte blocks programmed.
+ **************************************************************************************************
+ */
+static uint16 flashProgram(uint16 addr, uint8 *buf, uint16 cnt, uint8 sync)
+{
+  uint32 byteAddr = (uint32)addr * HAL_FLASH_WORD_SIZE;
+  uint32 len = (uint32)cnt * HAL_FLASH_WORD_SIZE;
+  uint32 idx;
+  uint8 cut = flashCutDue();
+
+  if (!flashLoaded)
+  {
+    (void)halPosixFlashOpen(NULL);
+  }
+
+  HAL_ASSERT((byteAddr + len) <= HAL_POSIX_FLASH_SIZE);
+
+  if (cut)
+  {
+    cnt /= 2;
+    len = (uint32)cnt * HAL_FLASH_WORD_SIZE;
+  }
+
+  for (idx = 0; idx < len; idx++)
+  {
+    flashImage[byteAddr + idx] &= buf[idx];  // Programming can only clear bits.
+  }
+
+  for (idx = 0; idx < cnt; idx++)
+  {
+    if (flashProgs[addr + idx] < HAL_POSIX_FLASH_WORD_PROGS)
+    {
+      flashProgs[addr + idx]++;
+    }
+    else
+    {
+      flashStat.overCnt++;  // Too many times to be sure of the bits on the part.
+    }
+  }
+
+  flashSync(byteAddr, len);
+  flashStat.wordCnt += cnt;
+
+  if (sync)
+  {
+    osalPosixAdvance((uint32)cnt * HAL_POSIX_FLASH_WORD_US);
+  }
+
+  if (cut)
+  {
+    flashCutDone();
+  }
+
+  return cnt;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashErase
+ *
+ * @brief       This function erases the specified page of the internal flash.
+ *
+ * input parameters
+ *
+ * @param       pg - A valid flash page number to erase.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashErase(uint8 pg)
+{
+  uint32 addr = (uint32)pg * HAL_FLASH_PAGE_SIZE;
+
+  if (!flashLoaded)
+  {
+    (void)halPosixFlashOpen(NULL);
+  }
+
+#if HAL_FLASH_ASYNC
+  HalFlashWait();
+#endif
+
+  HAL_ASSERT(pg < HAL_FLASH_PAGE_CNT);
+
+  if (flashCutDue())
+  {
+    (void)memset(flashImage + addr, 0xFF, HAL_FLASH_PAGE_SIZE / 2);
+    (void)memset(flashProgs + (addr / HAL_FLASH_WORD_SIZE), 0,
+                 HAL_FLASH_PAGE_SIZE / 2 / HAL_FLASH_WORD_SIZE);
+    flashSync(addr, HAL_FLASH_PAGE_SIZE / 2);
+    flashWear[pg]++;
+    osalPosixAdvance(HAL_POSIX_FLASH_ERASE_US / 2);
+    flashCutDone();
+    return;
+  }
+
+  (void)memset(flashImage + addr, 0xFF, HAL_FLASH_PAGE_SIZE);
+  (void)memset(flashProgs + (addr / HAL_FLASH_WORD_SIZE), 0, HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE);
+
+  flashSync(addr, HAL_FLASH_PAGE_SIZE);
+  flashStat.eraseCnt++;
+  flashWear[pg]++;
+  osalPosixAdvance(HAL_POSIX_FLASH_ERASE_US);
+}
+
+/**************************************************************************************************
+*/
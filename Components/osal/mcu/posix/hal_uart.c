@@ -0,0 +1,688 @@
+/**************************************************************************************************
+  Filename:       hal_uart.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    UART for the POSIX host port: the HAL UART API over a model of
+the CC2530 DMA driver. The test stands for the host at the other
+end of the line: it feeds the Rx ring, which lends its bytes in
+place with the stride of the DMA ring, and takes the bytes sent
+once they have crossed the line at the baud rate configured, on
+the virtual clock. HalUARTWrite() copies into a Tx buffer and,
+with HAL_UART_TXQ, HalUARTWriteQueue() sends buffers in place,
+the copied bytes going first as on the DMA driver.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "hal_assert.h"
+#include "hal_board_cfg.h"
+#include "hal_types.h"
+#include "hal_uart.h"
+#include "osal_posix.h"
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Constants
+ * ------------------------------------------------------------------------------------------------
+ */
+
+// The second byte of each Rx entry, where the DMA driver keeps its "new byte" marker.
+#define UART_RX_PAD  0xA5
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Typedefs
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#if HAL_UART_TXQ
+typedef struct
+{
+  uint8 *pBuf;
+  uint16 len;
+  halUARTTxFree_t pfnFree;
+} uartTxDesc_t;
+#endif
+
+typedef struct
+{
+  halUARTCBack_t callBackFunc;
+  halPosixUartTxCB_t pfnTx;
+  uint32 byteNs;     // Time a byte takes on the line, start and stop bits included.
+  uint8 open;
+
+  // Rx ring; each byte is followed by HAL_POSIX_UART_STRIDE-1 bytes that are not data.
+  uint8 rxBuf[HAL_POSIX_UART_RX_MAX * HAL_POSIX_UART_STRIDE];
+  uint16 rxHead;
+  uint16 rxCnt;
+
+  // Bytes of HalUARTWrite() waiting for the line, and the copy of them that it is sending.
+  uint8 txBuf[HAL_POSIX_UART_TX_MAX];
+  uint16 txLen;
+  uint8 txWire[HAL_POSIX_UART_TX_MAX];
+
+  uint8 *txPtr;      // Bytes on the line, NULL while it is idle.
+  uint16 txFlight;
+  uint64 txDone;     // Virtual time at which the last of them is sent.
+
+#if HAL_UART_TXQ
+  uartTxDesc_t txQ[HAL_POSIX_UART_TXQ_CNT];
+  uint8 txQHead;
+  uint8 txQCnt;
+  uint8 txFromQ;     // The bytes on the line are those of the queue head.
+  halUARTTxQStat_t txQStat;
+#endif
+
+  halPosixUartStat_t stat;
+} uartPort_t;
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static uartPort_t uartPort[HAL_UART_PORT_MAX];
+
+// Nanoseconds of ten bits at each HAL_UART_BR_ rate.
+static const uint32 uartByteNs[] = { 1041667, 520833, 260417, 173611, 86806 };
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void uartTxPoll(uartPort_t *pPort, uint8 port);
+
+/**************************************************************************************************
+ * @fn          HalUARTInit
+ *
+ * @brief       Initialize the UART model: every port closed and empty.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalUARTInit(void)
+{
+  (void)memset(uartPort, 0, sizeof(uartPort));
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTOpen
+ *
+ * @brief       Open a port, emptying its buffers. The host end set by halPosixUartSetTx() stays.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       config - Its configuration; only the baud rate and the callback are used.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      HAL_UART_SUCCESS, or HAL_UART_BAUDRATE_ERROR for an unknown rate.
+ **************************************************************************************************
+ */
+uint8 HalUARTOpen(uint8 port, halUARTCfg_t *config)
+{
+  uartPort_t *pPort = uartPort + port;
+  halPosixUartTxCB_t pfnTx = pPort->pfnTx;
+
+  HAL_ASSERT(port < HAL_UART_PORT_MAX);
+
+  if (config->baudRate >= sizeof(uartByteNs) / sizeof(uartByteNs[0]))
+  {
+    return HAL_UART_BAUDRATE_ERROR;
+  }
+
+  (void)memset(pPort, 0, sizeof(uartPort_t));
+  pPort->pfnTx = pfnTx;
+  pPort->callBackFunc = config->callBackFunc;
+  pPort->byteNs = uartByteNs[config->baudRate];
+  pPort->open = TRUE;
+
+  return HAL_UART_SUCCESS;
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTClose
+ *
+ * @brief       Close a port; what it had not sent is lost.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalUARTClose(uint8 port)
+{
+  uartPort[port].open = FALSE;
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTRead
+ *
+ * @brief       Copy bytes from the head of the Rx ring and release them.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       len - Maximum number of bytes to copy.
+ *
+ * output parameters
+ *
+ * @param       buf - The bytes.
+ *
+ * @return      The number of bytes copied.
+ **************************************************************************************************
+ */
+uint16 HalUARTRead(uint8 port, uint8 *buf, uint16 len)
+{
+  uartPort_t *pPort = uartPort + port;
+  uint16 cnt;
+
+  if (len > pPort->rxCnt)
+  {
+    len = pPort->rxCnt;
+  }
+
+  for (cnt = 0; cnt < len; cnt++)
+  {
+    *buf++ = pPort->rxBuf[pPort->rxHead * HAL_POSIX_UART_STRIDE];
+    pPort->rxHead = (pPort->rxHead + 1) % HAL_POSIX_UART_RX_MAX;
+  }
+  pPort->rxCnt -= len;
+
+  return len;
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTPeek
+ *
+ * @brief       Lend the bytes at the head of the Rx ring, up to the last received or the end of
+ *              the ring, in place.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ *
+ * output parameters
+ *
+ * @param       pSpan - The span.
+ *
+ * @return      The number of bytes in the span.
+ **************************************************************************************************
+ */
+uint16 HalUARTPeek(uint8 port, halUARTSpan_t *pSpan)
+{
+  uartPort_t *pPort = uartPort + port;
+
+  pSpan->pData = pPort->rxBuf + pPort->rxHead * HAL_POSIX_UART_STRIDE;
+  pSpan->stride = HAL_POSIX_UART_STRIDE;
+  pSpan->len = HAL_POSIX_UART_RX_MAX - pPort->rxHead;
+  if (pSpan->len > pPort->rxCnt)
+  {
+    pSpan->len = pPort->rxCnt;
+  }
+
+  return pSpan->len;
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTConsume
+ *
+ * @brief       Release bytes lent by HalUARTPeek().
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       len - Number of bytes, at most the span length.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalUARTConsume(uint8 port, uint16 len)
+{
+  uartPort_t *pPort = uartPort + port;
+
+  HAL_ASSERT(len <= pPort->rxCnt);
+  pPort->rxHead = (pPort->rxHead + len) % HAL_POSIX_UART_RX_MAX;
+  pPort->rxCnt -= len;
+}
+
+/**************************************************************************************************
+ * @fn          Hal_UART_RxBufLen
+ *
+ * @brief       Count the bytes in the Rx ring.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The number of bytes received and not yet released.
+ **************************************************************************************************
+ */
+uint16 Hal_UART_RxBufLen(uint8 port)
+{
+  return uartPort[port].rxCnt;
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTWrite
+ *
+ * @brief       Copy a buffer into the Tx buffer, all or none, as the DMA driver does.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       buf - The bytes to send.
+ * @param       len - Number of bytes.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      'len', or 0 if they do not fit.
+ **************************************************************************************************
+ */
+uint16 HalUARTWrite(uint8 port, uint8 *buf, uint16 len)
+{
+  uartPort_t *pPort = uartPort + port;
+
+  if (!pPort->open || ((pPort->txLen + len) > HAL_POSIX_UART_TX_MAX))
+  {
+    pPort->stat.txRefused++;
+    return 0;
+  }
+
+  (void)memcpy(pPort->txBuf + pPort->txLen, buf, len);
+  pPort->txLen += len;
+
+  return len;
+}
+
+#if HAL_UART_TXQ
+/**************************************************************************************************
+ * @fn          HalUARTWriteQueue
+ *
+ * @brief       Queue a buffer to be sent in place and released by 'pfnFree' once sent.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       buf - The buffer, owned by the driver if queued.
+ * @param       len - Its length.
+ * @param       pfnFree - Function to release it.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if queued; FALSE if the queue is full and the caller keeps the buffer.
+ **************************************************************************************************
+ */
+uint8 HalUARTWriteQueue(uint8 port, uint8 *buf, uint16 len, halUARTTxFree_t pfnFree)
+{
+  uartPort_t *pPort = uartPort + port;
+  uartTxDesc_t *pDesc;
+
+  if (!pPort->open || (pPort->txQCnt >= HAL_POSIX_UART_TXQ_CNT))
+  {
+    pPort->txQStat.drop++;
+    return FALSE;
+  }
+
+  if (len == 0)
+  {
+    pfnFree(buf);
+    return TRUE;
+  }
+
+  pDesc = pPort->txQ + ((pPort->txQHead + pPort->txQCnt) % HAL_POSIX_UART_TXQ_CNT);
+  pDesc->pBuf = buf;
+  pDesc->len = len;
+  pDesc->pfnFree = pfnFree;
+
+  if (++pPort->txQCnt > pPort->txQStat.depthMax)
+  {
+    pPort->txQStat.depthMax = pPort->txQCnt;
+  }
+
+  return TRUE;
+}
+
+/**************************************************************************************************
+ * @fn          HalUARTTxQStat
+ *
+ * @brief       Read the Tx queue counters of a port.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       clear - TRUE to restart the sent and drop counts and the high-water mark.
+ *
+ * output parameters
+ *
+ * @param       pStat - The counters.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalUARTTxQStat(uint8 port, halUARTTxQStat_t *pStat, uint8 clear)
+{
+  uartPort_t *pPort = uartPort + port;
+
+  pPort->txQStat.depth = pPort->txQCnt;
+  *pStat = pPort->txQStat;
+
+  if (clear)
+  {
+    pPort->txQStat.sent = 0;
+    pPort->txQStat.drop = 0;
+    pPort->txQStat.depthMax = pPort->txQCnt;
+  }
+}
+#endif
+
+/**************************************************************************************************
+ * @fn          HalUARTPoll
+ *
+ * @brief       Hand the bytes that have crossed the line to the host end, start sending the next
+ *              ones, and call back a port that has bytes received.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalUARTPoll(void)
+{
+  uint8 port;
+
+  for (port = 0; port < HAL_UART_PORT_MAX; port++)
+  {
+    uartPort_t *pPort = uartPort + port;
+
+    if (!pPort->open)
+    {
+      continue;
+    }
+
+    uartTxPoll(pPort, port);
+
+    if ((pPort->rxCnt != 0) && (pPort->callBackFunc != NULL))
+    {
+      pPort->callBackFunc(port, HAL_UART_RX_TIMEOUT);
+    }
+  }
+}
+
+/**************************************************************************************************
+ * @fn          uartTxPoll
+ *
+ * @brief       Retire the bytes on the line once sent, then put the Tx buffer on the line, or
+ *              else the head of the Tx queue.
+ *
+ * input parameters
+ *
+ * @param       pPort - The port.
+ * @param       port - Its number.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void uartTxPoll(uartPort_t *pPort, uint8 port)
+{
+  if ((pPort->txPtr != NULL) && (osalPosixTime() >= pPort->txDone))
+  {
+    pPort->stat.txCnt += pPort->txFlight;
+    if (pPort->pfnTx != NULL)
+    {
+      pPort->pfnTx(port, pPort->txPtr, pPort->txFlight);
+    }
+    pPort->txPtr = NULL;
+
+#if HAL_UART_TXQ
+    if (pPort->txFromQ)
+    {
+      uartTxDesc_t *pDesc = pPort->txQ + pPort->txQHead;
+
+      pPort->txQHead = (pPort->txQHead + 1) % HAL_POSIX_UART_TXQ_CNT;
+      pPort->txQCnt--;
+      pPort->txQStat.sent++;
+      pPort->txFromQ = FALSE;
+      pDesc->pfnFree(pDesc->pBuf);
+    }
+#endif
+  }
+
+  if (pPort->txPtr != NULL)
+  {
+    return;
+  }
+
+  if (pPort->txLen != 0)
+  {
+    (void)memcpy(pPort->txWire, pPort->txBuf, pPort->txLen);
+    pPort->txPtr = pPort->txWire;
+    pPort->txFlight = pPort->txLen;
+    pPort->txLen = 0;
+  }
+#if HAL_UART_TXQ
+  else if (pPort->txQCnt != 0)
+  {
+    pPort->txPtr = pPort->txQ[pPort->txQHead].pBuf;
+    pPort->txFlight = pPort->txQ[pPort->txQHead].len;
+    pPort->txFromQ = TRUE;
+  }
+#endif
+  else
+  {
+    return;
+  }
+
+  pPort->txDone = osalPosixTime() + ((uint64)pPort->txFlight * pPort->byteNs + 999) / 1000;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixUartRx
+ *
+ * @brief       The host sends bytes: as many as the Rx ring has room for are received at once.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       buf - The bytes.
+ * @param       len - Number of bytes.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The number of bytes received; the host holds the others, as its flow is off.
+ **************************************************************************************************
+ */
+uint16 halPosixUartRx(uint8 port, const uint8 *buf, uint16 len)
+{
+  uartPort_t *pPort = uartPort + port;
+  uint16 cnt;
+
+  HAL_ASSERT(port < HAL_UART_PORT_MAX);
+
+  if (len > (HAL_POSIX_UART_RX_MAX - pPort->rxCnt))
+  {
+    pPort->stat.rxHeld += len - (HAL_POSIX_UART_RX_MAX - pPort->rxCnt);
+    len = HAL_POSIX_UART_RX_MAX - pPort->rxCnt;
+  }
+
+  for (cnt = 0; cnt < len; cnt++)
+  {
+    uint16 idx = ((pPort->rxHead + pPort->rxCnt + cnt) % HAL_POSIX_UART_RX_MAX) *
+                 HAL_POSIX_UART_STRIDE;
+
+    pPort->rxBuf[idx] = buf[cnt];
+    if (HAL_POSIX_UART_STRIDE > 1)
+    {
+      pPort->rxBuf[idx + 1] = UART_RX_PAD;
+    }
+  }
+  pPort->rxCnt += len;
+  pPort->stat.rxCnt += len;
+
+  return len;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixUartSetTx
+ *
+ * @brief       Set the host end of a port, which is handed the bytes sent as they cross the line.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       pfnTx - Callback, or NULL to drop the bytes sent.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixUartSetTx(uint8 port, halPosixUartTxCB_t pfnTx)
+{
+  HAL_ASSERT(port < HAL_UART_PORT_MAX);
+  uartPort[port].pfnTx = pfnTx;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixUartFlush
+ *
+ * @brief       Move the virtual clock on until everything written to a port has been sent.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixUartFlush(uint8 port)
+{
+  uartPort_t *pPort = uartPort + port;
+
+  while (pPort->open)
+  {
+    uartTxPoll(pPort, port);
+
+    if (pPort->txPtr == NULL)
+    {
+      break;
+    }
+    if (pPort->txDone > osalPosixTime())
+    {
+      osalPosixAdvance((uint32)(pPort->txDone - osalPosixTime()));
+    }
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixUartGetStat
+ *
+ * @brief       Copy the statistics of a port and optionally clear them.
+ *
+ * input parameters
+ *
+ * @param       port - UART port.
+ * @param       clear - TRUE to clear the statistics once copied.
+ *
+ * output parameters
+ *
+ * @param       pStat - The statistics.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixUartGetStat(uint8 port, halPosixUartStat_t *pStat, uint8 clear)
+{
+  *pStat = uartPort[port].stat;
+
+  if (clear)
+  {
+    (void)memset(&uartPort[port].stat, 0, sizeof(halPosixUartStat_t));
+  }
+}
+
+/**************************************************************************************************
+*/
@@ -0,0 +1,450 @@
+/**************************************************************************************************
+  Filename:       hal_xnv.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    SPI NOR Xtra-NV for the POSIX host port: the M25PE20 that the
+CC2530EB carries on USART1, driven through the XNV_SPI_* macros of
+hal_board_cfg.h. The model decodes the commands that hal_ota.c
+sends, holds the device busy on the virtual clock while it
+programs or erases, and counts the commands that a real part
+would ignore or that would corrupt its contents.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "hal_assert.h"
+#include "hal_board_cfg.h"
+#include "hal_mcu.h"
+#include "hal_types.h"
+#include "osal_posix.h"
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Constants
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#define XNV_PAGE_SIZE     256
+#define XNV_SECTOR_SIZE   0x10000UL
+
+#define XNV_CMD_PP        0x02  // Page Program: clears bits only.
+#define XNV_CMD_RDSR      0x05
+#define XNV_CMD_WREN      0x06
+#define XNV_CMD_PW        0x0A  // Page Write: erases the bytes written, then programs them.
+#define XNV_CMD_FAST_READ 0x0B
+#define XNV_CMD_SE        0xD8  // Sector Erase.
+#define XNV_CMD_PE        0xDB  // Page Erase.
+#define XNV_CMD_NONE      0xFF
+
+#define XNV_STAT_WIP      0x01
+#define XNV_STAT_WEL      0x02
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static uint8 xnvImage[HAL_POSIX_XNV_SIZE];
+static halPosixXnvStat_t xnvStat;
+static uint64 xnvBusyTill;   // Virtual time at which the program or erase in progress is done.
+static uint32 xnvNs;         // Bus time not yet added to the virtual clock.
+static uint8 xnvWel;         // Write Enable Latch.
+
+// The command being clocked in while the chip select is low.
+static uint8 xnvSelected;
+static uint8 xnvCmd;
+static uint16 xnvIdx;        // Bytes clocked in since the chip select fell.
+static uint32 xnvAddr;
+static uint8 xnvRx;
+static uint8 xnvPage[XNV_PAGE_SIZE];
+static uint16 xnvPageCnt;    // Data bytes of a page command, wrapped ones included.
+
+// The CC2530 port direction register that hal_ota.c flips around an XNV access.
+uint8 halPosixP1Dir;
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static uint8 xnvBusy(void);
+static void xnvCommit(void);
+
+/**************************************************************************************************
+ * @fn          halPosixXnvFill
+ *
+ * @brief       Set every byte of the Xtra-NV to 'val', as if left by an earlier image, and let
+ *              the device idle with its write enable latch reset.
+ *
+ * input parameters
+ *
+ * @param       val - The byte value; 0xFF for an erased part.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixXnvFill(uint8 val)
+{
+  (void)memset(xnvImage, val, sizeof(xnvImage));
+  xnvBusyTill = 0;
+  xnvWel = FALSE;
+  xnvSelected = FALSE;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixXnvPeek
+ *
+ * @brief       Copy bytes of the Xtra-NV without going through the bus or the virtual clock.
+ *
+ * input parameters
+ *
+ * @param       addr - Byte address into the Xtra-NV.
+ * @param       len - Number of bytes.
+ *
+ * output parameters
+ *
+ * @param       buf - The bytes.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixXnvPeek(uint32 addr, uint8 *buf, uint16 len)
+{
+  HAL_ASSERT((addr + len) <= HAL_POSIX_XNV_SIZE);
+  (void)memcpy(buf, xnvImage + addr, len);
+}
+
+/**************************************************************************************************
+ * @fn          halPosixXnvGetStat
+ *
+ * @brief       Copy the Xtra-NV statistics and optionally clear them.
+ *
+ * input parameters
+ *
+ * @param       clear - TRUE to clear the statistics once copied.
+ *
+ * output parameters
+ *
+ * @param       pStat - The statistics.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixXnvGetStat(halPosixXnvStat_t *pStat, uint8 clear)
+{
+  *pStat = xnvStat;
+
+  if (clear)
+  {
+    (void)memset(&xnvStat, 0, sizeof(xnvStat));
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixXnvBegin
+ *
+ * @brief       Drive the Xtra-NV chip select low: the next byte clocked in is a command.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixXnvBegin(void)
+{
+  xnvSelected = TRUE;
+  xnvCmd = XNV_CMD_NONE;
+  xnvIdx = 0;
+  xnvAddr = 0;
+  xnvPageCnt = 0;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixXnvTx
+ *
+ * @brief       Clock one byte out to the Xtra-NV and the byte it returns in. The byte returned
+ *              while the command itself is clocked is 0xFF, as the output is not driven yet.
+ *
+ * input parameters
+ *
+ * @param       ch - The byte sent.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixXnvTx(uint8 ch)
+{
+  xnvNs += HAL_POSIX_XNV_BYTE_NS;
+  osalPosixAdvance(xnvNs / 1000);
+  xnvNs %= 1000;
+
+  xnvRx = 0xFF;
+  if (!xnvSelected)
+  {
+    return;
+  }
+
+  if (xnvIdx++ == 0)
+  {
+    xnvCmd = ch;
+    // Only the status register can be read while the device programs or erases.
+    if ((xnvCmd != XNV_CMD_RDSR) && xnvBusy())
+    {
+      xnvStat.badCnt++;
+      xnvCmd = XNV_CMD_NONE;
+    }
+    return;
+  }
+
+  switch (xnvCmd)
+  {
+  case XNV_CMD_RDSR:
+    xnvRx = (xnvBusy() ? XNV_STAT_WIP : 0) | (xnvWel ? XNV_STAT_WEL : 0);
+    break;
+
+  case XNV_CMD_FAST_READ:
+    if (xnvIdx <= 4)
+    {
+      xnvAddr = (xnvAddr << 8) | ch;
+    }
+    else if (xnvIdx > 5)  // After the dummy byte.
+    {
+      xnvRx = xnvImage[xnvAddr++ % HAL_POSIX_XNV_SIZE];
+    }
+    break;
+
+  case XNV_CMD_PP:
+  case XNV_CMD_PW:
+  case XNV_CMD_PE:
+  case XNV_CMD_SE:
+    if (xnvIdx <= 4)
+    {
+      xnvAddr = (xnvAddr << 8) | ch;
+    }
+    else if ((xnvCmd == XNV_CMD_PP) || (xnvCmd == XNV_CMD_PW))
+    {
+      // Past the end of the page the address wraps to its start, over the bytes already sent.
+      xnvPage[(xnvAddr + xnvPageCnt) % XNV_PAGE_SIZE] = ch;
+      if (xnvPageCnt < 2 * XNV_PAGE_SIZE)
+      {
+        xnvPageCnt++;
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halPosixXnvRx
+ *
+ * @brief       The byte that the Xtra-NV returned while the last byte was sent.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      The byte received.
+ **************************************************************************************************
+ */
+uint8 halPosixXnvRx(void)
+{
+  return xnvRx;
+}
+
+/**************************************************************************************************
+ * @fn          halPosixXnvEnd
+ *
+ * @brief       Drive the Xtra-NV chip select high, which executes a write enable, program or
+ *              erase command clocked in since it fell.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void halPosixXnvEnd(void)
+{
+  if (xnvSelected && (xnvCmd != XNV_CMD_NONE))
+  {
+    xnvStat.cmdCnt++;
+    xnvCommit();
+  }
+
+  xnvSelected = FALSE;
+}
+
+/**************************************************************************************************
+ * @fn          xnvBusy
+ *
+ * @brief       Tell whether a program or erase is still in progress on the virtual clock.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE while the Write In Progress bit is set.
+ **************************************************************************************************
+ */
+static uint8 xnvBusy(void)
+{
+  return (osalPosixTime() < xnvBusyTill) ? TRUE : FALSE;
+}
+
+/**************************************************************************************************
+ * @fn          xnvCommit
+ *
+ * @brief       Execute the command clocked in, as the chip select rises. A program or erase
+ *              needs the write enable latch set and the whole address clocked in; it resets the
+ *              latch and keeps the device busy for its duration.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void xnvCommit(void)
+{
+  uint32 base, size;
+  uint16 cnt, idx;
+  uint8 old;
+
+  switch (xnvCmd)
+  {
+  case XNV_CMD_WREN:
+    xnvWel = TRUE;
+    return;
+
+  case XNV_CMD_PP:
+  case XNV_CMD_PW:
+  case XNV_CMD_PE:
+  case XNV_CMD_SE:
+    break;
+
+  default:
+    return;
+  }
+
+  if (!xnvWel || (xnvIdx < 4))
+  {
+    xnvStat.badCnt++;
+    return;
+  }
+  xnvWel = FALSE;
+  xnvAddr %= HAL_POSIX_XNV_SIZE;
+
+  if ((xnvCmd == XNV_CMD_PE) || (xnvCmd == XNV_CMD_SE))
+  {
+    size = (xnvCmd == XNV_CMD_PE) ? XNV_PAGE_SIZE : XNV_SECTOR_SIZE;
+    (void)memset(xnvImage + (xnvAddr & ~(size - 1)), 0xFF, size);
+    xnvBusyTill = osalPosixTime() +
+                  ((xnvCmd == XNV_CMD_PE) ? HAL_POSIX_XNV_PE_US : HAL_POSIX_XNV_SE_US);
+    xnvStat.eraseCnt++;
+    return;
+  }
+
+  base = xnvAddr & ~(uint32)(XNV_PAGE_SIZE - 1);
+  cnt = (xnvPageCnt > XNV_PAGE_SIZE) ? XNV_PAGE_SIZE : xnvPageCnt;
+  if (((xnvAddr % XNV_PAGE_SIZE) + xnvPageCnt) > XNV_PAGE_SIZE)
+  {
+    xnvStat.wrapCnt++;
+  }
+
+  for (idx = 0; idx < cnt; idx++)
+  {
+    uint32 addr = base + ((xnvAddr + idx) % XNV_PAGE_SIZE);
+    uint8 val = xnvPage[(xnvAddr + idx) % XNV_PAGE_SIZE];
+
+    if (xnvCmd == XNV_CMD_PW)
+    {
+      xnvImage[addr] = val;
+      continue;
+    }
+
+    // Page Program can only clear bits: setting one back needs an erase first.
+    old = xnvImage[addr];
+    if ((old & val) != val)
+    {
+      xnvStat.badCnt++;
+    }
+    xnvImage[addr] = old & val;
+  }
+
+  xnvBusyTill = osalPosixTime() + ((xnvCmd == XNV_CMD_PP) ? HAL_POSIX_XNV_PP_US : HAL_POSIX_XNV_PW_US);
+  xnvStat.progCnt++;
+}
+
+/**************************************************************************************************
+*/
@@ -0,0 +1,302 @@
+/**************************************************************************************************
+  Filename:       osal_posix.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Virtual clock, sleep hook and run loop for the POSIX host port.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "comdef.h"
+#include "hal_drivers.h"
+#include "hal_assert.h"
+#include "OnBoard.h"
+#include "OSAL.h"
+#include "osal_posix.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+volatile uint8 halPosixIntEnable = 1;
+uint32 halPosixCriticalCnt = 0;
+
+uint8 aExtendedAddress[8];
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static osalPosixStat_t posixStat;
+
+// End of the current osalPosixRun() window; an indefinite sleep jumps here.
+static uint64 posixRunEnd;
+
+static osalPosixPollCB_t posixPollCB;
+
+/*********************************************************************
+ * @fn      osalPosixAdvance
+ *
+ * @brief   Move the virtual clock forward.
+ *
+ * @param   usecs - microseconds to add
+ *
+ * @return  none
+ */
+void osalPosixAdvance( uint32 usecs )
+{
+  posixStat.now += usecs;
+}
+
+/*********************************************************************
+ * @fn      osalPosixTime
+ *
+ * @brief   Read the virtual clock.
+ *
+ * @param   none
+ *
+ * @return  virtual time in microseconds
+ */
+uint64 osalPosixTime( void )
+{
+  return posixStat.now;
+}
+
+/*********************************************************************
+ * @fn      osalPosixSleep
+ *
+ * @brief   Emulate the sleep taken by OSAL_SET_CPU_INTO_SLEEP(): the
+ *          clock jumps straight to the wakeup time, or to the end of
+ *          the current run window when no timer is pending.
+ *
+ * @param   msecs - time to sleep, 0 for "until woken"
+ *
+ * @return  none
+ */
+void osalPosixSleep( uint32 msecs )
+{
+  uint64 wake;
+
+  if ( msecs == 0 )
+  {
+    wake = posixRunEnd;
+  }
+  else
+  {
+    wake = posixStat.now + (uint64)msecs * 1000;
+    if ( wake > posixRunEnd )
+    {
+      wake = posixRunEnd;
+    }
+  }
+
+#if HAL_FLASH_ASYNC
+  // The flash DMA interrupt ends the sleep.
+  if ( (halPosixFlashDue() != 0) && (halPosixFlashDue() < wake) )
+  {
+    wake = halPosixFlashDue();
+  }
+#endif
+
+  posixStat.sleepCnt++;
+  if ( wake > posixStat.now )
+  {
+    posixStat.sleepTime += wake - posixStat.now;
+    posixStat.now = wake;
+  }
+}
+
+/*********************************************************************
+ * @fn      osalPosixRun
+ *
+ * @brief   Run the OSAL scheduler for the given amount of virtual time.
+ *          Each pass through osal_run_system() costs
+ *          OSAL_POSIX_PASS_COST_US so that a busy loop still makes
+ *          progress.
+ *
+ * @param   msecs - virtual time to run for
+ *
+ * @return  none
+ */
+void osalPosixRun( uint32 msecs )
+{
+  posixRunEnd = posixStat.now + (uint64)msecs * 1000;
+
+  while ( posixStat.now < posixRunEnd )
+  {
+    osal_run_system();
+    posixStat.passCnt++;
+    posixStat.now += OSAL_POSIX_PASS_COST_US;
+  }
+}
+
+/*********************************************************************
+ * @fn      osalPosixSetPoll
+ *
+ * @brief   Install a callback invoked on every Hal_ProcessPoll().
+ *
+ * @param   pfnPoll - callback, or NULL to remove it
+ *
+ * @return  none
+ */
+void osalPosixSetPoll( osalPosixPollCB_t pfnPoll )
+{
+  posixPollCB = pfnPoll;
+}
+
+/*********************************************************************
+ * @fn      osalPosixGetStat
+ *
+ * @brief   Copy the host port statistics.
+ *
+ * @param   pStat - where to copy them
+ * @param   clear - TRUE to zero the counters (not the clock) afterwards
+ *
+ * @return  none
+ */
+void osalPosixGetStat( osalPosixStat_t *pStat, uint8 clear )
+{
+  *pStat = posixStat;
+
+  if ( clear )
+  {
+    posixStat.passCnt = 0;
+    posixStat.sleepCnt = 0;
+    posixStat.sleepTime = 0;
+  }
+}
+
+/*********************************************************************
+ * @fn      macMcuPrecisionCount
+ *
+ * @brief   The OSAL clock source: 320us ticks of the virtual clock.
+ *
+ * @param   none
+ *
+ * @return  tick count
+ */
+uint32 macMcuPrecisionCount( void )
+{
+  return (uint32)(posixStat.now / 320);
+}
+
+/*********************************************************************
+ * @fn      TimerElapsed
+ *
+ * @brief   Not used; osalTimeUpdate() reads macMcuPrecisionCount().
+ *
+ * @param   none
+ *
+ * @return  0
+ */
+uint32 TimerElapsed( void )
+{
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      Hal_ProcessPoll
+ *
+ * @brief   Called once per scheduler pass; gives the host a place to
+ *          inject "interrupt" work.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void Hal_ProcessPoll( void )
+{
+#if HAL_FLASH_ASYNC
+  halPosixFlashPoll();
+#endif
+  HalUARTPoll();
+
+  if ( posixPollCB != NULL )
+  {
+    posixPollCB();
+  }
+}
+
+/*********************************************************************
+ * @fn      Onboard_rand
+ *
+ * @brief   Random number generator
+ *
+ * @param   none
+ *
+ * @return  uint16 - new random number
+ */
+uint16 Onboard_rand( void )
+{
+  return ( (uint16)rand() );
+}
+
+/*********************************************************************
+ * @fn      halAssertHandler
+ *
+ * @brief   Abort the host process so the failure is visible to the test.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halAssertHandler( void )
+{
+  fprintf( stderr, "halAssertHandler: assertion failed\n" );
+  abort();
+}
+
+/*********************************************************************
+ * @fn      halPosixReset
+ *
+ * @brief   A reset ends the host process; the flash file survives it.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halPosixReset( void )
+{
+  halPosixFlashClose();
+  exit( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,231 @@
+/**************************************************************************************************
+  Filename:       osal_posix.h
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Virtual clock and run loop for executing the OSAL on a POSIX host.
+Time only moves when the host calls osalPosixAdvance(), when the
+OSAL sleeps, or per scheduler pass inside osalPosixRun(), so host
+runs are deterministic and independent of the wall clock.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+#ifndef OSAL_POSIX_H
+#define OSAL_POSIX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Virtual time charged for each pass through osal_run_system()
+#if !defined OSAL_POSIX_PASS_COST_US
+  #define OSAL_POSIX_PASS_COST_US  10
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint64 now;          // virtual time, in microseconds
+  uint32 passCnt;      // passes through osal_run_system()
+  uint32 sleepCnt;     // OSAL_SET_CPU_INTO_SLEEP() calls
+  uint64 sleepTime;    // virtual microseconds spent asleep
+} osalPosixStat_t;
+
+typedef struct
+{
+  uint32 readCnt;      // HalFlashRead() calls
+  uint32 wordCnt;      // flash words programmed
+  uint32 eraseCnt;     // pages erased
+  uint32 cutCnt;       // writes or erases cut by halPosixFlashCut()
+  uint32 overCnt;      // words programmed more than HAL_POSIX_FLASH_WORD_PROGS times since erased
+} halPosixFlashStat_t;
+
+typedef struct
+{
+  uint32 cmdCnt;       // Xtra-NV commands executed or refused
+  uint32 progCnt;      // Page Program and Page Write commands
+  uint32 eraseCnt;     // Page Erase and Sector Erase commands
+  uint32 wrapCnt;      // page commands whose data wrapped to the start of their page
+  uint32 badCnt;       // commands refused while busy or without WEL, and bytes programmed unerased
+} halPosixXnvStat_t;
+
+typedef struct
+{
+  uint32 rxCnt;        // bytes received from the host
+  uint32 rxHeld;       // bytes the host held back because the Rx ring was full
+  uint32 txCnt;        // bytes sent to the host
+  uint32 txRefused;    // HalUARTWrite() calls refused because the Tx buffer was full
+} halPosixUartStat_t;
+
+typedef void (*osalPosixPollCB_t)( void );
+typedef void (*halPosixFlashCutCB_t)( void );
+typedef void (*halPosixUartTxCB_t)( uint8 port, uint8 *pBuf, uint16 len );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+extern volatile uint8 halPosixIntEnable;
+extern uint32 halPosixCriticalCnt;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+  /*
+   * Move the virtual clock forward
+   */
+  extern void osalPosixAdvance( uint32 usecs );
+
+  /*
+   * Read the virtual clock, in microseconds
+   */
+  extern uint64 osalPosixTime( void );
+
+  /*
+   * Sleep hook used by OSAL_SET_CPU_INTO_SLEEP()
+   */
+  extern void osalPosixSleep( uint32 msecs );
+
+  /*
+   * Run the OSAL scheduler for the given amount of virtual time
+   */
+  extern void osalPosixRun( uint32 msecs );
+
+  /*
+   * Install a callback invoked from Hal_ProcessPoll(), used to inject "interrupts"
+   */
+  extern void osalPosixSetPoll( osalPosixPollCB_t pfnPoll );
+
+  /*
+   * Copy (and optionally clear) the host port statistics
+   */
+  extern void osalPosixGetStat( osalPosixStat_t *pStat, uint8 clear );
+
+  /*
+   * Reset hook used by HAL_SYSTEM_RESET()
+   */
+  extern void halPosixReset( void );
+
+  /*
+   * Select the file backing the simulated flash; NULL selects HAL_POSIX_FLASH_FILE
+   */
+  extern uint8 halPosixFlashOpen( const char *path );
+
+  /*
+   * Flush and close the simulated flash file
+   */
+  extern void halPosixFlashClose( void );
+
+  /*
+   * Copy (and optionally clear) the simulated flash statistics
+   */
+  extern void halPosixFlashGetStat( halPosixFlashStat_t *pStat, uint8 clear );
+
+  /*
+   * Count of the erases of one flash page since the host started
+   */
+  extern uint32 halPosixFlashWear( uint8 pg );
+
+  /*
+   * Cut the power during the write or erase after the next 'ops' ones
+   */
+  extern void halPosixFlashCut( uint32 ops, halPosixFlashCutCB_t pfnCut );
+
+  /*
+   * Retire the asynchronous flash writes done by now, signalling their tasks (HAL_FLASH_ASYNC)
+   */
+  extern void halPosixFlashPoll( void );
+
+  /*
+   * Virtual time at which the next asynchronous flash write is done, 0 if none (HAL_FLASH_ASYNC)
+   */
+  extern uint64 halPosixFlashDue( void );
+
+  /*
+   * Set every byte of the SPI Xtra-NV to a value and let it idle
+   */
+  extern void halPosixXnvFill( uint8 val );
+
+  /*
+   * Copy bytes of the SPI Xtra-NV without going through its bus
+   */
+  extern void halPosixXnvPeek( uint32 addr, uint8 *buf, uint16 len );
+
+  /*
+   * Copy (and optionally clear) the SPI Xtra-NV statistics
+   */
+  extern void halPosixXnvGetStat( halPosixXnvStat_t *pStat, uint8 clear );
+
+  /*
+   * The host sends bytes to a UART port; returns how many the Rx ring took
+   */
+  extern uint16 halPosixUartRx( uint8 port, const uint8 *buf, uint16 len );
+
+  /*
+   * Set the host end of a UART port, handed the bytes sent as they cross the line
+   */
+  extern void halPosixUartSetTx( uint8 port, halPosixUartTxCB_t pfnTx );
+
+  /*
+   * Move the virtual clock on until everything written to a UART port has been sent
+   */
+  extern void halPosixUartFlush( uint8 port );
+
+  /*
+   * Copy (and optionally clear) the statistics of a UART port
+   */
+  extern void halPosixUartGetStat( uint8 port, halPosixUartStat_t *pStat, uint8 clear );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_POSIX_H */
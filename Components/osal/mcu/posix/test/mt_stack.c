@@ -0,0 +1,105 @@
+/**************************************************************************************************
+  Filename:       mt_stack.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Stand-ins for the rest of the stack that MT_SYS calls, which the
+                  host builds leave out. None of the host tests or benchmarks use it.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "ZComDef.h"
+#include "MT.h"
+#include "MT_DEBUG.h"
+#include "ZGlobals.h"
+#include "ZMAC.h"
+#include "mac_low_level.h"
+#include "hal_adc.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+#if !defined ( INCLUDE_REVISION_INFORMATION )
+const uint8 MTVersionString[5] = { 2, 0, 2, 6, 0 };
+#else
+const uint8 MTVersionString[10] = { 2, 0, 2, 6, 0, 0, 0, 0, 0, 0 };
+#endif
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+void zgSetItem( uint16 id, uint16 len, void *buf )
+{
+}
+
+ZMacStatus_t ZMacGetReq( ZMacAttributes_t attr, byte *value )
+{
+  return ZMacUnsupportedAttribute;
+}
+
+ZMacStatus_t ZMacSetReq( ZMacAttributes_t attr, byte *value )
+{
+  return ZMacUnsupportedAttribute;
+}
+
+uint8 MAC_MlmeSetReq( uint8 pibAttribute, void *pValue )
+{
+  return MAC_UNSUPPORTED_ATTRIBUTE;
+}
+
+uint8 macRadioSetTxPower( uint8 txPower )
+{
+  return txPower;
+}
+
+uint16 HalAdcRead( uint8 channel, uint8 resolution )
+{
+  return 0;
+}
+
+void MT_ProcessDebugMsg( mtDebugMsg_t *pData )
+{
+}
+
+void MT_ProcessDebugStr( mtDebugStr_t *pData )
+{
+}
+
+/*********************************************************************
+*********************************************************************/
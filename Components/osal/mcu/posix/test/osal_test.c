@@ -0,0 +1,334 @@
+/**************************************************************************************************
+  Filename:       osal_test.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Test runner for the POSIX host port. Each test runs in its
+own process, so a failed check or an injected power cut does
+not leak OSAL state into the next test.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+
+/*********************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ */
+
+static uint16 osalTestTask( uint8 task_id, uint16 events );
+static const osalTest_t *osalTestFind( const char *name );
+static int osalTestRun( const osalTest_t *pTest );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// The task table of the test build: OSAL_TEST_TASK_CNT test tasks, then the NV task.
+const pTaskEventHandlerFn tasksArr[] = {
+  osalTestTask,
+  osalTestTask,
+  osalTestTask,
+#if OSAL_NV_TASK
+  osal_nv_process_event,
+#endif
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+osalTestEventCB_t osalTestEventCB;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const osalTest_t *const osalTestTables[] = {
+  osalTestsOsal,
+  osalTestsNv,
+  osalTestsFlash,
+#if defined MT_SYS_FUNC
+  osalTestsMt,
+#endif
+#if defined MT_TASK
+  osalTestsMtUart,
+#endif
+#if defined HAL_OTA_XNV_ERASE
+  osalTestsOta,
+#endif
+};
+
+static uint32 osalTestSeedVal = 1;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Initialize the test tasks and the NV task.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  OSAL_TEST_CHECK( tasksEvents != NULL );
+  osal_memset( tasksEvents, 0, (sizeof( uint16 ) * tasksCnt) );
+
+#if OSAL_NV_TASK
+  osal_nv_task_init( OSAL_TEST_TASK_CNT );
+#endif
+}
+
+/*********************************************************************
+ * @fn      osalTestTask
+ *
+ * @brief   Event handler of the test tasks; hands the events to the
+ *          running test, or drops them if it installed no handler.
+ *
+ * @param   task_id - test task
+ * @param   events - events pending
+ *
+ * @return  events not processed
+ */
+static uint16 osalTestTask( uint8 task_id, uint16 events )
+{
+  if ( osalTestEventCB != NULL )
+  {
+    return osalTestEventCB( task_id, events );
+  }
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *pMsg;
+
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+      (void)osal_msg_deallocate( pMsg );
+    }
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+ * @fn      osalTestFail
+ *
+ * @brief   Report a failed check and end the test process.
+ *
+ * @param   file, line - location of the check
+ * @param   expr - the condition that failed
+ *
+ * @return  none
+ */
+void osalTestFail( const char *file, int line, const char *expr )
+{
+  fprintf( stderr, "%s:%d: check failed: %s\n", file, line, expr );
+  exit( 1 );
+}
+
+/*********************************************************************
+ * @fn      osalTestBoot
+ *
+ * @brief   Power up the OSAL as after a reset, with NV kept in the
+ *          given flash file.
+ *
+ * @param   flash - flash file; its contents survive earlier boots
+ *
+ * @return  none
+ */
+void osalTestBoot( const char *flash )
+{
+  OSAL_TEST_CHECK( halPosixFlashOpen( flash ) );
+  osalTestEventCB = NULL;
+
+  (void)osal_init_system();
+  osal_nv_init( NULL );
+}
+
+/*********************************************************************
+ * @fn      osalTestSeed / osalTestRand
+ *
+ * @brief   Small LCG, so that the random workloads do not depend on
+ *          the C library of the host.
+ */
+void osalTestSeed( uint32 seed )
+{
+  osalTestSeedVal = seed;
+}
+
+uint32 osalTestRand( void )
+{
+  osalTestSeedVal = osalTestSeedVal * 1103515245UL + 12345UL;
+  return ( (osalTestSeedVal >> 8) & 0x00FFFFFFUL );
+}
+
+/*********************************************************************
+ * @fn      osalTestFind
+ *
+ * @brief   Look a test up by name.
+ *
+ * @param   name - test name
+ *
+ * @return  the test, or NULL if there is none of that name
+ */
+static const osalTest_t *osalTestFind( const char *name )
+{
+  uint8 tbl;
+  const osalTest_t *pTest;
+
+  for ( tbl = 0; tbl < sizeof( osalTestTables ) / sizeof( osalTestTables[0] ); tbl++ )
+  {
+    for ( pTest = osalTestTables[tbl]; pTest->name != NULL; pTest++ )
+    {
+      if ( strcmp( pTest->name, name ) == 0 )
+      {
+        return pTest;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*********************************************************************
+ * @fn      osalTestRun
+ *
+ * @brief   Run one test in a child process.
+ *
+ * @param   pTest - the test
+ *
+ * @return  0 if it passed
+ */
+static int osalTestRun( const osalTest_t *pTest )
+{
+  int status;
+  pid_t pid;
+
+  fflush( stdout );
+  pid = fork();
+  if ( pid == 0 )
+  {
+    pTest->pfnTest();
+    exit( 0 );
+  }
+
+  if ( (pid < 0) || (waitpid( pid, &status, 0 ) != pid) )
+  {
+    return -1;
+  }
+
+  return ( (WIFEXITED( status ) && (WEXITSTATUS( status ) == 0)) ? 0 : -1 );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   osal_test           - run every test
+ *          osal_test -l        - list the tests
+ *          osal_test <name>... - run the named tests
+ *
+ * @return  0 if every test run passed
+ */
+int main( int argc, char **argv )
+{
+  const osalTest_t *pTest;
+  int failCnt = 0;
+  int runCnt = 0;
+  uint8 tbl;
+  int arg;
+
+  if ( (argc > 1) && (strcmp( argv[1], "-l" ) == 0) )
+  {
+    for ( tbl = 0; tbl < sizeof( osalTestTables ) / sizeof( osalTestTables[0] ); tbl++ )
+    {
+      for ( pTest = osalTestTables[tbl]; pTest->name != NULL; pTest++ )
+      {
+        printf( "%s\n", pTest->name );
+      }
+    }
+    return 0;
+  }
+
+  if ( argc == 1 )
+  {
+    for ( tbl = 0; tbl < sizeof( osalTestTables ) / sizeof( osalTestTables[0] ); tbl++ )
+    {
+      for ( pTest = osalTestTables[tbl]; pTest->name != NULL; pTest++ )
+      {
+        int rc = osalTestRun( pTest );
+
+        printf( "%-24s %s\n", pTest->name, (rc == 0) ? "ok" : "FAILED" );
+        failCnt += (rc != 0);
+        runCnt++;
+      }
+    }
+  }
+
+  for ( arg = 1; arg < argc; arg++ )
+  {
+    int rc;
+
+    pTest = osalTestFind( argv[arg] );
+    if ( pTest == NULL )
+    {
+      fprintf( stderr, "no test named %s\n", argv[arg] );
+      return 2;
+    }
+
+    rc = osalTestRun( pTest );
+    printf( "%-24s %s\n", pTest->name, (rc == 0) ? "ok" : "FAILED" );
+    failCnt += (rc != 0);
+    runCnt++;
+  }
+
+  printf( "%d of %d tests passed\n", runCnt - failCnt, runCnt );
+  return ( (failCnt == 0) ? 0 : 1 );
+}
+
+/*********************************************************************
+*********************************************************************/
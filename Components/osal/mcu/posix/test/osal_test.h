@@ -0,0 +1,130 @@
+/**************************************************************************************************
+  Filename:       osal_test.h
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Test runner interface for the POSIX host port.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+#ifndef OSAL_TEST_H
+#define OSAL_TEST_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "comdef.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Fail the running test, which ends its process, unless the condition holds
+#define OSAL_TEST_CHECK( x )  st( if ( !(x) ) { osalTestFail( __FILE__, __LINE__, #x ); } )
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Test tasks, in priority order, ahead of the NV task
+#define OSAL_TEST_TASK_CNT    3
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef void (*osalTestFn_t)( void );
+
+typedef struct
+{
+  const char *name;
+  osalTestFn_t pfnTest;
+} osalTest_t;
+
+typedef uint16 (*osalTestEventCB_t)( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// Handler of the events of the test tasks, set by the running test
+extern osalTestEventCB_t osalTestEventCB;
+
+// Test tables, each ended by a NULL name
+extern const osalTest_t osalTestsOsal[];
+extern const osalTest_t osalTestsNv[];
+extern const osalTest_t osalTestsFlash[];
+#if defined MT_SYS_FUNC
+extern const osalTest_t osalTestsMt[];
+#endif
+#if defined MT_TASK
+extern const osalTest_t osalTestsMtUart[];
+#endif
+#if defined HAL_OTA_XNV_ERASE
+extern const osalTest_t osalTestsOta[];
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+  /*
+   * Report a failed check and end the test
+   */
+  extern void osalTestFail( const char *file, int line, const char *expr );
+
+  /*
+   * Power up the OSAL, with NV in the given flash file
+   */
+  extern void osalTestBoot( const char *flash );
+
+  /*
+   * Deterministic pseudo-random numbers for the tests
+   */
+  extern void osalTestSeed( uint32 seed );
+  extern uint32 osalTestRand( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_TEST_H */
@@ -0,0 +1,207 @@
+/**************************************************************************************************
+  Filename:       test_flash.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Host tests of the HAL flash drivers on the simulated flash:
+the queue of asynchronous (DMA) writes.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "hal_board_cfg.h"
+#include "hal_flash.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// A page clear of NV
+#define TEST_FLASH_PAGE    (HAL_NV_PAGE_BEG - 1)
+#define TEST_FLASH_ADDR    ((uint16)((uint32)TEST_FLASH_PAGE * HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE))
+
+// Words of each queued write
+#define TEST_FLASH_WORDS   16
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+#if HAL_FLASH_ASYNC
+// Completion events of the queued writes, in the order they came, and when
+static uint8 testDone[HAL_FLASH_ASYNC_CNT * 2];
+static uint64 testDoneAt[HAL_FLASH_ASYNC_CNT * 2];
+static uint8 testDoneCnt;
+
+static uint8 testBuf[HAL_FLASH_ASYNC_CNT * 2][TEST_FLASH_WORDS * HAL_FLASH_WORD_SIZE];
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+#if HAL_FLASH_ASYNC
+/*
+ * Note each write done, lowest event first; write n signals event bit n.
+ */
+static uint16 testFlashEvent( uint8 task_id, uint16 events )
+{
+  uint8 bit;
+
+  for ( bit = 0; bit < 16; bit++ )
+  {
+    if ( events & BV( bit ) )
+    {
+      OSAL_TEST_CHECK( testDoneCnt < sizeof( testDone ) );
+      testDone[testDoneCnt] = bit;
+      testDoneAt[testDoneCnt++] = osalPosixTime();
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * New data for write n, which goes TEST_FLASH_WORDS words after write n-1.
+ */
+static void testFlashFill( uint8 n )
+{
+  uint8 k;
+
+  for ( k = 0; k < sizeof( testBuf[n] ); k++ )
+  {
+    testBuf[n][k] = (uint8)osalTestRand();
+  }
+}
+
+static uint8 testFlashQueue( uint8 n )
+{
+  testFlashFill( n );
+
+  return HalFlashWriteAsync( TEST_FLASH_ADDR + (uint16)n * TEST_FLASH_WORDS, testBuf[n],
+                             TEST_FLASH_WORDS, 0, BV( n ) );
+}
+
+/*
+ * HAL_FLASH_ASYNC_CNT writes queue and one more is refused; they complete
+ * one after the other in the order queued, each signalling its own event
+ * once programmed, and a freed slot takes a write again. A synchronous
+ * write waits for the queue, and the data is all there.
+ */
+static void testFlashAsync( void )
+{
+  uint8 buf[TEST_FLASH_WORDS * HAL_FLASH_WORD_SIZE];
+  uint32 step = TEST_FLASH_WORDS * HAL_POSIX_FLASH_WORD_US;
+  uint64 start;
+  uint8 n;
+
+  remove( "test_flash.bin" );
+  osalTestBoot( "test_flash.bin" );
+  osalTestSeed( 19 );
+  osalTestEventCB = testFlashEvent;
+  testDoneCnt = 0;
+  HalFlashErase( TEST_FLASH_PAGE );
+
+  start = osalPosixTime();
+  for ( n = 0; n < HAL_FLASH_ASYNC_CNT; n++ )
+  {
+    OSAL_TEST_CHECK( testFlashQueue( n ) );
+  }
+  OSAL_TEST_CHECK( HalFlashBusy() == HAL_FLASH_ASYNC_CNT );
+  OSAL_TEST_CHECK( !testFlashQueue( n ) );
+  OSAL_TEST_CHECK( osalPosixTime() == start );
+
+  // The first one done frees a slot for the next.
+  osalPosixAdvance( (uint32)(halPosixFlashDue() - osalPosixTime()) );
+  OSAL_TEST_CHECK( HalFlashBusy() == HAL_FLASH_ASYNC_CNT - 1 );
+  OSAL_TEST_CHECK( testFlashQueue( n ) );
+  n++;
+  OSAL_TEST_CHECK( testFlashQueue( n ) == FALSE );
+
+  while ( HalFlashBusy() != 0 )
+  {
+    osalPosixRun( 1 );
+  }
+  osalPosixRun( 1 );
+
+  OSAL_TEST_CHECK( testDoneCnt == HAL_FLASH_ASYNC_CNT + 1 );
+  for ( n = 0; n < testDoneCnt; n++ )
+  {
+    OSAL_TEST_CHECK( testDone[n] == n );
+    OSAL_TEST_CHECK( testDoneAt[n] >= start + (uint64)(n + 1) * step );
+    OSAL_TEST_CHECK( (n == 0) || (testDoneAt[n] >= testDoneAt[n-1] + step) );
+  }
+  OSAL_TEST_CHECK( testDoneAt[0] <= start + step + 1000 );
+
+  // A synchronous write returns with the queued one before it done.
+  n = HAL_FLASH_ASYNC_CNT + 1;
+  OSAL_TEST_CHECK( testFlashQueue( n ) );
+  testFlashFill( n + 1 );
+  start = osalPosixTime();
+  HalFlashWrite( TEST_FLASH_ADDR + (uint16)(n + 1) * TEST_FLASH_WORDS, testBuf[n + 1],
+                 TEST_FLASH_WORDS );
+  OSAL_TEST_CHECK( HalFlashBusy() == 0 );
+  OSAL_TEST_CHECK( osalPosixTime() >= start + 2 * step );
+
+  for ( n = 0; n < HAL_FLASH_ASYNC_CNT + 3; n++ )
+  {
+    HalFlashRead( TEST_FLASH_PAGE, (uint16)n * TEST_FLASH_WORDS * HAL_FLASH_WORD_SIZE,
+                  buf, sizeof( buf ) );
+    OSAL_TEST_CHECK( memcmp( buf, testBuf[n], sizeof( buf ) ) == 0 );
+  }
+}
+#endif
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const osalTest_t osalTestsFlash[] = {
+#if HAL_FLASH_ASYNC
+  { "flash_async",  testFlashAsync },
+#endif
+  { NULL, NULL }
+};
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,407 @@
+/**************************************************************************************************
+  Filename:       test_mt.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Host tests of MT_SYS, on the events of a ZNP task.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Nv.h"
+#include "MT.h"
+#include "MT_RPC.h"
+#include "MT_SYS.h"
+#include "MT_UART.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+#include "znp_app.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_MT_BASE       0x0401
+#define TEST_MT_CNT        6
+#define TEST_MT_LEN_MAX    600
+
+#define TEST_MT_FRAMES     24
+
+// The pace of the stream indications, as MT_SYS.c sets it
+#if !defined MT_SYS_NV_STREAM_DLY
+#define MT_SYS_NV_STREAM_DLY  40
+#endif
+
+// Msecs a full frame takes on the line at the 38400 baud of MT_UartInit()
+#define TEST_MT_LINE_MS    ((MT_UART_TX_BUFF_MAX * 10UL * 1000UL) / 38400UL + 1)
+
+// The events that znpEventLoop() checks ahead of MT's
+#define TEST_ZNP_EVENTS    (ZNP_SPI_RX_AREQ_EVENT | ZNP_SPI_RX_SREQ_EVENT | \
+                            ZNP_UART_TX_READY_EVENT)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// MT_SYS_NV_SNAPSHOT_IND frames sent to the host, in MT_SYS_NV_SNAPSHOT_IMPORT form
+static uint8 testFrame[TEST_MT_FRAMES][MT_RPC_FRAME_HDR_SZ + MT_RPC_DATA_MAX];
+static uint8 testFrameCnt;
+
+// The last other response sent to the host
+static uint8 testRspCmd;
+static uint8 testRsp[MT_RPC_DATA_MAX];
+
+// ZNP events taken by the events of MT
+static uint16 testZnpCnt;
+
+#if defined ( OSAL_NV_EXTENDED )
+// The item as put together from MT_SYS_OSAL_NV_STREAM_IND, and the indications that carried it
+static uint8 testStream[TEST_MT_LEN_MAX];
+static uint16 testStreamLen;
+static uint8 testStreamCnt;
+#endif
+
+static uint8 testData[TEST_MT_CNT][TEST_MT_LEN_MAX];
+static const uint16 testLen[TEST_MT_CNT] = { 600, 0, 1, 40, 121, 122 };
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * The event handling of znpEventLoop(): one event at a time, the ZNP
+ * ones first.
+ */
+static uint16 testZnpEvent( uint8 task_id, uint16 events )
+{
+  if ( events & TEST_ZNP_EVENTS )
+  {
+    testZnpCnt++;
+    return ( events & ~TEST_ZNP_EVENTS );
+  }
+  else if ( events & MT_SYS_NV_STREAM_EVT )
+  {
+    MT_SysNvStream();
+    return ( events ^ MT_SYS_NV_STREAM_EVT );
+  }
+  return 0;
+}
+
+/*
+ * The host end of MT: keep the snapshot frames and the last other response.
+ */
+static void testMtRsp( uint8 cmdId, uint8 dataLen, uint8 *dataPtr )
+{
+  if ( cmdId == MT_SYS_NV_SNAPSHOT_IND )
+  {
+    OSAL_TEST_CHECK( testFrameCnt < TEST_MT_FRAMES );
+    testFrame[testFrameCnt][MT_RPC_POS_LEN] = dataLen;
+    osal_memcpy( testFrame[testFrameCnt] + MT_RPC_FRAME_HDR_SZ, dataPtr, dataLen );
+    testFrameCnt++;
+  }
+#if defined ( OSAL_NV_EXTENDED )
+  else if ( cmdId == MT_SYS_OSAL_NV_STREAM_IND )
+  {
+    // Status, table ID, sub ID, offset, data length, data: the pieces come in order.
+    OSAL_TEST_CHECK( (dataPtr[0] == SUCCESS) && (osal_build_uint16( dataPtr+5 ) == testStreamLen) );
+    OSAL_TEST_CHECK( testStreamLen + dataPtr[7] <= sizeof( testStream ) );
+    osal_memcpy( testStream + testStreamLen, dataPtr + 8, dataPtr[7] );
+    testStreamLen += dataPtr[7];
+    testStreamCnt++;
+  }
+#endif
+  else
+  {
+    testRspCmd = cmdId;
+    osal_memcpy( testRsp, dataPtr, dataLen );
+  }
+}
+
+/*
+ * The host end of the UART: split the bytes sent into frames, each of
+ * which must be whole and check.
+ */
+static void testMtTx( uint8 port, uint8 *pBuf, uint16 len )
+{
+  while ( len != 0 )
+  {
+    uint8 dataLen = pBuf[1];
+
+    OSAL_TEST_CHECK( (pBuf[0] == MT_UART_SOF) && (len >= dataLen + SPI_0DATA_MSG_LEN) );
+    OSAL_TEST_CHECK( MT_UartCalcFCS( pBuf + 1, MT_RPC_FRAME_HDR_SZ + dataLen ) ==
+                     pBuf[MT_RPC_FRAME_HDR_SZ + 1 + dataLen] );
+    testMtRsp( pBuf[1 + MT_RPC_POS_CMD1], dataLen, pBuf + 1 + MT_RPC_FRAME_HDR_SZ );
+
+    pBuf += dataLen + SPI_0DATA_MSG_LEN;
+    len -= dataLen + SPI_0DATA_MSG_LEN;
+  }
+}
+
+static void testBoot( const char *flash )
+{
+  (void)remove( flash );
+  osalTestBoot( flash );
+  osalPosixRun( 1 );
+  // The ZNP task, which takes MT's events: test task 0
+  MT_TaskID = 0;
+  MT_UartInit();
+  halPosixUartSetTx( MT_UART_DEFAULT_PORT, testMtTx );
+  osalTestEventCB = testZnpEvent;
+}
+
+/*
+ * Hand a frame to MT_SYS as it comes from the host.
+ */
+static void testMtRequest( uint8 cmdType, uint8 cmdId, uint8 len, const uint8 *pData )
+{
+  uint8 buf[MT_RPC_FRAME_HDR_SZ + MT_RPC_DATA_MAX];
+
+  buf[MT_RPC_POS_LEN] = len;
+  buf[MT_RPC_POS_CMD0] = cmdType | (uint8)MT_RPC_SYS_SYS;
+  buf[MT_RPC_POS_CMD1] = cmdId;
+  osal_memcpy( buf + MT_RPC_FRAME_HDR_SZ, pData, len );
+
+  testRspCmd = 0;
+  (void)MT_SysCommandProcessing( buf );
+  halPosixUartFlush( MT_UART_DEFAULT_PORT );
+}
+
+/*
+ * A snapshot exported over MT, at the pace of MT_SYS_NV_STREAM_EVT,
+ * imports into a blank device; without MT_SYS_NV_SNAPSHOT_SECURITY it
+ * leaves out the key that MT may not read. An import frame too short for
+ * its data length is refused.
+ */
+static void testMtSnapshot( void )
+{
+  uint8 buf[TEST_MT_LEN_MAX];
+  uint8 *pLast;
+  uint8 idx;
+  uint16 k;
+
+  testBoot( "test_mt_export.bin" );
+  osalTestSeed( 6 );
+  testFrameCnt = 0;
+
+  for ( idx = 0; idx < TEST_MT_CNT; idx++ )
+  {
+    for ( k = 0; k < testLen[idx]; k++ )
+    {
+      testData[idx][k] = (uint8)osalTestRand();
+    }
+    OSAL_TEST_CHECK( osal_nv_item_init( TEST_MT_BASE + idx, testLen[idx],
+                                        testData[idx] ) == NV_ITEM_UNINIT );
+  }
+  OSAL_TEST_CHECK( osal_nv_item_init( ZCD_NV_PRECFGKEY, 16, testData[0] ) == NV_ITEM_UNINIT );
+
+  testMtRequest( MT_RPC_CMD_SREQ, MT_SYS_NV_SNAPSHOT_EXPORT, 0, NULL );
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_NV_SNAPSHOT_EXPORT) && (testRsp[0] == SUCCESS) );
+  OSAL_TEST_CHECK( osal_build_uint16( testRsp+1 ) == TEST_MT_CNT );
+
+  osalPosixRun( 2000 );
+  OSAL_TEST_CHECK( testZnpCnt == 0 );
+  OSAL_TEST_CHECK( testFrameCnt > 1 );
+  pLast = testFrame[testFrameCnt-1] + MT_RPC_FRAME_HDR_SZ;
+  OSAL_TEST_CHECK( (pLast[2] == 0) && (pLast[3] == SUCCESS) );
+  OSAL_TEST_CHECK( osal_build_uint16( pLast ) == testFrameCnt-1 );
+
+  testBoot( "test_mt_import.bin" );
+
+  // A data length past the end of the frame, and a last part without its CRC
+  osal_memcpy( buf, testFrame[0], sizeof( testFrame[0] ) );
+  buf[MT_RPC_POS_LEN]--;
+  testMtRequest( MT_RPC_CMD_SREQ, MT_SYS_NV_SNAPSHOT_IMPORT, buf[MT_RPC_POS_LEN], buf + MT_RPC_FRAME_HDR_SZ );
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_NV_SNAPSHOT_IMPORT) && (testRsp[0] == ZInvalidParameter) );
+  testMtRequest( MT_RPC_CMD_AREQ, MT_SYS_NV_SNAPSHOT_IMPORT, 4, pLast );
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_NV_SNAPSHOT_ACK) && (testRsp[0] == ZInvalidParameter) );
+
+  for ( idx = 0; idx < testFrameCnt; idx++ )
+  {
+    testMtRequest( MT_RPC_CMD_AREQ, MT_SYS_NV_SNAPSHOT_IMPORT, testFrame[idx][MT_RPC_POS_LEN],
+                   testFrame[idx] + MT_RPC_FRAME_HDR_SZ );
+  }
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_NV_SNAPSHOT_ACK) && (testRsp[0] == SUCCESS) );
+  OSAL_TEST_CHECK( osal_build_uint16( testRsp+1 ) == testFrameCnt );
+
+  for ( idx = 0; idx < TEST_MT_CNT; idx++ )
+  {
+    OSAL_TEST_CHECK( osal_nv_item_len( TEST_MT_BASE + idx ) == testLen[idx] );
+    if ( testLen[idx] != 0 )
+    {
+      OSAL_TEST_CHECK( osal_nv_read( TEST_MT_BASE + idx, 0, testLen[idx], buf ) == SUCCESS );
+      OSAL_TEST_CHECK( memcmp( buf, testData[idx], testLen[idx] ) == 0 );
+    }
+  }
+  OSAL_TEST_CHECK( osal_nv_item_len( ZCD_NV_PRECFGKEY ) == 0 );
+}
+
+#if OSAL_NV_SNAPSHOT && MT_SYS_NV_SNAPSHOT_KEYS
+/*
+ * With MT_SYS_NV_SNAPSHOT_SECURITY, the snapshot carries the key items as
+ * well, and they import into a blank device.
+ */
+static void testMtSnapshotKeys( void )
+{
+  uint8 flags = MT_SYS_NV_SNAPSHOT_SECURITY;
+  uint8 key[16], buf[16];
+  uint8 idx;
+
+  testBoot( "test_mt_keys.bin" );
+  osalTestSeed( 18 );
+  testFrameCnt = 0;
+
+  for ( idx = 0; idx < sizeof( key ); idx++ )
+  {
+    key[idx] = (uint8)osalTestRand();
+  }
+  OSAL_TEST_CHECK( osal_nv_item_init( ZCD_NV_PRECFGKEY, sizeof( key ), key ) == NV_ITEM_UNINIT );
+  OSAL_TEST_CHECK( osal_nv_item_init( TEST_MT_BASE, sizeof( key ), key ) == NV_ITEM_UNINIT );
+
+  testMtRequest( MT_RPC_CMD_SREQ, MT_SYS_NV_SNAPSHOT_EXPORT, 1, &flags );
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_NV_SNAPSHOT_EXPORT) && (testRsp[0] == SUCCESS) );
+  OSAL_TEST_CHECK( osal_build_uint16( testRsp+1 ) == 2 );
+  osalPosixRun( 2000 );
+  OSAL_TEST_CHECK( testFrameCnt > 1 );
+
+  testBoot( "test_mt_keys_import.bin" );
+  for ( idx = 0; idx < testFrameCnt; idx++ )
+  {
+    testMtRequest( MT_RPC_CMD_AREQ, MT_SYS_NV_SNAPSHOT_IMPORT, testFrame[idx][MT_RPC_POS_LEN],
+                   testFrame[idx] + MT_RPC_FRAME_HDR_SZ );
+  }
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_NV_SNAPSHOT_ACK) && (testRsp[0] == SUCCESS) );
+
+  OSAL_TEST_CHECK( osal_nv_item_len( ZCD_NV_PRECFGKEY ) == sizeof( key ) );
+  OSAL_TEST_CHECK( osal_nv_read( ZCD_NV_PRECFGKEY, 0, sizeof( key ), buf ) == SUCCESS );
+  OSAL_TEST_CHECK( memcmp( buf, key, sizeof( key ) ) == 0 );
+  OSAL_TEST_CHECK( osal_nv_read( TEST_MT_BASE, 0, sizeof( key ), buf ) == SUCCESS );
+  OSAL_TEST_CHECK( memcmp( buf, key, sizeof( key ) ) == 0 );
+}
+#endif
+
+#if defined ( OSAL_NV_EXTENDED )
+/*
+ * A large item reads back whole in one MT_SYS_OSAL_NV_READ_STREAM request,
+ * as a train of indications each MT_SYS_NV_STREAM_DLY after the last, where
+ * MT_SYS_OSAL_NV_READ_EXT takes a round trip per frame of it.
+ */
+static void testMtNvStream( void )
+{
+  uint8 req[8];
+  uint16 ofs, trips = 0;
+  uint32 start;
+  uint16 k;
+
+  testBoot( "test_mt_stream.bin" );
+  osalTestSeed( 17 );
+  for ( k = 0; k < testLen[0]; k++ )
+  {
+    testData[0][k] = (uint8)osalTestRand();
+  }
+  OSAL_TEST_CHECK( osal_nv_item_init( TEST_MT_BASE, testLen[0], testData[0] ) == NV_ITEM_UNINIT );
+
+  // Round trips: each response carries as much of the item as fits.
+  for ( ofs = 0; ofs < testLen[0]; ofs += testRsp[1] )
+  {
+    req[0] = LO_UINT16( TEST_MT_BASE );
+    req[1] = HI_UINT16( TEST_MT_BASE );
+    req[2] = LO_UINT16( ofs );
+    req[3] = HI_UINT16( ofs );
+    testMtRequest( MT_RPC_CMD_SREQ, MT_SYS_OSAL_NV_READ_EXT, 4, req );
+    OSAL_TEST_CHECK( (testRspCmd == MT_SYS_OSAL_NV_READ_EXT) && (testRsp[0] == SUCCESS) );
+    OSAL_TEST_CHECK( (testRsp[1] != 0) && (memcmp( testRsp+2, testData[0]+ofs, testRsp[1] ) == 0) );
+    trips++;
+  }
+
+  // One request for the whole item
+  req[0] = LO_UINT16( ZCD_NV_EX_LEGACY );
+  req[1] = HI_UINT16( ZCD_NV_EX_LEGACY );
+  req[2] = LO_UINT16( TEST_MT_BASE );
+  req[3] = HI_UINT16( TEST_MT_BASE );
+  req[4] = req[5] = req[6] = req[7] = 0;
+  testMtRequest( MT_RPC_CMD_SREQ, MT_SYS_OSAL_NV_READ_STREAM, 8, req );
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_OSAL_NV_READ_STREAM) && (testRsp[0] == SUCCESS) );
+  OSAL_TEST_CHECK( osal_build_uint16( testRsp+1 ) == testLen[0] );
+
+  start = osalPosixTime() / 1000;
+  while ( (testStreamLen < testLen[0]) && ((osalPosixTime() / 1000) - start < 2000) )
+  {
+    osalPosixRun( 1 );
+  }
+  OSAL_TEST_CHECK( (testStreamLen == testLen[0]) &&
+                   (memcmp( testStream, testData[0], testLen[0] ) == 0) );
+  // An indication has 6 more header bytes than a response, so may take one more frame.
+  OSAL_TEST_CHECK( (trips > 1) && (testStreamCnt >= trips) && (testStreamCnt <= trips + 1) );
+  // The indications keep their pace; the last one then takes its time on the line.
+  OSAL_TEST_CHECK( (osalPosixTime() / 1000) - start <=
+                   (uint32)(testStreamCnt - 1) * (MT_SYS_NV_STREAM_DLY + 1) + TEST_MT_LINE_MS + 2 );
+  OSAL_TEST_CHECK( testZnpCnt == 0 );
+
+  // Past the end of the item, nothing is streamed.
+  req[4] = LO_UINT16( testLen[0] );
+  req[5] = HI_UINT16( testLen[0] );
+  testStreamCnt = 0;
+  testMtRequest( MT_RPC_CMD_SREQ, MT_SYS_OSAL_NV_READ_STREAM, 8, req );
+  OSAL_TEST_CHECK( (testRspCmd == MT_SYS_OSAL_NV_READ_STREAM) && (testRsp[0] == ZInvalidParameter) );
+  osalPosixRun( 200 );
+  OSAL_TEST_CHECK( testStreamCnt == 0 );
+}
+#endif
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const osalTest_t osalTestsMt[] = {
+#if OSAL_NV_SNAPSHOT
+  { "mt_snapshot",  testMtSnapshot },
+#endif
+#if OSAL_NV_SNAPSHOT && MT_SYS_NV_SNAPSHOT_KEYS
+  { "mt_snapshot_keys", testMtSnapshotKeys },
+#endif
+#if defined ( OSAL_NV_EXTENDED )
+  { "mt_nv_stream", testMtNvStream },
+#endif
+  { NULL, NULL }
+};
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,846 @@
+/**************************************************************************************************
+  Filename:       test_mt_uart.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Host tests of the MT UART transport, over the UART model of hal_uart.c.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Nv.h"
+#include "MT.h"
+#include "MT_RPC.h"
+#include "MT_TASK.h"
+#include "MT_UART.h"
+#include "MT_UTIL.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// The task that MT_UART hands the frames to: test task 1
+#define TEST_UART_APP_TASK   1
+
+#define TEST_UART_FRAMES     32
+#define TEST_UART_DATA_MAX   40
+
+// Frames of the tests, to a subsystem that MT does not process. Their bytes are all below
+// 0x80, so that none of them looks like a start of frame to the parser.
+#define TEST_UART_CMD0       ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_APP)
+
+// Requests of the batch test, and the NV items they write
+#define TEST_BATCH_CNT       50
+#define TEST_BATCH_ITEM      0x0480
+#define TEST_BATCH_ITEM_CNT  4
+#define TEST_BATCH_ITEM_LEN  4
+
+// MT_UTIL_CB_FILTER_SET: | index | action | cmd0 | cmd1 | endpoint | profile(2) |
+// clusterMin(2) | clusterMax(2) | srcAddr(2) | srcMask(2) |
+#define TEST_CBF_SET_LEN  15
+
+// MT_SYS_PIPE_REQ of the pipe test: | seq | MT_SYS_PING SREQ |, the window they are sent
+// against and the time MT takes over each
+#define TEST_PIPE_CNT        24
+#define TEST_PIPE_REQ_LEN    (1 + MT_RPC_FRAME_HDR_SZ)
+#define TEST_PIPE_WINDOW     2
+#define TEST_PIPE_WORK_US    3000
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Frames handed to the application task, from their length byte on
+static uint8 testUartMsg[TEST_UART_FRAMES][MT_RPC_FRAME_HDR_SZ + TEST_UART_DATA_MAX];
+static uint8 testUartMsgCnt;
+
+// Times each frame sent by MT reached the host, by its command ID
+static uint8 testUartTxCnt[TEST_UART_FRAMES];
+
+// The last SRSP sent by MT, from its length byte on, and the number sent
+static uint8 testUartRsp[MT_RPC_FRAME_HDR_SZ + MT_RPC_DATA_MAX];
+static uint16 testUartRspCnt;
+
+// Sequence IDs of the MT_SYS_PIPE_RSP sent by MT, in the order they reached the host
+static uint8 testPipeSeq[2 * TEST_PIPE_CNT];
+static uint8 testPipeSeqCnt;
+
+// Most MT_SYS_PIPE_REQ queued at MT at once, and the times it had its window of them
+// with more left in the Rx buffer
+static uint8 testPipeMax;
+static uint16 testPipeHeld;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint16 testUartEvent( uint8 task_id, uint16 events )
+{
+  if ( events & SYS_EVENT_MSG )
+  {
+    mtOSALSerialData_t *pMsg;
+
+    while ( (pMsg = (mtOSALSerialData_t *)osal_msg_receive( task_id )) != NULL )
+    {
+      uint8 len = pMsg->msg[MT_RPC_POS_LEN];
+
+      OSAL_TEST_CHECK( (task_id == TEST_UART_APP_TASK) && (pMsg->hdr.event == CMD_SERIAL_MSG) );
+      OSAL_TEST_CHECK( (testUartMsgCnt < TEST_UART_FRAMES) && (len <= TEST_UART_DATA_MAX) );
+      osal_memcpy( testUartMsg[testUartMsgCnt++], pMsg->msg, MT_RPC_FRAME_HDR_SZ + len );
+      (void)osal_msg_deallocate( (uint8 *)pMsg );
+    }
+    return ( events ^ SYS_EVENT_MSG );
+  }
+  return 0;
+}
+
+static void testUartBoot( const char *flash )
+{
+  (void)remove( flash );
+  osalTestBoot( flash );
+  osalPosixRun( 1 );
+
+  MT_UartInit();
+  MT_UartRegisterTaskID( TEST_UART_APP_TASK );
+  osalTestEventCB = testUartEvent;
+  testUartMsgCnt = 0;
+}
+
+/*
+ * Build a frame of 'len' data bytes; returns its length on the line.
+ */
+static uint8 testUartFrame( uint8 *pBuf, uint8 cmd1, uint8 len )
+{
+  uint8 k;
+
+  pBuf[0] = MT_UART_SOF;
+  pBuf[1 + MT_RPC_POS_LEN] = len;
+  pBuf[1 + MT_RPC_POS_CMD0] = TEST_UART_CMD0;
+  pBuf[1 + MT_RPC_POS_CMD1] = cmd1;
+  for ( k = 0; k < len; k++ )
+  {
+    pBuf[1 + MT_RPC_FRAME_HDR_SZ + k] = (uint8)((cmd1 * 7 + k) & 0x7F);
+  }
+  pBuf[1 + MT_RPC_FRAME_HDR_SZ + len] = MT_UartCalcFCS( pBuf + 1, MT_RPC_FRAME_HDR_SZ + len );
+
+  return ( len + SPI_0DATA_MSG_LEN );
+}
+
+/*
+ * The host sends bytes, all of which the Rx buffer takes, and the parser
+ * runs until it has released them.
+ */
+static void testUartSend( const uint8 *pBuf, uint16 len )
+{
+  OSAL_TEST_CHECK( halPosixUartRx( MT_UART_DEFAULT_PORT, pBuf, len ) == len );
+  osalPosixRun( 1 );
+  OSAL_TEST_CHECK( Hal_UART_RxBufLen( MT_UART_DEFAULT_PORT ) == 0 );
+}
+
+/*
+ * Check that a frame the host sent was handed over as the given one.
+ */
+static void testUartCheck( uint8 idx, const uint8 *pFrame )
+{
+  OSAL_TEST_CHECK( idx < testUartMsgCnt );
+  OSAL_TEST_CHECK( memcmp( testUartMsg[idx], pFrame + 1, MT_RPC_FRAME_HDR_SZ + pFrame[1] ) == 0 );
+}
+
+/*
+ * Check an MT_SYS_PIPE_RSP, from its length byte on, and note its sequence ID.
+ */
+static void testPipeRsp( const uint8 *pRsp )
+{
+  const uint8 *pData = pRsp + MT_RPC_POS_DAT0;
+
+  // | seq | credits | cmd0 | cmd1 | capabilities(2) |, the SRSP of the MT_SYS_PING
+  OSAL_TEST_CHECK( pRsp[MT_RPC_POS_LEN] == 6 );
+  OSAL_TEST_CHECK( pData[1] <= TEST_PIPE_WINDOW );
+  OSAL_TEST_CHECK( (pData[2] == ((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS)) &&
+                   (pData[3] == MT_SYS_PING) );
+  OSAL_TEST_CHECK( testPipeSeqCnt < sizeof( testPipeSeq ) );
+  testPipeSeq[testPipeSeqCnt++] = pData[0];
+}
+
+/*
+ * The host end of the UART: count the frames by their command ID, keep
+ * the last SRSP and check the MT_SYS_PIPE_RSP.
+ */
+static void testUartTx( uint8 port, uint8 *pBuf, uint16 len )
+{
+  while ( len != 0 )
+  {
+    uint8 dataLen = pBuf[1 + MT_RPC_POS_LEN];
+    uint8 cmd1 = pBuf[1 + MT_RPC_POS_CMD1];
+
+    OSAL_TEST_CHECK( (pBuf[0] == MT_UART_SOF) && (len >= dataLen + SPI_0DATA_MSG_LEN) );
+    OSAL_TEST_CHECK( MT_UartCalcFCS( pBuf + 1, MT_RPC_FRAME_HDR_SZ + dataLen ) ==
+                     pBuf[1 + MT_RPC_FRAME_HDR_SZ + dataLen] );
+    if ( cmd1 < TEST_UART_FRAMES )
+    {
+      testUartTxCnt[cmd1]++;
+    }
+    if ( (pBuf[1 + MT_RPC_POS_CMD0] & MT_RPC_CMD_TYPE_MASK) == MT_RPC_CMD_SRSP )
+    {
+      osal_memcpy( testUartRsp, pBuf + 1, MT_RPC_FRAME_HDR_SZ + dataLen );
+      testUartRspCnt++;
+    }
+    else if ( (pBuf[1 + MT_RPC_POS_CMD0] == ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS)) &&
+              (cmd1 == MT_SYS_PIPE_RSP) )
+    {
+      testPipeRsp( pBuf + 1 );
+    }
+
+    pBuf += dataLen + SPI_0DATA_MSG_LEN;
+    len -= dataLen + SPI_0DATA_MSG_LEN;
+  }
+}
+
+/*
+ * Run MT as its task does, on test task 1, with the host at the other end
+ * of its UART.
+ */
+static void testUartMtBoot( const char *flash )
+{
+  (void)remove( flash );
+  osalTestBoot( flash );
+  osalPosixRun( 1 );
+
+  halPosixUartSetTx( MT_UART_DEFAULT_PORT, testUartTx );
+  MT_TaskInit( TEST_UART_APP_TASK );
+  osalTestEventCB = MT_ProcessEvent;
+
+  // MT_SYS_RESET_IND
+  osalPosixRun( 1 );
+  halPosixUartFlush( MT_UART_DEFAULT_PORT );
+  (void)memset( testUartTxCnt, 0, sizeof( testUartTxCnt ) );
+}
+
+/*
+ * The host sends a frame, as fast as the Rx buffer takes it, then waits
+ * for its SRSP.
+ */
+static void testUartSreq( const uint8 *pBuf, uint16 len )
+{
+  uint16 cnt = testUartRspCnt;
+  uint16 ms;
+
+  for ( ms = 0; (testUartRspCnt == cnt) && (ms < 1000); ms++ )
+  {
+    uint16 rx = halPosixUartRx( MT_UART_DEFAULT_PORT, pBuf, len );
+
+    pBuf += rx;
+    len -= rx;
+    osalPosixRun( 1 );
+  }
+  OSAL_TEST_CHECK( (len == 0) && (testUartRspCnt == cnt + 1) );
+}
+
+/*
+ * Put request 'idx' of the batch test at pCmd, from its length byte on;
+ * returns its length and sets the status it must get.
+ */
+static uint8 testBatchCmd( uint8 *pCmd, uint8 idx, uint8 *pStatus )
+{
+  if ( (idx % 10) == 9 )
+  {
+    // To a subsystem that is not built in
+    pCmd[MT_RPC_POS_LEN] = 1;
+    pCmd[MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_APP;
+    pCmd[MT_RPC_POS_CMD1] = 0x01;
+    pCmd[MT_RPC_POS_DAT0] = idx;
+    *pStatus = MT_RPC_ERR_SUBSYSTEM;
+    return ( MT_RPC_FRAME_HDR_SZ + 1 );
+  }
+
+  // MT_SYS_OSAL_NV_WRITE of one byte: to an item that does not exist, past the end of one, or in it
+  pCmd[MT_RPC_POS_LEN] = 5;
+  pCmd[MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS;
+  pCmd[MT_RPC_POS_CMD1] = MT_SYS_OSAL_NV_WRITE;
+  pCmd[MT_RPC_POS_DAT0] = LO_UINT16( TEST_BATCH_ITEM + (idx % TEST_BATCH_ITEM_CNT) );
+  pCmd[MT_RPC_POS_DAT0 + 1] = HI_UINT16( TEST_BATCH_ITEM + (idx % TEST_BATCH_ITEM_CNT) );
+  pCmd[MT_RPC_POS_DAT0 + 2] = (idx / TEST_BATCH_ITEM_CNT) % TEST_BATCH_ITEM_LEN;
+  pCmd[MT_RPC_POS_DAT0 + 3] = 1;
+  pCmd[MT_RPC_POS_DAT0 + 4] = idx;
+  *pStatus = ZSuccess;
+
+  if ( (idx % 10) == 4 )
+  {
+    pCmd[MT_RPC_POS_DAT0 + 1] ^= 0x40;
+    *pStatus = ZInvalidParameter;
+  }
+  else if ( (idx % 10) == 7 )
+  {
+    pCmd[MT_RPC_POS_DAT0 + 2] = TEST_BATCH_ITEM_LEN;
+    *pStatus = ZInvalidParameter;
+  }
+
+  return ( MT_RPC_FRAME_HDR_SZ + 5 );
+}
+
+/*
+ * Frame a command for the line, in place: its SOF before it at pBuf[0] and
+ * its FCS after it. Returns the frame length.
+ */
+static uint16 testUartSeal( uint8 *pBuf )
+{
+  uint8 len = MT_RPC_FRAME_HDR_SZ + pBuf[1 + MT_RPC_POS_LEN];
+
+  pBuf[0] = MT_UART_SOF;
+  pBuf[1 + len] = MT_UartCalcFCS( pBuf + 1, len );
+  return ( len + 2 );
+}
+
+/*
+ * 50 requests sent one at a time, then again in MT_SYS_BATCH frames as full
+ * as MT_RPC_DATA_MAX allows, over the UART: each request gets the same
+ * status both ways, and the SRSP of a batch carries its count and then the
+ * status of each request in order.
+ */
+static void testUartBatch( void )
+{
+  uint8 frame[SPI_0DATA_MSG_LEN + MT_RPC_DATA_MAX];
+  uint8 status[TEST_BATCH_CNT];
+  uint8 expect[TEST_BATCH_CNT];
+  uint8 data[TEST_BATCH_ITEM_LEN];
+  uint8 item[TEST_BATCH_ITEM_CNT][TEST_BATCH_ITEM_LEN];
+  uint16 single, batch, used;
+  uint8 idx, k;
+
+  testUartMtBoot( "test_uart_batch.bin" );
+  (void)memset( data, 0, sizeof( data ) );
+  (void)memset( item, 0, sizeof( item ) );
+  for ( k = 0; k < TEST_BATCH_ITEM_CNT; k++ )
+  {
+    OSAL_TEST_CHECK( osal_nv_item_init( TEST_BATCH_ITEM + k, TEST_BATCH_ITEM_LEN, data ) ==
+                     NV_ITEM_UNINIT );
+  }
+
+  single = testUartRspCnt;
+  for ( idx = 0; idx < TEST_BATCH_CNT; idx++ )
+  {
+    (void)testBatchCmd( frame + 1, idx, expect + idx );
+    testUartSreq( frame, testUartSeal( frame ) );
+    status[idx] = testUartRsp[MT_RPC_POS_DAT0];
+    OSAL_TEST_CHECK( status[idx] == expect[idx] );
+    if ( expect[idx] == ZSuccess )
+    {
+      item[idx % TEST_BATCH_ITEM_CNT][frame[1 + MT_RPC_POS_DAT0 + 2]] = idx;
+    }
+  }
+  single = testUartRspCnt - single;
+  // The NV cache keeps the items it took in on the first pass.
+  used = osal_heap_mem_used();
+
+  batch = testUartRspCnt;
+  for ( idx = 0; idx < TEST_BATCH_CNT; )
+  {
+    uint8 *pCmd = frame + 1 + MT_RPC_POS_DAT0 + 1;
+    uint8 first = idx;
+    uint8 cnt = 0;
+
+    while ( (idx < TEST_BATCH_CNT) &&
+            (pCmd + MT_RPC_FRAME_HDR_SZ + 5 <= frame + 1 + MT_RPC_FRAME_HDR_SZ + MT_RPC_DATA_MAX) )
+    {
+      pCmd += testBatchCmd( pCmd, idx++, expect + first + cnt );
+      cnt++;
+    }
+    frame[1 + MT_RPC_POS_LEN] = (uint8)(pCmd - (frame + 1 + MT_RPC_FRAME_HDR_SZ));
+    frame[1 + MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS;
+    frame[1 + MT_RPC_POS_CMD1] = MT_SYS_BATCH;
+    frame[1 + MT_RPC_POS_DAT0] = cnt;
+    testUartSreq( frame, testUartSeal( frame ) );
+
+    OSAL_TEST_CHECK( testUartRsp[MT_RPC_POS_CMD0] == ((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS) );
+    OSAL_TEST_CHECK( (testUartRsp[MT_RPC_POS_CMD1] == MT_SYS_BATCH) &&
+                     (testUartRsp[MT_RPC_POS_LEN] == cnt + 1) &&
+                     (testUartRsp[MT_RPC_POS_DAT0] == cnt) );
+    OSAL_TEST_CHECK( memcmp( testUartRsp + MT_RPC_POS_DAT0 + 1, status + first, cnt ) == 0 );
+  }
+  batch = testUartRspCnt - batch;
+
+  // One SRSP per request, against one per batch
+  OSAL_TEST_CHECK( (single == TEST_BATCH_CNT) && (batch > 1) && (batch < TEST_BATCH_CNT / 10) );
+
+  // The batches wrote the same bytes, in the same order, as the requests one at a time.
+  for ( k = 0; k < TEST_BATCH_ITEM_CNT; k++ )
+  {
+    OSAL_TEST_CHECK( osal_nv_read( TEST_BATCH_ITEM + k, 0, TEST_BATCH_ITEM_LEN, data ) == SUCCESS );
+    OSAL_TEST_CHECK( memcmp( data, item[k], TEST_BATCH_ITEM_LEN ) == 0 );
+  }
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+}
+
+/*
+ * The host sends an MT_UTIL SREQ and waits for its SRSP.
+ */
+static void testUartUtil( uint8 cmdId, uint8 len, const uint8 *pData )
+{
+  uint8 frame[SPI_0DATA_MSG_LEN + MT_RPC_DATA_MAX];
+
+  frame[1 + MT_RPC_POS_LEN] = len;
+  frame[1 + MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_UTIL;
+  frame[1 + MT_RPC_POS_CMD1] = cmdId;
+  osal_memcpy( frame + 1 + MT_RPC_FRAME_HDR_SZ, pData, len );
+  testUartSreq( frame, testUartSeal( frame ) );
+}
+
+/*
+ * Check the SRSP of an MT_UTIL command: its own with the given status, or
+ * the MT_RPC error SRSP.
+ */
+static void testUartUtilRsp( uint8 cmdId, uint8 status )
+{
+  if ( status == MT_RPC_ERR_LENGTH )
+  {
+    OSAL_TEST_CHECK( testUartRsp[MT_RPC_POS_CMD0] == ((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_RES0) );
+    OSAL_TEST_CHECK( (testUartRsp[MT_RPC_POS_DAT0 + 1] == ((uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_UTIL)) &&
+                     (testUartRsp[MT_RPC_POS_DAT0 + 2] == cmdId) );
+  }
+  else
+  {
+    OSAL_TEST_CHECK( (testUartRsp[MT_RPC_POS_CMD0] == ((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_UTIL)) &&
+                     (testUartRsp[MT_RPC_POS_CMD1] == cmdId) );
+  }
+  OSAL_TEST_CHECK( testUartRsp[MT_RPC_POS_DAT0] == status );
+}
+
+/*
+ * A callback as MT_AF or MT_ZDO describes it to the filter.
+ */
+static uint8 testUartCb( uint8 sys, uint8 known, uint16 clusterId )
+{
+  mtUtilCbKey_t key;
+
+  key.cmd0 = (uint8)MT_RPC_CMD_AREQ | sys;
+  key.cmd1 = 0x81;
+  key.known = known;
+  key.endpoint = 8;
+  key.profileId = 0x0104;
+  key.clusterId = clusterId;
+  key.srcAddr = 0x1234;
+
+  return MT_UtilCbFilter( &key );
+}
+
+/*
+ * The callback filter over MT: short frames get MT_RPC_ERR_LENGTH, a rule
+ * for a callback the filter does not see is refused, and the counters of
+ * MT_UTIL_CB_FILTER_STATS follow the callbacks that went through it.
+ */
+static void testUartCbFilter( void )
+{
+  uint8 rule[TEST_CBF_SET_LEN] = {
+    0, MT_UTIL_CB_FILTER_PASS, (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_AF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x00, 0x01, 0xFF, 0x01, 0x00, 0x00, 0x00, 0x00 };
+  uint8 arg;
+  uint8 *pStat = testUartRsp + MT_RPC_POS_DAT0;
+
+  testUartMtBoot( "test_uart_cbf.bin" );
+
+  // Frames too short for their command
+  testUartUtil( MT_UTIL_CB_FILTER_RESET, 0, NULL );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_RESET, MT_RPC_ERR_LENGTH );
+  testUartUtil( MT_UTIL_CB_FILTER_STATS, 0, NULL );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_STATS, MT_RPC_ERR_LENGTH );
+  testUartUtil( MT_UTIL_CB_FILTER_SET, sizeof( rule ) - 1, rule );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_SET, MT_RPC_ERR_LENGTH );
+
+  // Drop all but the AF callbacks of clusters 0x0100-0x01FF.
+  arg = 0;
+  testUartUtil( MT_UTIL_CB_FILTER_RESET, 1, &arg );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_RESET, ZInvalidParameter );
+  arg = MT_UTIL_CB_FILTER_DROP;
+  testUartUtil( MT_UTIL_CB_FILTER_RESET, 1, &arg );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_RESET, ZSuccess );
+  testUartUtil( MT_UTIL_CB_FILTER_SET, sizeof( rule ), rule );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_SET, ZSuccess );
+
+  // No callback of MT_SYS goes through the filter.
+  rule[0] = 1;
+  rule[2] = (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS;
+  testUartUtil( MT_UTIL_CB_FILTER_SET, sizeof( rule ), rule );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_SET, ZInvalidParameter );
+
+  OSAL_TEST_CHECK( testUartCb( MT_RPC_SYS_AF, MT_UTIL_CB_KEY_EP | MT_UTIL_CB_KEY_CLUSTER, 0x0150 ) );
+  OSAL_TEST_CHECK( !testUartCb( MT_RPC_SYS_AF, MT_UTIL_CB_KEY_EP | MT_UTIL_CB_KEY_CLUSTER, 0x0200 ) );
+  // A confirm has no cluster, so the rule does not match it.
+  OSAL_TEST_CHECK( !testUartCb( MT_RPC_SYS_AF, MT_UTIL_CB_KEY_EP, 0x0150 ) );
+  OSAL_TEST_CHECK( !testUartCb( MT_RPC_SYS_ZDO, MT_UTIL_CB_KEY_CLUSTER, 0x0150 ) );
+
+  // | status | default | pass(4) | drop(4) | rule count | match count(2) per rule |
+  arg = TRUE;
+  testUartUtil( MT_UTIL_CB_FILTER_STATS, 1, &arg );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_STATS, ZSuccess );
+  OSAL_TEST_CHECK( (pStat[1] == MT_UTIL_CB_FILTER_DROP) && (osal_build_uint32( pStat + 2, 4 ) == 1) &&
+                   (osal_build_uint32( pStat + 6, 4 ) == 3) && (pStat[10] == MT_UTIL_CB_FILTER_MAX) );
+  OSAL_TEST_CHECK( (osal_build_uint16( pStat + 11 ) == 1) && (osal_build_uint16( pStat + 13 ) == 0) );
+
+  // Cleared once reported
+  testUartUtil( MT_UTIL_CB_FILTER_STATS, 1, &arg );
+  OSAL_TEST_CHECK( (osal_build_uint32( pStat + 2, 4 ) == 0) && (osal_build_uint32( pStat + 6, 4 ) == 0) &&
+                   (osal_build_uint16( pStat + 11 ) == 0) );
+
+  // Back to passing everything
+  arg = MT_UTIL_CB_FILTER_PASS;
+  testUartUtil( MT_UTIL_CB_FILTER_RESET, 1, &arg );
+  testUartUtilRsp( MT_UTIL_CB_FILTER_RESET, ZSuccess );
+  OSAL_TEST_CHECK( testUartCb( MT_RPC_SYS_ZDO, MT_UTIL_CB_KEY_CLUSTER, 0x0150 ) );
+  OSAL_TEST_CHECK( testUartCb( MT_RPC_SYS_AF, MT_UTIL_CB_KEY_EP | MT_UTIL_CB_KEY_CLUSTER, 0x0200 ) );
+}
+
+/*
+ * A frame arrives whole whichever of its bytes is the first after the end
+ * of the Rx ring, so that HalUARTPeek() lends it in two spans.
+ */
+static void testUartWrap( void )
+{
+  uint8 frame[SPI_0DATA_MSG_LEN + TEST_UART_DATA_MAX];
+  uint8 pad[HAL_POSIX_UART_RX_MAX];
+  halPosixUartStat_t stat;
+  uint16 used;
+  uint8 len, pos;
+
+  testUartBoot( "test_uart_wrap.bin" );
+  (void)memset( pad, 0, sizeof( pad ) );
+  len = testUartFrame( frame, 0x21, 20 );
+  used = osal_heap_mem_used();
+
+  for ( pos = 1; pos < len; pos++ )
+  {
+    uint16 head, padLen;
+
+    // Bytes that are not frames move the head of the ring to 'pos' bytes before its end.
+    halPosixUartGetStat( MT_UART_DEFAULT_PORT, &stat, FALSE );
+    head = (uint16)(stat.rxCnt % HAL_POSIX_UART_RX_MAX);
+    padLen = (2 * HAL_POSIX_UART_RX_MAX - pos - head) % HAL_POSIX_UART_RX_MAX;
+    if ( padLen != 0 )
+    {
+      testUartSend( pad, padLen );
+    }
+    OSAL_TEST_CHECK( testUartMsgCnt == pos - 1 );
+
+    testUartSend( frame, len );
+    OSAL_TEST_CHECK( testUartMsgCnt == pos );
+    testUartCheck( pos - 1, frame );
+  }
+
+  halPosixUartGetStat( MT_UART_DEFAULT_PORT, &stat, FALSE );
+  OSAL_TEST_CHECK( stat.rxHeld == 0 );
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+}
+
+/*
+ * A frame that fails its FCS is dropped, and the frames after it, sent
+ * with it, still arrive.
+ */
+static void testUartBadFcs( void )
+{
+  uint8 buf[4 * (SPI_0DATA_MSG_LEN + TEST_UART_DATA_MAX)];
+  uint8 *pA, *pB, *pC, *pD;
+  uint16 used;
+  uint8 len;
+
+  testUartBoot( "test_uart_fcs.bin" );
+  used = osal_heap_mem_used();
+
+  pA = buf;
+  len = testUartFrame( pA, 0x31, 12 );
+  pA[len - 1] ^= 0x01;
+  pB = pA + len;
+  len = testUartFrame( pB, 0x32, 0 );
+  pC = pB + len;
+  len = testUartFrame( pC, 0x33, 30 );
+  pC[SPI_0DATA_MSG_LEN + 3] ^= 0x10;
+  pD = pC + len;
+  len = testUartFrame( pD, 0x34, 5 );
+
+  testUartSend( buf, (uint16)(pD + len - buf) );
+  OSAL_TEST_CHECK( testUartMsgCnt == 2 );
+  testUartCheck( 0, pB );
+  testUartCheck( 1, pD );
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+}
+
+/*
+ * A frame cut short takes the bytes of the frames after it as the rest of
+ * its data, and fails its FCS; the parser then finds the next start of
+ * frame, and the frames after that arrive.
+ */
+static void testUartTruncated( void )
+{
+  uint8 buf[5 * (SPI_0DATA_MSG_LEN + TEST_UART_DATA_MAX)];
+  uint8 *pW, *pT, *pX, *pY, *pZ;
+  uint16 used;
+  uint8 len;
+
+  testUartBoot( "test_uart_cut.bin" );
+  used = osal_heap_mem_used();
+
+  // T says 30 data bytes but has 10: the 4th data byte of Y is taken as its FCS.
+  pW = buf;
+  len = testUartFrame( pW, 0x41, 6 );
+  pT = pW + len;
+  (void)testUartFrame( pT, 0x42, 30 );
+  len = 1 + MT_RPC_FRAME_HDR_SZ + 10;
+  pX = pT + len;
+  len = testUartFrame( pX, 0x43, 8 );
+  pY = pX + len;
+  len = testUartFrame( pY, 0x44, 9 );
+  pZ = pY + len;
+  len = testUartFrame( pZ, 0x45, 3 );
+
+  // The host sends the frames one at a time; T is still taking data when X and Y arrive.
+  testUartSend( pW, (uint16)(pT - pW) );
+  testUartSend( pT, (uint16)(pX - pT) );
+  OSAL_TEST_CHECK( testUartMsgCnt == 1 );
+  testUartSend( pX, (uint16)(pY - pX) );
+  testUartSend( pY, (uint16)(pZ - pY) );
+  OSAL_TEST_CHECK( testUartMsgCnt == 1 );
+  testUartSend( pZ, len );
+
+  OSAL_TEST_CHECK( testUartMsgCnt == 2 );
+  testUartCheck( 0, pW );
+  testUartCheck( 1, pZ );
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+}
+
+#if MT_PIPE_SUPPORT
+/*
+ * The events of MT, each request taking it TEST_PIPE_WORK_US: note how many
+ * requests are queued at it and whether the parser holds more back.
+ */
+static uint16 testPipeEvent( uint8 task_id, uint16 events )
+{
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 cnt = osal_msg_count( task_id, CMD_SERIAL_MSG );
+
+    if ( testPipeMax < cnt )
+    {
+      testPipeMax = cnt;
+    }
+    if ( (cnt == TEST_PIPE_WINDOW) && (Hal_UART_RxBufLen( MT_UART_DEFAULT_PORT ) != 0) )
+    {
+      testPipeHeld++;
+    }
+    osalPosixAdvance( TEST_PIPE_WORK_US );
+  }
+
+  return MT_ProcessEvent( task_id, events );
+}
+
+/*
+ * Put 'cnt' MT_SYS_PIPE_REQ frames of MT_SYS_PING in a row at pBuf, from
+ * sequence ID 'seq' on; returns their length.
+ */
+static uint16 testPipeFrames( uint8 *pBuf, uint8 seq, uint8 cnt )
+{
+  uint8 *pFrame = pBuf;
+
+  while ( cnt-- != 0 )
+  {
+    pFrame[1 + MT_RPC_POS_LEN] = TEST_PIPE_REQ_LEN;
+    pFrame[1 + MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS;
+    pFrame[1 + MT_RPC_POS_CMD1] = MT_SYS_PIPE_REQ;
+    pFrame[1 + MT_RPC_POS_DAT0] = seq++;
+    pFrame[1 + MT_RPC_POS_DAT0 + 1 + MT_RPC_POS_LEN] = 0;
+    pFrame[1 + MT_RPC_POS_DAT0 + 1 + MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS;
+    pFrame[1 + MT_RPC_POS_DAT0 + 1 + MT_RPC_POS_CMD1] = MT_SYS_PING;
+    pFrame += testUartSeal( pFrame );
+  }
+
+  return (uint16)(pFrame - pBuf);
+}
+
+/*
+ * The host sends bytes as fast as the Rx buffer takes them, then waits
+ * until MT has answered 'cnt' more pipelined requests.
+ */
+static void testPipePush( const uint8 *pBuf, uint16 len, uint8 cnt )
+{
+  uint8 done = testPipeSeqCnt + cnt;
+  uint16 ms;
+
+  for ( ms = 0; ((len != 0) || (testPipeSeqCnt < done)) && (ms < 1000); ms++ )
+  {
+    uint16 rx = halPosixUartRx( MT_UART_DEFAULT_PORT, pBuf, len );
+
+    pBuf += rx;
+    len -= rx;
+    osalPosixRun( 1 );
+  }
+  OSAL_TEST_CHECK( (len == 0) && (testPipeSeqCnt == done) );
+}
+
+/*
+ * With a window of 2, the host pushes 24 MT_SYS_PIPE_REQ at once, more than
+ * the Rx buffer holds: MT never has more than the window of them queued,
+ * the parser leaves the rest in the Rx buffer and the host is held off, and
+ * every request is answered, in order, with no more credits than the window.
+ * The port reopened while the parser holds frames back starts clean.
+ */
+static void testUartPipe( void )
+{
+  uint8 frame[SPI_0DATA_MSG_LEN + 1];
+  uint8 req[TEST_PIPE_CNT * (SPI_0DATA_MSG_LEN + TEST_PIPE_REQ_LEN)];
+  halPosixUartStat_t stat;
+  uint16 len, used;
+  uint8 idx, cnt;
+
+  testUartMtBoot( "test_uart_pipe.bin" );
+  osalTestEventCB = testPipeEvent;
+  testPipeSeqCnt = 0;
+  testPipeMax = 0;
+  testPipeHeld = 0;
+
+  // MT_SYS_PIPE_CFG: | window |, SRSP | status | window | credits |
+  frame[1 + MT_RPC_POS_LEN] = 1;
+  frame[1 + MT_RPC_POS_CMD0] = (uint8)MT_RPC_CMD_SREQ | (uint8)MT_RPC_SYS_SYS;
+  frame[1 + MT_RPC_POS_CMD1] = MT_SYS_PIPE_CFG;
+  frame[1 + MT_RPC_POS_DAT0] = TEST_PIPE_WINDOW;
+  testUartSreq( frame, testUartSeal( frame ) );
+  OSAL_TEST_CHECK( (testUartRsp[MT_RPC_POS_CMD1] == MT_SYS_PIPE_CFG) &&
+                   (testUartRsp[MT_RPC_POS_DAT0] == ZSuccess) &&
+                   (testUartRsp[MT_RPC_POS_DAT0 + 1] == TEST_PIPE_WINDOW) &&
+                   (testUartRsp[MT_RPC_POS_DAT0 + 2] == TEST_PIPE_WINDOW) );
+  used = osal_heap_mem_used();
+  halPosixUartGetStat( MT_UART_DEFAULT_PORT, &stat, TRUE );
+
+  len = testPipeFrames( req, 0, TEST_PIPE_CNT );
+  OSAL_TEST_CHECK( len > HAL_POSIX_UART_RX_MAX );
+  testPipePush( req, len, TEST_PIPE_CNT );
+
+  for ( idx = 0; idx < TEST_PIPE_CNT; idx++ )
+  {
+    OSAL_TEST_CHECK( testPipeSeq[idx] == idx );
+  }
+  halPosixUartGetStat( MT_UART_DEFAULT_PORT, &stat, TRUE );
+  OSAL_TEST_CHECK( (testPipeMax == TEST_PIPE_WINDOW) && (testPipeHeld != 0) && (stat.rxHeld != 0) );
+  OSAL_TEST_CHECK( Hal_UART_RxBufLen( MT_UART_DEFAULT_PORT ) == 0 );
+
+  // The port is reopened while frames are held back: those in the Rx buffer are lost, the
+  // requests MT has already queued are still answered, and the next ones are taken as sent.
+  len = testPipeFrames( req, TEST_PIPE_CNT, 8 );
+  OSAL_TEST_CHECK( halPosixUartRx( MT_UART_DEFAULT_PORT, req, len ) == len );
+  osalPosixRun( 1 );
+  OSAL_TEST_CHECK( Hal_UART_RxBufLen( MT_UART_DEFAULT_PORT ) != 0 );
+  MT_UartInit();
+  MT_UartRegisterTaskID( TEST_UART_APP_TASK );
+  osalPosixRun( 50 );
+  cnt = testPipeSeqCnt;
+  OSAL_TEST_CHECK( (cnt > TEST_PIPE_CNT) && (cnt <= TEST_PIPE_CNT + TEST_PIPE_WINDOW + 1) );
+
+  len = testPipeFrames( req, 2 * TEST_PIPE_CNT, 4 );
+  testPipePush( req, len, 4 );
+  for ( idx = 0; idx < 4; idx++ )
+  {
+    OSAL_TEST_CHECK( testPipeSeq[cnt + idx] == 2 * TEST_PIPE_CNT + idx );
+  }
+  OSAL_TEST_CHECK( (Hal_UART_RxBufLen( MT_UART_DEFAULT_PORT ) == 0) && (testPipeMax == TEST_PIPE_WINDOW) );
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+}
+#endif
+
+#if HAL_UART_TXQ
+/*
+ * MT sends more frames at once than the Tx queue holds: those it refuses
+ * go by the Tx buffer instead, ahead of the queue, and none is lost.
+ */
+static void testUartTxqFull( void )
+{
+  uint8 data[TEST_UART_DATA_MAX];
+  halUARTTxQStat_t qStat;
+  halPosixUartStat_t stat;
+  uint16 used;
+  uint8 cnt = HAL_POSIX_UART_TXQ_CNT + 4;
+  uint8 idx;
+
+  testUartBoot( "test_uart_txq.bin" );
+  halPosixUartSetTx( MT_UART_DEFAULT_PORT, testUartTx );
+  (void)memset( data, 0x5A, sizeof( data ) );
+  used = osal_heap_mem_used();
+
+  // The 4 frames past the queue fit in the Tx buffer together.
+  OSAL_TEST_CHECK( 4 * (SPI_0DATA_MSG_LEN + 10) <= HAL_POSIX_UART_TX_MAX );
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    MT_BuildAndSendZToolResponse( TEST_UART_CMD0, idx, 10, data );
+  }
+  HalUARTTxQStat( MT_UART_DEFAULT_PORT, &qStat, FALSE );
+  OSAL_TEST_CHECK( (qStat.depth == HAL_POSIX_UART_TXQ_CNT) && (qStat.drop == 4) );
+
+  halPosixUartFlush( MT_UART_DEFAULT_PORT );
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    OSAL_TEST_CHECK( testUartTxCnt[idx] == 1 );
+  }
+  HalUARTTxQStat( MT_UART_DEFAULT_PORT, &qStat, FALSE );
+  OSAL_TEST_CHECK( (qStat.depth == 0) && (qStat.sent == HAL_POSIX_UART_TXQ_CNT) );
+  halPosixUartGetStat( MT_UART_DEFAULT_PORT, &stat, FALSE );
+  OSAL_TEST_CHECK( stat.txRefused == 0 );
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+}
+#endif
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const osalTest_t osalTestsMtUart[] = {
+  { "mt_uart_wrap",      testUartWrap },
+  { "mt_uart_bad_fcs",   testUartBadFcs },
+  { "mt_uart_truncated", testUartTruncated },
+  { "mt_batch_loopback", testUartBatch },
+  { "mt_util_cb_filter", testUartCbFilter },
+#if MT_PIPE_SUPPORT
+  { "mt_pipe_credits",   testUartPipe },
+#endif
+#if HAL_UART_TXQ
+  { "mt_uart_txq_full",  testUartTxqFull },
+#endif
+  { NULL, NULL }
+};
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,550 @@
+/**************************************************************************************************
+  Filename:       test_nv.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Host tests of the CC2530 NV driver over the simulated flash,
+including resets and power cuts in the middle of flash writes.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Nv.h"
+#include "OSAL_Tasks.h"
+#include "ZComDef.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_NV_BASE       0x0500
+#define TEST_NV_CNT        60
+#define TEST_NV_LEN_MAX    64
+
+// The item being changed when the power was cut
+#define TEST_OP_NONE       0
+#define TEST_OP_WRITE      1
+#define TEST_OP_DELETE     2
+#define TEST_OP_CREATE     3
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// What NV is expected to hold
+static uint8 testData[TEST_NV_CNT][TEST_NV_LEN_MAX];
+static uint16 testLen[TEST_NV_CNT];
+
+// The change in progress: either it or the old contents may survive a power cut.
+static uint8 testOp;
+static uint8 testOpItem;
+static uint8 testOpData[TEST_NV_LEN_MAX];
+
+static jmp_buf testCutEnv;
+
+#if OSAL_NV_BG_COMPACT
+// Give the NV task a single pass after each operation, rather than a millisecond of them.
+static uint8 testNvStep;
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void testPowerCut( void )
+{
+  longjmp( testCutEnv, 1 );
+}
+
+/*
+ * Check NV against what it is expected to hold. An item changed by the
+ * operation cut short by a power cut may be either old or new; the
+ * model takes whichever survived.
+ */
+static void testNvCheck( void )
+{
+  uint8 buf[TEST_NV_LEN_MAX];
+  uint8 idx;
+
+  for ( idx = 0; idx < TEST_NV_CNT; idx++ )
+  {
+    uint16 len = osal_nv_item_len( TEST_NV_BASE + idx );
+
+    if ( (testOp != TEST_OP_NONE) && (idx == testOpItem) )
+    {
+      uint8 isOld, isNew;
+
+      isOld = (len == testLen[idx]) &&
+              ((len == 0) || ((osal_nv_read( TEST_NV_BASE + idx, 0, len, buf ) == SUCCESS) &&
+                              (memcmp( buf, testData[idx], len ) == 0)));
+
+      if ( testOp == TEST_OP_WRITE )
+      {
+        isNew = (len == testLen[idx]) &&
+                (osal_nv_read( TEST_NV_BASE + idx, 0, len, buf ) == SUCCESS) &&
+                (memcmp( buf, testOpData, len ) == 0);
+      }
+      else if ( testOp == TEST_OP_DELETE )
+      {
+        isNew = (len == 0);
+      }
+      else
+      {
+        isNew = (len != 0) && (osal_nv_read( TEST_NV_BASE + idx, 0, len, buf ) == SUCCESS);
+      }
+      OSAL_TEST_CHECK( isOld || isNew );
+
+      if ( isNew && !isOld )
+      {
+        testLen[idx] = len;
+        if ( len != 0 )
+        {
+          (void)osal_nv_read( TEST_NV_BASE + idx, 0, len, testData[idx] );
+        }
+      }
+      continue;
+    }
+
+    OSAL_TEST_CHECK( len == testLen[idx] );
+    if ( len != 0 )
+    {
+      OSAL_TEST_CHECK( osal_nv_read( TEST_NV_BASE + idx, 0, len, buf ) == SUCCESS );
+      OSAL_TEST_CHECK( memcmp( buf, testData[idx], len ) == 0 );
+    }
+  }
+
+  testOp = TEST_OP_NONE;
+}
+
+/*
+ * One random create, write or delete, applied to NV and then, once it
+ * is in flash, to the model.
+ */
+static void testNvOp( void )
+{
+  uint8 idx = osalTestRand() % TEST_NV_CNT;
+  uint16 ndx, cnt;
+  uint16 len;
+  uint16 k;
+
+  testOpItem = idx;
+
+  if ( testLen[idx] == 0 )
+  {
+    len = 4 + (osalTestRand() % 40);
+    for ( k = 0; k < len; k++ )
+    {
+      testOpData[k] = (uint8)osalTestRand();
+    }
+    testOp = TEST_OP_CREATE;
+    OSAL_TEST_CHECK( osal_nv_item_init( TEST_NV_BASE + idx, len, testOpData ) == NV_ITEM_UNINIT );
+  }
+  else if ( (osalTestRand() % 10) == 0 )
+  {
+    len = 0;
+    testOp = TEST_OP_DELETE;
+    OSAL_TEST_CHECK( osal_nv_delete( TEST_NV_BASE + idx, testLen[idx] ) == SUCCESS );
+  }
+  else
+  {
+    len = testLen[idx];
+    ndx = osalTestRand() % len;
+    osal_memcpy( testOpData, testData[idx], len );
+    cnt = 1 + (osalTestRand() % (len - ndx));
+    for ( k = ndx; k < ndx + cnt; k++ )
+    {
+      testOpData[k] = (uint8)osalTestRand();
+    }
+    testOp = TEST_OP_WRITE;
+    OSAL_TEST_CHECK( osal_nv_write( TEST_NV_BASE + idx, ndx, cnt, testOpData + ndx ) == SUCCESS );
+  }
+
+#if OSAL_NV_CACHE
+  // Written back at once, so that a power cut can only tear this operation.
+  OSAL_TEST_CHECK( osal_nv_flush() == SUCCESS );
+#endif
+#if OSAL_NV_BG_COMPACT
+  if ( testNvStep )
+  {
+    osal_run_system();
+  }
+  else
+  {
+    osalPosixRun( 1 );
+  }
+#endif
+
+  osal_memcpy( testData[idx], testOpData, len );
+  testLen[idx] = len;
+  testOp = TEST_OP_NONE;
+}
+
+/*
+ * Create, read, write and delete, and their failure cases.
+ */
+static void testNvItems( void )
+{
+  uint8 buf[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  uint8 rd[8];
+
+  remove( "test_nv_items.bin" );
+  osalTestBoot( "test_nv_items.bin" );
+
+  OSAL_TEST_CHECK( osal_nv_item_len( 0x0401 ) == 0 );
+  OSAL_TEST_CHECK( osal_nv_read( 0x0401, 0, 1, rd ) == NV_OPER_FAILED );
+  OSAL_TEST_CHECK( osal_nv_write( 0x0401, 0, 1, buf ) == NV_ITEM_UNINIT );
+  OSAL_TEST_CHECK( osal_nv_item_init( 0x0401, 8, buf ) == NV_ITEM_UNINIT );
+  OSAL_TEST_CHECK( osal_nv_item_init( 0x0401, 8, NULL ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_nv_item_len( 0x0401 ) == 8 );
+
+  OSAL_TEST_CHECK( osal_nv_write( 0x0401, 6, 4, buf ) == NV_OPER_FAILED );
+  OSAL_TEST_CHECK( osal_nv_write( 0x0401, 2, 2, buf ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_nv_read( 0x0401, 0, 8, rd ) == SUCCESS );
+  OSAL_TEST_CHECK( (rd[1] == 2) && (rd[2] == 1) && (rd[3] == 2) && (rd[4] == 5) );
+
+  OSAL_TEST_CHECK( osal_nv_delete( 0x0401, 7 ) == NV_BAD_ITEM_LEN );
+  OSAL_TEST_CHECK( osal_nv_delete( 0x0401, 8 ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_nv_item_len( 0x0401 ) == 0 );
+  OSAL_TEST_CHECK( osal_nv_delete( 0x0401, 8 ) == NV_ITEM_UNINIT );
+
+  // The Ids with the MSB set are reserved for the records of the NV driver.
+  OSAL_TEST_CHECK( osal_nv_item_init( 0x8401, 8, buf ) == NV_OPER_FAILED );
+  OSAL_TEST_CHECK( osal_nv_write( 0xFFFE, 0, 8, buf ) == NV_OPER_FAILED );
+  OSAL_TEST_CHECK( osal_nv_delete( 0xFFFD, 8 ) == NV_OPER_FAILED );
+}
+
+/*
+ * Random changes keep NV equal to the model, through page compactions
+ * and across resets, without programming any flash word more times
+ * between erases than the part allows.
+ */
+static void testNvModel( void )
+{
+  halPosixFlashStat_t stat;
+  uint16 iter;
+
+  remove( "test_nv_model.bin" );
+  osalTestBoot( "test_nv_model.bin" );
+  osalTestSeed( 11 );
+
+  for ( iter = 1; iter <= 6000; iter++ )
+  {
+    testNvOp();
+
+    if ( (iter % 500) == 0 )
+    {
+      testNvCheck();
+      osalTestBoot( "test_nv_model.bin" );
+      testNvCheck();
+    }
+  }
+
+  halPosixFlashGetStat( &stat, FALSE );
+  OSAL_TEST_CHECK( stat.overCnt == 0 );
+}
+
+/*
+ * A power cut in the middle of any flash write or erase loses at most
+ * the change being made.
+ */
+static void testNvPowerCut( void )
+{
+  halPosixFlashStat_t stat;
+  volatile uint16 iter;
+
+  remove( "test_nv_cut.bin" );
+  osalTestBoot( "test_nv_cut.bin" );
+  osalTestSeed( 16 );
+
+  for ( iter = 0; iter < 6000; iter++ )
+  {
+    if ( setjmp( testCutEnv ) != 0 )
+    {
+      osalTestBoot( "test_nv_cut.bin" );
+      testNvCheck();
+      continue;
+    }
+
+    if ( (osalTestRand() % 40) == 0 )
+    {
+      halPosixFlashCut( osalTestRand() % 40, testPowerCut );
+    }
+    testNvOp();
+  }
+
+  halPosixFlashCut( 0, NULL );
+  osalTestBoot( "test_nv_cut.bin" );
+  testNvCheck();
+
+  halPosixFlashGetStat( &stat, FALSE );
+  OSAL_TEST_CHECK( stat.cutCnt > 50 );
+  OSAL_TEST_CHECK( stat.overCnt == 0 );
+}
+
+#if OSAL_NV_BG_COMPACT
+/*
+ * Writes, creates and deletes interleaved with the steps of background
+ * compactions, one step after each, keep NV equal to the model, and the
+ * compacted pages hold it across a reset.
+ */
+static void testNvBgCompact( void )
+{
+  halPosixFlashStat_t stat;
+  uint16 during = 0;
+  uint16 iter;
+
+  remove( "test_nv_bg.bin" );
+  osalTestBoot( "test_nv_bg.bin" );
+  osalTestSeed( 23 );
+  halPosixFlashGetStat( &stat, TRUE );
+  testNvStep = TRUE;
+
+  for ( iter = 1; iter <= 4000; iter++ )
+  {
+    if ( tasksEvents[OSAL_TEST_TASK_CNT] & OSAL_NV_COMPACT_EVT )
+    {
+      during++;
+    }
+    testNvOp();
+
+    if ( (iter % 250) == 0 )
+    {
+      testNvCheck();
+    }
+  }
+
+  // Let the last compaction run to its end.
+  while ( tasksEvents[OSAL_TEST_TASK_CNT] & OSAL_NV_COMPACT_EVT )
+  {
+    osal_run_system();
+  }
+  testNvStep = FALSE;
+  testNvCheck();
+  osalTestBoot( "test_nv_bg.bin" );
+  testNvCheck();
+
+  halPosixFlashGetStat( &stat, FALSE );
+  OSAL_TEST_CHECK( (stat.eraseCnt >= 30) && (during >= 1000) );
+  OSAL_TEST_CHECK( stat.overCnt == 0 );
+}
+#endif
+
+#if OSAL_NV_TXN
+/*
+ * A transaction cut short at any flash write leaves either all of its
+ * items changed or none of them, and programs no flash word more times
+ * between erases than the part allows.
+ */
+static void testNvTxn( void )
+{
+  halPosixFlashStat_t stat;
+  uint8 buf[3][16];
+  uint8 rd[16];
+  volatile uint16 iter;
+  volatile uint8 committed;
+  uint16 commitCnt = 0;
+  uint8 idx, k, newCnt;
+
+  remove( "test_nv_txn.bin" );
+  osalTestBoot( "test_nv_txn.bin" );
+  osalTestSeed( 14 );
+
+  osal_memset( buf, 0, sizeof( buf ) );
+  for ( idx = 0; idx < 3; idx++ )
+  {
+    OSAL_TEST_CHECK( osal_nv_item_init( TEST_NV_BASE + idx, 16, buf[idx] ) == NV_ITEM_UNINIT );
+  }
+
+  for ( iter = 0; iter < 250; iter++ )
+  {
+    committed = FALSE;
+
+    if ( setjmp( testCutEnv ) == 0 )
+    {
+      halPosixFlashCut( osalTestRand() % 32, testPowerCut );
+
+      OSAL_TEST_CHECK( osal_nv_txn_begin() == SUCCESS );
+      for ( idx = 0; idx < 3; idx++ )
+      {
+        for ( k = 0; k < 16; k++ )
+        {
+          rd[k] = (uint8)(iter + 1);
+        }
+        OSAL_TEST_CHECK( osal_nv_write( TEST_NV_BASE + idx, 0, 16, rd ) == SUCCESS );
+      }
+      OSAL_TEST_CHECK( osal_nv_txn_commit() == SUCCESS );
+#if OSAL_NV_CACHE
+      OSAL_TEST_CHECK( osal_nv_flush() == SUCCESS );
+#endif
+      committed = TRUE;
+      halPosixFlashCut( 0, NULL );
+    }
+
+    osalTestBoot( "test_nv_txn.bin" );
+
+    newCnt = 0;
+    for ( idx = 0; idx < 3; idx++ )
+    {
+      OSAL_TEST_CHECK( osal_nv_read( TEST_NV_BASE + idx, 0, 16, rd ) == SUCCESS );
+      if ( memcmp( rd, buf[idx], 16 ) != 0 )
+      {
+        OSAL_TEST_CHECK( rd[0] == (uint8)(iter + 1) );
+        newCnt++;
+      }
+    }
+    OSAL_TEST_CHECK( (newCnt == 0) || (newCnt == 3) );
+    OSAL_TEST_CHECK( !committed || (newCnt == 3) );
+    commitCnt += (newCnt == 3);
+
+    if ( newCnt == 3 )
+    {
+      for ( idx = 0; idx < 3; idx++ )
+      {
+        osal_memset( buf[idx], (uint8)(iter + 1), 16 );
+      }
+    }
+  }
+
+  // Both outcomes were seen.
+  OSAL_TEST_CHECK( (commitCnt > 10) && (commitCnt < 240) );
+
+  halPosixFlashGetStat( &stat, FALSE );
+  OSAL_TEST_CHECK( stat.overCnt == 0 );
+}
+#endif
+
+#if OSAL_NV_CACHE
+/*
+ * A reset loses the cached writes that were not flushed, but not the
+ * startup option, which bypasses the cache.
+ */
+static void testNvCacheReset( void )
+{
+  uint8 val = 0;
+
+  remove( "test_nv_reset.bin" );
+  osalTestBoot( "test_nv_reset.bin" );
+
+  OSAL_TEST_CHECK( osal_nv_item_init( ZCD_NV_STARTUP_OPTION, 1, &val ) == NV_ITEM_UNINIT );
+  OSAL_TEST_CHECK( osal_nv_item_init( TEST_NV_BASE, 1, &val ) == NV_ITEM_UNINIT );
+
+  val = ZCD_STARTOPT_DEFAULT_NETWORK_STATE;
+  OSAL_TEST_CHECK( osal_nv_write( ZCD_NV_STARTUP_OPTION, 0, 1, &val ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_nv_write( TEST_NV_BASE, 0, 1, &val ) == SUCCESS );
+  osalTestBoot( "test_nv_reset.bin" );
+
+  OSAL_TEST_CHECK( osal_nv_read( ZCD_NV_STARTUP_OPTION, 0, 1, &val ) == SUCCESS );
+  OSAL_TEST_CHECK( val == ZCD_STARTOPT_DEFAULT_NETWORK_STATE );
+  OSAL_TEST_CHECK( osal_nv_read( TEST_NV_BASE, 0, 1, &val ) == SUCCESS );
+  OSAL_TEST_CHECK( val == 0 );
+
+  // What the reset paths do before SystemReset()
+  val = ZCD_STARTOPT_DEFAULT_NETWORK_STATE;
+  OSAL_TEST_CHECK( osal_nv_write( TEST_NV_BASE, 0, 1, &val ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_nv_flush() == SUCCESS );
+  osalTestBoot( "test_nv_reset.bin" );
+  OSAL_TEST_CHECK( osal_nv_read( TEST_NV_BASE, 0, 1, &val ) == SUCCESS );
+  OSAL_TEST_CHECK( val == ZCD_STARTOPT_DEFAULT_NETWORK_STATE );
+}
+#endif
+
+#if defined ( OSAL_NV_EXTENDED )
+/*
+ * Extended items are separate from the legacy ones and from each other.
+ */
+static void testNvExtended( void )
+{
+  uint8 buf[300];
+  uint8 rd[300];
+  uint16 k;
+
+  remove( "test_nv_ex.bin" );
+  osalTestBoot( "test_nv_ex.bin" );
+
+  for ( k = 0; k < sizeof( buf ); k++ )
+  {
+    buf[k] = (uint8)k;
+  }
+
+  OSAL_TEST_CHECK( osal_nv_item_init_ex( 2, 7, sizeof( buf ), buf ) == NV_ITEM_UNINIT );
+  OSAL_TEST_CHECK( osal_nv_item_init_ex( 2, 8, 4, buf ) == NV_ITEM_UNINIT );
+  OSAL_TEST_CHECK( osal_nv_item_len_ex( 2, 7 ) == sizeof( buf ) );
+  OSAL_TEST_CHECK( osal_nv_item_len_ex( 3, 7 ) == 0 );
+
+  OSAL_TEST_CHECK( osal_nv_write_ex( 2, 7, 290, 4, buf ) == SUCCESS );
+  osalTestBoot( "test_nv_ex.bin" );
+  OSAL_TEST_CHECK( osal_nv_read_ex( 2, 7, 0, sizeof( rd ), rd ) == SUCCESS );
+  OSAL_TEST_CHECK( (rd[289] == 33) && (rd[290] == 0) && (rd[293] == 3) && (rd[294] == 38) );
+
+  OSAL_TEST_CHECK( osal_nv_delete_ex( 2, 7, sizeof( buf ) ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_nv_item_len_ex( 2, 7 ) == 0 );
+  OSAL_TEST_CHECK( osal_nv_item_len_ex( 2, 8 ) == 4 );
+}
+#endif
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const osalTest_t osalTestsNv[] = {
+  { "nv_items",     testNvItems },
+  { "nv_model",     testNvModel },
+  { "nv_power_cut", testNvPowerCut },
+#if OSAL_NV_BG_COMPACT
+  { "nv_bg_compact", testNvBgCompact },
+#endif
+#if OSAL_NV_TXN
+  { "nv_txn",       testNvTxn },
+#endif
+#if OSAL_NV_CACHE
+  { "nv_cache_reset", testNvCacheReset },
+#endif
+#if defined ( OSAL_NV_EXTENDED )
+  { "nv_extended",  testNvExtended },
+#endif
+  { NULL, NULL }
+};
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,692 @@
+/**************************************************************************************************
+  Filename:       test_osal.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Host tests of the OSAL scheduler, messages, timers and heap.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_PwrMgr.h"
+#include "OSAL_Tasks.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Timers that fit the event bits of the test tasks, SYS_EVENT_MSG aside
+#define TEST_TIMER_CNT     (OSAL_TEST_TASK_CNT * 15)
+
+#define TEST_HEAP_SLOTS    32
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint32 testDue[OSAL_TEST_TASK_CNT][16];
+static uint32 testFired[OSAL_TEST_TASK_CNT][16];
+static uint16 testFireCnt;
+
+static uint8 testOrder[8];
+static uint8 testOrderCnt;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Power up on erased flash and let the clock catch up with the time
+ * that erasing it took, so that every run starts from the same state.
+ */
+static void testBoot( const char *flash )
+{
+  (void)remove( flash );
+  osalTestBoot( flash );
+  osalPosixRun( 1 );
+}
+
+static uint16 testMsgCount( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+  return events;
+}
+
+/*
+ * Messages sent to a task come back from osal_msg_receive() in order,
+ * behind any pushed to the front, and only to that task.
+ */
+static void testMsgQueue( void )
+{
+  uint8 *pMsg;
+  uint8 idx;
+
+  testBoot( "test_msg.bin" );
+  osalTestEventCB = testMsgCount;
+
+  for ( idx = 0; idx < 10; idx++ )
+  {
+    pMsg = osal_msg_allocate( sizeof( osal_event_hdr_t ) );
+    OSAL_TEST_CHECK( pMsg != NULL );
+    ((osal_event_hdr_t *)pMsg)->event = idx;
+    OSAL_TEST_CHECK( osal_msg_send( idx % 2, pMsg ) == SUCCESS );
+  }
+
+  pMsg = osal_msg_allocate( sizeof( osal_event_hdr_t ) );
+  ((osal_event_hdr_t *)pMsg)->event = 99;
+  OSAL_TEST_CHECK( osal_msg_push_front( 1, pMsg ) == SUCCESS );
+
+  OSAL_TEST_CHECK( osal_msg_count( 0, 0xFF ) == 5 );
+  OSAL_TEST_CHECK( osal_msg_count( 1, 0xFF ) == 6 );
+  OSAL_TEST_CHECK( osal_msg_count( 2, 0xFF ) == 0 );
+  OSAL_TEST_CHECK( osal_msg_find( 1, 7 ) != NULL );
+  OSAL_TEST_CHECK( osal_msg_find( 0, 7 ) == NULL );
+
+  pMsg = osal_msg_receive( 1 );
+  OSAL_TEST_CHECK( ((osal_event_hdr_t *)pMsg)->event == 99 );
+  (void)osal_msg_deallocate( pMsg );
+
+  for ( idx = 0; idx < 10; idx++ )
+  {
+    pMsg = osal_msg_receive( idx % 2 );
+    OSAL_TEST_CHECK( (pMsg != NULL) && (((osal_event_hdr_t *)pMsg)->event == idx) );
+    (void)osal_msg_deallocate( pMsg );
+  }
+
+  OSAL_TEST_CHECK( osal_msg_receive( 0 ) == NULL );
+  OSAL_TEST_CHECK( osal_msg_receive( 1 ) == NULL );
+  OSAL_TEST_CHECK( !(tasksEvents[0] & SYS_EVENT_MSG) && !(tasksEvents[1] & SYS_EVENT_MSG) );
+  OSAL_TEST_CHECK( osal_msg_send( tasksCnt, osal_msg_allocate( 4 ) ) == INVALID_TASK );
+}
+
+static uint16 testOrderEvent( uint8 task_id, uint16 events )
+{
+  if ( testOrderCnt < sizeof( testOrder ) )
+  {
+    testOrder[testOrderCnt++] = task_id;
+  }
+  return 0;
+}
+
+/*
+ * Ready tasks are serviced in task priority order, whatever order
+ * their events were set in.
+ */
+static void testReadyOrder( void )
+{
+  testBoot( "test_ready.bin" );
+  osalTestEventCB = testOrderEvent;
+
+  (void)osal_set_event( 2, 0x0001 );
+  (void)osal_set_event( 0, 0x0001 );
+  (void)osal_set_event( 1, 0x0001 );
+  osalPosixRun( 1 );
+
+  OSAL_TEST_CHECK( testOrderCnt == 3 );
+  OSAL_TEST_CHECK( (testOrder[0] == 0) && (testOrder[1] == 1) && (testOrder[2] == 2) );
+  OSAL_TEST_CHECK( osal_set_event( tasksCnt, 0x0001 ) == INVALID_TASK );
+
+  // A main loop of its own, as the ZNP one, runs the first ready task after task 0 and then
+  // task 0; a task whose events were cleared behind the bitmap's back is skipped.
+  testOrderCnt = 0;
+  (void)osal_set_event( 0, 0x0001 );
+  (void)osal_set_event( 1, 0x0001 );
+  (void)osal_set_event( 2, 0x0001 );
+  tasksEvents[1] = 0;
+  OSAL_TEST_CHECK( osal_next_ready( 1 ) == 2 );
+  osal_run_task( 2 );
+  OSAL_TEST_CHECK( osal_next_ready( 0 ) == 0 );
+  osal_run_task( 0 );
+  OSAL_TEST_CHECK( osal_next_ready( 0 ) == TASK_NO_TASK );
+  OSAL_TEST_CHECK( (testOrderCnt == 2) && (testOrder[0] == 2) && (testOrder[1] == 0) );
+}
+
+static uint16 testTimerEvent( uint8 task_id, uint16 events )
+{
+  uint8 bit;
+
+  for ( bit = 0; bit < 15; bit++ )
+  {
+    if ( events & BV( bit ) )
+    {
+      testFired[task_id][bit] = osal_GetSystemClock();
+      testFireCnt++;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Every timer fires once, no earlier than its timeout and within a
+ * tick of it; stopped timers never fire.
+ */
+static void testTimers( void )
+{
+  uint8 task;
+  uint8 bit;
+  uint16 stopped = 0;
+
+  testBoot( "test_timers.bin" );
+  osalTestEventCB = testTimerEvent;
+  osalTestSeed( 2 );
+
+  for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+  {
+    for ( bit = 0; bit < 15; bit++ )
+    {
+      uint32 timeout = 1 + (osalTestRand() % 5000);
+
+      testDue[task][bit] = osal_GetSystemClock() + timeout;
+      OSAL_TEST_CHECK( osal_start_timerEx( task, BV( bit ), timeout ) == SUCCESS );
+    }
+  }
+  OSAL_TEST_CHECK( osal_timer_num_active() == TEST_TIMER_CNT );
+  OSAL_TEST_CHECK( osal_get_timeoutEx( 1, BV( 3 ) ) == testDue[1][3] - osal_GetSystemClock() );
+
+  // Restarting a timer moves its deadline rather than adding a second one.
+  testDue[2][0] = osal_GetSystemClock() + 6000;
+  OSAL_TEST_CHECK( osal_start_timerEx( 2, BV( 0 ), 6000 ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_timer_num_active() == TEST_TIMER_CNT );
+
+  for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+  {
+    for ( bit = 1; bit < 15; bit += 4 )
+    {
+      OSAL_TEST_CHECK( osal_stop_timerEx( task, BV( bit ) ) == SUCCESS );
+      testDue[task][bit] = 0;
+      stopped++;
+    }
+  }
+  OSAL_TEST_CHECK( osal_stop_timerEx( 0, BV( 1 ) ) == INVALID_EVENT_ID );
+  OSAL_TEST_CHECK( osal_get_timeoutEx( 0, BV( 1 ) ) == 0 );
+
+  osalPosixRun( 7000 );
+
+  OSAL_TEST_CHECK( testFireCnt == TEST_TIMER_CNT - stopped );
+  OSAL_TEST_CHECK( osal_timer_num_active() == 0 );
+  for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+  {
+    for ( bit = 0; bit < 15; bit++ )
+    {
+      if ( testDue[task][bit] == 0 )
+      {
+        OSAL_TEST_CHECK( testFired[task][bit] == 0 );
+      }
+      else
+      {
+        OSAL_TEST_CHECK( testFired[task][bit] >= testDue[task][bit] );
+        OSAL_TEST_CHECK( testFired[task][bit] <= testDue[task][bit] + 1 );
+      }
+    }
+  }
+}
+
+static uint16 testReloadEvent( uint8 task_id, uint16 events )
+{
+  if ( events & 0x0001 )
+  {
+    testFireCnt++;
+  }
+  return 0;
+}
+
+/*
+ * A reload timer keeps firing at its period until it is stopped.
+ */
+static void testReloadTimer( void )
+{
+  testBoot( "test_reload.bin" );
+  osalTestEventCB = testReloadEvent;
+
+  OSAL_TEST_CHECK( osal_start_reload_timer( 0, 0x0001, 100 ) == SUCCESS );
+  osalPosixRun( 1050 );
+  OSAL_TEST_CHECK( testFireCnt == 10 );
+  OSAL_TEST_CHECK( osal_timer_num_active() == 1 );
+
+  OSAL_TEST_CHECK( osal_stop_timerEx( 0, 0x0001 ) == SUCCESS );
+  osalPosixRun( 1000 );
+  OSAL_TEST_CHECK( testFireCnt == 10 );
+}
+
+/*
+ * A timeout of 2^31 ms or more is shortened to 2^31 - 1 ms instead of
+ * expiring at once.
+ */
+static void testTimerRange( void )
+{
+  testBoot( "test_timer_range.bin" );
+  osalTestEventCB = testReloadEvent;
+
+  OSAL_TEST_CHECK( osal_start_timerEx( 0, 0x0001, 0xFFFFFFFFUL ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_start_reload_timer( 1, 0x0001, 0x80000000UL ) == SUCCESS );
+  osalPosixRun( 1000 );
+  OSAL_TEST_CHECK( testFireCnt == 0 );
+  OSAL_TEST_CHECK( osal_get_timeoutEx( 0, 0x0001 ) > 0x7FFFFFFFUL - 1100 );
+  OSAL_TEST_CHECK( osal_get_timeoutEx( 0, 0x0001 ) <= 0x7FFFFFFFUL - 1000 );
+  OSAL_TEST_CHECK( osal_get_timeoutEx( 1, 0x0001 ) > 0x7FFFFFFFUL - 1100 );
+}
+
+/*
+ * Random allocations and frees keep their contents and, once all are
+ * freed, give the whole heap back.
+ */
+static void testHeap( void )
+{
+  uint8 *pBlk[TEST_HEAP_SLOTS];
+  uint16 len[TEST_HEAP_SLOTS];
+  uint16 iter;
+  uint8 idx;
+  uint16 k;
+#if ( OSALMEM_METRICS )
+  uint16 used;
+#endif
+
+  testBoot( "test_heap.bin" );
+  osalTestSeed( 4 );
+  osal_memset( pBlk, 0, sizeof( pBlk ) );
+#if ( OSALMEM_METRICS )
+  used = osal_heap_mem_used();
+#endif
+
+  for ( iter = 0; iter < 20000; iter++ )
+  {
+    idx = osalTestRand() % TEST_HEAP_SLOTS;
+
+    if ( pBlk[idx] != NULL )
+    {
+      for ( k = 0; k < len[idx]; k++ )
+      {
+        OSAL_TEST_CHECK( pBlk[idx][k] == (uint8)(idx + k) );
+      }
+      osal_mem_free( pBlk[idx] );
+      pBlk[idx] = NULL;
+    }
+    else
+    {
+      len[idx] = 1 + (osalTestRand() % ((idx < 24) ? 40 : 200));
+      pBlk[idx] = osal_mem_alloc( len[idx] );
+      if ( pBlk[idx] != NULL )
+      {
+        for ( k = 0; k < len[idx]; k++ )
+        {
+          pBlk[idx][k] = (uint8)(idx + k);
+        }
+      }
+    }
+  }
+
+  for ( idx = 0; idx < TEST_HEAP_SLOTS; idx++ )
+  {
+    if ( pBlk[idx] != NULL )
+    {
+      osal_mem_free( pBlk[idx] );
+    }
+  }
+#if ( OSALMEM_METRICS )
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+#endif
+}
+
+#if ( OSAL_MSG_POOLS )
+// Blocks of all the message pools together.
+#define TEST_POOL_BLK_CNT  (OSAL_MSG_POOL_SMALL_CNT + OSAL_MSG_POOL_MEDIUM_CNT + OSAL_MSG_POOL_LARGE_CNT)
+
+/*
+ * An exhausted pool falls back to the larger pools, and to the heap once
+ * they are exhausted too, and counts it.
+ */
+static void testMsgPools( void )
+{
+  uint8 *pMsg[TEST_POOL_BLK_CNT + 1];
+  osalMsgPoolStat_t stat;
+  uint8 idx;
+
+  testBoot( "test_pools.bin" );
+
+  for ( idx = 0; idx <= TEST_POOL_BLK_CNT; idx++ )
+  {
+    pMsg[idx] = osal_msg_allocate( OSAL_MSG_POOL_SMALL_LEN );
+    OSAL_TEST_CHECK( pMsg[idx] != NULL );
+
+    if ( idx == OSAL_MSG_POOL_SMALL_CNT )
+    {
+      // The first small message over the pool's count is served by the medium pool.
+      OSAL_TEST_CHECK( osal_msg_pool_stat( OSAL_MSG_POOL_MEDIUM, &stat ) == SUCCESS );
+      OSAL_TEST_CHECK( (stat.used == 1) && (stat.fallback == 0) );
+    }
+  }
+
+  OSAL_TEST_CHECK( osal_msg_pool_stat( OSAL_MSG_POOL_SMALL, &stat ) == SUCCESS );
+  OSAL_TEST_CHECK( (stat.used == OSAL_MSG_POOL_SMALL_CNT) &&
+                   (stat.fallback == TEST_POOL_BLK_CNT + 1 - OSAL_MSG_POOL_SMALL_CNT) );
+  OSAL_TEST_CHECK( osal_msg_pool_stat( OSAL_MSG_POOL_MEDIUM, &stat ) == SUCCESS );
+  OSAL_TEST_CHECK( stat.used == OSAL_MSG_POOL_MEDIUM_CNT );
+  OSAL_TEST_CHECK( osal_msg_pool_stat( OSAL_MSG_POOL_LARGE, &stat ) == SUCCESS );
+  OSAL_TEST_CHECK( stat.used == OSAL_MSG_POOL_LARGE_CNT );
+
+  for ( idx = 0; idx <= TEST_POOL_BLK_CNT; idx++ )
+  {
+    OSAL_TEST_CHECK( osal_msg_deallocate( pMsg[idx] ) == SUCCESS );
+  }
+
+  for ( idx = 0; idx < OSAL_MSG_POOL_CNT; idx++ )
+  {
+    OSAL_TEST_CHECK( osal_msg_pool_stat( idx, &stat ) == SUCCESS );
+    OSAL_TEST_CHECK( stat.used == 0 );
+  }
+  OSAL_TEST_CHECK( osal_msg_pool_stat( OSAL_MSG_POOL_SMALL, &stat ) == SUCCESS );
+  OSAL_TEST_CHECK( stat.maxUsed == OSAL_MSG_POOL_SMALL_CNT );
+}
+#endif
+
+#if ( OSAL_MSG_SHARED )
+static uint16 testSharedEvent( uint8 task_id, uint16 events )
+{
+  uint8 *pMsg;
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+      OSAL_TEST_CHECK( ((osal_event_hdr_t *)pMsg)->event == 0x42 );
+      testFireCnt++;
+      if ( task_id == 0 )
+      {
+        // Forward it; the send takes its own reference, so ours is still dropped below.
+        OSAL_TEST_CHECK( osal_msg_send( OSAL_TEST_TASK_CNT - 1, pMsg ) == SUCCESS );
+      }
+      (void)osal_msg_deallocate( pMsg );
+    }
+    return ( events ^ SYS_EVENT_MSG );
+  }
+  return 0;
+}
+
+/*
+ * One shared message reaches every task, plus a second time the task
+ * that it is forwarded to, and is freed by the last receiver to
+ * deallocate it.
+ */
+static void testMsgShared( void )
+{
+  uint8 *pMsg;
+  uint8 task;
+#if ( OSALMEM_METRICS )
+  uint16 used;
+#endif
+
+  testBoot( "test_shared.bin" );
+  osalTestEventCB = testSharedEvent;
+#if ( OSALMEM_METRICS )
+  used = osal_heap_mem_used();
+#endif
+
+  pMsg = osal_msg_allocate_shared( sizeof( osal_event_hdr_t ) );
+  OSAL_TEST_CHECK( pMsg != NULL );
+  ((osal_event_hdr_t *)pMsg)->event = 0x42;
+  for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+  {
+    OSAL_TEST_CHECK( osal_msg_send( task, pMsg ) == SUCCESS );
+  }
+  OSAL_TEST_CHECK( osal_msg_deallocate( pMsg ) == SUCCESS );
+
+  osalPosixRun( 1 );
+  OSAL_TEST_CHECK( testFireCnt == OSAL_TEST_TASK_CNT + 1 );
+#if ( OSALMEM_METRICS )
+  OSAL_TEST_CHECK( osal_heap_mem_used() == used );
+#endif
+}
+#endif
+
+#if ( OSALMEM_SITE_TAGS )
+/*
+ * osal_heap_map() reports a block by the line that allocated it, and a
+ * block from the osal_mem_alloc() function rather than the macro by the
+ * unknown site.
+ */
+static void testHeapSites( void )
+{
+  void *(*pfnAlloc)( uint16 size ) = osal_mem_alloc;
+  osalMemMap_t map;
+  uint8 *pTagged;
+  uint8 *pUnknown;
+  uint16 line;
+  uint8 found = 0;
+  uint8 idx;
+
+  testBoot( "test_heap_sites.bin" );
+
+  line = __LINE__ + 1;
+  pTagged = osal_mem_alloc( 200 );
+  pUnknown = pfnAlloc( 300 );
+  OSAL_TEST_CHECK( (pTagged != NULL) && (pUnknown != NULL) );
+
+  osal_heap_map( &map );
+  for ( idx = 0; idx < map.siteCnt && idx < OSALMEM_MAP_SITES; idx++ )
+  {
+    if ( (map.site[idx].file == OSALMEM_SITE_FILE) && (map.site[idx].line == line) )
+    {
+      found |= 0x01;
+    }
+    else if ( (map.site[idx].file == OSALMEM_SITE_UNKNOWN_FILE) &&
+              (map.site[idx].line == OSALMEM_SITE_UNKNOWN_LINE) )
+    {
+      OSAL_TEST_CHECK( map.site[idx].blkCnt == 1 );
+      found |= 0x02;
+    }
+  }
+  OSAL_TEST_CHECK( found == 0x03 );
+
+  osal_mem_free( pTagged );
+  osal_mem_free( pUnknown );
+}
+#endif
+
+#if ( OSAL_PROFILE )
+static uint16 testProfileEvent( uint8 task_id, uint16 events )
+{
+  osalPosixAdvance( 3200 );
+  return 0;
+}
+
+/*
+ * The profile charges each handler run to its task.
+ */
+static void testProfile( void )
+{
+  osalProfileStat_t stat;
+
+  testBoot( "test_profile.bin" );
+  osalTestEventCB = testProfileEvent;
+  osal_profile_reset();
+
+  (void)osal_set_event( 1, 0x0004 );
+  osalPosixRun( 10 );
+
+  OSAL_TEST_CHECK( osal_profile_get( 1, &stat ) == SUCCESS );
+  OSAL_TEST_CHECK( (stat.runCnt == 1) && (stat.runTime >= 10) && (stat.maxRunTime >= 10) );
+  OSAL_TEST_CHECK( osal_profile_get( 0, &stat ) == SUCCESS );
+  OSAL_TEST_CHECK( stat.runCnt == 0 );
+}
+#endif
+
+/*
+ * Timers whose slack windows overlap expire together, in one wakeup
+ * of a battery device, at the latest common deadline.
+ */
+static void testTimerSlack( void )
+{
+  osalPosixStat_t stat;
+  uint32 start;
+
+  testBoot( "test_slack.bin" );
+  osalTestEventCB = testTimerEvent;
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+  start = osal_GetSystemClock();
+
+  OSAL_TEST_CHECK( osal_start_timerSlackEx( 0, BV( 0 ), 1000, 300 ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_start_timerSlackEx( 1, BV( 0 ), 1200, 200 ) == SUCCESS );
+  OSAL_TEST_CHECK( osal_start_timerEx( 2, BV( 0 ), 1250 ) == SUCCESS );
+  osalPosixGetStat( &stat, TRUE );
+  osalPosixRun( 2000 );
+
+  OSAL_TEST_CHECK( testFireCnt == 3 );
+  OSAL_TEST_CHECK( testFired[0][0] == testFired[2][0] );
+  OSAL_TEST_CHECK( testFired[1][0] == testFired[2][0] );
+  OSAL_TEST_CHECK( (testFired[2][0] >= start + 1250) && (testFired[2][0] <= start + 1251) );
+}
+
+/*
+ * With random slack timers, osal_next_timeout() is the end of the
+ * earliest window among the timers due before that end - the same
+ * answer as visiting every timer in deadline order.
+ */
+static void testTimerSlackNext( void )
+{
+  uint16 slack[OSAL_TEST_TASK_CNT][15];
+  uint16 iter;
+  uint8 task;
+  uint8 bit;
+
+  testBoot( "test_slack_next.bin" );
+  osalTestSeed( 5 );
+
+  for ( iter = 0; iter < 400; iter++ )
+  {
+    uint16 cnt = 1 + (osalTestRand() % TEST_TIMER_CNT);
+    uint32 expect = 0xFFFFFFFFUL;
+    uint32 due = 0;
+
+    // Vary the count so that the last heap slot is sometimes a left child
+    osal_memset( testDue, 0, sizeof( testDue ) );
+    for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+    {
+      for ( bit = 0; (bit < 15) && (cnt != 0); bit++, cnt-- )
+      {
+        uint32 timeout = 1 + (osalTestRand() % 5000);
+
+        slack[task][bit] = (osalTestRand() & 1) ? (osalTestRand() % 2000) : 0;
+        testDue[task][bit] = timeout;
+        OSAL_TEST_CHECK( osal_start_timerSlackEx( task, BV( bit ), timeout,
+                                                  slack[task][bit] ) == SUCCESS );
+      }
+    }
+
+    // Visit the timers in deadline order until one is due after the best window end
+    for ( ;; )
+    {
+      uint32 next = 0xFFFFFFFFUL;
+
+      for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+      {
+        for ( bit = 0; bit < 15; bit++ )
+        {
+          if ( (testDue[task][bit] > due) && (testDue[task][bit] < next) )
+          {
+            next = testDue[task][bit];
+          }
+        }
+      }
+      if ( (next == 0xFFFFFFFFUL) || (next >= expect) )
+      {
+        break;
+      }
+      for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+      {
+        for ( bit = 0; bit < 15; bit++ )
+        {
+          if ( (testDue[task][bit] == next) && (next + slack[task][bit] < expect) )
+          {
+            expect = next + slack[task][bit];
+          }
+        }
+      }
+      due = next;
+    }
+
+    OSAL_TEST_CHECK( osal_next_timeout() == expect );
+
+    for ( task = 0; task < OSAL_TEST_TASK_CNT; task++ )
+    {
+      for ( bit = 0; bit < 15; bit++ )
+      {
+        if ( testDue[task][bit] != 0 )
+        {
+          OSAL_TEST_CHECK( osal_stop_timerEx( task, BV( bit ) ) == SUCCESS );
+        }
+      }
+    }
+    OSAL_TEST_CHECK( osal_timer_num_active() == 0 );
+  }
+}
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const osalTest_t osalTestsOsal[] = {
+  { "msg_queue",    testMsgQueue },
+  { "ready_order",  testReadyOrder },
+  { "timers",       testTimers },
+  { "reload_timer", testReloadTimer },
+  { "timer_slack",  testTimerSlack },
+  { "timer_slack_next", testTimerSlackNext },
+  { "timer_range",  testTimerRange },
+  { "heap",         testHeap },
+#if ( OSAL_MSG_POOLS )
+  { "msg_pools",    testMsgPools },
+#endif
+#if ( OSAL_MSG_SHARED )
+  { "msg_shared",   testMsgShared },
+#endif
+#if ( OSALMEM_SITE_TAGS )
+  { "heap_sites",   testHeapSites },
+#endif
+#if ( OSAL_PROFILE )
+  { "profile",      testProfile },
+#endif
+  { NULL, NULL }
+};
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,272 @@
+/**************************************************************************************************
+  Filename:       test_ota.c
+  Revised:        $Date$
+  Revision:       $Revision$
+
+  Description:    Host tests of hal_ota.c on the SPI Xtra-NV model: the erase ahead
+of the download cursor and the page boundaries of the SPI writes.
+
+
+  Copyright 2014 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "hal_board_cfg.h"
+#include "hal_ota.h"
+#include "osal_posix.h"
+#include "osal_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// An OTA image block: not a divisor of a page, so that blocks straddle the pages.
+#define TEST_OTA_BLOCK     48
+
+// Air time between two blocks, in msecs: longer than a Page Erase.
+#define TEST_OTA_GAP_MS    15
+
+// The paced download runs past the first 64 KB sector of the Xtra-NV.
+#define TEST_OTA_PACED_END (0x10000UL + 4 * HAL_OTA_XNV_ERASE_SIZE)
+
+// Blocks paced before the erase is far enough ahead for the writes not to find it busy.
+#define TEST_OTA_RAMP_CNT  (2 * HAL_OTA_XNV_ERASE_AHEAD / TEST_OTA_BLOCK)
+
+// Blocks then written back to back, more than the erase ahead covers.
+#define TEST_OTA_RUSH_CNT  (2 * HAL_OTA_XNV_ERASE_AHEAD / TEST_OTA_BLOCK)
+
+#define TEST_OTA_PAGE      256
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Lengths of the writes of the page test, one after the other: within a page, across one
+// boundary, up to a boundary, one whole page, across two boundaries, and within a page again.
+static const uint16 testOtaLens[] = { 200, 120, 192, 256, 300, 60 };
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * The byte of the test image at an offset.
+ */
+static uint8 testOtaByte( uint32 oset )
+{
+  return (uint8)(oset * 7 + (oset >> 8) + 1);
+}
+
+static void testOtaFill( uint8 *buf, uint32 oset, uint16 len )
+{
+  while ( len-- )
+  {
+    *buf++ = testOtaByte( oset++ );
+  }
+}
+
+/*
+ * The SPI commands needed to write len bytes at oset, one per page touched.
+ */
+static uint16 testOtaPages( uint32 oset, uint16 len )
+{
+  return (uint16)((oset + len - 1) / TEST_OTA_PAGE - oset / TEST_OTA_PAGE + 1);
+}
+
+/*
+ * Read the DL image back through HalOTARead() and compare it.
+ */
+static void testOtaCheck( uint32 oset, uint32 end )
+{
+  uint8 buf[200], exp[200];
+  uint16 len;
+
+  for ( ; oset < end; oset += len )
+  {
+    len = (end - oset < sizeof( buf )) ? (uint16)(end - oset) : sizeof( buf );
+    HalOTARead( oset, buf, len, HAL_OTA_DL );
+    testOtaFill( exp, oset, len );
+    OSAL_TEST_CHECK( memcmp( buf, exp, len ) == 0 );
+  }
+}
+
+static void testOtaWrite( uint32 oset, uint16 len )
+{
+  uint8 buf[TEST_OTA_PAGE * 2];
+
+  OSAL_TEST_CHECK( len <= sizeof( buf ) );
+  testOtaFill( buf, oset, len );
+  HalOTAWrite( oset, buf, len, HAL_OTA_DL );
+}
+
+/*
+ * A download over an Xtra-NV full of an old image: paced by the air,
+ * HalOTAPoll() keeps the erase ahead of the cursor, across the 64 KB
+ * sector and every erase granule, and once it got ahead no block waits
+ * for an erase. Rushed, the writes wait for the erases they need. Either
+ * way nothing is programmed over unerased bits, and nothing is erased
+ * more than HAL_OTA_XNV_ERASE_AHEAD beyond the cursor.
+ */
+static void testOtaEraseAhead( void )
+{
+  halPosixXnvStat_t xnv;
+  halOTAStat_t ota;
+  uint32 oset, end;
+  uint16 progs = 0, stalls = 0;
+  uint8 ms, val;
+
+  osalTestBoot( "test_ota.bin" );
+  halPosixXnvFill( 0x00 );
+  HalOTAGetStat( &ota, TRUE );
+  halPosixXnvGetStat( &xnv, TRUE );
+
+  for ( oset = 0; oset < TEST_OTA_PACED_END; oset += TEST_OTA_BLOCK )
+  {
+    if ( oset == TEST_OTA_RAMP_CNT * TEST_OTA_BLOCK )
+    {
+      HalOTAGetStat( &ota, FALSE );
+      stalls = ota.writeStall;
+    }
+
+    testOtaWrite( oset, TEST_OTA_BLOCK );
+    progs += testOtaPages( oset, TEST_OTA_BLOCK );
+
+    for ( ms = 0; ms < TEST_OTA_GAP_MS; ms++ )
+    {
+      osalPosixAdvance( 1000 );
+      HalOTAPoll();
+    }
+  }
+  end = oset;
+
+  HalOTAGetStat( &ota, FALSE );
+  halPosixXnvGetStat( &xnv, FALSE );
+  OSAL_TEST_CHECK( (stalls >= 1) && (ota.writeStall == stalls) );
+  OSAL_TEST_CHECK( ota.readStall == 0 );
+  OSAL_TEST_CHECK( ota.progBytes == end );
+  OSAL_TEST_CHECK( ota.progCnt == progs );
+  OSAL_TEST_CHECK( xnv.progCnt == progs );
+  OSAL_TEST_CHECK( xnv.eraseCnt == ota.eraseCnt );
+  OSAL_TEST_CHECK( xnv.badCnt == 0 );
+  OSAL_TEST_CHECK( xnv.wrapCnt == 0 );
+
+  // Erased up to HAL_OTA_XNV_ERASE_AHEAD past the cursor, and not one granule more.
+  end = (end + HAL_OTA_XNV_ERASE_SIZE - 1) / HAL_OTA_XNV_ERASE_SIZE * HAL_OTA_XNV_ERASE_SIZE;
+  halPosixXnvPeek( end + HAL_OTA_XNV_ERASE_AHEAD - 1, &val, 1 );
+  OSAL_TEST_CHECK( val == 0xFF );
+  halPosixXnvPeek( end + HAL_OTA_XNV_ERASE_AHEAD, &val, 1 );
+  OSAL_TEST_CHECK( val == 0x00 );
+  testOtaCheck( 0, oset );
+
+  // Back to back, the writes catch up with the erase and wait for it.
+  for ( end = oset + TEST_OTA_RUSH_CNT * TEST_OTA_BLOCK; oset < end; oset += TEST_OTA_BLOCK )
+  {
+    testOtaWrite( oset, TEST_OTA_BLOCK );
+  }
+  HalOTAGetStat( &ota, FALSE );
+  OSAL_TEST_CHECK( ota.writeStall > 1 );
+  OSAL_TEST_CHECK( ota.progBytes == end );
+
+  // A read waits for the erase that a poll starts once the last block is programmed.
+  osalPosixAdvance( HAL_POSIX_XNV_PP_US );
+  HalOTAPoll();
+  testOtaCheck( 0, end );
+  HalOTAGetStat( &ota, FALSE );
+  OSAL_TEST_CHECK( ota.readStall == 1 );
+
+  halPosixXnvGetStat( &xnv, FALSE );
+  OSAL_TEST_CHECK( xnv.badCnt == 0 );
+  OSAL_TEST_CHECK( xnv.wrapCnt == 0 );
+}
+
+/*
+ * Writes that straddle the 256-byte pages of the Xtra-NV: HalSPIWrite()
+ * splits them into one command per page, so that no data wraps to the
+ * start of a page, both with Page Write once no download is going on
+ * and with Page Program into the pages erased ahead of a download.
+ */
+static void testOtaPageStraddle( void )
+{
+  halPosixXnvStat_t xnv;
+  uint32 base, oset;
+  uint32 progs;
+  uint8 pass, n;
+
+  osalTestBoot( "test_ota.bin" );
+
+  // Checking an erased Xtra-NV finds no image and ends any download.
+  halPosixXnvFill( 0xFF );
+  OSAL_TEST_CHECK( HalOTAChkDL( 0 ) == FAILURE );
+  halPosixXnvFill( 0x00 );
+
+  // Page Write away from the start of the image, then Page Program from a new download.
+  for ( pass = 0; pass < 2; pass++ )
+  {
+    base = (pass == 0) ? 0x1000 : 0;
+    halPosixXnvGetStat( &xnv, TRUE );
+    progs = 0;
+
+    for ( oset = base, n = 0; n < sizeof( testOtaLens ) / sizeof( testOtaLens[0] ); n++ )
+    {
+      testOtaWrite( oset, testOtaLens[n] );
+      progs += testOtaPages( oset, testOtaLens[n] );
+      halPosixXnvGetStat( &xnv, FALSE );
+      OSAL_TEST_CHECK( xnv.progCnt == progs );
+      oset += testOtaLens[n];
+    }
+
+    OSAL_TEST_CHECK( progs == 8 );
+    OSAL_TEST_CHECK( xnv.wrapCnt == 0 );
+    OSAL_TEST_CHECK( xnv.badCnt == 0 );
+    OSAL_TEST_CHECK( (pass == 0) == (xnv.eraseCnt == 0) );
+    testOtaCheck( base, oset );
+  }
+}
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const osalTest_t osalTestsOta[] = {
+  { "ota_erase_ahead",   testOtaEraseAhead },
+  { "ota_page_straddle", testOtaPageStraddle },
+  { NULL, NULL }
+};
+
+/*********************************************************************
+*********************************************************************/
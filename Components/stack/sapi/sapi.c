@@ -149,6 +149,10 @@ static void SAPI_AllowBindConfirm( uint16 source );
  */
 void zb_SystemReset ( void )
 {
+#if OSAL_NV_CACHE
+  // Restart with the configuration that zb_WriteConfiguration() may still hold in the NV cache.
+  (void)osal_nv_flush();
+#endif
   SystemResetSoft();  // Especially useful for CC2531 to not break comm with USB Host.
 }
 
@@ -42,6 +42,7 @@
  */
 #include "ZComDef.h"
 #include "OSAL.h"
+#include "OSAL_Nv.h"
 #include "zcl.h"
 #include "zcl_general.h"
 #include "zcl_ota.h"
@@ -2178,6 +2179,9 @@ static void zclOTA_UpgradeComplete ( uint8 status )
       // Reset the CRC Shadow and reboot.  The bootloader will see the
       // CRC shadow has been cleared and switch to the new image
       HalOTAInvRC();
+#if OSAL_NV_CACHE
+      (void)osal_nv_flush();
+#endif
       SystemReset();
     }
   }
@@ -558,6 +558,9 @@ UINT16 ZDApp_event_loop( uint8 task_id, UINT16 events )
     {
       // Set the NV startup option to force a "new" join.
       zgWriteStartupOptions( ZG_STARTUP_SET, ZCD_STARTOPT_DEFAULT_NETWORK_STATE );
+#if OSAL_NV_CACHE
+      (void)osal_nv_flush();  // The startup option must be in flash when the device restarts.
+#endif
 
       // The device has been in the UNAUTH state, so reset
       // Note: there will be no return from this call
@@ -1955,12 +1955,42 @@ uint8 ZDO_SendMsgCBs( zdoIncomingMsg_t *inMsg )
 {
   uint8 ret = FALSE;
   ZDO_MsgCB_t *pList = zdoMsgCBs;
+#if ( OSAL_MSG_SHARED )
+  zdoIncomingMsg_t *msgPtr = NULL;
+#endif
   while ( pList )
   {
     if ( (pList->clusterID == inMsg->clusterID)
        || ((pList->clusterID == ZDO_ALL_MSGS_CLUSTERID)
            && ((inMsg->clusterID & ZDO_RESPONSE_BIT) || (inMsg->clusterID == Device_annce))) )
     {
+#if ( OSAL_MSG_SHARED )
+      // One shared copy is built on the first match and delivered to every registered task.
+      // The ZDO_CB_MSG handlers only read it and then deallocate it; one that forwards it
+      // must still deallocate it after the send (see OSAL_MSG_SHARED_ID).
+      if ( msgPtr == NULL )
+      {
+        msgPtr = (zdoIncomingMsg_t *)osal_msg_allocate_shared( sizeof( zdoIncomingMsg_t ) +
+                                                               inMsg->asduLen );
+        if ( msgPtr )
+        {
+          osal_memcpy( msgPtr, inMsg, sizeof( zdoIncomingMsg_t ));
+
+          if ( inMsg->asduLen )
+          {
+            msgPtr->asdu = (byte*)(((byte*)msgPtr) + sizeof( zdoIncomingMsg_t ));
+            osal_memcpy( msgPtr->asdu, inMsg->asdu, inMsg->asduLen );
+          }
+
+          msgPtr->hdr.event = ZDO_CB_MSG;
+        }
+      }
+
+      if ( msgPtr && (osal_msg_send( pList->taskID, (uint8 *)msgPtr ) == SUCCESS) )
+      {
+        ret = TRUE;
+      }
+#else
       zdoIncomingMsg_t *msgPtr;
 
       // Send the address to the task
@@ -1980,9 +2010,18 @@ uint8 ZDO_SendMsgCBs( zdoIncomingMsg_t *inMsg )
         osal_msg_send( pList->taskID, (uint8 *)msgPtr );
         ret = TRUE;
       }
+#endif
     }
     pList = (ZDO_MsgCB_t *)pList->next;
   }
+
+#if ( OSAL_MSG_SHARED )
+  // Drop the reference held while sending; the receivers hold the rest
+  if ( msgPtr )
+  {
+    osal_msg_deallocate( (uint8 *)msgPtr );
+  }
+#endif
   return ( ret );
 }
 
@@ -111,7 +111,6 @@ uint16 *tasksEvents;
  *********************************************************************/
 
 void osal_start_znp(void);
-static void osal_run_task(uint8 idx);
 
 /*********************************************************************
  * @fn      osalInitTasks
@@ -184,19 +183,16 @@ void osal_start_znp( void )
 #endif
     Hal_ProcessPoll();
 
-    for (idx = 1; idx < tasksCnt; idx++)
+    idx = osal_next_ready(1);  // Highest priority ready task after the ZNP task.
+    if (idx < tasksCnt)
     {
-      if (tasksEvents[idx])
-      {
-        osal_run_task(idx);
+      osal_run_task(idx);
 #if defined( POWER_SAVING )
-        busy = TRUE;
+      busy = TRUE;
 #endif
-        break;
-      }
     }
 
-    if (tasksEvents[0])  // Always run the ZNP task.
+    if (osal_next_ready(0) == 0)  // Always run the ZNP task.
     {
       osal_run_task(0);
 #if defined( POWER_SAVING )
@@ -213,37 +209,5 @@ void osal_start_znp( void )
   }
 }
 
-/*********************************************************************
- * @fn      osal_run_task
- *
- * @brief
- *
- *   This function is the main loop function of the task system.  It
- *   will look through all task events and call the task_event_processor()
- *   function for the task with the event.  If there are no events (for
- *   all tasks), this function puts the processor into Sleep.
- *   This Function doesn't return.
- *
- * @param   void
- *
- * @return  none
- */
-static void osal_run_task(uint8 idx)
-{
-  uint16 events;
-  halIntState_t intState;
-
-  HAL_ENTER_CRITICAL_SECTION(intState);
-  events = tasksEvents[idx];
-  tasksEvents[idx] = 0;  // Clear the Events for this task.
-  HAL_EXIT_CRITICAL_SECTION(intState);
-
-  events = (tasksArr[idx])( idx, events );
-
-  HAL_ENTER_CRITICAL_SECTION(intState);
-  tasksEvents[idx] |= events;  // Add back unprocessed events to the current task.
-  HAL_EXIT_CRITICAL_SECTION(intState);
-}
-
 /*********************************************************************
 *********************************************************************/
@@ -89,6 +89,9 @@ static uint8* npMtSpiAlloc(uint8 cmd0, uint8 len);
 static void npMtSpiSend(uint8 *pBuf);
 uint8* npSpiPollCallback(void);
 bool npSpiReadyCallback(void);
+#if MT_PIPE_SUPPORT
+static uint8 npSpiPipeReq(uint8 *pBuf);
+#endif
 #endif
 
 /* ------------------------------------------------------------------------------------------------
@@ -221,8 +224,13 @@ uint16 znpEventLoop(uint8 taskId, uint16 events)
   {
     if ((pBuf = npSpiGetReqBuf()) != NULL )
     {
-      MT_ProcessIncoming(pBuf);
-      npSpiAReqComplete();
+#if MT_PIPE_SUPPORT
+      if (!npSpiPipeReq(pBuf))
+#endif
+      {
+        MT_ProcessIncoming(pBuf);
+        npSpiAReqComplete();
+      }
     }
 
     events ^= ZNP_SPI_RX_AREQ_EVENT;
@@ -264,6 +272,13 @@ uint16 znpEventLoop(uint8 taskId, uint16 events)
     events ^= MT_SYS_OSAL_EVENT_3;
   }
 #endif
+#if MT_SYS_NV_STREAM
+  else if (events & MT_SYS_NV_STREAM_EVT)
+  {
+    MT_SysNvStream();
+    events ^= MT_SYS_NV_STREAM_EVT;
+  }
+#endif
 #if defined POWER_SAVING
   else if (events & ZNP_PWRMGR_CONSERVE_EVENT)
   {
@@ -726,6 +741,50 @@ bool npSpiReadyCallback(void)
 {
   return !OSAL_MSG_Q_EMPTY(&npTxQueue);
 }
+
+#if MT_PIPE_SUPPORT
+/**************************************************************************************************
+ * @fn          npSpiPipeReq
+ *
+ * @brief       This function processes a pipelined request (MT_SYS_PIPE_REQ) received on SPI.
+ *              The request is copied out of the SPI buffer and the SPI released before it is
+ *              processed, so that the host can send the next request meanwhile; the responses are
+ *              queued as AREQs for the host to POLL.
+ *
+ * input parameters
+ *
+ * @param pBuf - Pointer to the received AREQ in the SPI buffer.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the frame was a pipelined request and has been processed; FALSE if it is
+ *              to be processed in place as any other AREQ.
+ **************************************************************************************************
+ */
+static uint8 npSpiPipeReq(uint8 *pBuf)
+{
+  uint8 len = pBuf[MT_RPC_POS_LEN] + MT_RPC_FRAME_HDR_SZ;
+  uint8 *pReq;
+
+  if ((pBuf[MT_RPC_POS_CMD0] != ((uint8)MT_RPC_CMD_AREQ | (uint8)MT_RPC_SYS_SYS)) ||
+      (pBuf[MT_RPC_POS_CMD1] != MT_SYS_PIPE_REQ) ||
+      ((pReq = osal_mem_alloc(len)) == NULL))
+  {
+    return FALSE;
+  }
+
+  (void)osal_memcpy(pReq, pBuf, len);
+  MT_PipeQueued(pReq);
+  npSpiAReqComplete();
+
+  MT_ProcessIncoming(pReq);
+  (void)osal_mem_free(pReq);
+
+  return TRUE;
+}
+#endif
 #endif
 
 /**************************************************************************************************